@@ -41,6 +41,7 @@
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-notify.h>
+#include <thunar/thunar-profiler.h>
 #include <thunar/thunar-session-client.h>
 #include <thunar/thunar-stock.h>
 #include <thunar/thunar-preferences.h>
@@ -309,6 +310,9 @@ error0:
   /* enter the main loop */
   gtk_main ();
 
+  /* write the profile, if requested */
+  thunar_profiler_shutdown ();
+
 #ifdef HAVE_DBUS
   if (dbus_service != NULL)
     g_object_unref (G_OBJECT (dbus_service));
@@ -61,6 +61,11 @@
 
 
 
+/* the number of finished jobs kept for the job statistics */
+#define THUNAR_APPLICATION_MAX_FINISHED_JOBS (32)
+
+
+
 /* Prototype for the Thunar job launchers */
 typedef ThunarJob *(*Launcher) (GList *source_path_list,
                                 GList *target_path_list);
@@ -95,6 +100,8 @@ static void           thunar_application_collect_and_launch     (ThunarApplicati
                                                                  GClosure               *new_files_closure);
 static void           thunar_application_launch_finished        (ThunarJob              *job,
                                                                  ThunarView             *view);
+static void           thunar_application_job_finished           (ThunarJob              *job,
+                                                                 ThunarApplication      *application);
 static void           thunar_application_launch                 (ThunarApplication      *application,
                                                                  gpointer                parent,
                                                                  const gchar            *icon_name,
@@ -140,6 +147,12 @@ struct _ThunarApplication
   ThunarThumbnailCache  *thumbnail_cache;
   ThunarThumbnailer     *thumbnailer;
 
+  ThunarJobScheduler    *job_scheduler;
+
+  /* the running jobs and the statistics of the last finished ones */
+  GList                 *running_jobs;
+  GList                 *finished_job_stats;
+
   gboolean               daemon;
 
   guint                  show_dialogs_timer_id;
@@ -160,6 +173,7 @@ struct _ThunarApplication
 static GQuark thunar_application_screen_quark;
 static GQuark thunar_application_startup_id_quark;
 static GQuark thunar_application_file_quark;
+static GQuark thunar_application_job_title_quark;
 
 
 
@@ -180,6 +194,8 @@ thunar_application_class_init (ThunarApplicationClass *klass)
     g_quark_from_static_string ("thunar-application-startup-id");
   thunar_application_file_quark =
     g_quark_from_static_string ("thunar-application-file");
+  thunar_application_job_title_quark =
+    g_quark_from_static_string ("thunar-application-job-title");
 
   gobject_class = G_OBJECT_CLASS (klass);
   gobject_class->finalize = thunar_application_finalize;
@@ -219,6 +235,9 @@ thunar_application_init (ThunarApplication *application)
   application->files_to_launch = NULL;
   application->progress_dialog = NULL;
 
+  /* the jobs look up the scheduler from their threads */
+  application->job_scheduler = thunar_job_scheduler_new ();
+
   /* check if we have a saved accel map */
   path = xfce_resource_lookup (XFCE_RESOURCE_CONFIG, "Thunar/accels.scm");
   if (G_LIKELY (path != NULL))
@@ -296,6 +315,18 @@ thunar_application_finalize (GObject *object)
   if (application->thumbnail_cache != NULL)
     g_object_unref (G_OBJECT (application->thumbnail_cache));
 
+  /* release the job scheduler */
+  g_object_unref (G_OBJECT (application->job_scheduler));
+
+  /* release the job statistics */
+  for (lp = application->running_jobs; lp != NULL; lp = lp->next)
+    {
+      g_signal_handlers_disconnect_by_func (G_OBJECT (lp->data), G_CALLBACK (thunar_application_job_finished), application);
+      g_object_unref (G_OBJECT (lp->data));
+    }
+  g_list_free (application->running_jobs);
+  g_list_free_full (application->finished_job_stats, (GDestroyNotify) thunar_job_stats_free);
+
   /* disconnect from the preferences */
   g_object_unref (G_OBJECT (application->preferences));
   
@@ -447,6 +478,39 @@ thunar_application_launch_finished (ThunarJob  *job,
 
 
 
+static void
+thunar_application_job_finished (ThunarJob         *job,
+                                 ThunarApplication *application)
+{
+  ThunarJobStats *stats;
+  GList          *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+  _thunar_return_if_fail (THUNAR_IS_APPLICATION (application));
+
+  /* jobs that returned early did not leave their phase */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_IDLE);
+
+  /* keep the statistics of the last finished jobs */
+  stats = thunar_job_get_stats (job);
+  stats->title = g_strdup (g_object_get_qdata (G_OBJECT (job), thunar_application_job_title_quark));
+  application->finished_job_stats = g_list_prepend (application->finished_job_stats, stats);
+
+  lp = g_list_nth (application->finished_job_stats, THUNAR_APPLICATION_MAX_FINISHED_JOBS);
+  if (lp != NULL)
+    {
+      lp->prev->next = NULL;
+      g_list_free_full (lp, (GDestroyNotify) thunar_job_stats_free);
+    }
+
+  /* forget the running job */
+  g_signal_handlers_disconnect_by_func (G_OBJECT (job), G_CALLBACK (thunar_application_job_finished), application);
+  application->running_jobs = g_list_remove (application->running_jobs, job);
+  g_object_unref (G_OBJECT (job));
+}
+
+
+
 static void
 thunar_application_launch (ThunarApplication *application,
                            gpointer           parent,
@@ -469,6 +533,13 @@ thunar_application_launch (ThunarApplication *application,
   /* try to allocate a new job for the operation */
   job = (*launcher) (source_file_list, target_file_list);
 
+  /* remember the job for the job statistics */
+  g_object_set_qdata_full (G_OBJECT (job), thunar_application_job_title_quark,
+                           g_strdup (title), g_free);
+  application->running_jobs = g_list_prepend (application->running_jobs, g_object_ref (job));
+  g_signal_connect (G_OBJECT (job), "finished",
+                    G_CALLBACK (thunar_application_job_finished), application);
+
   if (THUNAR_IS_VIEW (parent))
     {
       /* connect a callback to instantly refresh the thunar view */
@@ -2065,3 +2136,60 @@ thunar_application_get_thumbnail_cache (ThunarApplication *application)
 }
 
 
+
+/**
+ * thunar_application_get_job_scheduler:
+ * @application : a #ThunarApplication.
+ *
+ * Returns the #ThunarJobScheduler that decides when the copy, move,
+ * delete and trash jobs may start. May be called from any thread.
+ *
+ * The caller is responsible to free the returned object
+ * using g_object_unref() when no longer needed.
+ *
+ * Return value: the #ThunarJobScheduler of @application.
+ **/
+ThunarJobScheduler *
+thunar_application_get_job_scheduler (ThunarApplication *application)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_APPLICATION (application), NULL);
+  return g_object_ref (application->job_scheduler);
+}
+
+
+
+/**
+ * thunar_application_get_job_statistics:
+ * @application : a #ThunarApplication.
+ *
+ * Returns the statistics of the running jobs, followed by the
+ * statistics of the last finished jobs, newest first.
+ *
+ * The caller is responsible to free the returned list
+ * using g_list_free_full() with thunar_job_stats_free().
+ *
+ * Return value: the list of #ThunarJobStats of @application.
+ **/
+GList *
+thunar_application_get_job_statistics (ThunarApplication *application)
+{
+  ThunarJobStats *stats;
+  GList          *statistics = NULL;
+  GList          *lp;
+
+  _thunar_return_val_if_fail (THUNAR_IS_APPLICATION (application), NULL);
+
+  for (lp = application->running_jobs; lp != NULL; lp = lp->next)
+    {
+      stats = thunar_job_get_stats (lp->data);
+      stats->title = g_strdup (g_object_get_qdata (G_OBJECT (lp->data), thunar_application_job_title_quark));
+      statistics = g_list_prepend (statistics, stats);
+    }
+
+  for (lp = application->finished_job_stats; lp != NULL; lp = lp->next)
+    statistics = g_list_prepend (statistics, thunar_job_stats_copy (lp->data));
+
+  return g_list_reverse (statistics);
+}
+
+
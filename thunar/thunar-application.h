@@ -23,6 +23,7 @@
 #ifndef __THUNAR_APPLICATION_H__
 #define __THUNAR_APPLICATION_H__
 
+#include <thunar/thunar-job-scheduler.h>
 #include <thunar/thunar-window.h>
 #include <thunar/thunar-thumbnail-cache.h>
 
@@ -144,6 +145,10 @@ void                  thunar_application_restore_files             (ThunarApplic
 
 ThunarThumbnailCache *thunar_application_get_thumbnail_cache       (ThunarApplication *application);
 
+ThunarJobScheduler   *thunar_application_get_job_scheduler         (ThunarApplication *application);
+
+GList                *thunar_application_get_job_statistics        (ThunarApplication *application);
+
 G_END_DECLS;
 
 #endif /* !__THUNAR_APPLICATION_H__ */
@@ -43,6 +43,7 @@
 #include <thunar/thunar-dbus-service.h>
 #include <thunar/thunar-file.h>
 #include <thunar/thunar-gdk-extensions.h>
+#include <thunar/thunar-job.h>
 #include <thunar/thunar-preferences-dialog.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-properties-dialog.h>
@@ -194,6 +195,9 @@ static gboolean thunar_dbus_service_unlink_files                (ThunarDBusServi
                                                                  const gchar            *display,
                                                                  const gchar            *startup_id,
                                                                  GError                **error);
+static gboolean thunar_dbus_service_get_job_statistics         (ThunarDBusService      *dbus_service,
+                                                                 GPtrArray             **statistics,
+                                                                 GError                **error);
 static gboolean thunar_dbus_service_terminate                   (ThunarDBusService      *dbus_service,
                                                                  GError                **error);
 
@@ -1312,6 +1316,115 @@ thunar_dbus_service_unlink_files (ThunarDBusService  *dbus_service,
 
 
 
+static void
+thunar_dbus_service_value_free (gpointer data)
+{
+  g_value_unset (data);
+  g_slice_free (GValue, data);
+}
+
+
+
+static GValue *
+thunar_dbus_service_value_new (GType type)
+{
+  return g_value_init (g_slice_new0 (GValue), type);
+}
+
+
+
+static gboolean
+thunar_dbus_service_get_job_statistics (ThunarDBusService *dbus_service,
+                                        GPtrArray        **statistics,
+                                        GError           **error)
+{
+  static const gchar *phase_names[] = { "idle", "queued", "collecting", "processing", "paused" };
+  static const gchar *time_names[] = { NULL, "queued-time", "collecting-time", "processing-time", "paused-time" };
+  ThunarApplication  *application;
+  ThunarJobStats     *stats;
+  GHashTable         *entry;
+  GValue             *value;
+  GArray             *array;
+  GList              *stats_list;
+  GList              *lp;
+  gchar             **slowest_files;
+  guint               n;
+
+  G_STATIC_ASSERT (G_N_ELEMENTS (phase_names) == THUNAR_JOB_N_PHASES);
+  G_STATIC_ASSERT (G_N_ELEMENTS (time_names) == THUNAR_JOB_N_PHASES);
+
+  application = thunar_application_get ();
+  stats_list = thunar_application_get_job_statistics (application);
+  g_object_unref (application);
+
+  *statistics = g_ptr_array_new ();
+  for (lp = stats_list; lp != NULL; lp = lp->next)
+    {
+      stats = lp->data;
+      entry = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, thunar_dbus_service_value_free);
+
+      value = thunar_dbus_service_value_new (G_TYPE_STRING);
+      g_value_set_string (value, (stats->title != NULL) ? stats->title : "");
+      g_hash_table_insert (entry, g_strdup ("title"), value);
+
+      value = thunar_dbus_service_value_new (G_TYPE_STRING);
+      g_value_set_static_string (value, phase_names[stats->phase]);
+      g_hash_table_insert (entry, g_strdup ("phase"), value);
+
+      value = thunar_dbus_service_value_new (G_TYPE_UINT);
+      g_value_set_uint (value, stats->n_files);
+      g_hash_table_insert (entry, g_strdup ("files"), value);
+
+      value = thunar_dbus_service_value_new (G_TYPE_UINT64);
+      g_value_set_uint64 (value, stats->n_bytes);
+      g_hash_table_insert (entry, g_strdup ("bytes"), value);
+
+      value = thunar_dbus_service_value_new (G_TYPE_DOUBLE);
+      g_value_set_double (value, thunar_job_stats_bytes_rate (stats));
+      g_hash_table_insert (entry, g_strdup ("bytes-per-second"), value);
+
+      value = thunar_dbus_service_value_new (G_TYPE_DOUBLE);
+      g_value_set_double (value, thunar_job_stats_files_rate (stats));
+      g_hash_table_insert (entry, g_strdup ("files-per-second"), value);
+
+      for (n = THUNAR_JOB_PHASE_IDLE + 1; n < THUNAR_JOB_N_PHASES; ++n)
+        {
+          value = thunar_dbus_service_value_new (G_TYPE_INT64);
+          g_value_set_int64 (value, stats->phase_times[n]);
+          g_hash_table_insert (entry, g_strdup (time_names[n]), value);
+        }
+
+      array = g_array_sized_new (FALSE, FALSE, sizeof (guint), THUNAR_JOB_STATS_N_LATENCIES);
+      g_array_append_vals (array, stats->latencies, THUNAR_JOB_STATS_N_LATENCIES);
+      value = thunar_dbus_service_value_new (dbus_g_type_get_collection ("GArray", G_TYPE_UINT));
+      g_value_take_boxed (value, array);
+      g_hash_table_insert (entry, g_strdup ("latency-histogram"), value);
+
+      /* the slowest files are filled from the start */
+      slowest_files = g_new0 (gchar *, THUNAR_JOB_STATS_N_SLOWEST + 1);
+      for (n = 0; n < THUNAR_JOB_STATS_N_SLOWEST && stats->slowest_files[n] != NULL; ++n)
+        slowest_files[n] = g_strdup (stats->slowest_files[n]);
+
+      value = thunar_dbus_service_value_new (G_TYPE_STRV);
+      g_value_take_boxed (value, slowest_files);
+      g_hash_table_insert (entry, g_strdup ("slowest-files"), value);
+
+      array = g_array_sized_new (FALSE, FALSE, sizeof (gint64), n);
+      g_array_append_vals (array, stats->slowest_times, n);
+      value = thunar_dbus_service_value_new (dbus_g_type_get_collection ("GArray", G_TYPE_INT64));
+      g_value_take_boxed (value, array);
+      g_hash_table_insert (entry, g_strdup ("slowest-times"), value);
+
+      g_ptr_array_add (*statistics, entry);
+    }
+
+  g_list_free_full (stats_list, (GDestroyNotify) thunar_job_stats_free);
+
+  return TRUE;
+}
+
+
+
 static gboolean
 thunar_dbus_service_terminate (ThunarDBusService *dbus_service,
                                GError           **error)
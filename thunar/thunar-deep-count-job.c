@@ -30,6 +30,8 @@
 #include <thunar/thunar-deep-count-job.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-marshal.h>
+#include <thunar/thunar-preferences.h>
+#include <thunar/thunar-size-cache.h>
 #include <thunar/thunar-util.h>
 #include <thunar/thunar-private.h>
 
@@ -46,11 +48,39 @@ enum
 #define DEEP_COUNT_FILE_INFO_NAMESPACE \
   G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
   G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
-  G_FILE_ATTRIBUTE_ID_FILESYSTEM
+  G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE "," \
+  G_FILE_ATTRIBUTE_ID_FILESYSTEM "," \
+  G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+  G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC "," \
+  G_FILE_ATTRIBUTE_UNIX_DEVICE "," \
+  G_FILE_ATTRIBUTE_UNIX_INODE "," \
+  G_FILE_ATTRIBUTE_UNIX_NLINK
+
+/* interval between two "status-update" emissions */
+#define DEEP_COUNT_STATUS_INTERVAL (G_USEC_PER_SEC / 4)
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _deep_count_job_lock(job)   g_mutex_lock (&((job)->lock))
+#define _deep_count_job_unlock(job) g_mutex_unlock (&((job)->lock))
+#define _deep_count_job_signal(job) g_cond_signal (&((job)->cond))
+#else
+#define _deep_count_job_lock(job)   g_mutex_lock ((job)->lock)
+#define _deep_count_job_unlock(job) g_mutex_unlock ((job)->lock)
+#define _deep_count_job_signal(job) g_cond_signal ((job)->cond)
+#endif
+
+
+
+typedef struct _ThunarDeepCountTask  ThunarDeepCountTask;
+typedef struct _ThunarDeepCountInode ThunarDeepCountInode;
+
+
 
 static void     thunar_deep_count_job_finalize   (GObject                 *object);
 static gboolean thunar_deep_count_job_execute    (ExoJob                  *job,
                                                   GError                 **error);
+static void     thunar_deep_count_job_worker     (gpointer                 data,
+                                                  gpointer                 user_data);
 
 
 
@@ -61,6 +91,7 @@ struct _ThunarDeepCountJobClass
   /* signals */
   void (*status_update) (ThunarJob *job,
                          guint64    total_size,
+                         guint64    allocated_size,
                          guint      file_count,
                          guint      directory_count,
                          guint      unreadable_directory_count);
@@ -73,14 +104,53 @@ struct _ThunarDeepCountJob
   GList              *files;
   GFileQueryInfoFlags query_flags;
 
-  /* the time of the last "status-update" emission */
-  gint64              last_time;
+  /* directories are counted by a pool of workers, the job thread
+   * only waits for them and emits the status at a steady rate */
+  GThreadPool        *workers;
+  guint               n_workers;
 
-  /* status information */
+  /* the directories queued or being counted by the workers */
+  guint               n_pending;
+
+  /* error of an unreadable job file */
+  GError             *error;
+
+  /* the inodes of counted files with more than one link, so
+   * hard links are only counted once */
+  GHashTable         *inodes;
+
+  /* contents of the directories counted before */
+  ThunarSizeCache    *size_cache;
+
+  /* status information, the workers add their counts after
+   * each directory */
   guint64             total_size;
+  guint64             allocated_size;
   guint               file_count;
   guint               directory_count;
   guint               unreadable_directory_count;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex              lock;
+  GCond               cond;
+#else
+  GMutex             *lock;
+  GCond              *cond;
+#endif
+};
+
+struct _ThunarDeepCountTask
+{
+  GFile              *file;
+  gchar              *fs_id;
+  guint64             mtime;
+  gboolean            toplevel;
+};
+
+struct _ThunarDeepCountInode
+{
+  guint32             device;
+  guint64             inode;
 };
 
 
@@ -109,6 +179,7 @@ thunar_deep_count_job_class_init (ThunarDeepCountJobClass *klass)
    * ThunarDeepCountJob::status-update:
    * @job                        : a #ThunarJob.
    * @total_size                 : the total size in bytes.
+   * @allocated_size             : the total size allocated on disk in bytes.
    * @file_count                 : the number of files.
    * @directory_count            : the number of directories.
    * @unreadable_directory_count : the number of unreadable directories.
@@ -122,8 +193,9 @@ thunar_deep_count_job_class_init (ThunarDeepCountJobClass *klass)
                   G_SIGNAL_NO_HOOKS,
                   G_STRUCT_OFFSET (ThunarDeepCountJobClass, status_update),
                   NULL, NULL,
-                  _thunar_marshal_VOID__UINT64_UINT_UINT_UINT,
-                  G_TYPE_NONE, 4,
+                  _thunar_marshal_VOID__UINT64_UINT64_UINT_UINT_UINT,
+                  G_TYPE_NONE, 5,
+                  G_TYPE_UINT64,
                   G_TYPE_UINT64,
                   G_TYPE_UINT,
                   G_TYPE_UINT,
@@ -132,10 +204,45 @@ thunar_deep_count_job_class_init (ThunarDeepCountJobClass *klass)
 
 
 
+static guint
+thunar_deep_count_inode_hash (gconstpointer key)
+{
+  const ThunarDeepCountInode *inode = key;
+
+  return (guint) (inode->inode ^ (inode->inode >> 32)) ^ inode->device;
+}
+
+
+
+static gboolean
+thunar_deep_count_inode_equal (gconstpointer a,
+                               gconstpointer b)
+{
+  const ThunarDeepCountInode *inode_a = a;
+  const ThunarDeepCountInode *inode_b = b;
+
+  return inode_a->inode == inode_b->inode && inode_a->device == inode_b->device;
+}
+
+
+
 static void
 thunar_deep_count_job_init (ThunarDeepCountJob *job)
 {
   job->query_flags = G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS;
+  job->n_workers = 4;
+  job->inodes = g_hash_table_new_full (thunar_deep_count_inode_hash,
+                                       thunar_deep_count_inode_equal,
+                                       g_free, NULL);
+  job->size_cache = thunar_size_cache_get ();
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->cond);
+#else
+  job->lock = g_mutex_new ();
+  job->cond = g_cond_new ();
+#endif
 }
 
 
@@ -147,6 +254,20 @@ thunar_deep_count_job_finalize (GObject *object)
 
   g_list_free_full (job->files, g_object_unref);
 
+  g_hash_table_destroy (job->inodes);
+  g_object_unref (job->size_cache);
+
+  if (job->error != NULL)
+    g_error_free (job->error);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&job->lock);
+  g_cond_clear (&job->cond);
+#else
+  g_mutex_free (job->lock);
+  g_cond_free (job->cond);
+#endif
+
   (*G_OBJECT_CLASS (thunar_deep_count_job_parent_class)->finalize) (object);
 }
 
@@ -155,183 +276,356 @@ thunar_deep_count_job_finalize (GObject *object)
 static void
 thunar_deep_count_job_status_update (ThunarDeepCountJob *job)
 {
+  guint64 total_size;
+  guint64 allocated_size;
+  guint   file_count;
+  guint   directory_count;
+  guint   unreadable_directory_count;
+
   _thunar_return_if_fail (THUNAR_IS_DEEP_COUNT_JOB (job));
 
+  /* take a snapshot of the counts of the workers */
+  _deep_count_job_lock (job);
+  total_size = job->total_size;
+  allocated_size = job->allocated_size;
+  file_count = job->file_count;
+  directory_count = job->directory_count;
+  unreadable_directory_count = job->unreadable_directory_count;
+  _deep_count_job_unlock (job);
+
   exo_job_emit (EXO_JOB (job),
                 deep_count_signals[STATUS_UPDATE],
                 0,
-                job->total_size,
-                job->file_count,
-                job->directory_count,
-                job->unreadable_directory_count);
+                total_size,
+                allocated_size,
+                file_count,
+                directory_count,
+                unreadable_directory_count);
 }
 
 
 
+/* checks whether a file with more than one link was counted already,
+ * must be called with the job lock held */
 static gboolean
-thunar_deep_count_job_process (ExoJob       *job,
-                               GFile        *file,
-                               GFileInfo    *file_info,
-                               const gchar  *toplevel_fs_id,
-                               GError      **error)
+thunar_deep_count_job_is_counted (ThunarDeepCountJob *job,
+                                  GFileInfo          *info)
 {
-  ThunarDeepCountJob *count_job = THUNAR_DEEP_COUNT_JOB (job);
-  GFileEnumerator    *enumerator;
-  GFileInfo          *child_info;
-  GFileInfo          *info;
-  gboolean            success = TRUE;
-  GFile              *child;
-  gint64              real_time;
-  const gchar        *fs_id;
-  gboolean            toplevel_file = (toplevel_fs_id == NULL);
+  ThunarDeepCountInode  key;
+  ThunarDeepCountInode *inode;
 
-  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
-  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
-  _thunar_return_val_if_fail (file_info == NULL || G_IS_FILE_INFO (file_info), FALSE);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
-
-  /* abort if job was already cancelled */
-  if (exo_job_is_cancelled (job))
+  if (g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_NLINK) < 2
+      || !g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_INODE))
     return FALSE;
 
-  if (file_info != NULL)
-    {
-      /* use the enumerator info */
-      info = g_object_ref (file_info);
-    }
+  key.device = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+  key.inode = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+
+  if (g_hash_table_lookup (job->inodes, &key) != NULL)
+    return TRUE;
+
+  inode = g_memdup (&key, sizeof (key));
+  g_hash_table_insert (job->inodes, inode, inode);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_deep_count_job_queue (ThunarDeepCountJob *job,
+                             GFile              *file,
+                             const gchar        *fs_id,
+                             guint64             mtime,
+                             gboolean            toplevel)
+{
+  ThunarDeepCountTask *task;
+
+  task = g_slice_new (ThunarDeepCountTask);
+  task->file = g_object_ref (file);
+  task->fs_id = g_strdup (fs_id);
+  task->mtime = mtime;
+  task->toplevel = toplevel;
+
+  _deep_count_job_lock (job);
+  job->n_pending++;
+  _deep_count_job_unlock (job);
+
+  g_thread_pool_push (job->workers, task, NULL);
+}
+
+
+
+static void thunar_deep_count_job_process (ThunarDeepCountJob *job,
+                                           GFile              *file,
+                                           const gchar        *fs_id,
+                                           guint64             mtime,
+                                           gboolean            toplevel);
+
+
+
+static void
+thunar_deep_count_job_descend (ThunarDeepCountJob *job,
+                               GFile              *directory,
+                               GFileInfo          *info,
+                               const gchar        *fs_id)
+{
+  guint64 mtime;
+
+  mtime = thunar_size_cache_get_mtime (info);
+
+  /* hand the directory to an idle worker, but count it in this
+   * thread if the others have enough work queued already */
+  if (g_thread_pool_unprocessed (job->workers) < job->n_workers)
+    thunar_deep_count_job_queue (job, directory, fs_id, mtime, FALSE);
   else
-    {
-      /* query size and type of the current file */
-      info = g_file_query_info (file,
-                                DEEP_COUNT_FILE_INFO_NAMESPACE,
-                                count_job->query_flags,
-                                exo_job_get_cancellable (job),
-                                error);
-    }
+    thunar_deep_count_job_process (job, directory, fs_id, mtime, FALSE);
+}
 
-  /* abort on invalid info or cancellation */
-  if (info == NULL)
-    return FALSE;
 
-  /* abort on cancellation */
-  if (exo_job_is_cancelled (job))
-    {
-      g_object_unref (info);
-      return FALSE;
-    }
 
-  /* only check files on the same filesystem so no remote mounts or
-   * dummy filesystems are counted */
-  fs_id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
-  if (fs_id == NULL)
-    fs_id = "";
+static gboolean
+thunar_deep_count_job_same_fs (GFileInfo   *info,
+                               const gchar *fs_id)
+{
+  const gchar *child_fs_id;
 
-  if (toplevel_fs_id == NULL)
-    {
-      /* first toplevel, so use this id */
-      toplevel_fs_id = fs_id;
-    }
-  else if (strcmp (fs_id, toplevel_fs_id) != 0)
+  child_fs_id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
+  return g_strcmp0 (child_fs_id != NULL ? child_fs_id : "", fs_id) == 0;
+}
+
+
+
+static void
+thunar_deep_count_job_process (ThunarDeepCountJob *job,
+                               GFile              *file,
+                               const gchar        *fs_id,
+                               guint64             mtime,
+                               gboolean            toplevel)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo       *child_info;
+  GPtrArray       *subdirectories;
+  GError          *err = NULL;
+  GFile           *child;
+  guint64          total_size = 0;
+  guint64          allocated_size = 0;
+  guint            file_count = 0;
+  gboolean         counted;
+  gboolean         has_links = FALSE;
+  gchar          **names;
+  guint            n;
+
+  _thunar_return_if_fail (THUNAR_IS_DEEP_COUNT_JOB (job));
+  _thunar_return_if_fail (G_IS_FILE (file));
+
+  /* abort if job was already cancelled */
+  if (exo_job_is_cancelled (EXO_JOB (job)))
+    return;
+
+  /* reuse the contents of directories that did not change since they
+   * were counted, only their subdirectories have to be checked */
+  if (thunar_size_cache_lookup (job->size_cache, file, mtime,
+                                &total_size, &allocated_size,
+                                &file_count, &names))
     {
-      /* release the file info */
-      g_object_unref (info);
+      for (n = 0; names[n] != NULL && !exo_job_is_cancelled (EXO_JOB (job)); ++n)
+        {
+          child = g_file_get_child (file, names[n]);
+          child_info = g_file_query_info (child,
+                                          DEEP_COUNT_FILE_INFO_NAMESPACE,
+                                          job->query_flags,
+                                          exo_job_get_cancellable (EXO_JOB (job)),
+                                          NULL);
+          if (child_info != NULL)
+            {
+              if (g_file_info_get_file_type (child_info) == G_FILE_TYPE_DIRECTORY
+                  && thunar_deep_count_job_same_fs (child_info, fs_id))
+                thunar_deep_count_job_descend (job, child, child_info, fs_id);
 
-      /* other filesystem, continue */
-      return TRUE;
-    }
+              g_object_unref (child_info);
+            }
+          g_object_unref (child);
+        }
 
-  /* recurse if we have a directory */
-  if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+      g_strfreev (names);
+    }
+  else
     {
       /* try to read from the directory */
       enumerator = g_file_enumerate_children (file,
                                               DEEP_COUNT_FILE_INFO_NAMESPACE ","
                                               G_FILE_ATTRIBUTE_STANDARD_NAME,
-                                              count_job->query_flags,
-                                              exo_job_get_cancellable (job),
-                                              error);
+                                              job->query_flags,
+                                              exo_job_get_cancellable (EXO_JOB (job)),
+                                              &err);
 
-      if (!exo_job_is_cancelled (job))
+      if (enumerator == NULL)
         {
-          if (enumerator == NULL)
+          _deep_count_job_lock (job);
+
+          if (!exo_job_is_cancelled (EXO_JOB (job)))
             {
               /* directory was unreadable */
-              count_job->unreadable_directory_count++;
+              job->unreadable_directory_count++;
 
-              if (toplevel_file
-                  && g_list_length (count_job->files) < 2)
-                {
-                  /* we only bail out if the job file is unreadable */
-                  success = FALSE;
-                }
-              else
+              /* remember the error of the job file, the job fails if it
+               * was the only one */
+              if (toplevel && job->error == NULL)
                 {
-                  /* ignore errors from files other than the job file */
-                  g_clear_error (error);
+                  job->error = err;
+                  err = NULL;
                 }
             }
-          else
-            {
-              /* directory was readable */
-              count_job->directory_count++;
 
-              while (!exo_job_is_cancelled (job))
-                {
-                  /* query next child info */
-                  child_info = g_file_enumerator_next_file (enumerator,
-                                                            exo_job_get_cancellable (job),
-                                                            error);
+          _deep_count_job_unlock (job);
 
-                  /* abort on invalid child info (iteration ends) or cancellation */
-                  if (child_info == NULL)
-                    break;
+          g_clear_error (&err);
+          return;
+        }
 
-                  if (!exo_job_is_cancelled (job))
-                    {
-                      /* generate a GFile for the child */
-                      child = g_file_resolve_relative_path (file, g_file_info_get_name (child_info));
+      /* the names of the subdirectories for the size cache */
+      subdirectories = g_ptr_array_new_with_free_func (g_free);
 
-                      /* recurse unless the job was cancelled before */
-                      thunar_deep_count_job_process (job, child, child_info, toplevel_fs_id, error);
+      while (!exo_job_is_cancelled (EXO_JOB (job)))
+        {
+          /* query next child info */
+          child_info = g_file_enumerator_next_file (enumerator,
+                                                    exo_job_get_cancellable (EXO_JOB (job)),
+                                                    &err);
+
+          /* abort on invalid child info (iteration ends) or cancellation */
+          if (child_info == NULL)
+            break;
+
+          /* only check files on the same filesystem so no remote mounts or
+           * dummy filesystems are counted */
+          if (!thunar_deep_count_job_same_fs (child_info, fs_id))
+            {
+              g_object_unref (child_info);
+              continue;
+            }
 
-                      /* free resources */
-                      g_object_unref (child);
-                    }
+          if (g_file_info_get_file_type (child_info) == G_FILE_TYPE_DIRECTORY)
+            {
+              g_ptr_array_add (subdirectories, g_strdup (g_file_info_get_name (child_info)));
 
-                  g_object_unref (child_info);
+              child = g_file_get_child (file, g_file_info_get_name (child_info));
+              thunar_deep_count_job_descend (job, child, child_info, fs_id);
+              g_object_unref (child);
+            }
+          else
+            {
+              /* count hard linked files only once, the other files
+               * don't need the shared inode table */
+              if (g_file_info_get_attribute_uint32 (child_info, G_FILE_ATTRIBUTE_UNIX_NLINK) > 1)
+                {
+                  has_links = TRUE;
+
+                  _deep_count_job_lock (job);
+                  counted = thunar_deep_count_job_is_counted (job, child_info);
+                  _deep_count_job_unlock (job);
+                }
+              else
+                {
+                  counted = FALSE;
+                }
+
+              if (!counted)
+                {
+                  file_count++;
+                  total_size += g_file_info_get_size (child_info);
+                  allocated_size += g_file_info_get_attribute_uint64 (child_info,
+                                                                      G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE);
                 }
             }
+
+          g_object_unref (child_info);
         }
 
       /* destroy the enumerator */
-      if (enumerator != NULL)
-        g_object_unref (enumerator);
+      g_object_unref (enumerator);
 
-      /* emit status update whenever we've finished a directory,
-       * but not more than four times per second */
-      real_time = g_get_real_time ();
-      if (real_time >= count_job->last_time)
+      /* remember the complete contents of the directory. directories with
+       * hard links are not cached, their counts depend on the other
+       * directories counted in the same job */
+      if (err == NULL && !has_links && !exo_job_is_cancelled (EXO_JOB (job)))
         {
-          if (count_job->last_time != 0)
-            thunar_deep_count_job_status_update (count_job);
-          count_job->last_time = real_time + (G_USEC_PER_SEC / 4);
+          g_ptr_array_add (subdirectories, NULL);
+          thunar_size_cache_insert (job->size_cache, file, mtime,
+                                    total_size, allocated_size, file_count,
+                                    (gchar **) g_ptr_array_free (subdirectories, FALSE));
         }
+      else
+        {
+          g_ptr_array_free (subdirectories, TRUE);
+        }
+
+      g_clear_error (&err);
     }
-  else
-    {
-      /* we have a regular file or at least not a directory */
-      count_job->file_count++;
 
-      /* add size of the file to the total size */
-      count_job->total_size += g_file_info_get_size (info);
+  /* add the counts of this directory */
+  _deep_count_job_lock (job);
+  job->directory_count++;
+  job->file_count += file_count;
+  job->total_size += total_size;
+  job->allocated_size += allocated_size;
+  _deep_count_job_unlock (job);
+}
+
+
+
+static void
+thunar_deep_count_job_worker (gpointer data,
+                              gpointer user_data)
+{
+  ThunarDeepCountTask *task = data;
+  ThunarDeepCountJob  *job = THUNAR_DEEP_COUNT_JOB (user_data);
+
+  thunar_deep_count_job_process (job, task->file, task->fs_id, task->mtime, task->toplevel);
+
+  /* wake up the job thread once all directories are counted */
+  _deep_count_job_lock (job);
+  if (--job->n_pending == 0)
+    _deep_count_job_signal (job);
+  _deep_count_job_unlock (job);
+
+  g_object_unref (task->file);
+  g_free (task->fs_id);
+  g_slice_free (ThunarDeepCountTask, task);
+}
+
+
+
+static gboolean
+thunar_deep_count_job_wait (ThunarDeepCountJob *job)
+{
+  gboolean done;
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  gint64   end_time;
+#else
+  GTimeVal end_time;
+#endif
+
+  _deep_count_job_lock (job);
+
+  if (job->n_pending > 0)
+    {
+#if GLIB_CHECK_VERSION (2, 32, 0)
+      end_time = g_get_monotonic_time () + DEEP_COUNT_STATUS_INTERVAL;
+      g_cond_wait_until (&job->cond, &job->lock, end_time);
+#else
+      g_get_current_time (&end_time);
+      g_time_val_add (&end_time, DEEP_COUNT_STATUS_INTERVAL);
+      g_cond_timed_wait (job->cond, job->lock, &end_time);
+#endif
     }
 
-  /* destroy the file info */
-  g_object_unref (info);
+  done = (job->n_pending == 0);
+
+  _deep_count_job_unlock (job);
 
-  /* we've succeeded if there was no error when loading information
-   * about the job file itself and the job was not cancelled */
-  return !exo_job_is_cancelled (job) && success;
+  return done;
 }
 
 
@@ -341,10 +635,11 @@ thunar_deep_count_job_execute (ExoJob  *job,
                                GError **error)
 {
   ThunarDeepCountJob *count_job = THUNAR_DEEP_COUNT_JOB (job);
-  gboolean            success = TRUE;
+  GFileInfo          *info;
   GError             *err = NULL;
   GList              *lp;
   GFile              *gfile;
+  const gchar        *fs_id;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -355,44 +650,96 @@ thunar_deep_count_job_execute (ExoJob  *job,
 
   /* reset counters */
   count_job->total_size = 0;
+  count_job->allocated_size = 0;
   count_job->file_count = 0;
   count_job->directory_count = 0;
   count_job->unreadable_directory_count = 0;
-  count_job->last_time = 0;
+
+  count_job->workers = g_thread_pool_new (thunar_deep_count_job_worker, count_job,
+                                          count_job->n_workers, FALSE, NULL);
 
   /* count files, directories and compute size of the job files */
-  for (lp = count_job->files; lp != NULL; lp = lp->next)
+  for (lp = count_job->files; lp != NULL && err == NULL; lp = lp->next)
     {
       gfile = thunar_file_get_file (THUNAR_FILE (lp->data));
-      success = thunar_deep_count_job_process (job, gfile, NULL, NULL, &err);
-      if (G_UNLIKELY (!success))
-        break;
-    }
 
-  if (!success)
-    {
-      g_assert (err != NULL || exo_job_is_cancelled (job));
+      /* query size and type of the job file */
+      info = g_file_query_info (gfile,
+                                DEEP_COUNT_FILE_INFO_NAMESPACE,
+                                count_job->query_flags,
+                                exo_job_get_cancellable (job),
+                                &err);
+      if (G_UNLIKELY (info == NULL))
+        break;
 
-      /* set error if the job was cancelled. otherwise just propagate
-       * the results of the processing function */
-      if (exo_job_set_error_if_cancelled (job, error))
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
         {
-          if (err != NULL)
-            g_error_free (err);
+          /* each job file defines the filesystem that is counted below it */
+          fs_id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
+          thunar_deep_count_job_queue (count_job, gfile, fs_id != NULL ? fs_id : "",
+                                       thunar_size_cache_get_mtime (info),
+                                       TRUE);
         }
       else
         {
-          if (err != NULL)
-            g_propagate_error (error, err);
+          /* we have a regular file or at least not a directory */
+          _deep_count_job_lock (count_job);
+          if (!thunar_deep_count_job_is_counted (count_job, info))
+            {
+              count_job->file_count++;
+              count_job->total_size += g_file_info_get_size (info);
+              count_job->allocated_size += g_file_info_get_attribute_uint64 (info,
+                                                                             G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE);
+            }
+          _deep_count_job_unlock (count_job);
         }
+
+      g_object_unref (info);
     }
-  else if (!exo_job_is_cancelled (job))
-    {
-      /* emit final status update at the very end of the computation */
+
+  /* emit the counts at a steady rate until the workers are done,
+   * they stop early if the job was cancelled */
+  while (!thunar_deep_count_job_wait (count_job))
+    if (!exo_job_is_cancelled (job))
       thunar_deep_count_job_status_update (count_job);
+
+  g_thread_pool_free (count_job->workers, FALSE, TRUE);
+  count_job->workers = NULL;
+
+  /* we only bail out if the job file is unreadable */
+  if (err == NULL && count_job->error != NULL && g_list_length (count_job->files) < 2)
+    {
+      err = count_job->error;
+      count_job->error = NULL;
     }
 
-  return success;
+  /* set error if the job was cancelled. otherwise just propagate
+   * the results of the processing function */
+  if (exo_job_set_error_if_cancelled (job, error))
+    {
+      if (err != NULL)
+        g_error_free (err);
+      return FALSE;
+    }
+  else if (err != NULL)
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  /* remember the total of a single folder for the details view */
+  if (count_job->files->next == NULL
+      && count_job->unreadable_directory_count == 0
+      && thunar_file_is_directory (THUNAR_FILE (count_job->files->data)))
+    {
+      gfile = thunar_file_get_file (THUNAR_FILE (count_job->files->data));
+      thunar_size_cache_set_total (count_job->size_cache, gfile, count_job->total_size);
+    }
+
+  /* emit final status update at the very end of the computation */
+  thunar_deep_count_job_status_update (count_job);
+
+  return TRUE;
 }
 
 
@@ -401,6 +748,7 @@ ThunarDeepCountJob *
 thunar_deep_count_job_new (GList               *files,
                            GFileQueryInfoFlags  flags)
 {
+  ThunarPreferences  *preferences;
   ThunarDeepCountJob *job;
 
   _thunar_return_val_if_fail (files != NULL, NULL);
@@ -409,6 +757,11 @@ thunar_deep_count_job_new (GList               *files,
   job->files = g_list_copy (files);
   job->query_flags = flags;
 
+  /* determine the number of workers */
+  preferences = thunar_preferences_get ();
+  g_object_get (G_OBJECT (preferences), "misc-deep-count-workers", &job->n_workers, NULL);
+  g_object_unref (preferences);
+
   g_list_foreach (job->files, (GFunc) g_object_ref, NULL);
 
   return job;
@@ -21,6 +21,10 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include <gdk/gdkkeysyms.h>
 
 #include <thunar/thunar-column-editor.h>
@@ -33,6 +37,14 @@
 
 
 
+/* number of rows from which on the column widths are estimated */
+#define THUNAR_DETAILS_VIEW_ESTIMATE_MIN_ROWS (2000)
+
+/* number of rows measured to estimate the column widths */
+#define THUNAR_DETAILS_VIEW_ESTIMATE_SAMPLES  (256)
+
+
+
 /* Property identifiers */
 enum
 {
@@ -102,6 +114,16 @@ static void         thunar_details_view_action_setup_columns    (GtkAction
 static gboolean     thunar_details_view_get_fixed_columns       (ThunarDetailsView      *details_view);
 static void         thunar_details_view_set_fixed_columns       (ThunarDetailsView      *details_view,
                                                                  gboolean                fixed_columns);
+static gint         thunar_details_view_measure_row             (ThunarDetailsView      *details_view,
+                                                                 GtkTreeModel           *model,
+                                                                 GtkTreeIter            *iter,
+                                                                 ThunarColumn            column);
+static void         thunar_details_view_update_estimation       (ThunarDetailsView      *details_view);
+static void         thunar_details_view_num_files_changed       (ThunarDetailsView      *details_view);
+static void         thunar_details_view_folder_changed          (ThunarDetailsView      *details_view);
+static void         thunar_details_view_schedule_grow           (ThunarDetailsView      *details_view);
+static gboolean     thunar_details_view_grow_idle               (gpointer                user_data);
+static void         thunar_details_view_grow_idle_destroy       (gpointer                user_data);
 
 
 
@@ -123,6 +145,13 @@ struct _ThunarDetailsView
   /* whether to use fixed column widths */
   gboolean           fixed_columns;
 
+  /* whether the column widths are estimated from a sample
+   * of the rows, because the folder is too large to measure
+   * every row. The widths grow while scrolling through it.
+   */
+  gboolean           estimated_columns;
+  guint              grow_idle_id;
+
   /* the UI manager merge id for the details view */
   guint              ui_merge_id;
 };
@@ -201,6 +230,16 @@ thunar_details_view_init (ThunarDetailsView *details_view)
    */
   g_signal_connect (G_OBJECT (details_view), "notify::zoom-level", G_CALLBACK (thunar_details_view_zoom_level_changed), NULL);
 
+  /* refine the estimated column widths once a folder is loaded */
+  g_signal_connect (G_OBJECT (details_view), "notify::loading", G_CALLBACK (thunar_details_view_update_estimation), NULL);
+
+  /* estimate the column widths while the rows are inserted, and
+   * start over with the widths of a newly displayed folder */
+  g_signal_connect_object (G_OBJECT (THUNAR_STANDARD_VIEW (details_view)->model), "notify::num-files",
+                           G_CALLBACK (thunar_details_view_num_files_changed), details_view, G_CONNECT_SWAPPED);
+  g_signal_connect_object (G_OBJECT (THUNAR_STANDARD_VIEW (details_view)->model), "notify::folder",
+                           G_CALLBACK (thunar_details_view_folder_changed), details_view, G_CONNECT_SWAPPED);
+
   /* setup the details view actions */
   gtk_action_group_add_actions (THUNAR_STANDARD_VIEW (details_view)->action_group,
                                 action_entries, G_N_ELEMENTS (action_entries),
@@ -219,6 +258,10 @@ thunar_details_view_init (ThunarDetailsView *details_view)
   gtk_container_add (GTK_CONTAINER (details_view), tree_view);
   gtk_widget_show (tree_view);
 
+  /* grow estimated column widths as new rows are scrolled into view */
+  g_signal_connect_object (G_OBJECT (gtk_tree_view_get_vadjustment (GTK_TREE_VIEW (tree_view))), "value-changed",
+                           G_CALLBACK (thunar_details_view_schedule_grow), details_view, G_CONNECT_SWAPPED);
+
   /* configure general aspects of the details view */
   gtk_tree_view_set_rules_hint (GTK_TREE_VIEW (tree_view), TRUE);
   gtk_tree_view_set_enable_search (GTK_TREE_VIEW (tree_view), TRUE);
@@ -365,6 +408,10 @@ thunar_details_view_finalize (GObject *object)
   ThunarDetailsView *details_view = THUNAR_DETAILS_VIEW (object);
   ThunarColumn       column;
 
+  /* stop any pending width update */
+  if (G_UNLIKELY (details_view->grow_idle_id != 0))
+    g_source_remove (details_view->grow_idle_id);
+
   /* release the tree view columns array */
   for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
     g_object_unref (G_OBJECT (details_view->columns[column]));
@@ -465,47 +512,67 @@ thunar_details_view_unselect_all (ThunarStandardView *standard_view)
 
 
 
-static void
-thunar_details_view_selection_invert_foreach (GtkTreeModel *model,
-                                              GtkTreePath  *path,
-                                              GtkTreeIter  *iter,
-                                              gpointer      data)
-{
-  GList      **list = data;
-
-  *list = g_list_prepend (*list, gtk_tree_path_copy (path));
-}
-
-
-
 static void
 thunar_details_view_selection_invert (ThunarStandardView *standard_view)
 {
   GtkTreeSelection *selection;
-  GList            *selected_paths = NULL;
-  GList            *lp;
+  GtkTreePath      *first_path;
+  GtkTreePath      *last_path;
   GtkTreePath      *path;
+  GArray           *ranges;
+  gint              n_rows;
+  gint              first = -1;
+  gint              n;
 
   _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (standard_view));
 
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (GTK_BIN (standard_view)->child));
+  n_rows = gtk_tree_model_iter_n_children (GTK_TREE_MODEL (standard_view->model), NULL);
+
+  /* collect the ranges of unselected rows in one pass, so the
+   * selection is changed once per range instead of once per row */
+  ranges = g_array_new (FALSE, FALSE, sizeof (gint));
+  path = gtk_tree_path_new_first ();
+  for (n = 0; n < n_rows; ++n, gtk_tree_path_next (path))
+    {
+      if (!gtk_tree_selection_path_is_selected (selection, path))
+        {
+          if (first < 0)
+            first = n;
+        }
+      else if (first >= 0)
+        {
+          g_array_append_val (ranges, first);
+          first = n - 1;
+          g_array_append_val (ranges, first);
+          first = -1;
+        }
+    }
+  gtk_tree_path_free (path);
+
+  if (first >= 0)
+    {
+      g_array_append_val (ranges, first);
+      first = n_rows - 1;
+      g_array_append_val (ranges, first);
+    }
 
   /* block updates */
   g_signal_handlers_block_by_func (selection, thunar_standard_view_selection_changed, standard_view);
 
-  /* get paths of selected files */
-  gtk_tree_selection_selected_foreach (selection, thunar_details_view_selection_invert_foreach, &selected_paths);
-
-  gtk_tree_selection_select_all (selection);
+  gtk_tree_selection_unselect_all (selection);
 
-  for (lp = selected_paths; lp != NULL; lp = lp->next)
+  /* select the previously unselected ranges */
+  for (n = 0; n < (gint) ranges->len; n += 2)
     {
-      path = lp->data;
-      gtk_tree_selection_unselect_path (selection, path);
-      gtk_tree_path_free (path);
+      first_path = gtk_tree_path_new_from_indices (g_array_index (ranges, gint, n), -1);
+      last_path = gtk_tree_path_new_from_indices (g_array_index (ranges, gint, n + 1), -1);
+      gtk_tree_selection_select_range (selection, first_path, last_path);
+      gtk_tree_path_free (first_path);
+      gtk_tree_path_free (last_path);
     }
 
-  g_list_free (selected_paths);
+  g_array_free (ranges, TRUE);
 
   /* unblock updates */
   g_signal_handlers_unblock_by_func (selection, thunar_standard_view_selection_changed, standard_view);
@@ -851,6 +918,13 @@ thunar_details_view_zoom_level_changed (ThunarDetailsView *details_view)
       /* just queue a resize on this column */
       gtk_tree_view_column_queue_resize (details_view->columns[column]);
     }
+
+  /* estimated widths have to be sampled again for the new size */
+  if (G_UNLIKELY (details_view->estimated_columns))
+    {
+      details_view->estimated_columns = FALSE;
+      thunar_details_view_update_estimation (details_view);
+    }
 }
 
 
@@ -937,7 +1011,261 @@ thunar_details_view_set_fixed_columns (ThunarDetailsView *details_view,
        */
       gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (GTK_BIN (details_view)->child), fixed_columns);
 
+      /* the fixed widths replace the estimated ones, or large
+       * folders need estimated widths again without them.
+       */
+      details_view->estimated_columns = FALSE;
+      thunar_details_view_update_estimation (details_view);
+
       /* notify listeners */
       g_object_notify (G_OBJECT (details_view), "fixed-columns");
     }
 }
+
+
+
+static gint
+thunar_details_view_measure_row (ThunarDetailsView *details_view,
+                                 GtkTreeModel      *model,
+                                 GtkTreeIter       *iter,
+                                 ThunarColumn       column)
+{
+  gint width;
+
+  gtk_tree_view_column_cell_set_cell_data (details_view->columns[column], model, iter, FALSE, FALSE);
+  gtk_tree_view_column_cell_get_size (details_view->columns[column], NULL, NULL, NULL, &width, NULL);
+
+  return width;
+}
+
+
+
+/**
+ * thunar_details_view_update_estimation:
+ * @details_view : a #ThunarDetailsView.
+ *
+ * Switches @details_view to estimated column widths if the
+ * folder is too large to measure every row, or back to
+ * grow-only columns otherwise. Estimated widths are taken
+ * from an evenly spaced sample of the rows plus the row with
+ * the longest name, and the fixed height mode is enabled so
+ * the #GtkTreeView does not validate all rows.
+ **/
+static void
+thunar_details_view_update_estimation (ThunarDetailsView *details_view)
+{
+  GtkTreeModel *model;
+  GtkTreeIter   iter;
+  GtkTreeIter   longest_iter;
+  ThunarColumn  column;
+  ThunarFile   *file;
+  GtkWidget    *tree_view;
+  gsize         longest_length = 0;
+  gsize         length;
+  gint          widths[THUNAR_N_VISIBLE_COLUMNS];
+  gint          separator;
+  gint          n_rows = 0;
+  gint          n;
+
+  _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (details_view));
+
+  /* the column widths were chosen by the user */
+  if (details_view->fixed_columns)
+    return;
+
+  /* the estimate is refined once the folder is completely loaded */
+  if (details_view->estimated_columns && thunar_view_get_loading (THUNAR_VIEW (details_view)))
+    return;
+
+  tree_view = GTK_BIN (details_view)->child;
+  model = gtk_tree_view_get_model (GTK_TREE_VIEW (tree_view));
+  if (G_LIKELY (model != NULL))
+    n_rows = gtk_tree_model_iter_n_children (model, NULL);
+
+  if (n_rows < THUNAR_DETAILS_VIEW_ESTIMATE_MIN_ROWS)
+    {
+      /* small folders are measured completely by the tree view */
+      if (details_view->estimated_columns)
+        {
+          details_view->estimated_columns = FALSE;
+          for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+            gtk_tree_view_column_set_sizing (details_view->columns[column], GTK_TREE_VIEW_COLUMN_GROW_ONLY);
+          gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (tree_view), FALSE);
+        }
+      return;
+    }
+
+  /* determine the row with the longest name, which is a lot cheaper than measuring it */
+  if (gtk_tree_model_get_iter_first (model, &iter))
+    {
+      do
+        {
+          gtk_tree_model_get (model, &iter, THUNAR_COLUMN_FILE, &file, -1);
+          length = strlen (thunar_file_get_display_name (file));
+          if (length > longest_length)
+            {
+              longest_length = length;
+              longest_iter = iter;
+            }
+          g_object_unref (G_OBJECT (file));
+        }
+      while (gtk_tree_model_iter_next (model, &iter));
+    }
+
+  /* the tree view adds the separator to every measured cell */
+  gtk_widget_style_get (tree_view, "horizontal-separator", &separator, NULL);
+
+  /* previously estimated widths only ever grow */
+  for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+    {
+      if (details_view->estimated_columns)
+        widths[column] = gtk_tree_view_column_get_fixed_width (details_view->columns[column]) - separator;
+      else
+        widths[column] = 0;
+    }
+
+  /* measure the sampled rows */
+  for (n = 0; n <= THUNAR_DETAILS_VIEW_ESTIMATE_SAMPLES; ++n)
+    {
+      if (n < THUNAR_DETAILS_VIEW_ESTIMATE_SAMPLES)
+        {
+          if (!gtk_tree_model_iter_nth_child (model, &iter, NULL, (gint) (((gint64) n * n_rows) / THUNAR_DETAILS_VIEW_ESTIMATE_SAMPLES)))
+            continue;
+        }
+      else if (longest_length > 0)
+        iter = longest_iter;
+      else
+        break;
+
+      for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+        if (gtk_tree_view_column_get_visible (details_view->columns[column]))
+          widths[column] = MAX (widths[column], thunar_details_view_measure_row (details_view, model, &iter, column));
+    }
+
+  /* apply the estimated widths */
+  for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+    {
+      gtk_tree_view_column_set_fixed_width (details_view->columns[column], MAX (widths[column] + separator, 1));
+      gtk_tree_view_column_set_sizing (details_view->columns[column], GTK_TREE_VIEW_COLUMN_FIXED);
+    }
+
+  /* no need to validate every row with all columns fixed */
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (tree_view), TRUE);
+  details_view->estimated_columns = TRUE;
+
+  /* make sure the rows in view fit */
+  thunar_details_view_schedule_grow (details_view);
+}
+
+
+
+static void
+thunar_details_view_num_files_changed (ThunarDetailsView *details_view)
+{
+  _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (details_view));
+
+  /* switch to estimated widths as soon as the folder gets large,
+   * before the tree view measures all of the inserted rows */
+  if (!details_view->estimated_columns)
+    thunar_details_view_update_estimation (details_view);
+}
+
+
+
+static void
+thunar_details_view_folder_changed (ThunarDetailsView *details_view)
+{
+  ThunarColumn column;
+
+  _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (details_view));
+
+  /* the column widths were chosen by the user */
+  if (details_view->fixed_columns)
+    return;
+
+  /* the widths of the previous folder do not apply to the new one */
+  details_view->estimated_columns = FALSE;
+  for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+    {
+      gtk_tree_view_column_set_sizing (details_view->columns[column], GTK_TREE_VIEW_COLUMN_GROW_ONLY);
+      gtk_tree_view_column_queue_resize (details_view->columns[column]);
+    }
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (GTK_BIN (details_view)->child), FALSE);
+}
+
+
+
+static void
+thunar_details_view_schedule_grow (ThunarDetailsView *details_view)
+{
+  _thunar_return_if_fail (THUNAR_IS_DETAILS_VIEW (details_view));
+
+  if (details_view->estimated_columns && details_view->grow_idle_id == 0)
+    {
+      details_view->grow_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_details_view_grow_idle,
+                                                    details_view, thunar_details_view_grow_idle_destroy);
+    }
+}
+
+
+
+static gboolean
+thunar_details_view_grow_idle (gpointer user_data)
+{
+  ThunarDetailsView *details_view = THUNAR_DETAILS_VIEW (user_data);
+  GtkTreeModel      *model;
+  GtkTreePath       *start_path;
+  GtkTreePath       *end_path;
+  GtkTreeIter        iter;
+  ThunarColumn       column;
+  GtkWidget         *tree_view;
+  gint               widths[THUNAR_N_VISIBLE_COLUMNS];
+  gint               separator;
+  gint               n;
+
+  GDK_THREADS_ENTER ();
+
+  tree_view = GTK_BIN (details_view)->child;
+  model = gtk_tree_view_get_model (GTK_TREE_VIEW (tree_view));
+
+  /* measure the rows in view */
+  if (details_view->estimated_columns && model != NULL
+      && gtk_tree_view_get_visible_range (GTK_TREE_VIEW (tree_view), &start_path, &end_path))
+    {
+      for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+        widths[column] = 0;
+
+      if (gtk_tree_model_get_iter (model, &iter, start_path))
+        {
+          n = gtk_tree_path_get_indices (end_path)[0] - gtk_tree_path_get_indices (start_path)[0];
+          do
+            {
+              for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+                if (gtk_tree_view_column_get_visible (details_view->columns[column]))
+                  widths[column] = MAX (widths[column], thunar_details_view_measure_row (details_view, model, &iter, column));
+            }
+          while (n-- > 0 && gtk_tree_model_iter_next (model, &iter));
+        }
+
+      /* only ever grow the columns */
+      gtk_widget_style_get (tree_view, "horizontal-separator", &separator, NULL);
+      for (column = 0; column < THUNAR_N_VISIBLE_COLUMNS; ++column)
+        if (widths[column] + separator > gtk_tree_view_column_get_fixed_width (details_view->columns[column]))
+          gtk_tree_view_column_set_fixed_width (details_view->columns[column], widths[column] + separator);
+
+      gtk_tree_path_free (start_path);
+      gtk_tree_path_free (end_path);
+    }
+
+  GDK_THREADS_LEAVE ();
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_details_view_grow_idle_destroy (gpointer user_data)
+{
+  THUNAR_DETAILS_VIEW (user_data)->grow_idle_id = 0;
+}
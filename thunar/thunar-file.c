@@ -172,6 +172,10 @@ struct _ThunarFile
   gchar                *basename;
   gchar                *thumbnail_path;
 
+  /* emblems, determined on demand */
+  gchar               **emblem_names;
+  gchar                *emblems_key;
+
   /* sorting */
   gchar                *collate_key;
   gchar                *collate_key_nocase;
@@ -442,6 +446,10 @@ thunar_file_finalize (GObject *object)
   /* free the thumbnail path */
   g_free (file->thumbnail_path);
 
+  /* free the emblems */
+  g_strfreev (file->emblem_names);
+  g_free (file->emblems_key);
+
   /* release file */
   g_object_unref (file->gfile);
 
@@ -745,6 +753,18 @@ thunar_file_watch_reconnect (ThunarFile *file)
 
 
 
+static void
+thunar_file_emblems_clear (ThunarFile *file)
+{
+  g_strfreev (file->emblem_names);
+  file->emblem_names = NULL;
+
+  g_free (file->emblems_key);
+  file->emblems_key = NULL;
+}
+
+
+
 static void
 thunar_file_set_emblem_names_ready (GObject      *source_object,
                                     GAsyncResult *result,
@@ -759,6 +779,7 @@ thunar_file_set_emblem_names_ready (GObject      *source_object,
       g_error_free (error);
 
       g_file_info_remove_attribute (file->info, "metadata::emblems");
+      thunar_file_emblems_clear (file);
     }
 
   thunar_file_changed (file);
@@ -806,9 +827,8 @@ thunar_file_info_clear (ThunarFile *file)
   g_free (file->collate_key);
   file->collate_key = NULL;
 
-  /* free thumbnail path */
-  g_free (file->thumbnail_path);
-  file->thumbnail_path = NULL;
+  /* free the emblems */
+  thunar_file_emblems_clear (file);
 
   /* assume the file is mounted by default */
   FLAG_SET (file, THUNAR_FILE_FLAG_IS_MOUNTED);
@@ -1803,6 +1823,10 @@ thunar_file_rename (ThunarFile   *file,
           /* set the new file */
           file->gfile = renamed_file;
 
+          /* the thumbnail path depends on the uri */
+          g_free (file->thumbnail_path);
+          file->thumbnail_path = NULL;
+
           /* reload file information */
           thunar_file_load (file, NULL, NULL);
 
@@ -3104,6 +3128,63 @@ thunar_file_can_be_trashed (const ThunarFile *file)
 
 
 
+static void
+thunar_file_load_emblem_names (ThunarFile *file)
+{
+  GPtrArray *emblems;
+  guint32    uid;
+  gchar    **emblem_names;
+
+  _thunar_return_if_fail (file->emblem_names == NULL);
+
+  emblems = g_ptr_array_new ();
+
+  /* we add "cant-read" if either (a) the file is not readable or (b) a directory, that lacks the
+   * x-bit, see http://bugzilla.xfce.org/show_bug.cgi?id=1408 for the details about this change.
+   */
+  if (!thunar_file_is_readable (file)
+      || (thunar_file_is_directory (file)
+          && thunar_file_denies_access_permission (file, THUNAR_FILE_MODE_USR_EXEC,
+                                                         THUNAR_FILE_MODE_GRP_EXEC,
+                                                         THUNAR_FILE_MODE_OTH_EXEC)))
+    {
+      g_ptr_array_add (emblems, g_strdup (THUNAR_FILE_EMBLEM_NAME_CANT_READ));
+    }
+  else
+    {
+      /* determine the user ID of the file owner */
+      /* TODO what are we going to do here on non-UNIX systems? */
+      uid = g_file_info_get_attribute_uint32 (file->info, G_FILE_ATTRIBUTE_UNIX_UID);
+
+      if (G_UNLIKELY (uid == effective_user_id && !thunar_file_is_writable (file)))
+        {
+          /* we own the file, but we cannot write to it, that's why we mark it as "cant-write", so
+           * users won't be surprised when opening the file in a text editor, but are unable to save.
+           */
+          g_ptr_array_add (emblems, g_strdup (THUNAR_FILE_EMBLEM_NAME_CANT_WRITE));
+        }
+    }
+
+  if (thunar_file_is_symlink (file))
+    g_ptr_array_add (emblems, g_strdup (THUNAR_FILE_EMBLEM_NAME_SYMBOLIC_LINK));
+
+  /* determine the custom emblems */
+  emblem_names = g_file_info_get_attribute_stringv (file->info, "metadata::emblems");
+  if (G_UNLIKELY (emblem_names != NULL))
+    {
+      for (; *emblem_names != NULL; ++emblem_names)
+        g_ptr_array_add (emblems, g_strdup (*emblem_names));
+    }
+
+  g_ptr_array_add (emblems, NULL);
+  file->emblem_names = (gchar **) g_ptr_array_free (emblems, FALSE);
+
+  /* a key that identifies this set of emblems */
+  file->emblems_key = g_strjoinv ("\n", file->emblem_names);
+}
+
+
+
 /**
  * thunar_file_get_emblem_names:
  * @file : a #ThunarFile instance.
@@ -3123,9 +3204,8 @@ thunar_file_can_be_trashed (const ThunarFile *file)
 GList*
 thunar_file_get_emblem_names (ThunarFile *file)
 {
-  guint32   uid;
-  gchar   **emblem_names;
-  GList    *emblems = NULL;
+  GList *emblems = NULL;
+  guint  n;
 
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
 
@@ -3133,43 +3213,43 @@ thunar_file_get_emblem_names (ThunarFile *file)
   if (file->info == NULL)
     return NULL;
 
-  /* determine the custom emblems */
-  emblem_names = g_file_info_get_attribute_stringv (file->info, "metadata::emblems");
-  if (G_UNLIKELY (emblem_names != NULL))
-    {
-      for (; *emblem_names != NULL; ++emblem_names)
-        emblems = g_list_append (emblems, *emblem_names);
-    }
+  /* the emblems are cached until the file info changes */
+  if (file->emblem_names == NULL)
+    thunar_file_load_emblem_names (file);
 
-  if (thunar_file_is_symlink (file))
-    emblems = g_list_prepend (emblems, THUNAR_FILE_EMBLEM_NAME_SYMBOLIC_LINK);
+  for (n = 0; file->emblem_names[n] != NULL; ++n)
+    emblems = g_list_prepend (emblems, file->emblem_names[n]);
+
+  return g_list_reverse (emblems);
+}
 
-  /* determine the user ID of the file owner */
-  /* TODO what are we going to do here on non-UNIX systems? */
-  uid = file->info != NULL 
-        ? g_file_info_get_attribute_uint32 (file->info, G_FILE_ATTRIBUTE_UNIX_UID) 
-        : 0;
 
-  /* we add "cant-read" if either (a) the file is not readable or (b) a directory, that lacks the
-   * x-bit, see http://bugzilla.xfce.org/show_bug.cgi?id=1408 for the details about this change.
-   */
-  if (!thunar_file_is_readable (file)
-      || (thunar_file_is_directory (file)
-          && thunar_file_denies_access_permission (file, THUNAR_FILE_MODE_USR_EXEC,
-                                                         THUNAR_FILE_MODE_GRP_EXEC,
-                                                         THUNAR_FILE_MODE_OTH_EXEC)))
-    {
-      emblems = g_list_prepend (emblems, THUNAR_FILE_EMBLEM_NAME_CANT_READ);
-    }
-  else if (G_UNLIKELY (uid == effective_user_id && !thunar_file_is_writable (file)))
-    {
-      /* we own the file, but we cannot write to it, that's why we mark it as "cant-write", so
-       * users won't be surprised when opening the file in a text editor, but are unable to save.
-       */
-      emblems = g_list_prepend (emblems, THUNAR_FILE_EMBLEM_NAME_CANT_WRITE);
-    }
 
-  return emblems;
+/**
+ * thunar_file_get_emblems_key:
+ * @file : a #ThunarFile instance.
+ *
+ * Returns a string that identifies the set of emblems returned
+ * by thunar_file_get_emblem_names(). The string is empty if
+ * @file has no emblems, so callers can skip the emblems without
+ * building a list. The string is owned by @file and only valid
+ * until the file changes.
+ *
+ * Return value: the emblems key for @file.
+ **/
+const gchar*
+thunar_file_get_emblems_key (ThunarFile *file)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), "");
+
+  /* leave if there is no info */
+  if (file->info == NULL)
+    return "";
+
+  if (file->emblem_names == NULL)
+    thunar_file_load_emblem_names (file);
+
+  return file->emblems_key;
 }
 
 
@@ -3217,6 +3297,9 @@ thunar_file_set_emblem_names (ThunarFile *file,
   else
     g_file_info_set_attribute_stringv (file->info, "metadata::emblems", emblems);
 
+  /* the emblems are determined again on the next request */
+  thunar_file_emblems_clear (file);
+
   /* set meta data to the daemon */
   info = g_file_info_new ();
   g_file_info_set_attribute_stringv (info, "metadata::emblems", emblems);
@@ -3316,6 +3399,8 @@ thunar_file_get_thumbnail_path (ThunarFile *file)
   if (thunar_file_get_thumb_state (file) == THUNAR_FILE_THUMB_STATE_NONE)
     return NULL;
 
+  /* the path only depends on the uri, so it is computed once and
+   * kept until the file is renamed */
   if (G_UNLIKELY (file->thumbnail_path == NULL))
     {
       checksum = g_checksum_new (G_CHECKSUM_MD5);
@@ -3380,14 +3465,6 @@ thunar_file_set_thumb_state (ThunarFile          *file,
   /* set the new thumbnail state */
   FLAG_SET_THUMB_STATE (file, state);
 
-  /* remove path if the type is not supported */
-  if (state == THUNAR_FILE_THUMB_STATE_NONE
-      && file->thumbnail_path != NULL)
-    {
-      g_free (file->thumbnail_path);
-      file->thumbnail_path = NULL;
-    }
-
   /* if the file has a thumbnail, reload it */
   if (state == THUNAR_FILE_THUMB_STATE_READY)
     thunar_file_monitor_file_changed (file);
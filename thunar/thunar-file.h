@@ -215,6 +215,7 @@ gboolean          thunar_file_is_renameable        (const ThunarFile       *file
 gboolean          thunar_file_can_be_trashed       (const ThunarFile       *file);
 
 GList            *thunar_file_get_emblem_names     (ThunarFile              *file);
+const gchar      *thunar_file_get_emblems_key      (ThunarFile              *file);
 void              thunar_file_set_emblem_names     (ThunarFile              *file,
                                                     GList                   *emblem_names);
 
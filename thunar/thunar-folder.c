@@ -38,6 +38,7 @@ enum
 {
   PROP_0,
   PROP_CORRESPONDING_FILE,
+  PROP_DIRECTORIES_ONLY,
   PROP_LOADING,
 };
 
@@ -115,6 +116,9 @@ struct _ThunarFolder
 
   guint              in_destruction : 1;
 
+  /* whether only the directories in the folder are listed */
+  guint              directories_only : 1;
+
   ThunarFileMonitor *file_monitor;
 
   GFileMonitor      *monitor;
@@ -124,6 +128,7 @@ struct _ThunarFolder
 
 static guint  folder_signals[LAST_SIGNAL];
 static GQuark thunar_folder_quark;
+static GQuark thunar_folder_directories_quark;
 
 
 
@@ -159,6 +164,22 @@ thunar_folder_class_init (ThunarFolderClass *klass)
                                                         | G_PARAM_WRITABLE
                                                         | G_PARAM_CONSTRUCT_ONLY));
 
+  /**
+   * ThunarFolder::directories-only:
+   *
+   * Whether the #ThunarFolder only lists and monitors
+   * the directories in the folder.
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_DIRECTORIES_ONLY,
+                                   g_param_spec_boolean ("directories-only",
+                                                         "directories-only",
+                                                         "directories-only",
+                                                         FALSE,
+                                                         G_PARAM_READABLE
+                                                         | G_PARAM_WRITABLE
+                                                         | G_PARAM_CONSTRUCT_ONLY));
+
   /**
    * ThunarFolder::loading:
    *
@@ -298,7 +319,9 @@ thunar_folder_finalize (GObject *object)
   if (G_LIKELY (folder->corresponding_file != NULL))
     {
       /* drop the reference */
-      g_object_set_qdata (G_OBJECT (folder->corresponding_file), thunar_folder_quark, NULL);
+      g_object_set_qdata (G_OBJECT (folder->corresponding_file),
+                          folder->directories_only ? thunar_folder_directories_quark : thunar_folder_quark,
+                          NULL);
       g_object_unref (G_OBJECT (folder->corresponding_file));
     }
 
@@ -331,6 +354,10 @@ thunar_folder_get_property (GObject    *object,
       g_value_set_object (value, folder->corresponding_file);
       break;
 
+    case PROP_DIRECTORIES_ONLY:
+      g_value_set_boolean (value, folder->directories_only);
+      break;
+
     case PROP_LOADING:
       g_value_set_boolean (value, thunar_folder_get_loading (folder));
       break;
@@ -357,6 +384,10 @@ thunar_folder_set_property (GObject      *object,
       folder->corresponding_file = g_value_dup_object (value);
       break;
 
+    case PROP_DIRECTORIES_ONLY:
+      folder->directories_only = g_value_get_boolean (value);
+      break;
+
     case PROP_LOADING:
       _thunar_assert_not_reached ();
       break;
@@ -726,6 +757,14 @@ thunar_folder_monitor (GFileMonitor     *monitor,
         {
           /* allocate a file for the path */
           file = thunar_file_get (event_file, NULL);
+
+          /* ignore new files that are not directories if we only list those */
+          if (G_UNLIKELY (file != NULL && folder->directories_only && !thunar_file_is_directory (file)))
+            {
+              g_object_unref (G_OBJECT (file));
+              file = NULL;
+            }
+
           if (G_UNLIKELY (file != NULL))
             {
               /* prepend it to our internal list */
@@ -766,24 +805,12 @@ thunar_folder_monitor (GFileMonitor     *monitor,
 
 
 
-/**
- * thunar_folder_get_for_file:
- * @file : a #ThunarFile.
- *
- * Opens the specified @file as #ThunarFolder and
- * returns a reference to the folder.
- *
- * The caller is responsible to free the returned
- * object using g_object_unref() when no longer
- * needed.
- *
- * Return value: the #ThunarFolder which corresponds
- *               to @file.
- **/
-ThunarFolder*
-thunar_folder_get_for_file (ThunarFile *file)
+static ThunarFolder*
+thunar_folder_get_for_file_internal (ThunarFile *file,
+                                     gboolean    directories_only)
 {
   ThunarFolder *folder;
+  GQuark        quark;
 
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
 
@@ -797,12 +824,21 @@ thunar_folder_get_for_file (ThunarFile *file)
   if (!thunar_file_is_directory (file))
     return NULL;
 
-  /* determine the "thunar-folder" quark on-demand */
+  /* determine the "thunar-folder" quarks on-demand */
   if (G_UNLIKELY (thunar_folder_quark == 0))
-    thunar_folder_quark = g_quark_from_static_string ("thunar-folder");
+    {
+      thunar_folder_quark = g_quark_from_static_string ("thunar-folder");
+      thunar_folder_directories_quark = g_quark_from_static_string ("thunar-folder-directories");
+    }
+  quark = directories_only ? thunar_folder_directories_quark : thunar_folder_quark;
+
+  /* a folder listing all files also contains the directories, so there is
+   * no need to read the folder a second time if it is already opened */
+  folder = directories_only ? g_object_get_qdata (G_OBJECT (file), thunar_folder_quark) : NULL;
 
   /* check if we already know that folder */
-  folder = g_object_get_qdata (G_OBJECT (file), thunar_folder_quark);
+  if (G_LIKELY (folder == NULL))
+    folder = g_object_get_qdata (G_OBJECT (file), quark);
   if (G_UNLIKELY (folder != NULL))
     {
       g_object_ref (G_OBJECT (folder));
@@ -810,10 +846,13 @@ thunar_folder_get_for_file (ThunarFile *file)
   else
     {
       /* allocate the new instance */
-      folder = g_object_new (THUNAR_TYPE_FOLDER, "corresponding-file", file, NULL);
+      folder = g_object_new (THUNAR_TYPE_FOLDER,
+                             "corresponding-file", file,
+                             "directories-only", directories_only,
+                             NULL);
 
       /* connect the folder to the file */
-      g_object_set_qdata (G_OBJECT (file), thunar_folder_quark, folder);
+      g_object_set_qdata (G_OBJECT (file), quark, folder);
 
       /* schedule the loading of the folder */
       thunar_folder_reload (folder);
@@ -824,6 +863,57 @@ thunar_folder_get_for_file (ThunarFile *file)
 
 
 
+/**
+ * thunar_folder_get_for_file:
+ * @file : a #ThunarFile.
+ *
+ * Opens the specified @file as #ThunarFolder and
+ * returns a reference to the folder.
+ *
+ * The caller is responsible to free the returned
+ * object using g_object_unref() when no longer
+ * needed.
+ *
+ * Return value: the #ThunarFolder which corresponds
+ *               to @file.
+ **/
+ThunarFolder*
+thunar_folder_get_for_file (ThunarFile *file)
+{
+  return thunar_folder_get_for_file_internal (file, FALSE);
+}
+
+
+
+/**
+ * thunar_folder_get_directories_for_file:
+ * @file : a #ThunarFile.
+ *
+ * Like thunar_folder_get_for_file(), but the returned
+ * #ThunarFolder only lists and monitors the directories
+ * in @file. This avoids allocating #ThunarFile<!---->s for
+ * all the other files if only the directory hierarchy is
+ * of interest, like in the tree view.
+ *
+ * If @file is already opened with thunar_folder_get_for_file(),
+ * that #ThunarFolder is returned instead, so callers have to
+ * skip the files that are not directories themselves.
+ *
+ * The caller is responsible to free the returned
+ * object using g_object_unref() when no longer
+ * needed.
+ *
+ * Return value: the directories-only #ThunarFolder
+ *               which corresponds to @file.
+ **/
+ThunarFolder*
+thunar_folder_get_directories_for_file (ThunarFile *file)
+{
+  return thunar_folder_get_for_file_internal (file, TRUE);
+}
+
+
+
 /**
  * thunar_folder_get_corresponding_file:
  * @folder : a #ThunarFolder instance.
@@ -920,7 +1010,10 @@ thunar_folder_reload (ThunarFolder *folder)
   folder->new_files = NULL;
 
   /* start a new job */
-  folder->job = thunar_io_jobs_list_directory (thunar_file_get_file (folder->corresponding_file));
+  if (folder->directories_only)
+    folder->job = thunar_io_jobs_list_directories (thunar_file_get_file (folder->corresponding_file));
+  else
+    folder->job = thunar_io_jobs_list_directory (thunar_file_get_file (folder->corresponding_file));
   g_signal_connect (folder->job, "error", G_CALLBACK (thunar_folder_error), folder);
   g_signal_connect (folder->job, "finished", G_CALLBACK (thunar_folder_finished), folder);
   g_signal_connect (folder->job, "files-ready", G_CALLBACK (thunar_folder_files_ready), folder);
@@ -34,6 +34,7 @@
 #include <thunar/thunar-icon-factory.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-profiler.h>
 #include <thunar/thunar-thumbnail-frame.h>
 
 
@@ -41,6 +42,9 @@
 /* the timeout until the sweeper is run (in seconds) */
 #define THUNAR_ICON_FACTORY_SWEEP_TIMEOUT (30)
 
+/* the default budget of the file icon cache (in MiB) */
+#define THUNAR_ICON_CACHE_DEFAULT_SIZE (64)
+
 
 
 /* Property identifiers */
@@ -53,7 +57,8 @@ enum
 
 
 
-typedef struct _ThunarIconKey ThunarIconKey;
+typedef struct _ThunarIconKey        ThunarIconKey;
+typedef struct _ThunarIconCacheEntry ThunarIconCacheEntry;
 
 
 
@@ -86,6 +91,8 @@ static gboolean   thunar_icon_key_equal                     (gconstpointer
 static void       thunar_icon_key_free                      (gpointer                  data);
 static GdkPixbuf *thunar_icon_factory_load_fallback         (ThunarIconFactory        *factory,
                                                              gint                      size);
+static void       thunar_icon_factory_cache_size_changed    (ThunarIconFactory        *factory);
+static void       thunar_icon_cache_remove_factory          (ThunarIconFactory        *factory);
 
 
 
@@ -109,9 +116,6 @@ struct _ThunarIconFactory
   guint                sweep_timer_id;
 
   gulong               changed_hook_id;
-
-  /* stamp that gets bumped when the theme changes */
-  guint                theme_stamp;
 };
 
 struct _ThunarIconKey
@@ -120,21 +124,39 @@ struct _ThunarIconKey
   gint   size;
 };
 
-typedef struct
+struct _ThunarIconCacheEntry
 {
+  /* lookup key, neither the file nor the factory are referenced */
+  ThunarFile           *file;
+  ThunarIconFactory    *factory;
+  gint                  icon_size;
   ThunarFileIconState   icon_state;
   ThunarFileThumbState  thumb_state;
-  gint                  icon_size;
-  guint                 stamp;
+
   GdkPixbuf            *icon;
-}
-ThunarIconStore;
+  gsize                 n_bytes;
+
+  /* link in the LRU queue, its data points to the entry */
+  GList                 lru_link;
+};
 
 
 
 static GQuark thunar_icon_factory_quark = 0;
 static GQuark thunar_icon_factory_store_quark = 0;
 
+/* decoded file icons shared by all factories, the most recently
+ * used icon is at the head of the LRU queue. every file has the
+ * list of its entries attached as qdata, so the entries are
+ * dropped together with the file */
+static GHashTable *thunar_icon_cache = NULL;
+static GQueue      thunar_icon_cache_lru = G_QUEUE_INIT;
+static gsize       thunar_icon_cache_size = 0;
+static GHashTable *thunar_icon_cache_pixbufs = NULL;
+static gsize       thunar_icon_cache_budget = THUNAR_ICON_CACHE_DEFAULT_SIZE * 1024 * 1024;
+static guint       thunar_icon_cache_hits = 0;
+static guint       thunar_icon_cache_misses = 0;
+
 
 
 G_DEFINE_TYPE (ThunarIconFactory, thunar_icon_factory, G_TYPE_OBJECT)
@@ -230,6 +252,9 @@ thunar_icon_factory_finalize (GObject *object)
   /* clear the icon cache hash table */
   g_hash_table_destroy (factory->icon_cache);
 
+  /* drop the file icons loaded by this factory */
+  thunar_icon_cache_remove_factory (factory);
+
   /* remove the "changed" emission hook from the GtkIconTheme class */
   g_signal_remove_emission_hook (g_signal_lookup ("changed", GTK_TYPE_ICON_THEME), factory->changed_hook_id);
 
@@ -241,6 +266,7 @@ thunar_icon_factory_finalize (GObject *object)
     }
 
   /* disconnect from the preferences */
+  g_signal_handlers_disconnect_by_func (G_OBJECT (factory->preferences), thunar_icon_factory_cache_size_changed, factory);
   g_object_unref (G_OBJECT (factory->preferences));
 
   (*G_OBJECT_CLASS (thunar_icon_factory_parent_class)->finalize) (object);
@@ -307,8 +333,8 @@ thunar_icon_factory_changed (GSignalInvocationHint *ihint,
   /* drop all items from the icon cache */
   g_hash_table_remove_all (factory->icon_cache);
 
-  /* bump the stamp so all file icons are reloaded */
-  factory->theme_stamp++;
+  /* drop the file icons so they are reloaded from the new theme */
+  thunar_icon_cache_remove_factory (factory);
 
   /* keep the emission hook alive */
   return TRUE;
@@ -583,14 +609,246 @@ thunar_icon_key_free (gpointer data)
 
 
 
+static guint
+thunar_icon_cache_entry_hash (gconstpointer data)
+{
+  const ThunarIconCacheEntry *entry = data;
+
+  return g_direct_hash (entry->file) ^ g_direct_hash (entry->factory)
+         ^ ((guint) entry->icon_size << 8)
+         ^ ((guint) entry->icon_state << 4)
+         ^ (guint) entry->thumb_state;
+}
+
+
+
+static gboolean
+thunar_icon_cache_entry_equal (gconstpointer a,
+                               gconstpointer b)
+{
+  const ThunarIconCacheEntry *a_entry = a;
+  const ThunarIconCacheEntry *b_entry = b;
+
+  return a_entry->file == b_entry->file
+      && a_entry->factory == b_entry->factory
+      && a_entry->icon_size == b_entry->icon_size
+      && a_entry->icon_state == b_entry->icon_state
+      && a_entry->thumb_state == b_entry->thumb_state;
+}
+
+
+
 static void
-thunar_icon_store_free (gpointer data)
+thunar_icon_cache_pixbuf_ref (GdkPixbuf *icon,
+                              gsize      n_bytes)
 {
-  ThunarIconStore *store = data;
+  guint n_entries;
+
+  /* themed icons are shared by many entries, count their bytes once */
+  n_entries = GPOINTER_TO_UINT (g_hash_table_lookup (thunar_icon_cache_pixbufs, icon));
+  if (n_entries == 0)
+    thunar_icon_cache_size += n_bytes;
 
-  if (store->icon != NULL)
-    g_object_unref (store->icon);
-  g_slice_free (ThunarIconStore, store);
+  g_hash_table_insert (thunar_icon_cache_pixbufs, icon, GUINT_TO_POINTER (n_entries + 1));
+}
+
+
+
+static void
+thunar_icon_cache_pixbuf_unref (GdkPixbuf *icon,
+                                gsize      n_bytes)
+{
+  guint n_entries;
+
+  n_entries = GPOINTER_TO_UINT (g_hash_table_lookup (thunar_icon_cache_pixbufs, icon));
+  _thunar_assert (n_entries > 0);
+
+  if (n_entries > 1)
+    {
+      g_hash_table_insert (thunar_icon_cache_pixbufs, icon, GUINT_TO_POINTER (n_entries - 1));
+    }
+  else
+    {
+      g_hash_table_remove (thunar_icon_cache_pixbufs, icon);
+      thunar_icon_cache_size -= n_bytes;
+    }
+}
+
+
+
+static void
+thunar_icon_cache_entry_free (ThunarIconCacheEntry *entry)
+{
+  /* remove the entry from the cache */
+  g_hash_table_remove (thunar_icon_cache, entry);
+  g_queue_unlink (&thunar_icon_cache_lru, &entry->lru_link);
+  thunar_icon_cache_pixbuf_unref (entry->icon, entry->n_bytes);
+
+  g_object_unref (G_OBJECT (entry->icon));
+  g_slice_free (ThunarIconCacheEntry, entry);
+}
+
+
+
+static void
+thunar_icon_cache_file_entries_free (gpointer data)
+{
+  GSList *entries = data;
+  GSList *lp;
+
+  /* the file is finalized or its pixmap cache is cleared */
+  for (lp = entries; lp != NULL; lp = lp->next)
+    thunar_icon_cache_entry_free (lp->data);
+  g_slist_free (entries);
+}
+
+
+
+static void
+thunar_icon_cache_remove (ThunarIconCacheEntry *entry)
+{
+  GSList *entries;
+
+  /* detach the entry from the list on the file */
+  entries = g_object_steal_qdata (G_OBJECT (entry->file), thunar_icon_factory_store_quark);
+  entries = g_slist_remove (entries, entry);
+  if (entries != NULL)
+    {
+      g_object_set_qdata_full (G_OBJECT (entry->file), thunar_icon_factory_store_quark,
+                               entries, thunar_icon_cache_file_entries_free);
+    }
+
+  thunar_icon_cache_entry_free (entry);
+}
+
+
+
+static void
+thunar_icon_cache_trim (void)
+{
+  /* drop the least recently used icons until we're within the budget,
+   * but always keep the icon that was just added */
+  while (thunar_icon_cache_size > thunar_icon_cache_budget
+         && thunar_icon_cache_lru.length > 1)
+    thunar_icon_cache_remove (thunar_icon_cache_lru.tail->data);
+}
+
+
+
+static void
+thunar_icon_cache_remove_factory (ThunarIconFactory *factory)
+{
+  GList *lp;
+  GList *lnext;
+
+  for (lp = thunar_icon_cache_lru.head; lp != NULL; lp = lnext)
+    {
+      lnext = lp->next;
+      if (((ThunarIconCacheEntry *) lp->data)->factory == factory)
+        thunar_icon_cache_remove (lp->data);
+    }
+}
+
+
+
+static GdkPixbuf*
+thunar_icon_cache_lookup (ThunarIconFactory   *factory,
+                          ThunarFile          *file,
+                          ThunarFileIconState  icon_state,
+                          gint                 icon_size)
+{
+  ThunarIconCacheEntry  lookup;
+  ThunarIconCacheEntry *entry = NULL;
+
+  if (G_LIKELY (thunar_icon_cache != NULL))
+    {
+      lookup.file = file;
+      lookup.factory = factory;
+      lookup.icon_size = icon_size;
+      lookup.icon_state = icon_state;
+      lookup.thumb_state = thunar_file_get_thumb_state (file);
+      entry = g_hash_table_lookup (thunar_icon_cache, &lookup);
+    }
+
+  if (entry == NULL)
+    {
+      thunar_icon_cache_misses++;
+      return NULL;
+    }
+
+  thunar_icon_cache_hits++;
+
+  /* move the entry to the head of the LRU queue */
+  g_queue_unlink (&thunar_icon_cache_lru, &entry->lru_link);
+  g_queue_push_head_link (&thunar_icon_cache_lru, &entry->lru_link);
+
+  return g_object_ref (G_OBJECT (entry->icon));
+}
+
+
+
+static void
+thunar_icon_cache_insert (ThunarIconFactory   *factory,
+                          ThunarFile          *file,
+                          ThunarFileIconState  icon_state,
+                          gint                 icon_size,
+                          GdkPixbuf           *icon)
+{
+  ThunarIconCacheEntry *entry;
+  ThunarIconCacheEntry *existing;
+  GSList               *entries;
+
+  if (G_UNLIKELY (thunar_icon_cache == NULL))
+    {
+      thunar_icon_cache = g_hash_table_new (thunar_icon_cache_entry_hash, thunar_icon_cache_entry_equal);
+      thunar_icon_cache_pixbufs = g_hash_table_new (g_direct_hash, g_direct_equal);
+    }
+
+  entry = g_slice_new0 (ThunarIconCacheEntry);
+  entry->file = file;
+  entry->factory = factory;
+  entry->icon_size = icon_size;
+  entry->icon_state = icon_state;
+  entry->thumb_state = thunar_file_get_thumb_state (file);
+  entry->icon = g_object_ref (G_OBJECT (icon));
+  entry->n_bytes = gdk_pixbuf_get_rowstride (icon) * gdk_pixbuf_get_height (icon);
+  entry->lru_link.data = entry;
+
+  /* drop a previous entry for the same key */
+  existing = g_hash_table_lookup (thunar_icon_cache, entry);
+  if (G_UNLIKELY (existing != NULL))
+    thunar_icon_cache_remove (existing);
+
+  g_hash_table_insert (thunar_icon_cache, entry, entry);
+  g_queue_push_head_link (&thunar_icon_cache_lru, &entry->lru_link);
+  thunar_icon_cache_pixbuf_ref (entry->icon, entry->n_bytes);
+
+  /* attach the entry to the file */
+  entries = g_object_steal_qdata (G_OBJECT (file), thunar_icon_factory_store_quark);
+  entries = g_slist_prepend (entries, entry);
+  g_object_set_qdata_full (G_OBJECT (file), thunar_icon_factory_store_quark,
+                           entries, thunar_icon_cache_file_entries_free);
+
+  thunar_icon_cache_trim ();
+
+  /* show the cache in the profile, every insert follows a miss */
+  thunar_profiler_set_gauge ("icon-cache-bytes", thunar_icon_cache_size);
+  thunar_profiler_set_gauge ("icon-cache-icons", thunar_icon_cache_lru.length);
+  thunar_profiler_set_gauge ("icon-cache-hit-percent",
+                             (thunar_icon_cache_hits * G_GINT64_CONSTANT (100))
+                             / MAX (thunar_icon_cache_hits + thunar_icon_cache_misses, 1));
+}
+
+
+
+static void
+thunar_icon_factory_cache_size_changed (ThunarIconFactory *factory)
+{
+  guint size;
+
+  g_object_get (G_OBJECT (factory->preferences), "misc-icon-cache-size", &size, NULL);
+  thunar_icon_cache_budget = (gsize) size * 1024 * 1024;
+  thunar_icon_cache_trim ();
 }
 
 
@@ -672,6 +930,11 @@ thunar_icon_factory_get_for_icon_theme (GtkIconTheme *icon_theme)
       factory->preferences = thunar_preferences_get ();
       exo_binding_new (G_OBJECT (factory->preferences), "misc-thumbnail-mode",
                        G_OBJECT (factory), "thumbnail-mode");
+
+      /* apply the budget of the file icon cache */
+      g_signal_connect_swapped (G_OBJECT (factory->preferences), "notify::misc-icon-cache-size",
+                                G_CALLBACK (thunar_icon_factory_cache_size_changed), factory);
+      thunar_icon_factory_cache_size_changed (factory);
     }
   else
     {
@@ -793,22 +1056,15 @@ thunar_icon_factory_load_file_icon (ThunarIconFactory  *factory,
   GIcon           *gicon;
   const gchar     *icon_name;
   const gchar     *custom_icon;
-  ThunarIconStore *store;
 
   _thunar_return_val_if_fail (THUNAR_IS_ICON_FACTORY (factory), NULL);
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
   _thunar_return_val_if_fail (icon_size > 0, NULL);
 
-  /* check if we have a stored icon on the file and it is still valid */
-  store = g_object_get_qdata (G_OBJECT (file), thunar_icon_factory_store_quark);
-  if (store != NULL
-      && store->icon_state == icon_state
-      && store->icon_size == icon_size
-      && store->stamp == factory->theme_stamp
-      && store->thumb_state == thunar_file_get_thumb_state (file))
-    {
-      return g_object_ref (store->icon);
-    }
+  /* check if we have a decoded icon for the file in the cache */
+  icon = thunar_icon_cache_lookup (factory, file, icon_state, icon_size);
+  if (icon != NULL)
+    return icon;
 
   /* check if we have a custom icon for this file */
   custom_icon = thunar_file_get_custom_icon (file);
@@ -892,18 +1148,9 @@ thunar_icon_factory_load_file_icon (ThunarIconFactory  *factory,
       icon = thunar_icon_factory_load_icon (factory, icon_name, icon_size, TRUE);
     }
 
+  /* remember the icon for the next request */
   if (G_LIKELY (icon != NULL))
-    {
-      store = g_slice_new (ThunarIconStore);
-      store->icon_size = icon_size;
-      store->icon_state = icon_state;
-      store->stamp = factory->theme_stamp;
-      store->thumb_state = thunar_file_get_thumb_state (file);
-      store->icon = g_object_ref (icon);
-
-      g_object_set_qdata_full (G_OBJECT (file), thunar_icon_factory_store_quark,
-                               store, thunar_icon_store_free);
-    }
+    thunar_icon_cache_insert (factory, file, icon_state, icon_size, icon);
 
   return icon;
 }
@@ -921,7 +1168,7 @@ thunar_icon_factory_clear_pixmap_cache (ThunarFile *file)
 {
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
-  /* unset the data */
+  /* unset the data, which drops the cached icons of the file */
   if (thunar_icon_factory_store_quark != 0)
     g_object_set_qdata (G_OBJECT (file), thunar_icon_factory_store_quark, NULL);
 }
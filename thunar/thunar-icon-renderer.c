@@ -21,6 +21,10 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include <thunar/thunar-clipboard-manager.h>
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-gdk-extensions.h>
@@ -30,6 +34,11 @@
 
 
 
+/* maximum number of composited icons per renderer */
+#define THUNAR_ICON_RENDERER_MAX_COMPOSITES (256)
+
+
+
 enum
 {
   PROP_0,
@@ -42,29 +51,52 @@ enum
 
 
 
-static void thunar_icon_renderer_finalize      (GObject                 *object);
-static void thunar_icon_renderer_get_property  (GObject                 *object,
-                                                guint                    prop_id,
-                                                GValue                  *value,
-                                                GParamSpec              *pspec);
-static void thunar_icon_renderer_set_property  (GObject                 *object,
-                                                guint                    prop_id,
-                                                const GValue            *value,
-                                                GParamSpec              *pspec);
-static void thunar_icon_renderer_get_size      (GtkCellRenderer         *renderer,
-                                                GtkWidget               *widget,
-                                                GdkRectangle            *rectangle,
-                                                gint                    *x_offset,
-                                                gint                    *y_offset,
-                                                gint                    *width,
-                                                gint                    *height);
-static void thunar_icon_renderer_render        (GtkCellRenderer         *renderer,
-                                                GdkWindow               *window,
-                                                GtkWidget               *widget,
-                                                GdkRectangle            *background_area,
-                                                GdkRectangle            *cell_area,
-                                                GdkRectangle            *expose_area,
-                                                GtkCellRendererState     flags);
+static void     thunar_icon_renderer_finalize        (GObject                 *object);
+static void     thunar_icon_renderer_get_property    (GObject                 *object,
+                                                      guint                    prop_id,
+                                                      GValue                  *value,
+                                                      GParamSpec              *pspec);
+static void     thunar_icon_renderer_set_property    (GObject                 *object,
+                                                      guint                    prop_id,
+                                                      const GValue            *value,
+                                                      GParamSpec              *pspec);
+static void     thunar_icon_renderer_get_size        (GtkCellRenderer         *renderer,
+                                                      GtkWidget               *widget,
+                                                      GdkRectangle            *rectangle,
+                                                      gint                    *x_offset,
+                                                      gint                    *y_offset,
+                                                      gint                    *width,
+                                                      gint                    *height);
+static void     thunar_icon_renderer_render          (GtkCellRenderer         *renderer,
+                                                      GdkWindow               *window,
+                                                      GtkWidget               *widget,
+                                                      GdkRectangle            *background_area,
+                                                      GdkRectangle            *cell_area,
+                                                      GdkRectangle            *expose_area,
+                                                      GtkCellRendererState     flags);
+static guint    thunar_icon_renderer_composite_hash  (gconstpointer            data);
+static gboolean thunar_icon_renderer_composite_equal (gconstpointer            a,
+                                                      gconstpointer            b);
+static void     thunar_icon_renderer_composite_free  (gpointer                 data);
+
+
+
+struct _ThunarIconRendererComposite
+{
+  /* the unscaled icon, referenced so its address stays unique */
+  GdkPixbuf *icon;
+  gchar     *emblems_key;
+  gint       size;
+  gint       cell_width;
+  gint       cell_height;
+
+  /* the icon with its emblems and its offset in the cell */
+  GdkPixbuf *composite;
+  gint       x;
+  gint       y;
+
+  GList      lru_link;
+};
 
 
 
@@ -163,6 +195,12 @@ thunar_icon_renderer_init (ThunarIconRenderer *icon_renderer)
   /* use 1px padding */
   GTK_CELL_RENDERER (icon_renderer)->xpad = 1;
   GTK_CELL_RENDERER (icon_renderer)->ypad = 1;
+
+  /* cache of icons composited with their emblems */
+  icon_renderer->composites = g_hash_table_new_full (thunar_icon_renderer_composite_hash,
+                                                     thunar_icon_renderer_composite_equal,
+                                                     thunar_icon_renderer_composite_free,
+                                                     NULL);
 }
 
 
@@ -178,6 +216,9 @@ thunar_icon_renderer_finalize (GObject *object)
   if (G_LIKELY (icon_renderer->file != NULL))
     g_object_unref (G_OBJECT (icon_renderer->file));
 
+  /* release the composited icons */
+  g_hash_table_destroy (icon_renderer->composites);
+
   (*G_OBJECT_CLASS (thunar_icon_renderer_parent_class)->finalize) (object);
 }
 
@@ -350,6 +391,239 @@ thunar_icon_renderer_color_lighten (cairo_t   *cr,
 
 
 
+static guint
+thunar_icon_renderer_composite_hash (gconstpointer data)
+{
+  const ThunarIconRendererComposite *composite = data;
+
+  return g_direct_hash (composite->icon) ^ g_str_hash (composite->emblems_key)
+         ^ (composite->size << 20) ^ (composite->cell_width << 10) ^ composite->cell_height;
+}
+
+
+
+static gboolean
+thunar_icon_renderer_composite_equal (gconstpointer a,
+                                      gconstpointer b)
+{
+  const ThunarIconRendererComposite *composite_a = a;
+  const ThunarIconRendererComposite *composite_b = b;
+
+  return composite_a->icon == composite_b->icon
+      && composite_a->size == composite_b->size
+      && composite_a->cell_width == composite_b->cell_width
+      && composite_a->cell_height == composite_b->cell_height
+      && strcmp (composite_a->emblems_key, composite_b->emblems_key) == 0;
+}
+
+
+
+static void
+thunar_icon_renderer_composite_free (gpointer data)
+{
+  ThunarIconRendererComposite *composite = data;
+
+  g_object_unref (G_OBJECT (composite->icon));
+  g_object_unref (G_OBJECT (composite->composite));
+  g_free (composite->emblems_key);
+  g_slice_free (ThunarIconRendererComposite, composite);
+}
+
+
+
+static GdkPixbuf*
+thunar_icon_renderer_load_emblem (ThunarIconFactory *icon_factory,
+                                  const gchar       *name,
+                                  gint               emblem_size)
+{
+  GdkPixbuf *emblem;
+  GdkPixbuf *temp;
+
+  /* check if we have the emblem in the icon theme */
+  emblem = thunar_icon_factory_load_icon (icon_factory, name, emblem_size, FALSE);
+  if (G_UNLIKELY (emblem == NULL))
+    return NULL;
+
+  /* shrink insane emblems */
+  if (G_UNLIKELY (MAX (gdk_pixbuf_get_width (emblem), gdk_pixbuf_get_height (emblem)) > emblem_size))
+    {
+      /* scale down the emblem */
+      temp = exo_gdk_pixbuf_scale_ratio (emblem, emblem_size);
+      g_object_unref (G_OBJECT (emblem));
+      emblem = temp;
+    }
+
+  return emblem;
+}
+
+
+
+static void
+thunar_icon_renderer_emblem_position (gint                position,
+                                      const GdkRectangle *icon_area,
+                                      const GdkRectangle *cell_area,
+                                      GdkRectangle       *emblem_area)
+{
+  /* determine a good position for the emblem, depending on the position index */
+  switch (position)
+    {
+    case 0: /* right/bottom */
+      emblem_area->x = MIN (icon_area->x + icon_area->width - emblem_area->width / 2,
+                            cell_area->x + cell_area->width - emblem_area->width);
+      emblem_area->y = MIN (icon_area->y + icon_area->height - emblem_area->height / 2,
+                            cell_area->y + cell_area->height -emblem_area->height);
+      break;
+
+    case 1: /* left/bottom */
+      emblem_area->x = MAX (icon_area->x - emblem_area->width / 2,
+                            cell_area->x);
+      emblem_area->y = MIN (icon_area->y + icon_area->height - emblem_area->height / 2,
+                            cell_area->y + cell_area->height -emblem_area->height);
+      break;
+
+    case 2: /* left/top */
+      emblem_area->x = MAX (icon_area->x - emblem_area->width / 2,
+                            cell_area->x);
+      emblem_area->y = MAX (icon_area->y - emblem_area->height / 2,
+                            cell_area->y);
+      break;
+
+    case 3: /* right/top */
+      emblem_area->x = MIN (icon_area->x + icon_area->width - emblem_area->width / 2,
+                            cell_area->x + cell_area->width - emblem_area->width);
+      emblem_area->y = MAX (icon_area->y - emblem_area->height / 2,
+                            cell_area->y);
+      break;
+
+    default:
+      _thunar_assert_not_reached ();
+    }
+}
+
+
+
+static ThunarIconRendererComposite*
+thunar_icon_renderer_get_composite (ThunarIconRenderer *icon_renderer,
+                                    ThunarIconFactory  *icon_factory,
+                                    GdkPixbuf          *base_icon,
+                                    GdkPixbuf          *icon,
+                                    const GdkRectangle *icon_area,
+                                    const GdkRectangle *cell_area,
+                                    const gchar        *emblems_key)
+{
+  ThunarIconRendererComposite *composite;
+  ThunarIconRendererComposite  key;
+  GdkRectangle                 emblem_areas[4];
+  GdkRectangle                 composite_area;
+  GdkRectangle                 origin_cell_area;
+  GdkRectangle                 origin_icon_area;
+  GdkPixbuf                   *emblems[4];
+  GList                       *emblem_names;
+  GList                       *lp;
+  gint                         max_emblems;
+  gint                         emblem_size;
+  gint                         n_emblems = 0;
+  gint                         n;
+
+  /* check if we already composited this icon */
+  key.icon = base_icon;
+  key.emblems_key = (gchar *) emblems_key;
+  key.size = icon_renderer->size;
+  key.cell_width = cell_area->width;
+  key.cell_height = cell_area->height;
+  composite = g_hash_table_lookup (icon_renderer->composites, &key);
+  if (G_LIKELY (composite != NULL))
+    {
+      /* move the composite to the front of the LRU list */
+      g_queue_unlink (&icon_renderer->composites_lru, &composite->lru_link);
+      g_queue_push_head_link (&icon_renderer->composites_lru, &composite->lru_link);
+      return composite;
+    }
+
+  /* the emblem positions only depend on the icon position in the cell */
+  origin_cell_area.x = origin_cell_area.y = 0;
+  origin_cell_area.width = cell_area->width;
+  origin_cell_area.height = cell_area->height;
+  origin_icon_area = *icon_area;
+  origin_icon_area.x -= cell_area->x;
+  origin_icon_area.y -= cell_area->y;
+  composite_area = origin_icon_area;
+
+  /* render up to four emblems for sizes from 48 onwards, else up to 2 emblems */
+  max_emblems = (icon_renderer->size < 48) ? 2 : 4;
+
+  /* calculate the emblem size */
+  emblem_size = MIN ((2 * icon_renderer->size) / 3, 32);
+
+  /* load the emblems and determine their positions */
+  emblem_names = thunar_file_get_emblem_names (icon_renderer->file);
+  for (lp = emblem_names; lp != NULL && n_emblems < max_emblems; lp = lp->next)
+    {
+      emblems[n_emblems] = thunar_icon_renderer_load_emblem (icon_factory, lp->data, emblem_size);
+      if (G_UNLIKELY (emblems[n_emblems] == NULL))
+        continue;
+
+      emblem_areas[n_emblems].width = gdk_pixbuf_get_width (emblems[n_emblems]);
+      emblem_areas[n_emblems].height = gdk_pixbuf_get_height (emblems[n_emblems]);
+      thunar_icon_renderer_emblem_position (n_emblems, &origin_icon_area, &origin_cell_area, &emblem_areas[n_emblems]);
+      gdk_rectangle_union (&composite_area, &emblem_areas[n_emblems], &composite_area);
+
+      ++n_emblems;
+    }
+  g_list_free (emblem_names);
+
+  composite = g_slice_new0 (ThunarIconRendererComposite);
+  composite->icon = g_object_ref (G_OBJECT (base_icon));
+  composite->emblems_key = g_strdup (emblems_key);
+  composite->size = icon_renderer->size;
+  composite->cell_width = cell_area->width;
+  composite->cell_height = cell_area->height;
+  composite->x = composite_area.x;
+  composite->y = composite_area.y;
+  composite->lru_link.data = composite;
+
+  if (G_UNLIKELY (n_emblems == 0))
+    {
+      /* none of the emblems is available in the icon theme */
+      composite->composite = g_object_ref (G_OBJECT (icon));
+    }
+  else
+    {
+      /* draw the icon and the emblems on a transparent pixbuf */
+      composite->composite = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, composite_area.width, composite_area.height);
+      gdk_pixbuf_fill (composite->composite, 0x00000000);
+
+      gdk_pixbuf_composite (icon, composite->composite,
+                            origin_icon_area.x - composite_area.x, origin_icon_area.y - composite_area.y,
+                            origin_icon_area.width, origin_icon_area.height,
+                            origin_icon_area.x - composite_area.x, origin_icon_area.y - composite_area.y,
+                            1.0, 1.0, GDK_INTERP_NEAREST, 255);
+
+      for (n = 0; n < n_emblems; ++n)
+        {
+          gdk_pixbuf_composite (emblems[n], composite->composite,
+                                emblem_areas[n].x - composite_area.x, emblem_areas[n].y - composite_area.y,
+                                emblem_areas[n].width, emblem_areas[n].height,
+                                emblem_areas[n].x - composite_area.x, emblem_areas[n].y - composite_area.y,
+                                1.0, 1.0, GDK_INTERP_NEAREST, 255);
+          g_object_unref (G_OBJECT (emblems[n]));
+        }
+    }
+
+  /* remember the composite, dropping the least recently used one if the cache is full */
+  g_hash_table_insert (icon_renderer->composites, composite, composite);
+  g_queue_push_head_link (&icon_renderer->composites_lru, &composite->lru_link);
+  if (icon_renderer->composites_lru.length > THUNAR_ICON_RENDERER_MAX_COMPOSITES)
+    {
+      lp = g_queue_pop_tail_link (&icon_renderer->composites_lru);
+      g_hash_table_remove (icon_renderer->composites, lp->data);
+    }
+
+  return composite;
+}
+
+
+
 static void
 thunar_icon_renderer_render (GtkCellRenderer     *renderer,
                              GdkWindow           *window,
@@ -359,31 +633,42 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
                              GdkRectangle        *expose_area,
                              GtkCellRendererState flags)
 {
-  ThunarClipboardManager *clipboard;
-  ThunarFileIconState     icon_state;
-  ThunarIconRenderer     *icon_renderer = THUNAR_ICON_RENDERER (renderer);
-  ThunarIconFactory      *icon_factory;
-  GtkIconSource          *icon_source;
-  GtkIconTheme           *icon_theme;
-  GdkRectangle            emblem_area;
-  GdkRectangle            icon_area;
-  GdkRectangle            draw_area;
-  GdkPixbuf              *emblem;
-  GdkPixbuf              *icon;
-  GdkPixbuf              *temp;
-  GList                  *emblems;
-  GList                  *lp;
-  gint                    max_emblems;
-  gint                    position;
-  cairo_t                *cr;
-  gdouble                 alpha;
-  gint                    emblem_size;
-  gboolean                color_selected;
-  gboolean                color_lighten;
+  ThunarIconRendererComposite *composite;
+  ThunarClipboardManager      *clipboard;
+  ThunarFileIconState          icon_state;
+  ThunarIconRenderer          *icon_renderer = THUNAR_ICON_RENDERER (renderer);
+  ThunarIconFactory           *icon_factory;
+  GtkIconSource               *icon_source;
+  GtkIconTheme                *icon_theme;
+  GdkRectangle                 composite_area;
+  GdkRectangle                 emblem_area;
+  GdkRectangle                 icon_area;
+  GdkRectangle                 draw_area;
+  const gchar                 *emblems_key;
+  GdkPixbuf                   *base_icon;
+  GdkPixbuf                   *emblem;
+  GdkPixbuf                   *icon;
+  GdkPixbuf                   *temp;
+  GList                       *emblems;
+  GList                       *lp;
+  gint                         max_emblems;
+  gint                         position;
+  cairo_t                     *cr;
+  gdouble                      alpha;
+  gint                         emblem_size;
+  gboolean                     color_selected;
+  gboolean                     color_lighten;
+  gboolean                     insensitive;
 
   if (G_UNLIKELY (icon_renderer->file == NULL))
     return;
 
+  /* the icon, the composite and the emblems are all painted inside the
+   * cell, so skip the icon and clipboard lookups for cells that are not
+   * affected by the expose event */
+  if (!gdk_rectangle_intersect (expose_area, cell_area, &draw_area))
+    return;
+
   /* determine the icon state */
   icon_state = (icon_renderer->drop_file != icon_renderer->file)
              ? renderer->is_expanded
@@ -401,6 +686,9 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
       return;
     }
 
+  /* the unscaled icon identifies composited icons */
+  base_icon = g_object_ref (G_OBJECT (icon));
+
   /* pre-light the item if we're dragging about it */
   if (G_UNLIKELY (icon_state == THUNAR_FILE_ICON_STATE_DROP))
     flags |= GTK_CELL_RENDERER_PRELIT;
@@ -429,32 +717,70 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
   color_selected = (flags & GTK_CELL_RENDERER_SELECTED) != 0 && icon_renderer->follow_state;
   color_lighten = (flags & GTK_CELL_RENDERER_PRELIT) != 0 && icon_renderer->follow_state;
 
+  /* use a translucent icon to represent cutted and hidden files to the user */
+  clipboard = thunar_clipboard_manager_get_for_display (gtk_widget_get_display (widget));
+  if (thunar_clipboard_manager_has_cutted_file (clipboard, icon_renderer->file))
+    {
+      /* 50% translucent for cutted files */
+      alpha = 0.50;
+    }
+  else if (thunar_file_is_hidden (icon_renderer->file))
+    {
+      /* 75% translucent for hidden files */
+      alpha = 0.75;
+    }
+  else
+    {
+      alpha = 1.00;
+    }
+  g_object_unref (G_OBJECT (clipboard));
+
+  /* check if we should render an insensitive icon */
+  insensitive = (gtk_widget_get_state (widget) == GTK_STATE_INSENSITIVE || !renderer->sensitive);
+
+  /* the emblems of the file, an empty key if there are none */
+  emblems_key = icon_renderer->emblems ? thunar_file_get_emblems_key (icon_renderer->file) : "";
+
   /* create the context */
   cr = gdk_cairo_create (window);
 
-  /* check whether the icon is affected by the expose event */
-  if (gdk_rectangle_intersect (expose_area, &icon_area, &draw_area))
+  /* opaque icons with emblems are composited once and then painted
+   * as a single pixbuf, instead of loading and painting the emblems
+   * again on every expose */
+  if (*emblems_key != '\0' && alpha == 1.00 && G_LIKELY (!insensitive))
     {
-      /* use a translucent icon to represent cutted and hidden files to the user */
-      clipboard = thunar_clipboard_manager_get_for_display (gtk_widget_get_display (widget));
-      if (thunar_clipboard_manager_has_cutted_file (clipboard, icon_renderer->file))
-        {
-          /* 50% translucent for cutted files */
-          alpha = 0.50;
-        }
-      else if (thunar_file_is_hidden (icon_renderer->file))
-        {
-          /* 75% translucent for hidden files */
-          alpha = 0.75;
-        }
-      else
+      composite = thunar_icon_renderer_get_composite (icon_renderer, icon_factory, base_icon, icon,
+                                                      &icon_area, cell_area, emblems_key);
+
+      composite_area.x = cell_area->x + composite->x;
+      composite_area.y = cell_area->y + composite->y;
+      composite_area.width = gdk_pixbuf_get_width (composite->composite);
+      composite_area.height = gdk_pixbuf_get_height (composite->composite);
+
+      /* check whether the composite is affected by the expose event */
+      if (gdk_rectangle_intersect (expose_area, &composite_area, &draw_area))
         {
-          alpha = 1.00;
+          /* render the invalid parts of the composite */
+          thunar_gdk_cairo_set_source_pixbuf (cr, composite->composite, composite_area.x, composite_area.y);
+          gdk_cairo_rectangle (cr, &draw_area);
+          cairo_paint (cr);
+
+          /* paint the lighten mask */
+          if (color_lighten)
+            thunar_icon_renderer_color_lighten (cr, widget);
+
+          /* paint the selected mask */
+          if (color_selected)
+            thunar_icon_renderer_color_selected (cr, widget);
         }
-      g_object_unref (G_OBJECT (clipboard));
 
+      /* skip the emblems below */
+      emblems_key = "";
+    }
+  else if (gdk_rectangle_intersect (expose_area, &icon_area, &draw_area))
+    {
       /* check if we should render an insensitive icon */
-      if (G_UNLIKELY (gtk_widget_get_state (widget) == GTK_STATE_INSENSITIVE || !renderer->sensitive))
+      if (G_UNLIKELY (insensitive))
         {
           /* allocate an icon source */
           icon_source = gtk_icon_source_new ();
@@ -488,107 +814,59 @@ thunar_icon_renderer_render (GtkCellRenderer     *renderer,
 
   /* release the file's icon */
   g_object_unref (G_OBJECT (icon));
+  g_object_unref (G_OBJECT (base_icon));
 
   /* check if we should render emblems as well */
-  if (G_LIKELY (icon_renderer->emblems))
+  if (G_UNLIKELY (*emblems_key != '\0'))
     {
       /* display the primary emblem as well (if any) */
       emblems = thunar_file_get_emblem_names (icon_renderer->file);
-      if (G_UNLIKELY (emblems != NULL))
-        {
-          /* render up to four emblems for sizes from 48 onwards, else up to 2 emblems */
-          max_emblems = (icon_renderer->size < 48) ? 2 : 4;
 
-          /* render the emblems */
-          for (lp = emblems, position = 0; lp != NULL && position < max_emblems; lp = lp->next)
+      /* render up to four emblems for sizes from 48 onwards, else up to 2 emblems */
+      max_emblems = (icon_renderer->size < 48) ? 2 : 4;
+
+      /* calculate the emblem size */
+      emblem_size = MIN ((2 * icon_renderer->size) / 3, 32);
+
+      /* render the emblems */
+      for (lp = emblems, position = 0; lp != NULL && position < max_emblems; lp = lp->next)
+        {
+          /* check if we have the emblem in the icon theme */
+          emblem = thunar_icon_renderer_load_emblem (icon_factory, lp->data, emblem_size);
+          if (G_UNLIKELY (emblem == NULL))
+            continue;
+
+          /* determine the dimensions and the position of the emblem */
+          emblem_area.width = gdk_pixbuf_get_width (emblem);
+          emblem_area.height = gdk_pixbuf_get_height (emblem);
+          thunar_icon_renderer_emblem_position (position, &icon_area, cell_area, &emblem_area);
+
+          /* render the emblem */
+          if (gdk_rectangle_intersect (expose_area, &emblem_area, &draw_area))
             {
-              /* calculate the emblem size */
-              emblem_size = MIN ((2 * icon_renderer->size) / 3, 32);
-
-              /* check if we have the emblem in the icon theme */
-              emblem = thunar_icon_factory_load_icon (icon_factory, lp->data, emblem_size, FALSE);
-              if (G_UNLIKELY (emblem == NULL))
-                continue;
-
-              /* determine the dimensions of the emblem */
-              emblem_area.width = gdk_pixbuf_get_width (emblem);
-              emblem_area.height = gdk_pixbuf_get_height (emblem);
-
-              /* shrink insane emblems */
-              if (G_UNLIKELY (MAX (emblem_area.width, emblem_area.height) > emblem_size))
-                {
-                  /* scale down the emblem */
-                  temp = exo_gdk_pixbuf_scale_ratio (emblem, emblem_size);
-                  g_object_unref (G_OBJECT (emblem));
-                  emblem = temp;
-
-                  /* determine the size again */
-                  emblem_area.width = gdk_pixbuf_get_width (emblem);
-                  emblem_area.height = gdk_pixbuf_get_height (emblem);
-                }
-
-              /* determine a good position for the emblem, depending on the position index */
-              switch (position)
-                {
-                case 0: /* right/bottom */
-                  emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
-                                       cell_area->x + cell_area->width - emblem_area.width);
-                  emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
-                                       cell_area->y + cell_area->height -emblem_area.height);
-                  break;
-
-                case 1: /* left/bottom */
-                  emblem_area.x = MAX (icon_area.x - emblem_area.width / 2,
-                                       cell_area->x);
-                  emblem_area.y = MIN (icon_area.y + icon_area.height - emblem_area.height / 2,
-                                       cell_area->y + cell_area->height -emblem_area.height);
-                  break;
-
-                case 2: /* left/top */
-                  emblem_area.x = MAX (icon_area.x - emblem_area.width / 2,
-                                       cell_area->x);
-                  emblem_area.y = MAX (icon_area.y - emblem_area.height / 2,
-                                       cell_area->y);
-                  break;
-
-                case 3: /* right/top */
-                  emblem_area.x = MIN (icon_area.x + icon_area.width - emblem_area.width / 2,
-                                       cell_area->x + cell_area->width - emblem_area.width);
-                  emblem_area.y = MAX (icon_area.y - emblem_area.height / 2,
-                                       cell_area->y);
-                  break;
-
-                default:
-                  _thunar_assert_not_reached ();
-                }
-
-              /* render the emblem */
-              if (gdk_rectangle_intersect (expose_area, &emblem_area, &draw_area))
-                {
-                  /* render the invalid parts of the icon */
-                  thunar_gdk_cairo_set_source_pixbuf (cr, emblem, emblem_area.x, emblem_area.y);
-                  gdk_cairo_rectangle (cr, &draw_area);
-                  cairo_paint (cr);
-
-                  /* paint the lighten mask */
-                  if (color_lighten)
-                    thunar_icon_renderer_color_lighten (cr, widget);
-
-                  /* paint the selected mask */
-                  if (color_selected)
-                    thunar_icon_renderer_color_selected (cr, widget);
-                }
-
-              /* release the emblem */
-              g_object_unref (G_OBJECT (emblem));
-
-              /* advance the position index */
-              ++position;
+              /* render the invalid parts of the icon */
+              thunar_gdk_cairo_set_source_pixbuf (cr, emblem, emblem_area.x, emblem_area.y);
+              gdk_cairo_rectangle (cr, &draw_area);
+              cairo_paint (cr);
+
+              /* paint the lighten mask */
+              if (color_lighten)
+                thunar_icon_renderer_color_lighten (cr, widget);
+
+              /* paint the selected mask */
+              if (color_selected)
+                thunar_icon_renderer_color_selected (cr, widget);
             }
 
-          /* release the emblem name list */
-          g_list_free (emblems);
+          /* release the emblem */
+          g_object_unref (G_OBJECT (emblem));
+
+          /* advance the position index */
+          ++position;
         }
+
+      /* release the emblem name list */
+      g_list_free (emblems);
     }
 
   /* destroy the context */
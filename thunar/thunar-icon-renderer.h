@@ -25,8 +25,9 @@
 
 G_BEGIN_DECLS;
 
-typedef struct _ThunarIconRendererClass ThunarIconRendererClass;
-typedef struct _ThunarIconRenderer      ThunarIconRenderer;
+typedef struct _ThunarIconRendererClass     ThunarIconRendererClass;
+typedef struct _ThunarIconRenderer          ThunarIconRenderer;
+typedef struct _ThunarIconRendererComposite ThunarIconRendererComposite;
 
 #define THUNAR_TYPE_ICON_RENDERER            (thunar_icon_renderer_get_type ())
 #define THUNAR_ICON_RENDERER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_ICON_RENDERER, ThunarIconRenderer))
@@ -49,6 +50,10 @@ struct _ThunarIconRenderer
   gboolean       emblems;
   gboolean       follow_state;
   ThunarIconSize size;
+
+  /* composited icons with emblems and their LRU order */
+  GHashTable    *composites;
+  GQueue         composites_lru;
 };
 
 GType            thunar_icon_renderer_get_type (void) G_GNUC_CONST;
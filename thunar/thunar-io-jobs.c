@@ -22,7 +22,30 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-enum-types.h>
@@ -396,6 +419,462 @@ thunar_io_jobs_make_directories (GList *file_list)
 
 
 
+#ifdef HAVE_FDOPENDIR
+static gboolean
+_tij_dirent_is_directory (gint           dir_fd,
+                          struct dirent *dp)
+{
+  struct stat statb;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+  /* most file systems report the type with the entry */
+  if (dp->d_type != DT_UNKNOWN)
+    return (dp->d_type == DT_DIR);
+#endif
+
+  if (fstatat (dir_fd, dp->d_name, &statb, AT_SYMLINK_NOFOLLOW) < 0)
+    return FALSE;
+
+  return S_ISDIR (statb.st_mode);
+}
+
+
+
+/* counts the entries of the tree @name in the folder @parent_fd,
+ * including @name itself, for the progress of the native jobs */
+static guint
+_tij_count_at (ThunarJob   *job,
+               gint         parent_fd,
+               const gchar *name,
+               gboolean     is_directory)
+{
+  struct dirent *dp;
+  guint          n_files = 1;
+  DIR           *dir;
+  gint           fd;
+
+  if (!is_directory)
+    return n_files;
+
+  /* unreadable folders are reported when they are processed */
+  fd = openat (parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+  dir = (fd >= 0) ? fdopendir (fd) : NULL;
+  if (G_UNLIKELY (dir == NULL))
+    {
+      if (fd >= 0)
+        close (fd);
+      return n_files;
+    }
+
+  while (!exo_job_is_cancelled (EXO_JOB (job)))
+    {
+      dp = readdir (dir);
+      if (dp == NULL)
+        break;
+
+      /* skip the special entries */
+      if (strcmp (dp->d_name, ".") == 0 || strcmp (dp->d_name, "..") == 0)
+        continue;
+
+      n_files += _tij_count_at (job, fd, dp->d_name,
+                                _tij_dirent_is_directory (fd, dp));
+    }
+
+  closedir (dir);
+
+  return n_files;
+}
+#endif
+
+
+
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_UNLINKAT)
+/* maximum number of folders deleted at the same time */
+#define TIJ_UNLINK_MAX_WORKERS (4)
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _tij_unlink_lock(context)      g_mutex_lock (&((context)->ask_lock))
+#define _tij_unlink_unlock(context)    g_mutex_unlock (&((context)->ask_lock))
+#define _tij_unlink_wait(context)      g_cond_wait (&((context)->task_cond), &((context)->ask_lock))
+#define _tij_unlink_broadcast(context) g_cond_broadcast (&((context)->task_cond))
+#else
+#define _tij_unlink_lock(context)      g_mutex_lock ((context)->ask_lock)
+#define _tij_unlink_unlock(context)    g_mutex_unlock ((context)->ask_lock)
+#define _tij_unlink_wait(context)      g_cond_wait ((context)->task_cond, (context)->ask_lock)
+#define _tij_unlink_broadcast(context) g_cond_broadcast ((context)->task_cond)
+#endif
+
+typedef struct
+{
+  ThunarJob   *job;
+
+  /* the pool that deletes folders at any depth, a folder is
+   * only handed to it while one of its workers is free */
+  GThreadPool *workers;
+  guint        n_busy;
+
+  /* the workers ask their questions, report their progress
+   * and wait for the folders they handed out one at a time */
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex       ask_lock;
+  GCond        task_cond;
+#else
+  GMutex      *ask_lock;
+  GCond       *task_cond;
+#endif
+
+  /* number of entries to delete and deleted so far */
+  guint        n_total;
+  guint        n_done;
+  gint         percent;
+} TijUnlinkContext;
+
+typedef struct
+{
+  gint   parent_fd;
+  gchar *name;
+  gchar *path;
+
+  /* the number of tasks the parent folder waits for */
+  guint *n_pending;
+} TijUnlinkTask;
+
+
+
+static gboolean
+_tij_unlink_ask_retry (TijUnlinkContext *context,
+                       const gchar      *path,
+                       gint              errsv)
+{
+  ThunarJobResponse response;
+  gchar            *display_name;
+
+  if (exo_job_is_cancelled (EXO_JOB (context->job)))
+    return FALSE;
+
+  display_name = g_filename_display_basename (path);
+
+  /* ask the user whether he wants to skip this file */
+  _tij_unlink_lock (context);
+  response = thunar_job_ask_skip (context->job,
+                                  _("Could not delete file \"%s\": %s"),
+                                  display_name, g_strerror (errsv));
+  _tij_unlink_unlock (context);
+
+  g_free (display_name);
+
+  return (response == THUNAR_JOB_RESPONSE_RETRY);
+}
+
+
+
+static void
+_tij_unlink_done (TijUnlinkContext *context)
+{
+  gint percent;
+
+  _tij_unlink_lock (context);
+
+  context->n_done++;
+
+  /* only emit when the visible percentage changes */
+  percent = (context->n_done * 100.0) / MAX (context->n_total, context->n_done);
+  if (percent != context->percent)
+    {
+      context->percent = percent;
+      exo_job_percent (EXO_JOB (context->job), percent);
+    }
+
+  _tij_unlink_unlock (context);
+
+  /* every entry counts in the statistics, not just the top-level files */
+  thunar_job_files_done (context->job, 1, 0);
+
+  /* the job thread and the workers all stop at their next
+   * entry while the job is paused */
+  thunar_job_check_paused (context->job);
+}
+
+
+
+static void _tij_unlink_worker (gpointer data,
+                                gpointer user_data);
+
+
+
+/* hands a subfolder to the workers if one of them is free, each
+ * queued task has a worker of its own, so waiting for the tasks
+ * cannot block the pool */
+static gboolean
+_tij_unlink_reserve (TijUnlinkContext *context,
+                     guint            *n_pending)
+{
+  gboolean reserved = FALSE;
+
+  _tij_unlink_lock (context);
+
+  if (context->n_busy < TIJ_UNLINK_MAX_WORKERS)
+    {
+      context->n_busy++;
+      (*n_pending)++;
+      reserved = TRUE;
+    }
+
+  _tij_unlink_unlock (context);
+
+  return reserved;
+}
+
+
+
+/* deletes @name in the folder @parent_fd, recursively if it is a folder.
+ * the folders below it are handed to the workers while they are idle */
+static gboolean
+_tij_unlink_at (TijUnlinkContext *context,
+                gint              parent_fd,
+                const gchar      *name,
+                const gchar      *path,
+                gboolean          is_directory)
+{
+  TijUnlinkTask *task;
+  struct dirent *dp;
+  gchar         *child_path;
+  guint          n_pending = 0;
+  DIR           *dir;
+  gint           errsv;
+  gint           fd;
+
+  if (is_directory)
+    {
+retry_open:
+      /* open the folder relative to its parent, so its children
+       * don't need a full path lookup */
+      fd = openat (parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+      dir = (fd >= 0) ? fdopendir (fd) : NULL;
+      if (G_UNLIKELY (dir == NULL))
+        {
+          errsv = errno;
+          if (fd >= 0)
+            close (fd);
+
+          /* the folder was replaced by a file or is gone already */
+          if (errsv == ENOTDIR || errsv == ELOOP)
+            return _tij_unlink_at (context, parent_fd, name, path, FALSE);
+          else if (errsv == ENOENT)
+            {
+              _tij_unlink_done (context);
+              return TRUE;
+            }
+
+          if (_tij_unlink_ask_retry (context, path, errsv))
+            goto retry_open;
+
+          return FALSE;
+        }
+
+      while (!exo_job_is_cancelled (EXO_JOB (context->job)))
+        {
+          dp = readdir (dir);
+          if (dp == NULL)
+            break;
+
+          /* skip the special entries */
+          if (strcmp (dp->d_name, ".") == 0 || strcmp (dp->d_name, "..") == 0)
+            continue;
+
+          child_path = g_build_filename (path, dp->d_name, NULL);
+
+          if (_tij_dirent_is_directory (fd, dp)
+              && _tij_unlink_reserve (context, &n_pending))
+            {
+              /* the subtrees are independent, delete them in parallel */
+              task = g_slice_new (TijUnlinkTask);
+              task->parent_fd = fd;
+              task->name = g_strdup (dp->d_name);
+              task->path = child_path;
+              task->n_pending = &n_pending;
+              g_thread_pool_push (context->workers, task, NULL);
+            }
+          else
+            {
+              _tij_unlink_at (context, fd, dp->d_name, child_path,
+                              _tij_dirent_is_directory (fd, dp));
+              g_free (child_path);
+            }
+        }
+
+      /* wait for the subfolders before the folder is closed */
+      _tij_unlink_lock (context);
+      while (n_pending > 0)
+        _tij_unlink_wait (context);
+      _tij_unlink_unlock (context);
+
+      closedir (dir);
+    }
+
+retry_unlink:
+  if (exo_job_is_cancelled (EXO_JOB (context->job)))
+    return FALSE;
+
+  if (unlinkat (parent_fd, name, is_directory ? AT_REMOVEDIR : 0) < 0)
+    {
+      errsv = errno;
+      if (errsv != ENOENT)
+        {
+          if (_tij_unlink_ask_retry (context, path, errsv))
+            goto retry_unlink;
+
+          return FALSE;
+        }
+    }
+
+  _tij_unlink_done (context);
+
+  return TRUE;
+}
+
+
+
+static void
+_tij_unlink_worker (gpointer data,
+                    gpointer user_data)
+{
+  TijUnlinkTask    *task = data;
+  TijUnlinkContext *context = user_data;
+
+  if (!exo_job_is_cancelled (EXO_JOB (context->job)))
+    _tij_unlink_at (context, task->parent_fd, task->name, task->path, TRUE);
+
+  /* free the worker and wake up the parent folder */
+  _tij_unlink_lock (context);
+  context->n_busy--;
+  (*task->n_pending)--;
+  _tij_unlink_broadcast (context);
+  _tij_unlink_unlock (context);
+
+  g_free (task->name);
+  g_free (task->path);
+  g_slice_free (TijUnlinkTask, task);
+}
+
+
+
+/* deletes the local files in @file_list relative to open folders, which is
+ * a lot faster than g_file_delete() on each file for large trees. the trees
+ * are counted first to report the progress per deleted entry. returns
+ * the files that must be deleted with GIO */
+static GList *
+_tij_unlink_native (ThunarJob *job,
+                    GList     *file_list)
+{
+  ThunarThumbnailCache *thumbnail_cache;
+  ThunarApplication    *application;
+  struct stat           statb;
+  TijUnlinkContext      context;
+  gboolean              is_directory;
+  GList                *foreign_files = NULL;
+  GList                *local_files = NULL;
+  GList                *lp;
+  gchar                *path;
+  gchar                *display_name;
+
+  context.job = job;
+  context.n_busy = 0;
+  context.n_total = 0;
+  context.n_done = 0;
+  context.percent = -1;
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&context.ask_lock);
+  g_cond_init (&context.task_cond);
+#else
+  context.ask_lock = g_mutex_new ();
+  context.task_cond = g_cond_new ();
+#endif
+
+  /* the threads are only started when there are folders to delete */
+  context.workers = g_thread_pool_new (_tij_unlink_worker, &context,
+                                       TIJ_UNLINK_MAX_WORKERS, FALSE, NULL);
+
+  /* take a reference on the thumbnail cache */
+  application = thunar_application_get ();
+  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+  g_object_unref (application);
+
+  /* count the entries of the local trees for the progress */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_COLLECTING);
+  for (lp = file_list; lp != NULL && !exo_job_is_cancelled (EXO_JOB (job)); lp = lp->next)
+    {
+      /* skip root folders which cannot be deleted anyway */
+      if (thunar_g_file_is_root (lp->data))
+        continue;
+
+      path = g_file_get_path (lp->data);
+      if (path == NULL || !g_path_is_absolute (path) || lstat (path, &statb) < 0)
+        {
+          /* let gio handle the remote files and report the errors */
+          foreign_files = thunar_g_file_list_prepend (foreign_files, lp->data);
+          g_free (path);
+          continue;
+        }
+
+      context.n_total += _tij_count_at (job, AT_FDCWD, path, S_ISDIR (statb.st_mode));
+      local_files = thunar_g_file_list_prepend (local_files, lp->data);
+      g_free (path);
+    }
+
+  /* delete the trees in the order they were passed */
+  local_files = g_list_reverse (local_files);
+
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_PROCESSING);
+  for (lp = local_files; lp != NULL && !exo_job_is_cancelled (EXO_JOB (job)); lp = lp->next)
+    {
+      /* the file may have been deleted in the meantime */
+      path = g_file_get_path (lp->data);
+      if (lstat (path, &statb) < 0)
+        {
+          g_free (path);
+          continue;
+        }
+
+      display_name = g_filename_display_basename (path);
+      exo_job_info_message (EXO_JOB (job), "%s", display_name);
+      g_free (display_name);
+
+      is_directory = S_ISDIR (statb.st_mode);
+      if (_tij_unlink_at (&context, AT_FDCWD, path, path, is_directory))
+        {
+          /* notify the thumbnail cache once for the whole tree, the cleanup
+           * drops the thumbnails of all files below the folder */
+          if (is_directory)
+            thunar_thumbnail_cache_cleanup_file (thumbnail_cache, lp->data);
+          else
+            thunar_thumbnail_cache_delete_file (thumbnail_cache, lp->data);
+        }
+
+      g_free (path);
+    }
+
+  thunar_g_file_list_free (local_files);
+
+  /* release the thumbnail cache */
+  g_object_unref (thumbnail_cache);
+
+  g_thread_pool_free (context.workers, FALSE, TRUE);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&context.ask_lock);
+  g_cond_clear (&context.task_cond);
+#else
+  g_mutex_free (context.ask_lock);
+  g_cond_free (context.task_cond);
+#endif
+
+  return g_list_reverse (foreign_files);
+}
+#endif
+
+
+
 static gboolean
 _thunar_io_jobs_unlink (ThunarJob  *job,
                         GArray     *param_values,
@@ -407,9 +886,13 @@ _thunar_io_jobs_unlink (ThunarJob  *job,
   GFileInfo            *info;
   GError               *err = NULL;
   GList                *file_list;
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_UNLINKAT)
+  GList                *foreign_files;
+#endif
   GList                *lp;
   gchar                *base_name;
   gchar                *display_name;
+  gint64                start_time;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
@@ -419,11 +902,26 @@ _thunar_io_jobs_unlink (ThunarJob  *job,
   /* get the file list */
   file_list = g_value_get_boxed (&g_array_index (param_values, GValue, 0));
 
+  /* wait for the other jobs on the same devices */
+  if (!thunar_job_schedule (job, file_list, error))
+    return FALSE;
+
   /* tell the user that we're preparing to unlink the files */
   exo_job_info_message (EXO_JOB (job), _("Preparing..."));
 
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_UNLINKAT)
+  /* delete the local files directly, only the remaining files are
+   * collected and deleted through gio */
+  foreign_files = _tij_unlink_native (job, file_list);
+
+  /* recursively collect files for removal, not following any symlinks */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_COLLECTING);
+  file_list = _tij_collect_nofollow (job, foreign_files, TRUE, &err);
+  thunar_g_file_list_free (foreign_files);
+#else
   /* recursively collect files for removal, not following any symlinks */
   file_list = _tij_collect_nofollow (job, file_list, TRUE, &err);
+#endif
 
   /* free the file list and fail if there was an error or the job was cancelled */
   if (err != NULL || exo_job_is_cancelled (EXO_JOB (job)))
@@ -446,18 +944,25 @@ _thunar_io_jobs_unlink (ThunarJob  *job,
   g_object_unref (application);
 
   /* remove all the files */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_PROCESSING);
   for (lp = file_list; lp != NULL && !exo_job_is_cancelled (EXO_JOB (job)); lp = lp->next)
     {
       g_assert (G_IS_FILE (lp->data));
 
+      /* stop between two files while the job is paused */
+      thunar_job_check_paused (job);
+
       /* skip root folders which cannot be deleted anyway */
       if (thunar_g_file_is_root (lp->data))
         continue;
 
 again:
       /* try to delete the file */
+      start_time = g_get_monotonic_time ();
       if (g_file_delete (lp->data, exo_job_get_cancellable (EXO_JOB (job)), &err))
         {
+          thunar_job_file_done (job, lp->data, 0, start_time);
+
           /* notify the thumbnail cache that the corresponding thumbnail can also
            * be deleted now */
           thunar_thumbnail_cache_delete_file (thumbnail_cache, lp->data);
@@ -789,6 +1294,328 @@ thunar_io_jobs_link_files (GList *source_file_list,
 
 
 
+/* number of files moved to the trash between two progress updates */
+#define TIJ_TRASH_BATCH_SIZE (256)
+
+typedef struct
+{
+  gchar      *files_dir;
+  gchar      *info_dir;
+  gint        info_fd;
+  dev_t       device;
+
+  /* the names of the files in the trash, to find free names
+   * without probing the file system for each of them */
+  GHashTable *names;
+} TijTrash;
+
+
+
+static gboolean
+_tij_trash_open (TijTrash *trash)
+{
+  struct stat  statb;
+  const gchar *name;
+  GDir        *dir;
+  gchar       *trash_dir;
+
+  /* the home trash of the freedesktop.org trash specification */
+  trash_dir = g_build_filename (g_get_user_data_dir (), "Trash", NULL);
+  trash->files_dir = g_build_filename (trash_dir, "files", NULL);
+  trash->info_dir = g_build_filename (trash_dir, "info", NULL);
+  trash->info_fd = -1;
+  trash->names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_free (trash_dir);
+
+  if (g_mkdir_with_parents (trash->files_dir, 0700) < 0
+      || g_mkdir_with_parents (trash->info_dir, 0700) < 0
+      || stat (trash->files_dir, &statb) < 0)
+    return FALSE;
+
+  /* only files on the same device can be renamed into the trash */
+  trash->device = statb.st_dev;
+
+  trash->info_fd = open (trash->info_dir, O_RDONLY);
+  if (trash->info_fd < 0)
+    return FALSE;
+
+  /* index the names in use, for both the info files and the files
+   * themselves, which may be left without info by other programs */
+  dir = g_dir_open (trash->info_dir, 0, NULL);
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        if (g_str_has_suffix (name, ".trashinfo"))
+          {
+            g_hash_table_insert (trash->names,
+                                 g_strndup (name, strlen (name) - strlen (".trashinfo")),
+                                 GINT_TO_POINTER (TRUE));
+          }
+      g_dir_close (dir);
+    }
+
+  dir = g_dir_open (trash->files_dir, 0, NULL);
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        g_hash_table_insert (trash->names, g_strdup (name), GINT_TO_POINTER (TRUE));
+      g_dir_close (dir);
+    }
+
+  return TRUE;
+}
+
+
+
+static void
+_tij_trash_close (TijTrash *trash)
+{
+  if (trash->info_fd >= 0)
+    close (trash->info_fd);
+
+  g_hash_table_destroy (trash->names);
+  g_free (trash->files_dir);
+  g_free (trash->info_dir);
+}
+
+
+
+static gchar *
+_tij_trash_info_path (TijTrash    *trash,
+                      const gchar *name)
+{
+  gchar *info_name;
+  gchar *info_path;
+
+  info_name = g_strconcat (name, ".trashinfo", NULL);
+  info_path = g_build_filename (trash->info_dir, info_name, NULL);
+  g_free (info_name);
+
+  return info_path;
+}
+
+
+
+/* reserves a free name in the trash for @path by creating its info
+ * file, which is left open in @fd_return so the caller can sync it.
+ * returns the name or %NULL if the info file could not be written */
+static gchar *
+_tij_trash_write_info (TijTrash    *trash,
+                       const gchar *path,
+                       const gchar *deletion_date,
+                       gint        *fd_return)
+{
+  gchar *base_name;
+  gchar *escaped_path;
+  gchar *contents;
+  gchar *info_path;
+  gchar *name = NULL;
+  gsize  length;
+  guint  n;
+  gint   fd = -1;
+
+  base_name = g_path_get_basename (path);
+
+  for (n = 1; fd < 0; ++n)
+    {
+      g_free (name);
+      if (n == 1)
+        name = g_strdup (base_name);
+      else
+        name = g_strdup_printf ("%s.%u", base_name, n);
+
+      /* skip names that are known to be in use */
+      if (g_hash_table_lookup (trash->names, name) != NULL)
+        continue;
+
+      /* the name is in use from now on, even if another program took it */
+      g_hash_table_insert (trash->names, g_strdup (name), GINT_TO_POINTER (TRUE));
+
+      info_path = _tij_trash_info_path (trash, name);
+      fd = open (info_path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+      g_free (info_path);
+
+      if (fd < 0 && errno != EEXIST)
+        {
+          g_free (base_name);
+          g_free (name);
+          return NULL;
+        }
+    }
+
+  g_free (base_name);
+
+  escaped_path = g_uri_escape_string (path, "/", FALSE);
+  contents = g_strdup_printf ("[Trash Info]\nPath=%s\nDeletionDate=%s\n",
+                              escaped_path, deletion_date);
+  length = strlen (contents);
+  g_free (escaped_path);
+
+  if (write (fd, contents, length) != (gssize) length)
+    {
+      info_path = _tij_trash_info_path (trash, name);
+      g_unlink (info_path);
+      g_free (info_path);
+
+      g_free (name);
+      name = NULL;
+
+      close (fd);
+      fd = -1;
+    }
+
+  g_free (contents);
+
+  *fd_return = fd;
+
+  return name;
+}
+
+
+
+/* moves the local files in @file_list to the home trash in batches,
+ * writing the info files of a batch before its files are renamed.
+ * returns the files that must be trashed with GIO */
+static GList *
+_tij_trash_native (ThunarJob            *job,
+                   GList                *file_list,
+                   ThunarThumbnailCache *thumbnail_cache)
+{
+  struct stat statb;
+  GDateTime  *now;
+  TijTrash    trash;
+  GPtrArray  *batch_files;
+  GPtrArray  *batch_paths;
+  GPtrArray  *batch_names;
+  GArray     *batch_fds;
+  GList      *foreign_files = NULL;
+  GList      *lp;
+  gchar      *deletion_date;
+  gchar      *base_name;
+  gchar      *display_name;
+  gchar      *path;
+  gchar      *target_path;
+  gchar      *info_path;
+  guint       n_total;
+  guint       n_done = 0;
+  guint       n;
+  gint        fd;
+
+  if (!_tij_trash_open (&trash))
+    {
+      /* let gio handle everything */
+      _tij_trash_close (&trash);
+      return thunar_g_file_list_copy (file_list);
+    }
+
+  now = g_date_time_new_now_local ();
+  deletion_date = g_date_time_format (now, "%Y-%m-%dT%H:%M:%S");
+  g_date_time_unref (now);
+
+  batch_files = g_ptr_array_sized_new (TIJ_TRASH_BATCH_SIZE);
+  batch_paths = g_ptr_array_sized_new (TIJ_TRASH_BATCH_SIZE);
+  batch_names = g_ptr_array_sized_new (TIJ_TRASH_BATCH_SIZE);
+  batch_fds = g_array_sized_new (FALSE, FALSE, sizeof (gint), TIJ_TRASH_BATCH_SIZE);
+
+  n_total = g_list_length (file_list);
+
+  for (lp = file_list; lp != NULL && !exo_job_is_cancelled (EXO_JOB (job)); )
+    {
+      /* stop between two batches while the job is paused */
+      thunar_job_check_paused (job);
+
+      base_name = g_file_get_basename (lp->data);
+      display_name = g_filename_display_name (base_name);
+      exo_job_info_message (EXO_JOB (job), "%s", display_name);
+      g_free (display_name);
+      g_free (base_name);
+
+      /* write the info files of the next batch */
+      for (; lp != NULL && batch_files->len < TIJ_TRASH_BATCH_SIZE; lp = lp->next, ++n_done)
+        {
+          path = g_file_get_path (lp->data);
+
+          /* files on other devices and the trash itself are left to gio */
+          if (path == NULL
+              || lstat (path, &statb) < 0
+              || statb.st_dev != trash.device
+              || g_str_has_prefix (path, trash.files_dir)
+              || g_str_has_prefix (path, trash.info_dir))
+            {
+              foreign_files = thunar_g_file_list_prepend (foreign_files, lp->data);
+              g_free (path);
+              continue;
+            }
+
+          g_ptr_array_add (batch_names, _tij_trash_write_info (&trash, path, deletion_date, &fd));
+          if (g_ptr_array_index (batch_names, batch_names->len - 1) == NULL)
+            {
+              g_ptr_array_remove_index (batch_names, batch_names->len - 1);
+              foreign_files = thunar_g_file_list_prepend (foreign_files, lp->data);
+              g_free (path);
+              continue;
+            }
+
+          g_ptr_array_add (batch_files, lp->data);
+          g_ptr_array_add (batch_paths, path);
+          g_array_append_val (batch_fds, fd);
+        }
+
+      /* the info files must be on disk before the files move: first
+       * their contents, then their entries with one sync of the info
+       * folder per batch */
+      for (n = 0; n < batch_fds->len; ++n)
+        {
+          fsync (g_array_index (batch_fds, gint, n));
+          close (g_array_index (batch_fds, gint, n));
+        }
+      fsync (trash.info_fd);
+
+      for (n = 0; n < batch_files->len; ++n)
+        {
+          target_path = g_build_filename (trash.files_dir, g_ptr_array_index (batch_names, n), NULL);
+          if (g_rename (g_ptr_array_index (batch_paths, n), target_path) == 0)
+            {
+              /* update the thumbnail cache */
+              thunar_thumbnail_cache_cleanup_file (thumbnail_cache, g_ptr_array_index (batch_files, n));
+            }
+          else
+            {
+              /* drop the info file again and let gio report the problem */
+              info_path = _tij_trash_info_path (&trash, g_ptr_array_index (batch_names, n));
+              g_unlink (info_path);
+              g_free (info_path);
+
+              foreign_files = thunar_g_file_list_prepend (foreign_files, g_ptr_array_index (batch_files, n));
+            }
+          g_free (target_path);
+
+          g_free (g_ptr_array_index (batch_paths, n));
+          g_free (g_ptr_array_index (batch_names, n));
+        }
+
+      g_ptr_array_set_size (batch_files, 0);
+      g_ptr_array_set_size (batch_paths, 0);
+      g_ptr_array_set_size (batch_names, 0);
+      g_array_set_size (batch_fds, 0);
+
+      /* report the progress of the batch */
+      exo_job_percent (EXO_JOB (job), (n_done * 100.0) / n_total);
+    }
+
+  g_ptr_array_free (batch_files, TRUE);
+  g_ptr_array_free (batch_paths, TRUE);
+  g_ptr_array_free (batch_names, TRUE);
+  g_array_free (batch_fds, TRUE);
+  g_free (deletion_date);
+
+  _tij_trash_close (&trash);
+
+  return g_list_reverse (foreign_files);
+}
+
+
+
 static gboolean
 _thunar_io_jobs_trash (ThunarJob  *job,
                        GArray     *param_values,
@@ -798,6 +1625,7 @@ _thunar_io_jobs_trash (ThunarJob  *job,
   ThunarApplication    *application;
   GError               *err = NULL;
   GList                *file_list;
+  GList                *foreign_files;
   GList                *lp;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
@@ -810,12 +1638,20 @@ _thunar_io_jobs_trash (ThunarJob  *job,
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
     return FALSE;
 
+  /* wait for the other jobs on the same devices */
+  if (!thunar_job_schedule (job, file_list, error))
+    return FALSE;
+
   /* take a reference on the thumbnail cache */
   application = thunar_application_get ();
   thumbnail_cache = thunar_application_get_thumbnail_cache (application);
   g_object_unref (application);
 
-  for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
+  /* move the local files to the home trash in batches */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_PROCESSING);
+  foreign_files = _tij_trash_native (job, file_list, thumbnail_cache);
+
+  for (lp = foreign_files; err == NULL && lp != NULL; lp = lp->next)
     {
       _thunar_assert (G_IS_FILE (lp->data));
 
@@ -826,9 +1662,15 @@ _thunar_io_jobs_trash (ThunarJob  *job,
       thunar_thumbnail_cache_cleanup_file (thumbnail_cache, lp->data);
     }
 
+  thunar_g_file_list_free (foreign_files);
+
   /* release the thumbnail cache */
   g_object_unref (thumbnail_cache);
 
+  /* the native trash stops between two batches on cancellation */
+  if (err == NULL)
+    exo_job_set_error_if_cancelled (EXO_JOB (job), &err);
+
   if (err != NULL)
     {
       g_propagate_error (error, err);
@@ -871,6 +1713,456 @@ thunar_io_jobs_restore_files (GList *source_file_list,
 
 
 
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_FCHMODAT) && defined (HAVE_FCHOWNAT)
+/* maximum number of folders changed at the same time */
+#define TIJ_ATTRS_MAX_WORKERS (4)
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _tij_attrs_lock(context)      g_mutex_lock (&((context)->ask_lock))
+#define _tij_attrs_unlock(context)    g_mutex_unlock (&((context)->ask_lock))
+#define _tij_attrs_wait(context)      g_cond_wait (&((context)->task_cond), &((context)->ask_lock))
+#define _tij_attrs_broadcast(context) g_cond_broadcast (&((context)->task_cond))
+#else
+#define _tij_attrs_lock(context)      g_mutex_lock ((context)->ask_lock)
+#define _tij_attrs_unlock(context)    g_mutex_unlock ((context)->ask_lock)
+#define _tij_attrs_wait(context)      g_cond_wait ((context)->task_cond, (context)->ask_lock)
+#define _tij_attrs_broadcast(context) g_cond_broadcast ((context)->task_cond)
+#endif
+
+typedef struct
+{
+  ThunarJob     *job;
+  gboolean       recursive;
+
+  /* the new owner and group, or -1 to keep them */
+  gint           uid;
+  gint           gid;
+
+  /* the permission changes, if chmod is set */
+  gboolean       chmod;
+  ThunarFileMode dir_mask;
+  ThunarFileMode dir_mode;
+  ThunarFileMode file_mask;
+  ThunarFileMode file_mode;
+
+  /* the pool that changes folders at any depth, a folder is
+   * only handed to it while one of its workers is free */
+  GThreadPool   *workers;
+  guint          n_busy;
+
+  /* the workers ask their questions, report their progress
+   * and wait for the folders they handed out one at a time */
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex         ask_lock;
+  GCond          task_cond;
+#else
+  GMutex        *ask_lock;
+  GCond         *task_cond;
+#endif
+
+  /* number of entries to change and changed so far */
+  guint          n_total;
+  guint          n_done;
+  gint           percent;
+} TijAttrsContext;
+
+typedef struct
+{
+  gint   parent_fd;
+  gchar *name;
+  gchar *path;
+
+  /* the number of tasks the parent folder waits for */
+  guint *n_pending;
+} TijAttrsTask;
+
+
+
+static gboolean
+_tij_attrs_ask_retry (TijAttrsContext *context,
+                      const gchar     *path,
+                      gint             errsv)
+{
+  ThunarJobResponse response;
+  const gchar      *message;
+  gchar            *display_name;
+
+  if (exo_job_is_cancelled (EXO_JOB (context->job)))
+    return FALSE;
+
+  /* generate a useful error message */
+  if (context->chmod)
+    message = _("Failed to change the permissions of \"%s\": %s");
+  else if (context->uid >= 0)
+    message = _("Failed to change the owner of \"%s\": %s");
+  else
+    message = _("Failed to change the group of \"%s\": %s");
+
+  display_name = g_filename_display_basename (path);
+
+  /* ask the user whether to skip/retry this file */
+  _tij_attrs_lock (context);
+  response = thunar_job_ask_skip (context->job, message,
+                                  display_name, g_strerror (errsv));
+  _tij_attrs_unlock (context);
+
+  g_free (display_name);
+
+  return (response == THUNAR_JOB_RESPONSE_RETRY);
+}
+
+
+
+static void
+_tij_attrs_done (TijAttrsContext *context)
+{
+  gint percent;
+
+  _tij_attrs_lock (context);
+
+  context->n_done++;
+
+  /* only emit when the visible percentage changes */
+  percent = (context->n_done * 100.0) / MAX (context->n_total, context->n_done);
+  if (percent != context->percent)
+    {
+      context->percent = percent;
+      exo_job_percent (EXO_JOB (context->job), percent);
+    }
+
+  _tij_attrs_unlock (context);
+
+  /* every entry counts in the statistics, not just the top-level files */
+  thunar_job_files_done (context->job, 1, 0);
+
+  /* the job thread and the workers all stop at their next
+   * entry while the job is paused */
+  thunar_job_check_paused (context->job);
+}
+
+
+
+static mode_t
+_tij_attrs_new_mode (TijAttrsContext   *context,
+                     const struct stat *statb)
+{
+  if (S_ISDIR (statb->st_mode))
+    return ((statb->st_mode & ~context->dir_mask) | context->dir_mode) & 07777;
+  else
+    return ((statb->st_mode & ~context->file_mask) | context->file_mode) & 07777;
+}
+
+
+
+/* applies the change to @name in the folder @parent_fd, unless
+ * @statb shows that it already has the new mode or owner */
+static void
+_tij_attrs_change (TijAttrsContext   *context,
+                   gint               parent_fd,
+                   const gchar       *name,
+                   const gchar       *path,
+                   const struct stat *statb)
+{
+  mode_t new_mode = 0;
+  gint   result;
+  gint   errsv;
+
+  if (context->chmod)
+    {
+      /* symlinks have no permissions of their own */
+      if (S_ISLNK (statb->st_mode))
+        return;
+
+      new_mode = _tij_attrs_new_mode (context, statb);
+      if (new_mode == (statb->st_mode & 07777))
+        return;
+    }
+  else
+    {
+      if ((context->uid < 0 || statb->st_uid == (uid_t) context->uid)
+          && (context->gid < 0 || statb->st_gid == (gid_t) context->gid))
+        return;
+    }
+
+retry_change:
+  if (exo_job_is_cancelled (EXO_JOB (context->job)))
+    return;
+
+  if (context->chmod)
+    {
+      result = fchmodat (parent_fd, name, new_mode, 0);
+    }
+  else
+    {
+      result = fchownat (parent_fd, name,
+                         context->uid >= 0 ? (uid_t) context->uid : (uid_t) -1,
+                         context->gid >= 0 ? (gid_t) context->gid : (gid_t) -1,
+                         AT_SYMLINK_NOFOLLOW);
+    }
+
+  if (result < 0)
+    {
+      errsv = errno;
+      if (errsv != ENOENT && _tij_attrs_ask_retry (context, path, errsv))
+        goto retry_change;
+    }
+}
+
+
+
+static void _tij_attrs_worker (gpointer data,
+                               gpointer user_data);
+
+
+
+/* hands a subfolder to the workers if one of them is free, each
+ * queued task has a worker of its own, so waiting for the tasks
+ * cannot block the pool */
+static gboolean
+_tij_attrs_reserve (TijAttrsContext *context,
+                    guint           *n_pending)
+{
+  gboolean reserved = FALSE;
+
+  _tij_attrs_lock (context);
+
+  if (context->n_busy < TIJ_ATTRS_MAX_WORKERS)
+    {
+      context->n_busy++;
+      (*n_pending)++;
+      reserved = TRUE;
+    }
+
+  _tij_attrs_unlock (context);
+
+  return reserved;
+}
+
+
+
+/* changes @name in the folder @parent_fd and, for a recursive job,
+ * everything below it. the folders below it are handed to the
+ * workers while they are idle */
+static void
+_tij_attrs_at (TijAttrsContext *context,
+               gint             parent_fd,
+               const gchar     *name,
+               const gchar     *path)
+{
+  TijAttrsTask  *task;
+  struct dirent *dp;
+  struct stat    statb;
+  gboolean       contents_first;
+  gchar         *child_path;
+  guint          n_pending = 0;
+  DIR           *dir;
+  gint           errsv;
+  gint           fd;
+
+retry_stat:
+  if (exo_job_is_cancelled (EXO_JOB (context->job)))
+    return;
+
+  /* the mode and owner read here decide whether anything changes */
+  if (fstatat (parent_fd, name, &statb, AT_SYMLINK_NOFOLLOW) < 0)
+    {
+      errsv = errno;
+      if (errsv != ENOENT && _tij_attrs_ask_retry (context, path, errsv))
+        goto retry_stat;
+      _tij_attrs_done (context);
+      return;
+    }
+
+  if (!context->recursive || !S_ISDIR (statb.st_mode))
+    {
+      _tij_attrs_change (context, parent_fd, name, path, &statb);
+      _tij_attrs_done (context);
+      return;
+    }
+
+  /* a folder that loses permissions is changed after its contents, so
+   * it can still be read, otherwise before, so it can be read at all */
+  contents_first = context->chmod
+                   && (statb.st_mode & 07777 & ~_tij_attrs_new_mode (context, &statb)) != 0;
+  if (!contents_first)
+    _tij_attrs_change (context, parent_fd, name, path, &statb);
+
+retry_open:
+  /* open the folder relative to its parent, so its children
+   * don't need a full path lookup */
+  fd = openat (parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+  dir = (fd >= 0) ? fdopendir (fd) : NULL;
+  if (G_UNLIKELY (dir == NULL))
+    {
+      errsv = errno;
+      if (fd >= 0)
+        close (fd);
+
+      if (errsv != ENOENT && errsv != ENOTDIR && errsv != ELOOP
+          && _tij_attrs_ask_retry (context, path, errsv))
+        goto retry_open;
+    }
+  else
+    {
+      while (!exo_job_is_cancelled (EXO_JOB (context->job)))
+        {
+          dp = readdir (dir);
+          if (dp == NULL)
+            break;
+
+          /* skip the special entries */
+          if (strcmp (dp->d_name, ".") == 0 || strcmp (dp->d_name, "..") == 0)
+            continue;
+
+          child_path = g_build_filename (path, dp->d_name, NULL);
+
+          if (_tij_dirent_is_directory (fd, dp)
+              && _tij_attrs_reserve (context, &n_pending))
+            {
+              /* the subtrees are independent, change them in parallel */
+              task = g_slice_new (TijAttrsTask);
+              task->parent_fd = fd;
+              task->name = g_strdup (dp->d_name);
+              task->path = child_path;
+              task->n_pending = &n_pending;
+              g_thread_pool_push (context->workers, task, NULL);
+            }
+          else
+            {
+              _tij_attrs_at (context, fd, dp->d_name, child_path);
+              g_free (child_path);
+            }
+        }
+
+      /* wait for the subfolders before the folder is closed */
+      _tij_attrs_lock (context);
+      while (n_pending > 0)
+        _tij_attrs_wait (context);
+      _tij_attrs_unlock (context);
+
+      closedir (dir);
+    }
+
+  if (contents_first)
+    _tij_attrs_change (context, parent_fd, name, path, &statb);
+
+  _tij_attrs_done (context);
+}
+
+
+
+static void
+_tij_attrs_worker (gpointer data,
+                   gpointer user_data)
+{
+  TijAttrsTask    *task = data;
+  TijAttrsContext *context = user_data;
+
+  if (!exo_job_is_cancelled (EXO_JOB (context->job)))
+    _tij_attrs_at (context, task->parent_fd, task->name, task->path);
+
+  /* free the worker and wake up the parent folder */
+  _tij_attrs_lock (context);
+  context->n_busy--;
+  (*task->n_pending)--;
+  _tij_attrs_broadcast (context);
+  _tij_attrs_unlock (context);
+
+  g_free (task->name);
+  g_free (task->path);
+  g_slice_free (TijAttrsTask, task);
+}
+
+
+
+/* changes the mode or owner of the local files in @file_list relative to
+ * open folders, instead of resolving and querying every file through gio.
+ * the trees are counted first to report the progress per changed entry.
+ * returns the files that must be changed with GIO */
+static GList *
+_tij_attrs_native (TijAttrsContext *context,
+                   GList           *file_list)
+{
+  struct stat statb;
+  GList      *foreign_files = NULL;
+  GList      *local_files = NULL;
+  GList      *lp;
+  gchar      *path;
+  gchar      *display_name;
+
+  context->n_busy = 0;
+  context->n_total = 0;
+  context->n_done = 0;
+  context->percent = -1;
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&context->ask_lock);
+  g_cond_init (&context->task_cond);
+#else
+  context->ask_lock = g_mutex_new ();
+  context->task_cond = g_cond_new ();
+#endif
+
+  /* the threads are only started when there are folders to change */
+  context->workers = g_thread_pool_new (_tij_attrs_worker, context,
+                                        TIJ_ATTRS_MAX_WORKERS, FALSE, NULL);
+
+  /* count the entries of the local files for the progress */
+  thunar_job_set_phase (context->job, THUNAR_JOB_PHASE_COLLECTING);
+  for (lp = file_list; lp != NULL && !exo_job_is_cancelled (EXO_JOB (context->job)); lp = lp->next)
+    {
+      path = g_file_get_path (lp->data);
+      if (path == NULL || !g_path_is_absolute (path) || lstat (path, &statb) < 0)
+        {
+          /* let gio handle the remote files and report the errors */
+          foreign_files = thunar_g_file_list_prepend (foreign_files, lp->data);
+          g_free (path);
+          continue;
+        }
+
+      if (context->recursive)
+        context->n_total += _tij_count_at (context->job, AT_FDCWD, path, S_ISDIR (statb.st_mode));
+      else
+        context->n_total += 1;
+
+      local_files = thunar_g_file_list_prepend (local_files, lp->data);
+      g_free (path);
+    }
+
+  /* change the files in the order they were passed */
+  local_files = g_list_reverse (local_files);
+
+  thunar_job_set_phase (context->job, THUNAR_JOB_PHASE_PROCESSING);
+  for (lp = local_files; lp != NULL && !exo_job_is_cancelled (EXO_JOB (context->job)); lp = lp->next)
+    {
+      path = g_file_get_path (lp->data);
+
+      display_name = g_filename_display_basename (path);
+      exo_job_info_message (EXO_JOB (context->job), "%s", display_name);
+      g_free (display_name);
+
+      _tij_attrs_at (context, AT_FDCWD, path, path);
+
+      g_free (path);
+    }
+
+  thunar_g_file_list_free (local_files);
+
+  g_thread_pool_free (context->workers, FALSE, TRUE);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&context->ask_lock);
+  g_cond_clear (&context->task_cond);
+#else
+  g_mutex_free (context->ask_lock);
+  g_cond_free (context->task_cond);
+#endif
+
+  return g_list_reverse (foreign_files);
+}
+#endif
+
+
+
 static gboolean
 _thunar_io_jobs_chown (ThunarJob  *job,
                        GArray     *param_values,
@@ -882,6 +2174,10 @@ _thunar_io_jobs_chown (ThunarJob  *job,
   gboolean          recursive;
   GError           *err = NULL;
   GList            *file_list;
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_FCHMODAT) && defined (HAVE_FCHOWNAT)
+  TijAttrsContext   context;
+  GList            *foreign_files;
+#endif
   GList            *lp;
   gint              uid;
   gint              gid;
@@ -898,11 +2194,37 @@ _thunar_io_jobs_chown (ThunarJob  *job,
 
   _thunar_assert ((uid >= 0 || gid >= 0) && !(uid >= 0 && gid >= 0));
 
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_FCHMODAT) && defined (HAVE_FCHOWNAT)
+  /* change the local files directly, only the remaining files are
+   * collected and changed through gio */
+  context.job = job;
+  context.recursive = recursive;
+  context.uid = uid;
+  context.gid = gid;
+  context.chmod = FALSE;
+  foreign_files = _tij_attrs_native (&context, file_list);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    {
+      thunar_g_file_list_free (foreign_files);
+      return FALSE;
+    }
+
+  /* collect the files for the chown operation */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_COLLECTING);
+  if (recursive)
+    file_list = _tij_collect_nofollow (job, foreign_files, FALSE, &err);
+  else
+    file_list = thunar_g_file_list_copy (foreign_files);
+
+  thunar_g_file_list_free (foreign_files);
+#else
   /* collect the files for the chown operation */
   if (recursive)
     file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
   else
     file_list = thunar_g_file_list_copy (file_list);
+#endif
 
   if (err != NULL)
     {
@@ -911,7 +2233,8 @@ _thunar_io_jobs_chown (ThunarJob  *job,
     }
 
   /* we know the total list of files to process */
-  thunar_job_set_total_files (THUNAR_JOB (job), file_list);
+  if (file_list != NULL)
+    thunar_job_set_total_files (THUNAR_JOB (job), file_list);
 
   /* change the ownership of all files */
   for (lp = file_list; lp != NULL && err == NULL; lp = lp->next)
@@ -1018,6 +2341,10 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
   gboolean          recursive;
   GError           *err = NULL;
   GList            *file_list;
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_FCHMODAT) && defined (HAVE_FCHOWNAT)
+  TijAttrsContext   context;
+  GList            *foreign_files;
+#endif
   GList            *lp;
   ThunarFileMode    dir_mask;
   ThunarFileMode    dir_mode;
@@ -1040,11 +2367,41 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
   file_mode = g_value_get_flags (&g_array_index (param_values, GValue, 4));
   recursive = g_value_get_boolean (&g_array_index (param_values, GValue, 5));
 
+#if defined (HAVE_FDOPENDIR) && defined (HAVE_FCHMODAT) && defined (HAVE_FCHOWNAT)
+  /* change the local files directly, only the remaining files are
+   * collected and changed through gio */
+  context.job = job;
+  context.recursive = recursive;
+  context.uid = -1;
+  context.gid = -1;
+  context.chmod = TRUE;
+  context.dir_mask = dir_mask;
+  context.dir_mode = dir_mode;
+  context.file_mask = file_mask;
+  context.file_mode = file_mode;
+  foreign_files = _tij_attrs_native (&context, file_list);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    {
+      thunar_g_file_list_free (foreign_files);
+      return FALSE;
+    }
+
+  /* collect the files for the chown operation */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_COLLECTING);
+  if (recursive)
+    file_list = _tij_collect_nofollow (job, foreign_files, FALSE, &err);
+  else
+    file_list = thunar_g_file_list_copy (foreign_files);
+
+  thunar_g_file_list_free (foreign_files);
+#else
   /* collect the files for the chown operation */
   if (recursive)
     file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
   else
     file_list = thunar_g_file_list_copy (file_list);
+#endif
 
   if (err != NULL)
     {
@@ -1053,7 +2410,8 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
     }
 
   /* we know the total list of files to process */
-  thunar_job_set_total_files (THUNAR_JOB (job), file_list);
+  if (file_list != NULL)
+    thunar_job_set_total_files (THUNAR_JOB (job), file_list);
 
   /* change the ownership of all files */
   for (lp = file_list; lp != NULL && err == NULL; lp = lp->next)
@@ -1170,13 +2528,14 @@ _thunar_io_jobs_ls (ThunarJob  *job,
                     GArray     *param_values,
                     GError    **error)
 {
-  GError *err = NULL;
-  GFile  *directory;
-  GList  *file_list = NULL;
+  gboolean directories_only;
+  GError  *err = NULL;
+  GFile   *directory;
+  GList   *file_list = NULL;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
-  _thunar_return_val_if_fail (param_values->len == 1, FALSE);
+  _thunar_return_val_if_fail (param_values->len == 2, FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
@@ -1184,14 +2543,22 @@ _thunar_io_jobs_ls (ThunarJob  *job,
 
   /* determine the directory to list */
   directory = g_value_get_object (&g_array_index (param_values, GValue, 0));
+  directories_only = g_value_get_boolean (&g_array_index (param_values, GValue, 1));
 
   /* make sure the object is valid */
   _thunar_assert (G_IS_FILE (directory));
 
   /* collect directory contents (non-recursively) */
-  file_list = thunar_io_scan_directory (job, directory,
-                                        G_FILE_QUERY_INFO_NONE, 
-                                        FALSE, FALSE, TRUE, &err);
+  if (directories_only)
+    {
+      file_list = thunar_io_scan_subdirectories (job, directory, &err);
+    }
+  else
+    {
+      file_list = thunar_io_scan_directory (job, directory,
+                                            G_FILE_QUERY_INFO_NONE,
+                                            FALSE, FALSE, TRUE, &err);
+    }
 
   /* abort on errors or cancellation */
   if (err != NULL)
@@ -1237,7 +2604,21 @@ thunar_io_jobs_list_directory (GFile *directory)
 {
   _thunar_return_val_if_fail (G_IS_FILE (directory), NULL);
   
-  return thunar_simple_job_launch (_thunar_io_jobs_ls, 1, G_TYPE_FILE, directory);
+  return thunar_simple_job_launch (_thunar_io_jobs_ls, 2,
+                                   G_TYPE_FILE, directory,
+                                   G_TYPE_BOOLEAN, FALSE);
+}
+
+
+
+ThunarJob *
+thunar_io_jobs_list_directories (GFile *directory)
+{
+  _thunar_return_val_if_fail (G_IS_FILE (directory), NULL);
+
+  return thunar_simple_job_launch (_thunar_io_jobs_ls, 2,
+                                   G_TYPE_FILE, directory,
+                                   G_TYPE_BOOLEAN, TRUE);
 }
 
 
@@ -22,6 +22,19 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include <gio/gio.h>
 
 #include <exo/exo.h>
@@ -180,3 +193,193 @@ thunar_io_scan_directory (ThunarJob          *job,
   
   return files;
 }
+
+
+
+#ifdef HAVE_DIRENT_H
+static gboolean
+thunar_io_scan_subdirectories_native (ThunarJob   *job,
+                                      GFile       *file,
+                                      const gchar *path,
+                                      GList      **files_return,
+                                      GError     **error)
+{
+  struct dirent *d;
+  ThunarFile    *thunar_file;
+  GFile         *child_file;
+  GList         *files = NULL;
+  DIR           *dp;
+  gint           errsv;
+
+  /* let gio report the error */
+  dp = opendir (path);
+  if (G_UNLIKELY (dp == NULL))
+    return FALSE;
+
+  while (!exo_job_is_cancelled (EXO_JOB (job)))
+    {
+      /* readdir() only tells errors and the end of the folder apart by errno */
+      errno = 0;
+      d = readdir (dp);
+      if (G_UNLIKELY (d == NULL))
+        {
+          errsv = errno;
+          if (G_UNLIKELY (errsv != 0))
+            {
+              g_set_error_literal (error, G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+              thunar_g_file_list_free (files);
+              files = NULL;
+            }
+          break;
+        }
+
+      /* skip the special entries */
+      if (d->d_name[0] == '.' && (d->d_name[1] == '\0' || (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+        continue;
+
+#ifdef DT_DIR
+      /* only directories, links (which may point to a directory) and entries
+       * of unknown type need to be looked at, everything else is skipped
+       * without querying any information */
+      if (d->d_type != DT_DIR && d->d_type != DT_LNK && d->d_type != DT_UNKNOWN)
+        continue;
+#endif
+
+      /* load the file and check if it is really a directory */
+      child_file = g_file_get_child (file, d->d_name);
+      thunar_file = thunar_file_get (child_file, NULL);
+      if (G_LIKELY (thunar_file != NULL))
+        {
+          if (thunar_file_is_directory (thunar_file))
+            files = thunar_g_file_list_prepend (files, thunar_file);
+          g_object_unref (G_OBJECT (thunar_file));
+        }
+      g_object_unref (child_file);
+    }
+
+  closedir (dp);
+
+  *files_return = files;
+
+  return TRUE;
+}
+#endif
+
+
+
+/**
+ * thunar_io_scan_subdirectories:
+ * @job   : a #ThunarJob.
+ * @file  : the directory to scan.
+ * @error : return location for errors or %NULL.
+ *
+ * Like thunar_io_scan_directory() with @return_thunar_files set,
+ * but only returns the #ThunarFile<!---->s for the directories
+ * in @file. On local file systems, other files are skipped based
+ * on the type reported by readdir(), without allocating anything
+ * for them.
+ *
+ * Return value: the list of #ThunarFile<!---->s for the directories
+ *               in @file. Release with thunar_g_file_list_free().
+ **/
+GList *
+thunar_io_scan_subdirectories (ThunarJob *job,
+                               GFile     *file,
+                               GError   **error)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo       *info;
+  GFileType        type;
+  GError          *err = NULL;
+  GFile           *child_file;
+  GList           *files = NULL;
+  ThunarFile      *thunar_file;
+#ifdef HAVE_DIRENT_H
+  gchar           *path;
+#endif
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  /* abort if the job was cancelled */
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return NULL;
+
+#ifdef HAVE_DIRENT_H
+  /* read local directories directly, falling back to gio for errors */
+  path = g_file_is_native (file) ? g_file_get_path (file) : NULL;
+  if (G_LIKELY (path != NULL))
+    {
+      if (thunar_io_scan_subdirectories_native (job, file, path, &files, &err))
+        {
+          g_free (path);
+
+          if (G_UNLIKELY (err != NULL))
+            {
+              g_propagate_error (error, err);
+              return NULL;
+            }
+          else if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+            {
+              thunar_g_file_list_free (files);
+              return NULL;
+            }
+
+          return files;
+        }
+      g_free (path);
+    }
+#endif
+
+  /* try to read from the directory */
+  enumerator = g_file_enumerate_children (file, THUNARX_FILE_INFO_NAMESPACE,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          exo_job_get_cancellable (EXO_JOB (job)),
+                                          &err);
+  if (err != NULL)
+    {
+      g_propagate_error (error, err);
+      return NULL;
+    }
+
+  /* iterate over children one by one */
+  while (!exo_job_is_cancelled (EXO_JOB (job)))
+    {
+      info = g_file_enumerator_next_file (enumerator, exo_job_get_cancellable (EXO_JOB (job)), &err);
+      if (G_UNLIKELY (info == NULL))
+        break;
+
+      /* only allocate files for the directories */
+      type = g_file_info_get_file_type (info);
+      if (type == G_FILE_TYPE_DIRECTORY || type == G_FILE_TYPE_MOUNTABLE)
+        {
+          child_file = g_file_get_child (file, g_file_info_get_name (info));
+          thunar_file = thunar_file_get_with_info (child_file, info, FALSE);
+          if (thunar_file_is_directory (thunar_file))
+            files = thunar_g_file_list_prepend (files, thunar_file);
+          g_object_unref (G_OBJECT (thunar_file));
+          g_object_unref (child_file);
+        }
+
+      g_object_unref (info);
+    }
+
+  /* release the enumerator */
+  g_object_unref (enumerator);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      thunar_g_file_list_free (files);
+      return NULL;
+    }
+  else if (exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
+    {
+      g_propagate_error (error, err);
+      thunar_g_file_list_free (files);
+      return NULL;
+    }
+
+  return files;
+}
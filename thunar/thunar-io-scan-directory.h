@@ -36,6 +36,10 @@ GList *thunar_io_scan_directory (ThunarJob          *job,
                                  gboolean            return_thunar_files,
                                  GError            **error);
 
+GList *thunar_io_scan_subdirectories (ThunarJob *job,
+                                      GFile     *file,
+                                      GError   **error);
+
 G_END_DECLS
 
 #endif /* !__THUNAR_IO_SCAN_DIRECTORY_H__ */
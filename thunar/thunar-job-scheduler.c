@@ -0,0 +1,604 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <thunar/thunar-job-scheduler.h>
+#include <thunar/thunar-preferences.h>
+#include <thunar/thunar-private.h>
+
+
+
+/**
+ * ThunarJobScheduler decides when the jobs that read or write a lot
+ * of data may start. Each job names the files it works on, the
+ * scheduler looks up the filesystems behind them and lets only
+ * ThunarPreferences:misc-jobs-per-device jobs run on the same
+ * filesystem at a time, in the order they were started. Jobs on
+ * unrelated filesystems still run in parallel.
+ *
+ * The jobs wait in their own threads, so the waiting and releasing
+ * functions may be called from any thread. A paused job gives up
+ * its place until it is resumed, so the queued jobs can go ahead.
+ **/
+
+
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _job_scheduler_lock(scheduler)   g_mutex_lock (&((scheduler)->lock))
+#define _job_scheduler_unlock(scheduler) g_mutex_unlock (&((scheduler)->lock))
+#define _job_scheduler_wait(scheduler)   g_cond_wait (&((scheduler)->cond), &((scheduler)->lock))
+#define _job_scheduler_signal(scheduler) g_cond_broadcast (&((scheduler)->cond))
+#else
+#define _job_scheduler_lock(scheduler)   g_mutex_lock ((scheduler)->lock)
+#define _job_scheduler_unlock(scheduler) g_mutex_unlock ((scheduler)->lock)
+#define _job_scheduler_wait(scheduler)   g_cond_wait ((scheduler)->cond, (scheduler)->lock)
+#define _job_scheduler_signal(scheduler) g_cond_broadcast ((scheduler)->cond)
+#endif
+
+
+
+typedef struct _ThunarJobSchedulerEntry ThunarJobSchedulerEntry;
+
+
+
+static void thunar_job_scheduler_finalize        (GObject            *object);
+static void thunar_job_scheduler_limit_changed   (ThunarJobScheduler *scheduler);
+
+
+
+struct _ThunarJobSchedulerClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarJobScheduler
+{
+  GObject            __parent__;
+
+  ThunarPreferences *preferences;
+
+  /* number of jobs that may run on a filesystem, 0 for no limit */
+  guint              jobs_per_device;
+
+  /* the ThunarJobSchedulerEntry of each job, the earlier entries
+   * start first */
+  GList             *entries;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex             lock;
+  GCond              cond;
+#else
+  GMutex            *lock;
+  GCond             *cond;
+#endif
+};
+
+struct _ThunarJobSchedulerEntry
+{
+  ThunarJob *job;
+
+  /* the filesystem ids of the files of the job */
+  gchar    **devices;
+
+  /* whether the job holds its place on the devices */
+  gboolean   running;
+};
+
+
+
+G_DEFINE_TYPE (ThunarJobScheduler, thunar_job_scheduler, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_job_scheduler_class_init (ThunarJobSchedulerClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_job_scheduler_finalize;
+}
+
+
+
+static void
+thunar_job_scheduler_init (ThunarJobScheduler *scheduler)
+{
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&scheduler->lock);
+  g_cond_init (&scheduler->cond);
+#else
+  scheduler->lock = g_mutex_new ();
+  scheduler->cond = g_cond_new ();
+#endif
+
+  /* follow the limit of the preferences */
+  scheduler->preferences = thunar_preferences_get ();
+  g_signal_connect_swapped (G_OBJECT (scheduler->preferences), "notify::misc-jobs-per-device",
+                            G_CALLBACK (thunar_job_scheduler_limit_changed), scheduler);
+  thunar_job_scheduler_limit_changed (scheduler);
+}
+
+
+
+static void
+thunar_job_scheduler_finalize (GObject *object)
+{
+  ThunarJobScheduler *scheduler = THUNAR_JOB_SCHEDULER (object);
+
+  /* the jobs keep a reference while they are scheduled */
+  _thunar_assert (scheduler->entries == NULL);
+
+  g_signal_handlers_disconnect_by_func (G_OBJECT (scheduler->preferences),
+                                        thunar_job_scheduler_limit_changed, scheduler);
+  g_object_unref (G_OBJECT (scheduler->preferences));
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&scheduler->lock);
+  g_cond_clear (&scheduler->cond);
+#else
+  g_mutex_free (scheduler->lock);
+  g_cond_free (scheduler->cond);
+#endif
+
+  (*G_OBJECT_CLASS (thunar_job_scheduler_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_job_scheduler_limit_changed (ThunarJobScheduler *scheduler)
+{
+  guint jobs_per_device;
+
+  g_object_get (G_OBJECT (scheduler->preferences), "misc-jobs-per-device", &jobs_per_device, NULL);
+
+  /* let the waiting jobs check the new limit */
+  _job_scheduler_lock (scheduler);
+  scheduler->jobs_per_device = jobs_per_device;
+  _job_scheduler_signal (scheduler);
+  _job_scheduler_unlock (scheduler);
+}
+
+
+
+static void
+thunar_job_scheduler_cancelled (GCancellable       *cancellable,
+                                ThunarJobScheduler *scheduler)
+{
+  /* wake up the job so it stops waiting */
+  thunar_job_scheduler_wakeup (scheduler);
+}
+
+
+
+/* returns the filesystem id of @file, or of the first existing parent
+ * for the target files that are not created yet */
+static gchar *
+thunar_job_scheduler_get_device (GFile        *file,
+                                 GCancellable *cancellable)
+{
+  GFileInfo *info;
+  GFile     *parent;
+  gchar     *device = NULL;
+
+  for (file = g_object_ref (file); file != NULL && device == NULL; file = parent)
+    {
+      info = g_file_query_info (file, G_FILE_ATTRIBUTE_ID_FILESYSTEM,
+                                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                cancellable, NULL);
+      if (info != NULL)
+        {
+          device = g_strdup (g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM));
+          g_object_unref (info);
+        }
+
+      parent = (device == NULL) ? g_file_get_parent (file) : NULL;
+      g_object_unref (file);
+    }
+
+  return device;
+}
+
+
+
+/* returns the filesystem ids of @files. the files of a folder are taken
+ * to be on the filesystem of the folder, so the folder is only queried
+ * once, no matter how many of its files the job works on */
+static gchar **
+thunar_job_scheduler_get_devices (GList        *files,
+                                  GCancellable *cancellable)
+{
+  GHashTable *parents;
+  GPtrArray  *devices;
+  gpointer    parent_device;
+  GFile      *parent;
+  GList      *lp;
+  gchar      *device;
+  guint       n;
+
+  devices = g_ptr_array_new ();
+  parents = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                   g_object_unref, g_free);
+
+  for (lp = files; lp != NULL && !g_cancellable_is_cancelled (cancellable); lp = lp->next)
+    {
+      parent = g_file_get_parent (lp->data);
+      if (G_UNLIKELY (parent == NULL))
+        {
+          /* the root folder has no parent to look at */
+          device = thunar_job_scheduler_get_device (lp->data, cancellable);
+        }
+      else
+        {
+          if (!g_hash_table_lookup_extended (parents, parent, NULL, &parent_device))
+            {
+              parent_device = thunar_job_scheduler_get_device (parent, cancellable);
+              g_hash_table_insert (parents, g_object_ref (parent), parent_device);
+            }
+
+          device = g_strdup (parent_device);
+          g_object_unref (parent);
+        }
+
+      if (device == NULL)
+        continue;
+
+      /* the files of a job are mostly on the same filesystem */
+      for (n = 0; n < devices->len; ++n)
+        if (strcmp (g_ptr_array_index (devices, n), device) == 0)
+          break;
+
+      if (n < devices->len)
+        g_free (device);
+      else
+        g_ptr_array_add (devices, device);
+    }
+
+  g_hash_table_destroy (parents);
+
+  g_ptr_array_add (devices, NULL);
+
+  return (gchar **) g_ptr_array_free (devices, FALSE);
+}
+
+
+
+static ThunarJobSchedulerEntry *
+thunar_job_scheduler_lookup (ThunarJobScheduler *scheduler,
+                             ThunarJob          *job)
+{
+  GList *lp;
+
+  for (lp = scheduler->entries; lp != NULL; lp = lp->next)
+    if (((ThunarJobSchedulerEntry *) lp->data)->job == job)
+      return lp->data;
+
+  return NULL;
+}
+
+
+
+static gboolean
+thunar_job_scheduler_share_device (ThunarJobSchedulerEntry *entry,
+                                   const gchar             *device)
+{
+  guint n;
+
+  for (n = 0; entry->devices[n] != NULL; ++n)
+    if (strcmp (entry->devices[n], device) == 0)
+      return TRUE;
+
+  return FALSE;
+}
+
+
+
+/* whether @entry may run now, must be called with the lock held */
+static gboolean
+thunar_job_scheduler_can_run (ThunarJobScheduler      *scheduler,
+                              ThunarJobSchedulerEntry *entry)
+{
+  ThunarJobSchedulerEntry *other;
+  gboolean                 before = TRUE;
+  GList                   *lp;
+  guint                    n_running;
+  guint                    n;
+
+  if (thunar_job_is_paused (entry->job))
+    return FALSE;
+
+  if (scheduler->jobs_per_device == 0)
+    return TRUE;
+
+  for (n = 0; entry->devices[n] != NULL; ++n)
+    {
+      n_running = 0;
+
+      for (lp = scheduler->entries; lp != NULL; lp = lp->next)
+        {
+          other = lp->data;
+          if (other == entry)
+            {
+              before = FALSE;
+              continue;
+            }
+
+          if (!thunar_job_scheduler_share_device (other, entry->devices[n]))
+            continue;
+
+          if (other->running)
+            n_running++;
+          else if (before && !thunar_job_is_paused (other->job)
+                   && !exo_job_is_cancelled (EXO_JOB (other->job)))
+            return FALSE;
+        }
+
+      before = TRUE;
+
+      if (n_running >= scheduler->jobs_per_device)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+/* waits until @entry may run or the job is cancelled */
+static void
+thunar_job_scheduler_wait (ThunarJobScheduler      *scheduler,
+                           ThunarJobSchedulerEntry *entry)
+{
+  GCancellable *cancellable;
+  gulong        handler_id;
+  gboolean      can_run;
+
+  cancellable = exo_job_get_cancellable (EXO_JOB (entry->job));
+  handler_id = g_cancellable_connect (cancellable, G_CALLBACK (thunar_job_scheduler_cancelled),
+                                      scheduler, NULL);
+
+  _job_scheduler_lock (scheduler);
+
+  can_run = thunar_job_scheduler_can_run (scheduler, entry);
+  if (!can_run && !thunar_job_is_paused (entry->job))
+    {
+      /* tell the user why nothing happens */
+      _job_scheduler_unlock (scheduler);
+      exo_job_info_message (EXO_JOB (entry->job), _("Waiting for other operations on the same device..."));
+      _job_scheduler_lock (scheduler);
+    }
+
+  while (!exo_job_is_cancelled (EXO_JOB (entry->job))
+         && !thunar_job_scheduler_can_run (scheduler, entry))
+    _job_scheduler_wait (scheduler);
+
+  entry->running = !exo_job_is_cancelled (EXO_JOB (entry->job));
+
+  _job_scheduler_unlock (scheduler);
+
+  g_cancellable_disconnect (cancellable, handler_id);
+}
+
+
+
+/**
+ * thunar_job_scheduler_new:
+ *
+ * Allocates a new #ThunarJobScheduler, the application
+ * keeps the one that is shared by all jobs.
+ *
+ * Return value: the newly allocated #ThunarJobScheduler.
+ **/
+ThunarJobScheduler*
+thunar_job_scheduler_new (void)
+{
+  return g_object_new (THUNAR_TYPE_JOB_SCHEDULER, NULL);
+}
+
+
+
+/**
+ * thunar_job_scheduler_acquire:
+ * @scheduler : a #ThunarJobScheduler.
+ * @job       : the #ThunarJob that wants to start.
+ * @files     : the #GFile<!---->s @job reads and writes.
+ * @error     : return location for errors or %NULL.
+ *
+ * Blocks the thread of @job until it may run on the filesystems
+ * of @files. Every successful call must be followed by a call to
+ * thunar_job_scheduler_release() when @job is done.
+ *
+ * Return value: %FALSE if @job was cancelled while waiting.
+ **/
+gboolean
+thunar_job_scheduler_acquire (ThunarJobScheduler *scheduler,
+                              ThunarJob          *job,
+                              GList              *files,
+                              GError            **error)
+{
+  ThunarJobSchedulerEntry *entry;
+  gboolean                 limited;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB_SCHEDULER (scheduler), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  _job_scheduler_lock (scheduler);
+  limited = (scheduler->jobs_per_device > 0);
+  _job_scheduler_unlock (scheduler);
+
+  entry = g_slice_new (ThunarJobSchedulerEntry);
+  entry->job = job;
+  entry->running = FALSE;
+
+  /* without a limit, which is the default, the devices are not
+   * needed and the job does not have to query its files */
+  if (limited)
+    entry->devices = thunar_job_scheduler_get_devices (files, exo_job_get_cancellable (EXO_JOB (job)));
+  else
+    entry->devices = g_new0 (gchar *, 1);
+
+  /* queue the job after the jobs started before */
+  _job_scheduler_lock (scheduler);
+  scheduler->entries = g_list_append (scheduler->entries, entry);
+  _job_scheduler_unlock (scheduler);
+
+  thunar_job_scheduler_wait (scheduler, entry);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    {
+      thunar_job_scheduler_release (scheduler, job);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_job_scheduler_release:
+ * @scheduler : a #ThunarJobScheduler.
+ * @job       : a #ThunarJob.
+ *
+ * Removes @job from @scheduler, so the next jobs on its
+ * filesystems can start.
+ **/
+void
+thunar_job_scheduler_release (ThunarJobScheduler *scheduler,
+                              ThunarJob          *job)
+{
+  ThunarJobSchedulerEntry *entry;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB_SCHEDULER (scheduler));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  _job_scheduler_lock (scheduler);
+
+  entry = thunar_job_scheduler_lookup (scheduler, job);
+  if (G_LIKELY (entry != NULL))
+    {
+      scheduler->entries = g_list_remove (scheduler->entries, entry);
+      _job_scheduler_signal (scheduler);
+    }
+
+  _job_scheduler_unlock (scheduler);
+
+  if (G_LIKELY (entry != NULL))
+    {
+      g_strfreev (entry->devices);
+      g_slice_free (ThunarJobSchedulerEntry, entry);
+    }
+}
+
+
+
+/**
+ * thunar_job_scheduler_yield:
+ * @scheduler : a #ThunarJobScheduler.
+ * @job       : a running #ThunarJob.
+ *
+ * Called by @job while it is paused. @job gives up its place on its
+ * filesystems and waits until it is resumed and may run again, or
+ * until it is cancelled.
+ **/
+void
+thunar_job_scheduler_yield (ThunarJobScheduler *scheduler,
+                            ThunarJob          *job)
+{
+  ThunarJobSchedulerEntry *entry;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB_SCHEDULER (scheduler));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  _job_scheduler_lock (scheduler);
+
+  entry = thunar_job_scheduler_lookup (scheduler, job);
+  if (G_LIKELY (entry != NULL))
+    {
+      /* let the queued jobs go ahead */
+      entry->running = FALSE;
+      _job_scheduler_signal (scheduler);
+    }
+
+  _job_scheduler_unlock (scheduler);
+
+  if (G_LIKELY (entry != NULL))
+    thunar_job_scheduler_wait (scheduler, entry);
+}
+
+
+
+/**
+ * thunar_job_scheduler_raise:
+ * @scheduler : a #ThunarJobScheduler.
+ * @job       : a #ThunarJob.
+ *
+ * Moves @job in front of all other jobs, so it starts as soon
+ * as a place on its filesystems is free.
+ **/
+void
+thunar_job_scheduler_raise (ThunarJobScheduler *scheduler,
+                            ThunarJob          *job)
+{
+  ThunarJobSchedulerEntry *entry;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB_SCHEDULER (scheduler));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  _job_scheduler_lock (scheduler);
+
+  entry = thunar_job_scheduler_lookup (scheduler, job);
+  if (G_LIKELY (entry != NULL))
+    {
+      scheduler->entries = g_list_remove (scheduler->entries, entry);
+      scheduler->entries = g_list_prepend (scheduler->entries, entry);
+      _job_scheduler_signal (scheduler);
+    }
+
+  _job_scheduler_unlock (scheduler);
+}
+
+
+
+/**
+ * thunar_job_scheduler_wakeup:
+ * @scheduler : a #ThunarJobScheduler.
+ *
+ * Lets the waiting jobs check again whether they may run, after
+ * a job was paused or resumed.
+ **/
+void
+thunar_job_scheduler_wakeup (ThunarJobScheduler *scheduler)
+{
+  _thunar_return_if_fail (THUNAR_IS_JOB_SCHEDULER (scheduler));
+
+  _job_scheduler_lock (scheduler);
+  _job_scheduler_signal (scheduler);
+  _job_scheduler_unlock (scheduler);
+}
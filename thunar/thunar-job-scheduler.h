@@ -0,0 +1,57 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_JOB_SCHEDULER_H__
+#define __THUNAR_JOB_SCHEDULER_H__
+
+#include <thunar/thunar-job.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarJobSchedulerClass ThunarJobSchedulerClass;
+typedef struct _ThunarJobScheduler      ThunarJobScheduler;
+
+#define THUNAR_TYPE_JOB_SCHEDULER            (thunar_job_scheduler_get_type ())
+#define THUNAR_JOB_SCHEDULER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_JOB_SCHEDULER, ThunarJobScheduler))
+#define THUNAR_JOB_SCHEDULER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_JOB_SCHEDULER, ThunarJobSchedulerClass))
+#define THUNAR_IS_JOB_SCHEDULER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_JOB_SCHEDULER))
+#define THUNAR_IS_JOB_SCHEDULER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_JOB_SCHEDULER))
+#define THUNAR_JOB_SCHEDULER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_JOB_SCHEDULER, ThunarJobSchedulerClass))
+
+GType               thunar_job_scheduler_get_type (void) G_GNUC_CONST;
+
+ThunarJobScheduler *thunar_job_scheduler_new      (void) G_GNUC_MALLOC;
+
+gboolean            thunar_job_scheduler_acquire  (ThunarJobScheduler *scheduler,
+                                                   ThunarJob          *job,
+                                                   GList              *files,
+                                                   GError            **error);
+void                thunar_job_scheduler_release  (ThunarJobScheduler *scheduler,
+                                                   ThunarJob          *job);
+void                thunar_job_scheduler_yield    (ThunarJobScheduler *scheduler,
+                                                   ThunarJob          *job);
+
+void                thunar_job_scheduler_raise    (ThunarJobScheduler *scheduler,
+                                                   ThunarJob          *job);
+void                thunar_job_scheduler_wakeup   (ThunarJobScheduler *scheduler);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_JOB_SCHEDULER_H__ */
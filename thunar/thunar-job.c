@@ -31,6 +31,7 @@
 
 #include <exo/exo.h>
 
+#include <thunar/thunar-application.h>
 #include <thunar/thunar-enum-types.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-marshal.h>
@@ -40,6 +41,22 @@
 
 #define THUNAR_JOB_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), THUNAR_TYPE_JOB, ThunarJobPrivate))
 
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _thunar_job_stats_lock(job)   g_mutex_lock (&((job)->priv->stats_lock))
+#define _thunar_job_stats_unlock(job) g_mutex_unlock (&((job)->priv->stats_lock))
+#define _thunar_job_pause_lock(job)   g_mutex_lock (&((job)->priv->pause_lock))
+#define _thunar_job_pause_unlock(job) g_mutex_unlock (&((job)->priv->pause_lock))
+#define _thunar_job_pause_wait(job)   g_cond_wait (&((job)->priv->pause_cond), &((job)->priv->pause_lock))
+#define _thunar_job_pause_signal(job) g_cond_broadcast (&((job)->priv->pause_cond))
+#else
+#define _thunar_job_stats_lock(job)   g_mutex_lock ((job)->priv->stats_lock)
+#define _thunar_job_stats_unlock(job) g_mutex_unlock ((job)->priv->stats_lock)
+#define _thunar_job_pause_lock(job)   g_mutex_lock ((job)->priv->pause_lock)
+#define _thunar_job_pause_unlock(job) g_mutex_unlock ((job)->priv->pause_lock)
+#define _thunar_job_pause_wait(job)   g_cond_wait ((job)->priv->pause_cond, (job)->priv->pause_lock)
+#define _thunar_job_pause_signal(job) g_cond_broadcast ((job)->priv->pause_cond)
+#endif
+
 
 
 /* Signal identifiers */
@@ -61,15 +78,40 @@ static ThunarJobResponse thunar_job_real_ask            (ThunarJob          *job
 static ThunarJobResponse thunar_job_real_ask_replace    (ThunarJob          *job,
                                                          ThunarFile         *source_file,
                                                          ThunarFile         *target_file);
+static void              thunar_job_processing_done     (ThunarJob          *job);
 
 
 
 struct _ThunarJobPrivate
 {
-  ThunarJobResponse earlier_ask_create_response;
-  ThunarJobResponse earlier_ask_overwrite_response;
-  ThunarJobResponse earlier_ask_skip_response;
-  GList            *total_files;
+  ThunarJobResponse   earlier_ask_create_response;
+  ThunarJobResponse   earlier_ask_overwrite_response;
+  ThunarJobResponse   earlier_ask_skip_response;
+  GList              *total_files;
+
+  /* the scheduler while the job holds a place on its devices */
+  ThunarJobScheduler *scheduler;
+  volatile gint       paused;
+
+  /* wakes up the threads of a paused job without a scheduler */
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex              pause_lock;
+  GCond               pause_cond;
+#else
+  GMutex             *pause_lock;
+  GCond              *pause_cond;
+#endif
+
+  /* statistics, updated by all threads of the job */
+  ThunarJobStats      stats;
+  gint64              phase_start_time;
+  GFile              *processing_file;
+  gint64              processing_start_time;
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex              stats_lock;
+#else
+  GMutex             *stats_lock;
+#endif
 };
 
 
@@ -213,6 +255,16 @@ thunar_job_init (ThunarJob *job)
   job->priv->earlier_ask_create_response = 0;
   job->priv->earlier_ask_overwrite_response = 0;
   job->priv->earlier_ask_skip_response = 0;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&job->priv->stats_lock);
+  g_mutex_init (&job->priv->pause_lock);
+  g_cond_init (&job->priv->pause_cond);
+#else
+  job->priv->stats_lock = g_mutex_new ();
+  job->priv->pause_lock = g_mutex_new ();
+  job->priv->pause_cond = g_cond_new ();
+#endif
 }
 
 
@@ -220,6 +272,28 @@ thunar_job_init (ThunarJob *job)
 static void
 thunar_job_finalize (GObject *object)
 {
+  ThunarJob *job = THUNAR_JOB (object);
+  guint      n;
+
+  /* a job that did not get to release its devices */
+  thunar_job_unschedule (job);
+
+  if (job->priv->processing_file != NULL)
+    g_object_unref (job->priv->processing_file);
+
+  for (n = 0; n < THUNAR_JOB_STATS_N_SLOWEST; ++n)
+    g_free (job->priv->stats.slowest_files[n]);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&job->priv->stats_lock);
+  g_mutex_clear (&job->priv->pause_lock);
+  g_cond_clear (&job->priv->pause_cond);
+#else
+  g_mutex_free (job->priv->stats_lock);
+  g_mutex_free (job->priv->pause_lock);
+  g_cond_free (job->priv->pause_cond);
+#endif
+
   (*G_OBJECT_CLASS (thunar_job_parent_class)->finalize) (object);
 }
 
@@ -609,13 +683,25 @@ thunar_job_processing_file (ThunarJob *job,
   exo_job_info_message (EXO_JOB (job), "%s", display_name);
   g_free (display_name);
 
+  /* stop here while the job is paused */
+  thunar_job_check_paused (job);
+
+  /* the previous file is done once the next one starts */
+  thunar_job_set_phase (job, THUNAR_JOB_PHASE_PROCESSING);
+  thunar_job_processing_done (job);
+
+  _thunar_job_stats_lock (job);
+  job->priv->processing_file = g_object_ref (current_file->data);
+  job->priv->processing_start_time = g_get_monotonic_time ();
+  _thunar_job_stats_unlock (job);
+
   /* verify that we have total files set */
   if (G_LIKELY (job->priv->total_files != NULL))
     {
       /* determine the number of files processed so far */
       for (lp = job->priv->total_files, n_processed = 0;
            lp != current_file;
-           lp = lp->next);
+           lp = lp->next, ++n_processed);
 
       /* emit only if n_processed is a multiple of 8 */
       if ((n_processed % 8) == 0)
@@ -627,3 +713,484 @@ thunar_job_processing_file (ThunarJob *job,
         }
     }
 }
+
+
+
+/**
+ * thunar_job_schedule:
+ * @job   : a #ThunarJob.
+ * @files : the #GFile<!---->s @job reads and writes.
+ * @error : return location for errors or %NULL.
+ *
+ * Called from the thread of @job before it starts its work. Blocks
+ * until the job scheduler of the application lets @job run on the
+ * devices of @files. When the job is done, it must call
+ * thunar_job_unschedule().
+ *
+ * Return value: %FALSE if @job was cancelled while waiting.
+ **/
+gboolean
+thunar_job_schedule (ThunarJob *job,
+                     GList     *files,
+                     GError   **error)
+{
+  ThunarApplication  *application;
+  ThunarJobScheduler *scheduler;
+  ThunarJobPhase      phase;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (job->priv->scheduler == NULL, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  application = thunar_application_get ();
+  scheduler = thunar_application_get_job_scheduler (application);
+  g_object_unref (application);
+
+  phase = thunar_job_set_phase (job, THUNAR_JOB_PHASE_QUEUED);
+
+  if (!thunar_job_scheduler_acquire (scheduler, job, files, error))
+    {
+      thunar_job_set_phase (job, phase);
+      g_object_unref (scheduler);
+      return FALSE;
+    }
+
+  thunar_job_set_phase (job, phase);
+
+  job->priv->scheduler = scheduler;
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_job_unschedule:
+ * @job : a #ThunarJob.
+ *
+ * Gives up the place of @job on its devices, so the next
+ * job can start. Does nothing if @job was not scheduled.
+ **/
+void
+thunar_job_unschedule (ThunarJob *job)
+{
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  if (job->priv->scheduler != NULL)
+    {
+      thunar_job_scheduler_release (job->priv->scheduler, job);
+      g_object_unref (job->priv->scheduler);
+      job->priv->scheduler = NULL;
+    }
+}
+
+
+
+static void
+thunar_job_pause_cancelled (GCancellable *cancellable,
+                            ThunarJob    *job)
+{
+  /* wake up the paused threads so they stop */
+  _thunar_job_pause_lock (job);
+  _thunar_job_pause_signal (job);
+  _thunar_job_pause_unlock (job);
+}
+
+
+
+/**
+ * thunar_job_check_paused:
+ * @job : a #ThunarJob.
+ *
+ * Called from the thread of @job between two steps of its work.
+ * If the job is paused, this blocks until it is resumed or
+ * cancelled. A scheduled job lets the other jobs on its devices
+ * run meanwhile.
+ **/
+void
+thunar_job_check_paused (ThunarJob *job)
+{
+  GCancellable  *cancellable;
+  ThunarJobPhase phase;
+  gulong         handler_id;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  if (G_LIKELY (!thunar_job_is_paused (job)))
+    return;
+
+  phase = thunar_job_set_phase (job, THUNAR_JOB_PHASE_PAUSED);
+
+  if (job->priv->scheduler != NULL)
+    {
+      thunar_job_scheduler_yield (job->priv->scheduler, job);
+    }
+  else
+    {
+      /* nothing else waits for the job, wait until it is
+       * resumed or cancelled */
+      cancellable = exo_job_get_cancellable (EXO_JOB (job));
+      handler_id = g_cancellable_connect (cancellable, G_CALLBACK (thunar_job_pause_cancelled),
+                                          job, NULL);
+
+      _thunar_job_pause_lock (job);
+      while (thunar_job_is_paused (job) && !exo_job_is_cancelled (EXO_JOB (job)))
+        _thunar_job_pause_wait (job);
+      _thunar_job_pause_unlock (job);
+
+      g_cancellable_disconnect (cancellable, handler_id);
+    }
+
+  /* with several threads pausing, the first one resumes the phase */
+  if (phase != THUNAR_JOB_PHASE_PAUSED)
+    thunar_job_set_phase (job, phase);
+}
+
+
+
+/**
+ * thunar_job_set_paused:
+ * @job    : a #ThunarJob.
+ * @paused : whether @job should pause.
+ *
+ * Pauses or resumes @job. A running job pauses the next time
+ * it calls thunar_job_check_paused(), a queued job will not
+ * start until it is resumed.
+ **/
+void
+thunar_job_set_paused (ThunarJob *job,
+                       gboolean   paused)
+{
+  ThunarApplication  *application;
+  ThunarJobScheduler *scheduler;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  /* change the state with the lock held, so a thread that is
+   * about to wait does not miss the wakeup */
+  _thunar_job_pause_lock (job);
+  g_atomic_int_set (&job->priv->paused, paused ? 1 : 0);
+  _thunar_job_pause_signal (job);
+  _thunar_job_pause_unlock (job);
+
+  /* let the waiting jobs reconsider */
+  application = thunar_application_get ();
+  scheduler = thunar_application_get_job_scheduler (application);
+  thunar_job_scheduler_wakeup (scheduler);
+  g_object_unref (scheduler);
+  g_object_unref (application);
+}
+
+
+
+/**
+ * thunar_job_is_paused:
+ * @job : a #ThunarJob.
+ *
+ * Return value: %TRUE if @job is paused.
+ **/
+gboolean
+thunar_job_is_paused (ThunarJob *job)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  return g_atomic_int_get (&job->priv->paused) != 0;
+}
+
+
+
+/**
+ * thunar_job_raise:
+ * @job : a #ThunarJob.
+ *
+ * Lets @job start before the other jobs that wait for
+ * the same devices.
+ **/
+void
+thunar_job_raise (ThunarJob *job)
+{
+  ThunarApplication  *application;
+  ThunarJobScheduler *scheduler;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  application = thunar_application_get ();
+  scheduler = thunar_application_get_job_scheduler (application);
+  thunar_job_scheduler_raise (scheduler, job);
+  g_object_unref (scheduler);
+  g_object_unref (application);
+}
+
+
+
+/* counts @file as done, must be called with the stats lock held */
+static void
+thunar_job_stats_add_file (ThunarJob *job,
+                           GFile     *file,
+                           guint64    size,
+                           gint64     latency)
+{
+  ThunarJobStats *stats = &job->priv->stats;
+  gint64          msecs = latency / 1000;
+  guint           n;
+  guint           m;
+
+  stats->n_files++;
+  stats->n_bytes += size;
+
+  /* find the bucket of the latency */
+  for (n = 0; n < THUNAR_JOB_STATS_N_LATENCIES - 1 && msecs >= (1 << n); ++n);
+  stats->latencies[n]++;
+
+  /* find the place among the slowest files */
+  for (n = 0; n < THUNAR_JOB_STATS_N_SLOWEST; ++n)
+    if (stats->slowest_files[n] == NULL || latency > stats->slowest_times[n])
+      break;
+
+  if (n < THUNAR_JOB_STATS_N_SLOWEST)
+    {
+      g_free (stats->slowest_files[THUNAR_JOB_STATS_N_SLOWEST - 1]);
+
+      for (m = THUNAR_JOB_STATS_N_SLOWEST - 1; m > n; --m)
+        {
+          stats->slowest_files[m] = stats->slowest_files[m - 1];
+          stats->slowest_times[m] = stats->slowest_times[m - 1];
+        }
+
+      stats->slowest_files[n] = g_file_get_parse_name (file);
+      stats->slowest_times[n] = latency;
+    }
+}
+
+
+
+/* counts the file of the last thunar_job_processing_file() as done */
+static void
+thunar_job_processing_done (ThunarJob *job)
+{
+  _thunar_job_stats_lock (job);
+
+  if (job->priv->processing_file != NULL)
+    {
+      thunar_job_stats_add_file (job, job->priv->processing_file, 0,
+                                 g_get_monotonic_time () - job->priv->processing_start_time);
+      g_object_unref (job->priv->processing_file);
+      job->priv->processing_file = NULL;
+    }
+
+  _thunar_job_stats_unlock (job);
+}
+
+
+
+/**
+ * thunar_job_set_phase:
+ * @job   : a #ThunarJob.
+ * @phase : the #ThunarJobPhase @job enters.
+ *
+ * Called from the threads of @job, the time until the next call
+ * is counted for @phase in the statistics of @job. Setting
+ * %THUNAR_JOB_PHASE_IDLE stops counting, a job sets it when it
+ * is done.
+ *
+ * Return value: the previous phase of @job.
+ **/
+ThunarJobPhase
+thunar_job_set_phase (ThunarJob      *job,
+                      ThunarJobPhase  phase)
+{
+  ThunarJobPhase previous;
+  gint64         now;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), THUNAR_JOB_PHASE_IDLE);
+  _thunar_return_val_if_fail (phase < THUNAR_JOB_N_PHASES, THUNAR_JOB_PHASE_IDLE);
+
+  /* the last file is done with the job */
+  if (phase == THUNAR_JOB_PHASE_IDLE)
+    thunar_job_processing_done (job);
+
+  now = g_get_monotonic_time ();
+
+  _thunar_job_stats_lock (job);
+
+  previous = job->priv->stats.phase;
+  if (previous != THUNAR_JOB_PHASE_IDLE)
+    job->priv->stats.phase_times[previous] += now - job->priv->phase_start_time;
+
+  job->priv->stats.phase = phase;
+  job->priv->phase_start_time = now;
+
+  _thunar_job_stats_unlock (job);
+
+  return previous;
+}
+
+
+
+/**
+ * thunar_job_file_done:
+ * @job        : a #ThunarJob.
+ * @file       : the #GFile that was processed.
+ * @size       : the number of bytes processed for @file.
+ * @start_time : the g_get_monotonic_time() when the work on @file started.
+ *
+ * Adds @file to the statistics of @job. May be called from any
+ * thread of @job. Jobs that use thunar_job_processing_file() don't
+ * need to call this.
+ **/
+void
+thunar_job_file_done (ThunarJob *job,
+                      GFile     *file,
+                      guint64    size,
+                      gint64     start_time)
+{
+  gint64 latency;
+
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+  _thunar_return_if_fail (G_IS_FILE (file));
+
+  latency = g_get_monotonic_time () - start_time;
+
+  _thunar_job_stats_lock (job);
+  thunar_job_stats_add_file (job, file, size, latency);
+  _thunar_job_stats_unlock (job);
+}
+
+
+
+/**
+ * thunar_job_files_done:
+ * @job     : a #ThunarJob.
+ * @n_files : the number of files that were processed.
+ * @n_bytes : the number of bytes processed for them.
+ *
+ * Adds @n_files to the statistics of @job, for jobs that process
+ * the entries of a tree without a #GFile for each of them. Their
+ * latencies are not recorded. May be called from any thread of @job.
+ **/
+void
+thunar_job_files_done (ThunarJob *job,
+                       guint      n_files,
+                       guint64    n_bytes)
+{
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
+
+  _thunar_job_stats_lock (job);
+  job->priv->stats.n_files += n_files;
+  job->priv->stats.n_bytes += n_bytes;
+  _thunar_job_stats_unlock (job);
+}
+
+
+
+/**
+ * thunar_job_get_stats:
+ * @job : a #ThunarJob.
+ *
+ * Returns the statistics of @job so far, including the time
+ * spent in the current phase. The caller is responsible to
+ * free the returned statistics using thunar_job_stats_free().
+ *
+ * Return value: a copy of the statistics of @job.
+ **/
+ThunarJobStats *
+thunar_job_get_stats (ThunarJob *job)
+{
+  ThunarJobStats *stats;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
+
+  _thunar_job_stats_lock (job);
+
+  stats = thunar_job_stats_copy (&job->priv->stats);
+  if (stats->phase != THUNAR_JOB_PHASE_IDLE)
+    stats->phase_times[stats->phase] += g_get_monotonic_time () - job->priv->phase_start_time;
+
+  _thunar_job_stats_unlock (job);
+
+  return stats;
+}
+
+
+
+/**
+ * thunar_job_stats_copy:
+ * @stats : a #ThunarJobStats.
+ *
+ * Return value: a copy of @stats, free with thunar_job_stats_free().
+ **/
+ThunarJobStats *
+thunar_job_stats_copy (ThunarJobStats *stats)
+{
+  ThunarJobStats *copy;
+  guint           n;
+
+  _thunar_return_val_if_fail (stats != NULL, NULL);
+
+  copy = g_slice_dup (ThunarJobStats, stats);
+  copy->title = g_strdup (stats->title);
+  for (n = 0; n < THUNAR_JOB_STATS_N_SLOWEST; ++n)
+    copy->slowest_files[n] = g_strdup (stats->slowest_files[n]);
+
+  return copy;
+}
+
+
+
+/**
+ * thunar_job_stats_free:
+ * @stats : a #ThunarJobStats.
+ *
+ * Frees @stats.
+ **/
+void
+thunar_job_stats_free (ThunarJobStats *stats)
+{
+  guint n;
+
+  if (stats == NULL)
+    return;
+
+  g_free (stats->title);
+  for (n = 0; n < THUNAR_JOB_STATS_N_SLOWEST; ++n)
+    g_free (stats->slowest_files[n]);
+
+  g_slice_free (ThunarJobStats, stats);
+}
+
+
+
+/**
+ * thunar_job_stats_bytes_rate:
+ * @stats : a #ThunarJobStats.
+ *
+ * Return value: the bytes processed per second of processing.
+ **/
+gdouble
+thunar_job_stats_bytes_rate (ThunarJobStats *stats)
+{
+  gint64 usecs;
+
+  _thunar_return_val_if_fail (stats != NULL, 0.0);
+
+  usecs = stats->phase_times[THUNAR_JOB_PHASE_PROCESSING];
+  return (usecs > 0) ? (stats->n_bytes * (gdouble) G_USEC_PER_SEC) / usecs : 0.0;
+}
+
+
+
+/**
+ * thunar_job_stats_files_rate:
+ * @stats : a #ThunarJobStats.
+ *
+ * Return value: the files processed per second of processing.
+ **/
+gdouble
+thunar_job_stats_files_rate (ThunarJobStats *stats)
+{
+  gint64 usecs;
+
+  _thunar_return_val_if_fail (stats != NULL, 0.0);
+
+  usecs = stats->phase_times[THUNAR_JOB_PHASE_PROCESSING];
+  return (usecs > 0) ? (stats->n_files * (gdouble) G_USEC_PER_SEC) / usecs : 0.0;
+}
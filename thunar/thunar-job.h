@@ -34,6 +34,7 @@ G_BEGIN_DECLS
 typedef struct _ThunarJobPrivate ThunarJobPrivate;
 typedef struct _ThunarJobClass   ThunarJobClass;
 typedef struct _ThunarJob        ThunarJob;
+typedef struct _ThunarJobStats   ThunarJobStats;
 
 #define THUNAR_TYPE_JOB            (thunar_job_get_type ())
 #define THUNAR_JOB(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_JOB, ThunarJob))
@@ -65,6 +66,56 @@ struct _ThunarJob
   ThunarJobPrivate *priv;
 };
 
+/**
+ * ThunarJobPhase:
+ * @THUNAR_JOB_PHASE_IDLE       : the job did not start yet or is done.
+ * @THUNAR_JOB_PHASE_QUEUED     : the job waits for other jobs on its devices.
+ * @THUNAR_JOB_PHASE_COLLECTING : the job collects the files to work on.
+ * @THUNAR_JOB_PHASE_PROCESSING : the job works on the files.
+ * @THUNAR_JOB_PHASE_PAUSED     : the job was paused by the user.
+ *
+ * The phases a #ThunarJob spends its time in.
+ **/
+typedef enum
+{
+  THUNAR_JOB_PHASE_IDLE,
+  THUNAR_JOB_PHASE_QUEUED,
+  THUNAR_JOB_PHASE_COLLECTING,
+  THUNAR_JOB_PHASE_PROCESSING,
+  THUNAR_JOB_PHASE_PAUSED,
+  THUNAR_JOB_N_PHASES,
+} ThunarJobPhase;
+
+/* number of buckets of the latency histogram */
+#define THUNAR_JOB_STATS_N_LATENCIES (16)
+
+/* number of slowest files remembered */
+#define THUNAR_JOB_STATS_N_SLOWEST   (5)
+
+struct _ThunarJobStats
+{
+  /* the title of the operation, if known */
+  gchar          *title;
+
+  ThunarJobPhase  phase;
+
+  /* files and bytes processed */
+  guint           n_files;
+  guint64         n_bytes;
+
+  /* microseconds spent in each phase */
+  gint64          phase_times[THUNAR_JOB_N_PHASES];
+
+  /* the number of files that took less than 2^n milliseconds
+   * and at least 2^(n-1), the last bucket counts the slower ones */
+  guint           latencies[THUNAR_JOB_STATS_N_LATENCIES];
+
+  /* display names and microseconds of the slowest files, the
+   * slowest first. unused entries are %NULL */
+  gchar          *slowest_files[THUNAR_JOB_STATS_N_SLOWEST];
+  gint64          slowest_times[THUNAR_JOB_STATS_N_SLOWEST];
+};
+
 GType             thunar_job_get_type               (void) G_GNUC_CONST;
 void              thunar_job_set_total_files        (ThunarJob       *job,
                                                      GList           *total_files);
@@ -92,6 +143,32 @@ gboolean          thunar_job_files_ready            (ThunarJob       *job,
 void              thunar_job_new_files              (ThunarJob       *job,
                                                      const GList     *file_list);
 
+gboolean          thunar_job_schedule               (ThunarJob       *job,
+                                                     GList           *files,
+                                                     GError         **error);
+void              thunar_job_unschedule             (ThunarJob       *job);
+void              thunar_job_check_paused           (ThunarJob       *job);
+void              thunar_job_set_paused             (ThunarJob       *job,
+                                                     gboolean         paused);
+gboolean          thunar_job_is_paused              (ThunarJob       *job);
+void              thunar_job_raise                  (ThunarJob       *job);
+
+ThunarJobPhase    thunar_job_set_phase              (ThunarJob       *job,
+                                                     ThunarJobPhase   phase);
+void              thunar_job_file_done              (ThunarJob       *job,
+                                                     GFile           *file,
+                                                     guint64          size,
+                                                     gint64           start_time);
+void              thunar_job_files_done             (ThunarJob       *job,
+                                                     guint            n_files,
+                                                     guint64          n_bytes);
+ThunarJobStats   *thunar_job_get_stats              (ThunarJob       *job) G_GNUC_MALLOC;
+
+ThunarJobStats   *thunar_job_stats_copy             (ThunarJobStats  *stats) G_GNUC_MALLOC;
+void              thunar_job_stats_free             (ThunarJobStats  *stats);
+gdouble           thunar_job_stats_bytes_rate       (ThunarJobStats  *stats);
+gdouble           thunar_job_stats_files_rate       (ThunarJobStats  *stats);
+
 G_END_DECLS
 
 #endif /* !__THUNAR_JOB_H__ */
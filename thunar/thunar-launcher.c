@@ -82,6 +82,8 @@ static void                    thunar_launcher_set_current_directory      (Thuna
 static GList                  *thunar_launcher_get_selected_files         (ThunarComponent          *component);
 static void                    thunar_launcher_set_selected_files         (ThunarComponent          *component,
                                                                            GList                    *selected_files);
+static void                    thunar_launcher_selection_sync             (ThunarLauncher           *launcher);
+static void                    thunar_launcher_selection_changed          (ThunarLauncher           *launcher);
 static GtkUIManager           *thunar_launcher_get_ui_manager             (ThunarComponent          *component);
 static void                    thunar_launcher_set_ui_manager             (ThunarComponent          *component,
                                                                            GtkUIManager             *ui_manager);
@@ -136,6 +138,10 @@ struct _ThunarLauncher
   ThunarFile             *current_directory;
   GList                  *selected_files;
 
+  /* the component the selected files are taken from on demand */
+  ThunarComponent        *selection_source;
+  gboolean                selection_outdated;
+
   guint                   launcher_idle_id;
 
   GtkIconFactory         *icon_factory;
@@ -307,6 +313,14 @@ thunar_launcher_dispose (GObject *object)
   thunar_component_set_ui_manager (THUNAR_COMPONENT (launcher), NULL);
   thunar_launcher_set_widget (THUNAR_LAUNCHER (launcher), NULL);
 
+  /* disconnect from the selection source */
+  if (launcher->selection_source != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (G_OBJECT (launcher->selection_source), thunar_launcher_selection_changed, launcher);
+      g_object_remove_weak_pointer (G_OBJECT (launcher->selection_source), (gpointer) &launcher->selection_source);
+      launcher->selection_source = NULL;
+    }
+
   /* disconnect from the currently selected files */
   thunar_g_file_list_free (launcher->selected_files);
   launcher->selected_files = NULL;
@@ -446,7 +460,12 @@ thunar_launcher_set_current_directory (ThunarNavigator *navigator,
 static GList*
 thunar_launcher_get_selected_files (ThunarComponent *component)
 {
-  return THUNAR_LAUNCHER (component)->selected_files;
+  ThunarLauncher *launcher = THUNAR_LAUNCHER (component);
+
+  /* make sure the selection source was queried */
+  thunar_launcher_selection_sync (launcher);
+
+  return launcher->selected_files;
 }
 
 
@@ -459,6 +478,9 @@ thunar_launcher_set_selected_files (ThunarComponent *component,
   GList          *np;
   GList          *op;
 
+  /* the given list replaces the selection of the source */
+  launcher->selection_outdated = FALSE;
+
   /* compare the old and the new list of selected files */
   for (np = selected_files, op = launcher->selected_files; np != NULL && op != NULL; np = np->next, op = op->next)
     if (G_UNLIKELY (np->data != op->data))
@@ -483,6 +505,50 @@ thunar_launcher_set_selected_files (ThunarComponent *component,
 
 
 
+static void
+thunar_launcher_selection_sync (ThunarLauncher *launcher)
+{
+  GList *selected_files;
+
+  _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
+
+  /* take a copy of the source selection only when it is needed */
+  if (G_UNLIKELY (launcher->selection_outdated))
+    {
+      launcher->selection_outdated = FALSE;
+
+      /* disconnect from the previously selected files */
+      thunar_g_file_list_free (launcher->selected_files);
+      launcher->selected_files = NULL;
+
+      /* connect to the selected files of the source */
+      if (G_LIKELY (launcher->selection_source != NULL))
+        {
+          selected_files = thunar_component_get_selected_files (launcher->selection_source);
+          launcher->selected_files = thunar_g_file_list_copy (selected_files);
+        }
+    }
+}
+
+
+
+static void
+thunar_launcher_selection_changed (ThunarLauncher *launcher)
+{
+  _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
+
+  /* the files are fetched from the source on the next request */
+  launcher->selection_outdated = TRUE;
+
+  /* update the launcher actions */
+  thunar_launcher_update (launcher);
+
+  /* notify listeners */
+  g_object_notify_by_pspec (G_OBJECT (launcher), launcher_props[PROP_SELECTED_FILES]);
+}
+
+
+
 static GtkUIManager*
 thunar_launcher_get_ui_manager (ThunarComponent *component)
 {
@@ -790,6 +856,9 @@ thunar_launcher_update_idle (gpointer data)
   /* reset the application set for the "Open" action */
   g_object_set_qdata (G_OBJECT (launcher->action_open), thunar_launcher_handler_quark, NULL);
 
+  /* query the selection source */
+  thunar_launcher_selection_sync (launcher);
+
   /* determine the number of files/directories/executables */
   for (lp = launcher->selected_files; lp != NULL; lp = lp->next, ++n_selected_files)
     {
@@ -1456,6 +1525,7 @@ thunar_launcher_action_sendto_desktop (GtkAction      *action,
   _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
 
   /* determine the source files */
+  thunar_launcher_selection_sync (launcher);
   files = thunar_file_list_to_thunar_g_file_list (launcher->selected_files);
   if (G_UNLIKELY (files == NULL))
     return;
@@ -1603,6 +1673,7 @@ thunar_launcher_action_sendto_device (GtkAction      *action,
   _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
 
   /* determine the source paths */
+  thunar_launcher_selection_sync (launcher);
   files = thunar_file_list_to_thunar_g_file_list (launcher->selected_files);
   if (G_UNLIKELY (files == NULL))
     return;
@@ -1681,6 +1752,9 @@ thunar_launcher_sendto_idle (gpointer user_data)
 
   GDK_THREADS_ENTER ();
 
+  /* query the selection source */
+  thunar_launcher_selection_sync (launcher);
+
   /* determine the number of selected files and check whether atleast one of these
    * files is located in the trash (to en-/disable the "sendto-desktop" action).
    */
@@ -1891,3 +1965,43 @@ thunar_launcher_set_widget (ThunarLauncher *launcher,
 
 
 
+/**
+ * thunar_launcher_set_selection_source:
+ * @launcher : a #ThunarLauncher.
+ * @source   : a #ThunarComponent or %NULL.
+ *
+ * Makes @launcher operate on the files selected in @source. Unlike
+ * binding the "selected-files" property, the list of selected files
+ * is only queried from @source once the actions need it.
+ **/
+void
+thunar_launcher_set_selection_source (ThunarLauncher  *launcher,
+                                      ThunarComponent *source)
+{
+  _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
+  _thunar_return_if_fail (source == NULL || THUNAR_IS_COMPONENT (source));
+
+  /* leave if nothing changed */
+  if (launcher->selection_source == source)
+    return;
+
+  /* disconnect from the previous source */
+  if (launcher->selection_source != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (G_OBJECT (launcher->selection_source), thunar_launcher_selection_changed, launcher);
+      g_object_remove_weak_pointer (G_OBJECT (launcher->selection_source), (gpointer) &launcher->selection_source);
+    }
+
+  /* activate the new source */
+  launcher->selection_source = source;
+
+  /* connect to the new source */
+  if (G_LIKELY (source != NULL))
+    {
+      g_object_add_weak_pointer (G_OBJECT (source), (gpointer) &launcher->selection_source);
+      g_signal_connect_swapped (G_OBJECT (source), "notify::selected-files", G_CALLBACK (thunar_launcher_selection_changed), launcher);
+    }
+
+  /* the selection of the new source is used from now on */
+  thunar_launcher_selection_changed (launcher);
+}
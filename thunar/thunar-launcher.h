@@ -41,6 +41,9 @@ ThunarLauncher *thunar_launcher_new                 (void) G_GNUC_MALLOC;
 void            thunar_launcher_set_widget          (ThunarLauncher       *launcher,
                                                      GtkWidget            *widget);
 
+void            thunar_launcher_set_selection_source (ThunarLauncher      *launcher,
+                                                      ThunarComponent     *source);
+
 G_END_DECLS;
 
 #endif /* !__THUNAR_LAUNCHER_H__ */
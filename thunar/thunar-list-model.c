@@ -36,6 +36,7 @@
 #include <thunar/thunar-list-model.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-size-cache.h>
 #include <thunar/thunar-user.h>
 
 
@@ -66,6 +67,8 @@ typedef gint (*ThunarSortFunc) (const ThunarFile *a,
                                 const ThunarFile *b,
                                 gboolean          case_sensitive);
 
+typedef struct _ThunarListModelTotal ThunarListModelTotal;
+
 
 
 static void               thunar_list_model_tree_model_init       (GtkTreeModelIface      *iface);
@@ -150,6 +153,10 @@ static void               thunar_list_model_files_added           (ThunarFolder
 static void               thunar_list_model_files_removed         (ThunarFolder           *folder,
                                                                    GList                  *files,
                                                                    ThunarListModel        *store);
+static void               thunar_list_model_total_changed         (ThunarSizeCache        *size_cache,
+                                                                   GFile                  *directory,
+                                                                   ThunarListModel        *store);
+static void               thunar_list_model_total_free            (gpointer                data);
 static gint               sort_by_date_accessed                   (const ThunarFile       *a,
                                                                    const ThunarFile       *b,
                                                                    gboolean                case_sensitive);
@@ -218,6 +225,11 @@ struct _ThunarListModel
    */
   ThunarFileMonitor *file_monitor;
 
+  /* folder totals from earlier deep counts for the size column,
+   * looked up once per folder row and modification time */
+  ThunarSizeCache   *size_cache;
+  GHashTable        *totals;
+
   /* ids for the "row-inserted" and "row-deleted" signals
    * of GtkTreeModel to speed up folder changing.
    */
@@ -230,6 +242,16 @@ struct _ThunarListModel
   ThunarSortFunc sort_func;
 };
 
+struct _ThunarListModelTotal
+{
+  /* modification time of the folder at the lookup */
+  guint64  mtime;
+
+  /* whether the size cache had a total for it */
+  gboolean known;
+  guint64  total_size;
+};
+
 
 
 static guint       list_model_signals[LAST_SIGNAL];
@@ -414,6 +436,12 @@ thunar_list_model_init (ThunarListModel *store)
   store->file_monitor = thunar_file_monitor_get_default ();
   g_signal_connect (G_OBJECT (store->file_monitor), "file-changed",
                     G_CALLBACK (thunar_list_model_file_changed), store);
+
+  store->size_cache = thunar_size_cache_get ();
+  g_signal_connect (G_OBJECT (store->size_cache), "total-changed",
+                    G_CALLBACK (thunar_list_model_total_changed), store);
+  store->totals = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                         g_object_unref, thunar_list_model_total_free);
 }
 
 
@@ -440,6 +468,11 @@ thunar_list_model_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (G_OBJECT (store->file_monitor), thunar_list_model_file_changed, store);
   g_object_unref (G_OBJECT (store->file_monitor));
 
+  /* disconnect from the size cache */
+  g_signal_handlers_disconnect_by_func (G_OBJECT (store->size_cache), thunar_list_model_total_changed, store);
+  g_object_unref (G_OBJECT (store->size_cache));
+  g_hash_table_destroy (store->totals);
+
   (*G_OBJECT_CLASS (thunar_list_model_parent_class)->finalize) (object);
 }
 
@@ -633,6 +666,62 @@ thunar_list_model_get_path (GtkTreeModel *model,
 
 
 
+/* looks up the total size of the last deep count of the folder @file,
+ * the size cache is only asked again when the folder changed */
+static gboolean
+thunar_list_model_get_total (ThunarListModel *store,
+                             ThunarFile      *file,
+                             guint64         *total_size)
+{
+  ThunarListModelTotal *total;
+  GFileInfo            *info;
+  guint64               mtime;
+
+  info = thunar_file_get_info (file);
+  if (G_UNLIKELY (info == NULL))
+    return FALSE;
+
+  mtime = thunar_size_cache_get_mtime (info);
+
+  total = g_hash_table_lookup (store->totals, file);
+  if (total == NULL)
+    {
+      total = g_slice_new (ThunarListModelTotal);
+      g_hash_table_insert (store->totals, g_object_ref (file), total);
+    }
+  else if (total->mtime == mtime)
+    {
+      *total_size = total->total_size;
+      return total->known;
+    }
+
+  total->mtime = mtime;
+  total->known = thunar_size_cache_get_total (store->size_cache,
+                                              thunar_file_get_file (file),
+                                              mtime, &total->total_size);
+
+  *total_size = total->total_size;
+  return total->known;
+}
+
+
+
+/* the size of @file as shown in the size column */
+static guint64
+thunar_list_model_get_size (ThunarListModel *store,
+                            ThunarFile      *file)
+{
+  guint64 total_size;
+
+  if (thunar_file_is_directory (file)
+      && thunar_list_model_get_total (store, file, &total_size))
+    return total_size;
+
+  return thunar_file_get_size (file);
+}
+
+
+
 static void
 thunar_list_model_get_value (GtkTreeModel *model,
                              GtkTreeIter  *iter,
@@ -645,6 +734,7 @@ thunar_list_model_get_value (GtkTreeModel *model,
   const gchar *real_name;
   ThunarUser  *user;
   ThunarFile  *file;
+  guint64      total_size;
   gchar       *str;
 
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (model));
@@ -716,7 +806,17 @@ thunar_list_model_get_value (GtkTreeModel *model,
 
     case THUNAR_COLUMN_SIZE:
       g_value_init (value, G_TYPE_STRING);
-      g_value_take_string (value, thunar_file_get_size_string (file));
+      if (thunar_file_is_directory (file)
+          && thunar_list_model_get_total (THUNAR_LIST_MODEL (model), file, &total_size))
+        {
+          /* show the total of a folder counted before, as long as
+           * the folder itself did not change */
+          g_value_take_string (value, g_format_size (total_size));
+        }
+      else
+        {
+          g_value_take_string (value, thunar_file_get_size_string (file));
+        }
       break;
 
     case THUNAR_COLUMN_TYPE:
@@ -1007,6 +1107,8 @@ thunar_list_model_cmp_func (gconstpointer a,
   ThunarListModel *store = THUNAR_LIST_MODEL (user_data);
   gboolean         isdir_a;
   gboolean         isdir_b;
+  guint64          size_a;
+  guint64          size_b;
 
   _thunar_return_val_if_fail (THUNAR_IS_FILE (a), 0);
   _thunar_return_val_if_fail (THUNAR_IS_FILE (b), 0);
@@ -1019,6 +1121,16 @@ thunar_list_model_cmp_func (gconstpointer a,
         return isdir_a ? -1 : 1;
     }
 
+  if (store->sort_func == sort_by_size)
+    {
+      /* the folder totals are kept in the store, so the
+       * sizes are compared here instead of in sort_by_size() */
+      size_a = thunar_list_model_get_size (store, (ThunarFile *) a);
+      size_b = thunar_list_model_get_size (store, (ThunarFile *) b);
+      if (size_a != size_b)
+        return (size_a < size_b ? -1 : 1) * store->sort_sign;
+    }
+
   return (*store->sort_func) (a, b, store->sort_case_sensitive) * store->sort_sign;
 }
 
@@ -1164,6 +1276,35 @@ thunar_list_model_file_changed (ThunarFileMonitor *file_monitor,
 
 
 
+static void
+thunar_list_model_total_changed (ThunarSizeCache *size_cache,
+                                 GFile           *directory,
+                                 ThunarListModel *store)
+{
+  ThunarFile *file;
+
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (size_cache));
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+
+  /* only folders with a row in the model were looked up */
+  file = thunar_file_cache_lookup (directory);
+  if (file != NULL && g_hash_table_remove (store->totals, file))
+    {
+      /* redraw the row with the new total */
+      thunar_list_model_file_changed (store->file_monitor, file, store);
+    }
+}
+
+
+
+static void
+thunar_list_model_total_free (gpointer data)
+{
+  g_slice_free (ThunarListModelTotal, data);
+}
+
+
+
 static void
 thunar_list_model_folder_destroy (ThunarFolder    *folder,
                                   ThunarListModel *store)
@@ -1311,6 +1452,9 @@ thunar_list_model_files_removed (ThunarFolder    *folder,
           store->hidden = g_slist_remove (store->hidden, lp->data);
           g_object_unref (G_OBJECT (lp->data));
         }
+
+      /* forget the total of the folder */
+      g_hash_table_remove (store->totals, lp->data);
     }
 
   /* this probably changed */
@@ -1775,6 +1919,9 @@ thunar_list_model_set_folder (ThunarListModel *store,
       g_slist_free_full (store->hidden, g_object_unref);
       store->hidden = NULL;
 
+      /* forget the folder totals */
+      g_hash_table_remove_all (store->totals);
+
       /* unregister signals and drop the reference */
       g_signal_handlers_disconnect_matched (G_OBJECT (store->folder), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, store);
       g_object_unref (G_OBJECT (store->folder));
@@ -2028,29 +2175,44 @@ GList*
 thunar_list_model_get_paths_for_files (ThunarListModel *store,
                                        GList           *files)
 {
+  GHashTable    *file_set;
   GList         *paths = NULL;
+  GList         *lp;
   GSequenceIter *row;
   GSequenceIter *end;
+  guint          n_files;
   gint           i = 0;
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
 
+  if (G_UNLIKELY (files == NULL))
+    return NULL;
+
+  /* put the files in a set, so each row is checked in constant time */
+  file_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (lp = files; lp != NULL; lp = lp->next)
+    g_hash_table_insert (file_set, lp->data, lp->data);
+  n_files = g_hash_table_size (file_set);
+
   row = g_sequence_get_begin_iter (store->rows);
   end = g_sequence_get_end_iter (store->rows);
 
-  /* find the rows for the given files */
-  while (row != end)
+  /* find the rows for the given files, stop once all were found */
+  while (row != end && n_files > 0)
     {
-      if (g_list_find (files, g_sequence_get (row)) != NULL)
+      if (g_hash_table_lookup (file_set, g_sequence_get (row)) != NULL)
         {
           _thunar_assert (i == g_sequence_iter_get_position (row));
           paths = g_list_prepend (paths, gtk_tree_path_new_from_indices (i, -1));
+          n_files--;
         }
 
       row = g_sequence_iter_next (row);
       i++;
     }
 
+  g_hash_table_destroy (file_set);
+
   return paths;
 }
 
@@ -2113,13 +2275,155 @@ thunar_list_model_get_paths_for_pattern (ThunarListModel *store,
 
 
 
+static gint
+thunar_list_model_compare_indices (gconstpointer a,
+                                   gconstpointer b)
+{
+  return *((const gint *) a) - *((const gint *) b);
+}
+
+
+
+/**
+ * thunar_list_model_get_ranges_for_paths:
+ * @store : a #ThunarListModel.
+ * @paths : a list of #GtkTreePath<!---->s in @store.
+ *
+ * Converts @paths to a sorted array of #ThunarListModelRange<!---->s,
+ * where adjacent rows are merged into a single range. This is a
+ * compact representation of large selections.
+ *
+ * The caller is responsible to free the returned array using
+ * g_array_free().
+ *
+ * Return value: the ranges of rows in @paths.
+ **/
+GArray*
+thunar_list_model_get_ranges_for_paths (ThunarListModel *store,
+                                        GList           *paths)
+{
+  ThunarListModelRange *range;
+  ThunarListModelRange  new_range;
+  GArray               *indices;
+  GArray               *ranges;
+  gboolean              sorted = TRUE;
+  GList                *lp;
+  gint                  index;
+  guint                 n;
+
+  _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
+
+  /* collect the row indices */
+  indices = g_array_new (FALSE, FALSE, sizeof (gint));
+  for (lp = paths; lp != NULL; lp = lp->next)
+    {
+      index = gtk_tree_path_get_indices (lp->data)[0];
+      if (indices->len > 0 && index < g_array_index (indices, gint, indices->len - 1))
+        sorted = FALSE;
+      g_array_append_val (indices, index);
+    }
+
+  /* the views usually return the paths in order */
+  if (G_UNLIKELY (!sorted))
+    g_array_sort (indices, thunar_list_model_compare_indices);
+
+  /* merge adjacent rows */
+  ranges = g_array_new (FALSE, FALSE, sizeof (ThunarListModelRange));
+  for (n = 0, range = NULL; n < indices->len; ++n)
+    {
+      index = g_array_index (indices, gint, n);
+      if (range != NULL && index <= range->last + 1)
+        {
+          range->last = MAX (range->last, index);
+        }
+      else
+        {
+          new_range.first = new_range.last = index;
+          g_array_append_val (ranges, new_range);
+          range = &g_array_index (ranges, ThunarListModelRange, ranges->len - 1);
+        }
+    }
+
+  g_array_free (indices, TRUE);
+
+  return ranges;
+}
+
+
+
+/**
+ * thunar_list_model_count_ranges:
+ * @ranges : an array of #ThunarListModelRange<!---->s.
+ *
+ * Return value: the number of rows in @ranges.
+ **/
+guint
+thunar_list_model_count_ranges (const GArray *ranges)
+{
+  ThunarListModelRange *range;
+  guint                 n_rows = 0;
+  guint                 n;
+
+  for (n = 0; ranges != NULL && n < ranges->len; ++n)
+    {
+      range = &g_array_index (ranges, ThunarListModelRange, n);
+      n_rows += range->last - range->first + 1;
+    }
+
+  return n_rows;
+}
+
+
+
+/**
+ * thunar_list_model_get_files_for_ranges:
+ * @store  : a #ThunarListModel.
+ * @ranges : a sorted array of #ThunarListModelRange<!---->s.
+ *
+ * Returns the #ThunarFile<!---->s in the rows of @ranges, in the
+ * order of the rows. The rows of each range are visited in
+ * sequence, without looking up each row separately.
+ *
+ * The caller is responsible to free the returned list using
+ * thunar_g_file_list_free().
+ *
+ * Return value: the list of #ThunarFile<!---->s in @ranges.
+ **/
+GList*
+thunar_list_model_get_files_for_ranges (ThunarListModel *store,
+                                        const GArray    *ranges)
+{
+  ThunarListModelRange *range;
+  GSequenceIter        *row;
+  GList                *files = NULL;
+  guint                 n;
+  gint                  i;
+
+  _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
+
+  for (n = 0; ranges != NULL && n < ranges->len; ++n)
+    {
+      range = &g_array_index (ranges, ThunarListModelRange, n);
+      row = g_sequence_get_iter_at_pos (store->rows, range->first);
+      for (i = range->first; i <= range->last && !g_sequence_iter_is_end (row); ++i)
+        {
+          files = g_list_prepend (files, g_object_ref (g_sequence_get (row)));
+          row = g_sequence_iter_next (row);
+        }
+    }
+
+  return g_list_reverse (files);
+}
+
+
+
 /**
  * thunar_list_model_get_statusbar_text:
- * @store          : a #ThunarListModel instance.
- * @selected_items : the list of selected items (as GtkTreePath's).
+ * @store           : a #ThunarListModel instance.
+ * @selected_ranges : the sorted ranges of selected rows or %NULL.
  *
  * Generates the statusbar text for @store with the given
- * @selected_items.
+ * @selected_ranges.
  *
  * This function is used by the #ThunarStandardView (and thereby
  * implicitly by #ThunarIconView and #ThunarDetailsView) to
@@ -2130,41 +2434,46 @@ thunar_list_model_get_paths_for_pattern (ThunarListModel *store,
  * g_free() when it's no longer needed.
  *
  * Return value: the statusbar text for @store with the given
- *               @selected_items.
+ *               @selected_ranges.
  **/
 gchar*
 thunar_list_model_get_statusbar_text (ThunarListModel *store,
-                                      GList           *selected_items)
-{
-  const gchar       *content_type;
-  const gchar       *original_path;
-  GtkTreeIter        iter;
-  ThunarFile        *file;
-  guint64            size;
-  guint64            size_summary;
-  gint               folder_count;
-  gint               non_folder_count;
-  GList             *lp;
-  gchar             *absolute_path;
-  gchar             *fspace_string;
-  gchar             *display_name;
-  gchar             *size_string;
-  gchar             *text;
-  gchar             *folder_text;
-  gchar             *non_folder_text;
-  gchar             *s;
-  gint               height;
-  gint               width;
-  gchar             *description;
-  GSequenceIter     *row;
-  GSequenceIter     *end;
-  gint               nrows;
-  ThunarPreferences *preferences;
-  gboolean           show_image_size;
+                                      const GArray    *selected_ranges)
+{
+  ThunarListModelRange *range;
+  const gchar          *content_type;
+  const gchar          *original_path;
+  ThunarFile           *file;
+  guint64               size;
+  guint64               size_summary;
+  gint                  folder_count;
+  gint                  non_folder_count;
+  gchar                *absolute_path;
+  gchar                *fspace_string;
+  gchar                *display_name;
+  gchar                *size_string;
+  gchar                *text;
+  gchar                *folder_text;
+  gchar                *non_folder_text;
+  gchar                *s;
+  gint                  height;
+  gint                  width;
+  gchar                *description;
+  GSequenceIter        *row;
+  GSequenceIter        *end;
+  gint                  nrows;
+  ThunarPreferences    *preferences;
+  gboolean              show_image_size;
+  guint                 n_selected;
+  guint                 n;
+  gint                  i;
 
   _thunar_return_val_if_fail (THUNAR_IS_LIST_MODEL (store), NULL);
 
-  if (selected_items == NULL)
+  /* count the selected rows, without visiting them */
+  n_selected = thunar_list_model_count_ranges (selected_ranges);
+
+  if (n_selected == 0)
     {
       /* try to determine a file for the current folder */
       file = (store->folder != NULL) ? thunar_folder_get_corresponding_file (store->folder) : NULL;
@@ -2214,13 +2523,11 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
           text = g_strdup_printf (ngettext ("%d item", "%d items", nrows), nrows);
         }
     }
-  else if (selected_items->next == NULL)
+  else if (n_selected == 1)
     {
-      /* resolve the iter for the single path */
-      gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, selected_items->data);
-
-      /* get the file for the given iter */
-      file = g_sequence_get (iter.user_data);
+      /* get the file for the single row */
+      range = &g_array_index (selected_ranges, ThunarListModelRange, 0);
+      file = g_sequence_get (g_sequence_get_iter_at_pos (store->rows, range->first));
 
       /* determine the content type of the file */
       content_type = thunar_file_get_content_type (file);
@@ -2306,20 +2613,26 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
       folder_count = 0;
       non_folder_count = 0;
 
-      /* analyze selection */
-      for (lp = selected_items; lp != NULL; lp = lp->next)
+      /* analyze selection, walking the rows of each range in sequence */
+      for (n = 0; n < selected_ranges->len; ++n)
         {
-          gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, lp->data);
-          file = g_sequence_get (iter.user_data);
-          if (thunar_file_is_directory (file))
+          range = &g_array_index (selected_ranges, ThunarListModelRange, n);
+          row = g_sequence_get_iter_at_pos (store->rows, range->first);
+          for (i = range->first; i <= range->last && !g_sequence_iter_is_end (row); ++i)
             {
-              folder_count++;
-            }
-          else
-            {
-              non_folder_count++;
-              if (thunar_file_is_regular (file))
-                size_summary += thunar_file_get_size (file);
+              file = g_sequence_get (row);
+              if (thunar_file_is_directory (file))
+                {
+                  folder_count++;
+                }
+              else
+                {
+                  non_folder_count++;
+                  if (thunar_file_is_regular (file))
+                    size_summary += thunar_file_get_size (file);
+                }
+
+              row = g_sequence_iter_next (row);
             }
         }
 
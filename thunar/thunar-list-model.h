@@ -26,6 +26,7 @@ G_BEGIN_DECLS;
 
 typedef struct _ThunarListModelClass ThunarListModelClass;
 typedef struct _ThunarListModel      ThunarListModel;
+typedef struct _ThunarListModelRange ThunarListModelRange;
 
 #define THUNAR_TYPE_LIST_MODEL            (thunar_list_model_get_type ())
 #define THUNAR_LIST_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_LIST_MODEL, ThunarListModel))
@@ -34,6 +35,19 @@ typedef struct _ThunarListModel      ThunarListModel;
 #define THUNAR_IS_LIST_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_LIST_MODEL))
 #define THUNAR_LIST_MODEL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_LIST_MODEL, ThunarListModelClass))
 
+/**
+ * ThunarListModelRange:
+ * @first : index of the first row in the range.
+ * @last  : index of the last row in the range.
+ *
+ * A range of adjacent rows in a #ThunarListModel.
+ **/
+struct _ThunarListModelRange
+{
+  gint first;
+  gint last;
+};
+
 GType            thunar_list_model_get_type               (void) G_GNUC_CONST;
 
 ThunarListModel *thunar_list_model_new                    (void);
@@ -58,8 +72,14 @@ GList           *thunar_list_model_get_paths_for_files    (ThunarListModel  *sto
 GList           *thunar_list_model_get_paths_for_pattern  (ThunarListModel  *store,
                                                            const gchar      *pattern);
 
+GArray          *thunar_list_model_get_ranges_for_paths   (ThunarListModel  *store,
+                                                           GList            *paths);
+guint            thunar_list_model_count_ranges           (const GArray     *ranges);
+GList           *thunar_list_model_get_files_for_ranges   (ThunarListModel  *store,
+                                                           const GArray     *ranges);
+
 gchar           *thunar_list_model_get_statusbar_text     (ThunarListModel  *store,
-                                                           GList            *selected_items);
+                                                           const GArray     *selected_ranges);
 
 G_END_DECLS;
 
@@ -75,14 +75,18 @@ enum
   PROP_MISC_VOLUME_MANAGEMENT,
   PROP_MISC_CASE_SENSITIVE,
   PROP_MISC_DATE_STYLE,
+  PROP_MISC_DEEP_COUNT_WORKERS,
   PROP_MISC_FOLDERS_FIRST,
   PROP_MISC_FULL_PATH_IN_TITLE,
   PROP_MISC_HORIZONTAL_WHEEL_NAVIGATES,
+  PROP_MISC_ICON_CACHE_SIZE,
   PROP_MISC_IMAGE_SIZE_IN_STATUSBAR,
+  PROP_MISC_JOBS_PER_DEVICE,
   PROP_MISC_MIDDLE_CLICK_IN_TAB,
   PROP_MISC_RECURSIVE_PERMISSIONS,
   PROP_MISC_REMEMBER_GEOMETRY,
   PROP_MISC_SHOW_ABOUT_TEMPLATES,
+  PROP_MISC_SHOW_JOB_STATISTICS,
   PROP_MISC_SINGLE_CLICK,
   PROP_MISC_SINGLE_CLICK_TIMEOUT,
   PROP_MISC_SMALL_TOOLBAR_ICONS,
@@ -490,6 +494,19 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                          THUNAR_DATE_STYLE_SIMPLE,
                          EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-deep-count-workers:
+   *
+   * The number of threads used to count the contents of
+   * folders in the properties dialog.
+   **/
+  preferences_props[PROP_MISC_DEEP_COUNT_WORKERS] =
+      g_param_spec_uint ("misc-deep-count-workers",
+                         "MiscDeepCountWorkers",
+                         NULL,
+                         1u, 32u, 4u,
+                         EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-folders-first:
    *
@@ -528,6 +545,20 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             FALSE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-icon-cache-size:
+   *
+   * The amount of memory in MiB that may be used to keep decoded
+   * file icons and thumbnails around. The least recently used
+   * icons are dropped once the cache exceeds this size.
+   **/
+  preferences_props[PROP_MISC_ICON_CACHE_SIZE] =
+      g_param_spec_uint ("misc-icon-cache-size",
+                         NULL,
+                         NULL,
+                         1u, 4096u, 64u,
+                         EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-image-size-in-statusbar:
    *
@@ -542,6 +573,21 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             FALSE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-jobs-per-device:
+   *
+   * The number of copy, move, delete and trash operations that
+   * may run on the same device at a time, the others wait until
+   * one of them is done. 0, the default, runs all operations at
+   * once, so cheap operations never wait behind a long copy.
+   **/
+  preferences_props[PROP_MISC_JOBS_PER_DEVICE] =
+      g_param_spec_uint ("misc-jobs-per-device",
+                         "MiscJobsPerDevice",
+                         NULL,
+                         0u, 32u, 0u,
+                         EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-middle-click-in-tab:
    *
@@ -597,6 +643,19 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             TRUE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-show-job-statistics:
+   *
+   * Whether the progress dialog shows the throughput, the time spent
+   * in each phase and the slowest files of the running operations.
+   **/
+  preferences_props[PROP_MISC_SHOW_JOB_STATISTICS] =
+      g_param_spec_boolean ("misc-show-job-statistics",
+                            "MiscShowJobStatistics",
+                            NULL,
+                            FALSE,
+                            EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:misc-single-click:
    *
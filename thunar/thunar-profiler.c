@@ -0,0 +1,605 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-profiler.h>
+
+
+
+/**
+ * The profiler records how long the views spend drawing frames and
+ * in main loop callbacks, how long asynchronous requests (such as
+ * thumbnails) take to complete, how often model signals are emitted
+ * and the values of gauges, such as the size of the icon cache.
+ * It is disabled unless the THUNAR_PROFILE environment variable is
+ * set when Thunar starts:
+ *
+ *   THUNAR_PROFILE=histogram  print duration histograms to stderr on exit.
+ *   THUNAR_PROFILE=trace      write a Chrome trace (chrome://tracing) to
+ *                             THUNAR_PROFILE_FILE on exit, which defaults
+ *                             to thunar-trace-<pid>.json in the temp dir.
+ *
+ * Callbacks are only recorded if they take longer than
+ * THUNAR_PROFILE_STALL_MS milliseconds (16 by default).
+ *
+ * The profiler may only be used from the main loop thread, and the
+ * names passed to it must be static strings without characters that
+ * need escaping in JSON, as they are neither copied nor escaped.
+ **/
+
+
+
+/* time window (in microseconds) in which signal emissions are counted */
+#define THUNAR_PROFILER_STORM_WINDOW    (100 * 1000)
+
+/* number of emissions in a window that are considered a storm */
+#define THUNAR_PROFILER_STORM_EMISSIONS (100)
+
+/* maximum number of events in a trace */
+#define THUNAR_PROFILER_MAX_EVENTS      (500000)
+
+
+
+typedef enum
+{
+  THUNAR_PROFILER_MODE_UNKNOWN,
+  THUNAR_PROFILER_MODE_OFF,
+  THUNAR_PROFILER_MODE_HISTOGRAM,
+  THUNAR_PROFILER_MODE_TRACE,
+} ThunarProfilerMode;
+
+typedef struct
+{
+  guint  n_events;
+  gint64 total;
+  gint64 max;
+  guint  buckets[11]; /* one more than bucket_limits */
+} ThunarProfilerStats;
+
+typedef struct
+{
+  gint64 last;
+  gint64 max;
+} ThunarProfilerGauge;
+
+typedef struct
+{
+  guint64 n_emissions;
+  gint64  window_begin;
+  guint   window_emissions;
+  guint   max_emissions;
+  guint   n_storms;
+} ThunarProfilerCounter;
+
+
+
+static void     thunar_profiler_init             (void);
+static void     thunar_profiler_add_event        (const gchar           *category,
+                                                  const gchar           *name,
+                                                  gint64                 begin,
+                                                  gint64                 duration);
+static void     thunar_profiler_add_counter      (const gchar           *category,
+                                                  const gchar           *name,
+                                                  gint64                 time,
+                                                  const gchar           *arg,
+                                                  gint64                 value);
+static void     thunar_profiler_record           (GHashTable            *table,
+                                                  const gchar           *category,
+                                                  const gchar           *name,
+                                                  gint64                 begin,
+                                                  gint64                 duration);
+static void     thunar_profiler_close_window     (const gchar           *name,
+                                                  ThunarProfilerCounter *counter);
+static void     thunar_profiler_print_stats      (gpointer               key,
+                                                  gpointer               value,
+                                                  gpointer               user_data);
+static void     thunar_profiler_print_counter    (gpointer               key,
+                                                  gpointer               value,
+                                                  gpointer               user_data);
+static void     thunar_profiler_print_gauge      (gpointer               key,
+                                                  gpointer               value,
+                                                  gpointer               user_data);
+
+
+
+/* upper bounds (in milliseconds) of the histogram buckets, the last bucket is open */
+static const gint bucket_limits[] = { 1, 2, 4, 8, 16, 33, 66, 133, 266, 533 };
+
+static ThunarProfilerMode profiler_mode = THUNAR_PROFILER_MODE_UNKNOWN;
+static gint64             profiler_stall_threshold;
+static GHashTable        *profiler_frames;
+static GHashTable        *profiler_stalls;
+static GHashTable        *profiler_latencies;
+static GHashTable        *profiler_counters;
+static GHashTable        *profiler_gauges;
+static GString           *profiler_trace;
+static guint              profiler_n_events;
+static guint              profiler_n_dropped;
+
+
+
+static void
+thunar_profiler_init (void)
+{
+  const gchar *mode;
+  const gchar *threshold;
+
+  mode = g_getenv ("THUNAR_PROFILE");
+  if (G_LIKELY (mode == NULL || *mode == '\0'))
+    {
+      profiler_mode = THUNAR_PROFILER_MODE_OFF;
+      return;
+    }
+
+  if (g_str_equal (mode, "trace"))
+    {
+      profiler_mode = THUNAR_PROFILER_MODE_TRACE;
+      profiler_trace = g_string_sized_new (64 * 1024);
+    }
+  else
+    {
+      if (!g_str_equal (mode, "histogram"))
+        g_warning ("Unknown THUNAR_PROFILE mode \"%s\", using \"histogram\"", mode);
+      profiler_mode = THUNAR_PROFILER_MODE_HISTOGRAM;
+    }
+
+  /* determine the stall threshold */
+  threshold = g_getenv ("THUNAR_PROFILE_STALL_MS");
+  profiler_stall_threshold = (threshold != NULL) ? MAX (atoi (threshold), 0) * 1000 : 16 * 1000;
+
+  /* the names are static strings, so the tables do not own them */
+  profiler_frames = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  profiler_stalls = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  profiler_latencies = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  profiler_counters = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  profiler_gauges = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+}
+
+
+
+static void
+thunar_profiler_add_event (const gchar *category,
+                           const gchar *name,
+                           gint64       begin,
+                           gint64       duration)
+{
+  if (profiler_trace == NULL)
+    return;
+
+  /* keep the trace at a reasonable size for long sessions */
+  if (G_UNLIKELY (profiler_n_events >= THUNAR_PROFILER_MAX_EVENTS))
+    {
+      profiler_n_dropped += 1;
+      return;
+    }
+
+  if (G_LIKELY (profiler_n_events > 0))
+    g_string_append (profiler_trace, ",\n");
+  profiler_n_events += 1;
+
+  /* complete event with a duration */
+  g_string_append_printf (profiler_trace,
+                          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ",\"pid\":%d,\"tid\":1}",
+                          name, category, begin, duration, (gint) getpid ());
+}
+
+
+
+static void
+thunar_profiler_add_counter (const gchar *category,
+                             const gchar *name,
+                             gint64       time,
+                             const gchar *arg,
+                             gint64       value)
+{
+  if (profiler_trace == NULL)
+    return;
+
+  /* keep the trace at a reasonable size for long sessions */
+  if (G_UNLIKELY (profiler_n_events >= THUNAR_PROFILER_MAX_EVENTS))
+    {
+      profiler_n_dropped += 1;
+      return;
+    }
+
+  if (G_LIKELY (profiler_n_events > 0))
+    g_string_append (profiler_trace, ",\n");
+  profiler_n_events += 1;
+
+  g_string_append_printf (profiler_trace,
+                          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"C\",\"ts\":%" G_GINT64_FORMAT ",\"args\":{\"%s\":%" G_GINT64_FORMAT "},\"pid\":%d,\"tid\":1}",
+                          name, category, time, arg, value, (gint) getpid ());
+}
+
+
+
+static void
+thunar_profiler_record (GHashTable  *table,
+                        const gchar *category,
+                        const gchar *name,
+                        gint64       begin,
+                        gint64       duration)
+{
+  ThunarProfilerStats *stats;
+  guint                n;
+
+  stats = g_hash_table_lookup (table, name);
+  if (G_UNLIKELY (stats == NULL))
+    {
+      stats = g_new0 (ThunarProfilerStats, 1);
+      g_hash_table_insert (table, (gpointer) name, stats);
+    }
+
+  /* find the histogram bucket for the duration */
+  for (n = 0; n < G_N_ELEMENTS (bucket_limits); ++n)
+    if (duration < bucket_limits[n] * 1000)
+      break;
+
+  stats->buckets[n] += 1;
+  stats->n_events += 1;
+  stats->total += duration;
+  stats->max = MAX (stats->max, duration);
+
+  thunar_profiler_add_event (category, name, begin, duration);
+}
+
+
+
+static void
+thunar_profiler_close_window (const gchar           *name,
+                              ThunarProfilerCounter *counter)
+{
+  if (counter->window_emissions == 0)
+    return;
+
+  counter->max_emissions = MAX (counter->max_emissions, counter->window_emissions);
+  if (counter->window_emissions >= THUNAR_PROFILER_STORM_EMISSIONS)
+    counter->n_storms += 1;
+
+  thunar_profiler_add_counter ("signal", name, counter->window_begin, "emissions", counter->window_emissions);
+
+  counter->window_emissions = 0;
+}
+
+
+
+static void
+thunar_profiler_print_stats (gpointer key,
+                             gpointer value,
+                             gpointer user_data)
+{
+  ThunarProfilerStats *stats = value;
+  GString             *buckets;
+  guint                n;
+
+  buckets = g_string_new (NULL);
+  for (n = 0; n < G_N_ELEMENTS (stats->buckets); ++n)
+    {
+      if (n < G_N_ELEMENTS (bucket_limits))
+        g_string_append_printf (buckets, " <%d:%u", bucket_limits[n], stats->buckets[n]);
+      else
+        g_string_append_printf (buckets, " >=%d:%u", bucket_limits[n - 1], stats->buckets[n]);
+    }
+
+  g_printerr ("  %-40s %8u  avg %8.2f ms  max %8.2f ms\n    ms%s\n",
+              (const gchar *) key, stats->n_events,
+              stats->total / (stats->n_events * 1000.0),
+              stats->max / 1000.0, buckets->str);
+
+  g_string_free (buckets, TRUE);
+}
+
+
+
+static void
+thunar_profiler_print_counter (gpointer key,
+                               gpointer value,
+                               gpointer user_data)
+{
+  ThunarProfilerCounter *counter = value;
+
+  g_printerr ("  %-40s %8" G_GUINT64_FORMAT "  max %u per %d ms  %u storms\n",
+              (const gchar *) key, counter->n_emissions, counter->max_emissions,
+              THUNAR_PROFILER_STORM_WINDOW / 1000, counter->n_storms);
+}
+
+
+
+static void
+thunar_profiler_print_gauge (gpointer key,
+                             gpointer value,
+                             gpointer user_data)
+{
+  ThunarProfilerGauge *gauge = value;
+
+  g_printerr ("  %-40s %8" G_GINT64_FORMAT "  max %" G_GINT64_FORMAT "\n",
+              (const gchar *) key, gauge->last, gauge->max);
+}
+
+
+
+/**
+ * thunar_profiler_get_enabled:
+ *
+ * Returns %TRUE if profiling was requested with the
+ * THUNAR_PROFILE environment variable.
+ *
+ * Return value: %TRUE if the profiler is enabled.
+ **/
+gboolean
+thunar_profiler_get_enabled (void)
+{
+  if (G_UNLIKELY (profiler_mode == THUNAR_PROFILER_MODE_UNKNOWN))
+    thunar_profiler_init ();
+
+  return (profiler_mode != THUNAR_PROFILER_MODE_OFF);
+}
+
+
+
+/**
+ * thunar_profiler_begin:
+ *
+ * Starts timing a frame or callback, to be passed to
+ * thunar_profiler_end_frame() or thunar_profiler_end_callback().
+ *
+ * Return value: the current monotonic time, or 0 if the
+ *               profiler is disabled.
+ **/
+gint64
+thunar_profiler_begin (void)
+{
+  if (G_LIKELY (!thunar_profiler_get_enabled ()))
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+
+
+/**
+ * thunar_profiler_end_frame:
+ * @name  : static name of the drawn widget.
+ * @begin : the value returned from thunar_profiler_begin().
+ *
+ * Records the duration of a frame drawn by @name.
+ **/
+void
+thunar_profiler_end_frame (const gchar *name,
+                           gint64       begin)
+{
+  if (G_LIKELY (begin == 0))
+    return;
+
+  thunar_profiler_record (profiler_frames, "frame", name, begin, g_get_monotonic_time () - begin);
+}
+
+
+
+/**
+ * thunar_profiler_end_callback:
+ * @name  : static name of the main loop source.
+ * @begin : the value returned from thunar_profiler_begin().
+ *
+ * Records the main loop callback @name if it stalled the
+ * main loop for longer than the threshold.
+ **/
+void
+thunar_profiler_end_callback (const gchar *name,
+                              gint64       begin)
+{
+  gint64 duration;
+
+  if (G_LIKELY (begin == 0))
+    return;
+
+  duration = g_get_monotonic_time () - begin;
+  if (duration >= profiler_stall_threshold)
+    thunar_profiler_record (profiler_stalls, "stall", name, begin, duration);
+}
+
+
+
+/**
+ * thunar_profiler_end_latency:
+ * @name  : static name of the completed request.
+ * @begin : the value returned from thunar_profiler_begin()
+ *          when the request was made.
+ *
+ * Records the time between making the request @name and
+ * its result being available.
+ **/
+void
+thunar_profiler_end_latency (const gchar *name,
+                             gint64       begin)
+{
+  if (G_LIKELY (begin == 0))
+    return;
+
+  thunar_profiler_record (profiler_latencies, "latency", name, begin, g_get_monotonic_time () - begin);
+}
+
+
+
+/**
+ * thunar_profiler_count_signal:
+ * @name : static name of the emitted signal.
+ *
+ * Counts an emission of the signal @name, so storms of
+ * emissions in a short time show up in the profile. This
+ * may be connected swapped to a signal, with @name as data.
+ **/
+void
+thunar_profiler_count_signal (const gchar *name)
+{
+  ThunarProfilerCounter *counter;
+  gint64                 now;
+
+  if (G_LIKELY (!thunar_profiler_get_enabled ()))
+    return;
+
+  counter = g_hash_table_lookup (profiler_counters, name);
+  if (G_UNLIKELY (counter == NULL))
+    {
+      counter = g_new0 (ThunarProfilerCounter, 1);
+      g_hash_table_insert (profiler_counters, (gpointer) name, counter);
+    }
+
+  /* start a new window once the current one is over */
+  now = g_get_monotonic_time ();
+  if (now - counter->window_begin >= THUNAR_PROFILER_STORM_WINDOW)
+    {
+      thunar_profiler_close_window (name, counter);
+      counter->window_begin = now;
+    }
+
+  counter->window_emissions += 1;
+  counter->n_emissions += 1;
+}
+
+
+
+/**
+ * thunar_profiler_set_gauge:
+ * @name  : static name of the gauge.
+ * @value : the current value of the gauge.
+ *
+ * Records the current @value of the gauge @name. The profile
+ * shows the last and the largest value, the trace shows the
+ * value over time.
+ **/
+void
+thunar_profiler_set_gauge (const gchar *name,
+                           gint64       value)
+{
+  ThunarProfilerGauge *gauge;
+
+  if (G_LIKELY (!thunar_profiler_get_enabled ()))
+    return;
+
+  gauge = g_hash_table_lookup (profiler_gauges, name);
+  if (G_UNLIKELY (gauge == NULL))
+    {
+      gauge = g_new0 (ThunarProfilerGauge, 1);
+      g_hash_table_insert (profiler_gauges, (gpointer) name, gauge);
+    }
+
+  /* skip unchanged values, the trace only needs the steps */
+  if (gauge->last == value && gauge->max != 0)
+    return;
+
+  gauge->last = value;
+  gauge->max = MAX (gauge->max, value);
+
+  thunar_profiler_add_counter ("gauge", name, g_get_monotonic_time (), "value", value);
+}
+
+
+
+/**
+ * thunar_profiler_shutdown:
+ *
+ * Writes the collected profile, as selected with the
+ * THUNAR_PROFILE environment variable, and releases
+ * the profiler data.
+ **/
+void
+thunar_profiler_shutdown (void)
+{
+  GHashTableIter iter;
+  gpointer       key;
+  gpointer       value;
+  const gchar   *filename;
+  gchar         *path;
+  GError        *error = NULL;
+
+  if (G_LIKELY (!thunar_profiler_get_enabled ()))
+    return;
+
+  /* account for the emissions in the last windows */
+  g_hash_table_iter_init (&iter, profiler_counters);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    thunar_profiler_close_window (key, value);
+
+  if (profiler_mode == THUNAR_PROFILER_MODE_TRACE)
+    {
+      /* determine the trace file */
+      filename = g_getenv ("THUNAR_PROFILE_FILE");
+      if (filename != NULL && *filename != '\0')
+        path = g_strdup (filename);
+      else
+        path = g_strdup_printf ("%s/thunar-trace-%d.json", g_get_tmp_dir (), (gint) getpid ());
+
+      /* complete the json document */
+      g_string_prepend (profiler_trace, "{\"traceEvents\":[\n");
+      g_string_append (profiler_trace, "\n]}\n");
+
+      if (g_file_set_contents (path, profiler_trace->str, profiler_trace->len, &error))
+        {
+          g_printerr ("Thunar: Wrote %u trace events to %s", profiler_n_events, path);
+          if (G_UNLIKELY (profiler_n_dropped > 0))
+            g_printerr (" (%u events dropped)", profiler_n_dropped);
+          g_printerr ("\n");
+        }
+      else
+        {
+          g_printerr ("Thunar: Failed to write trace: %s\n", error->message);
+          g_error_free (error);
+        }
+
+      g_string_free (profiler_trace, TRUE);
+      profiler_trace = NULL;
+      g_free (path);
+    }
+  else
+    {
+      g_printerr ("Thunar profile\n");
+      g_printerr ("frames:\n");
+      g_hash_table_foreach (profiler_frames, thunar_profiler_print_stats, NULL);
+      g_printerr ("main loop stalls (>= %" G_GINT64_FORMAT " ms):\n", profiler_stall_threshold / 1000);
+      g_hash_table_foreach (profiler_stalls, thunar_profiler_print_stats, NULL);
+      g_printerr ("request latencies:\n");
+      g_hash_table_foreach (profiler_latencies, thunar_profiler_print_stats, NULL);
+      g_printerr ("signal emissions:\n");
+      g_hash_table_foreach (profiler_counters, thunar_profiler_print_counter, NULL);
+      g_printerr ("gauges:\n");
+      g_hash_table_foreach (profiler_gauges, thunar_profiler_print_gauge, NULL);
+    }
+
+  g_hash_table_destroy (profiler_frames);
+  g_hash_table_destroy (profiler_stalls);
+  g_hash_table_destroy (profiler_latencies);
+  g_hash_table_destroy (profiler_counters);
+  g_hash_table_destroy (profiler_gauges);
+
+  /* don't record anything after the dump */
+  profiler_mode = THUNAR_PROFILER_MODE_OFF;
+}
@@ -283,6 +283,19 @@ thunar_progress_dialog_job_finished (ThunarProgressDialog *dialog,
 
 
 
+static void
+thunar_progress_dialog_job_raised (ThunarProgressDialog *dialog,
+                                   ThunarProgressView   *view)
+{
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_DIALOG (dialog));
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+
+  /* show the operations in the order they will start */
+  gtk_box_reorder_child (GTK_BOX (dialog->content_box), GTK_WIDGET (view), 0);
+}
+
+
+
 static void
 thunar_progress_dialog_update_status_icon (ThunarProgressDialog *dialog)
 {
@@ -375,6 +388,9 @@ thunar_progress_dialog_add_job (ThunarProgressDialog *dialog,
   g_signal_connect_swapped (view, "finished",
                             G_CALLBACK (thunar_progress_dialog_job_finished), dialog);
 
+  g_signal_connect_swapped (view, "raised",
+                            G_CALLBACK (thunar_progress_dialog_job_raised), dialog);
+
   if (dialog->status_icon != NULL)
     thunar_progress_dialog_update_status_icon (dialog);
 }
@@ -28,6 +28,7 @@
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-pango-extensions.h>
+#include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-util.h>
 #include <thunar/thunar-transfer-job.h>
@@ -56,6 +57,9 @@ static void              thunar_progress_view_set_property (GObject            *
                                                             const GValue       *value,
                                                             GParamSpec         *pspec);
 static void              thunar_progress_view_cancel_job   (ThunarProgressView *view);
+static void              thunar_progress_view_pause_job    (ThunarProgressView *view,
+                                                            GtkToggleButton    *button);
+static void              thunar_progress_view_raise_job    (ThunarProgressView *view);
 static ThunarJobResponse thunar_progress_view_ask          (ThunarProgressView *view,
                                                             const gchar        *message,
                                                             ThunarJobResponse   choices,
@@ -75,6 +79,7 @@ static void              thunar_progress_view_info_message (ThunarProgressView *
 static void              thunar_progress_view_percent      (ThunarProgressView *view,
                                                             gdouble             percent,
                                                             ExoJob             *job);
+static void              thunar_progress_view_update_stats (ThunarProgressView *view);
 static ThunarJob        *thunar_progress_view_get_job      (ThunarProgressView *view);
 static void              thunar_progress_view_set_job      (ThunarProgressView *view,
                                                             ThunarJob          *job);
@@ -95,6 +100,7 @@ struct _ThunarProgressView
   GtkWidget *progress_bar;
   GtkWidget *progress_label;
   GtkWidget *message_label;
+  GtkWidget *stats_label;
 
   gchar     *icon_name;
   gchar     *title;
@@ -164,6 +170,16 @@ thunar_progress_view_class_init (ThunarProgressViewClass *klass)
                 g_cclosure_marshal_VOID__VOID,
                 G_TYPE_NONE,
                 0);
+
+  g_signal_new ("raised",
+                THUNAR_TYPE_PROGRESS_VIEW,
+                G_SIGNAL_RUN_LAST | G_SIGNAL_NO_HOOKS,
+                0,
+                NULL,
+                NULL,
+                g_cclosure_marshal_VOID__VOID,
+                G_TYPE_NONE,
+                0);
 }
 
 
@@ -171,13 +187,15 @@ thunar_progress_view_class_init (ThunarProgressViewClass *klass)
 static void
 thunar_progress_view_init (ThunarProgressView *view)
 {
-  GtkWidget *image;
-  GtkWidget *label;
-  GtkWidget *button;
-  GtkWidget *vbox;
-  GtkWidget *vbox2;
-  GtkWidget *vbox3;
-  GtkWidget *hbox;
+  ThunarPreferences *preferences;
+  GtkWidget         *image;
+  GtkWidget         *label;
+  GtkWidget         *button;
+  GtkWidget         *vbox;
+  GtkWidget         *vbox2;
+  GtkWidget         *vbox3;
+  GtkWidget         *hbox;
+  gboolean           show_stats;
 
   vbox = gtk_vbox_new (FALSE, 6);
   gtk_container_add (GTK_CONTAINER (view), vbox);
@@ -225,6 +243,41 @@ thunar_progress_view_init (ThunarProgressView *view)
   gtk_box_pack_start (GTK_BOX (vbox3), view->progress_label, FALSE, TRUE, 0);
   gtk_widget_show (view->progress_label);
 
+  /* the statistics are for people debugging slow operations */
+  preferences = thunar_preferences_get ();
+  g_object_get (G_OBJECT (preferences), "misc-show-job-statistics", &show_stats, NULL);
+  g_object_unref (preferences);
+  if (G_UNLIKELY (show_stats))
+    {
+      view->stats_label = g_object_new (GTK_TYPE_LABEL, "xalign", 0.0f, NULL);
+      gtk_label_set_ellipsize (GTK_LABEL (view->stats_label), PANGO_ELLIPSIZE_END);
+      gtk_label_set_attributes (GTK_LABEL (view->stats_label), thunar_pango_attr_list_small ());
+      gtk_box_pack_start (GTK_BOX (vbox3), view->stats_label, FALSE, TRUE, 0);
+      gtk_widget_show (view->stats_label);
+    }
+
+  button = gtk_button_new ();
+  gtk_widget_set_tooltip_text (button, _("Start before the other operations"));
+  g_signal_connect_swapped (button, "clicked", G_CALLBACK (thunar_progress_view_raise_job), view);
+  gtk_box_pack_start (GTK_BOX (hbox), button, FALSE, TRUE, 0);
+  gtk_widget_set_can_focus (button, FALSE);
+  gtk_widget_show (button);
+
+  image = gtk_image_new_from_stock (GTK_STOCK_GOTO_TOP, GTK_ICON_SIZE_BUTTON);
+  gtk_container_add (GTK_CONTAINER (button), image);
+  gtk_widget_show (image);
+
+  button = gtk_toggle_button_new ();
+  gtk_widget_set_tooltip_text (button, _("Pause"));
+  g_signal_connect_swapped (button, "toggled", G_CALLBACK (thunar_progress_view_pause_job), view);
+  gtk_box_pack_start (GTK_BOX (hbox), button, FALSE, TRUE, 0);
+  gtk_widget_set_can_focus (button, FALSE);
+  gtk_widget_show (button);
+
+  image = gtk_image_new_from_stock (GTK_STOCK_MEDIA_PAUSE, GTK_ICON_SIZE_BUTTON);
+  gtk_container_add (GTK_CONTAINER (button), image);
+  gtk_widget_show (image);
+
   button = gtk_button_new ();
   g_signal_connect_swapped (button, "clicked", G_CALLBACK (thunar_progress_view_cancel_job), view);
   gtk_box_pack_start (GTK_BOX (hbox), button, FALSE, TRUE, 0);
@@ -357,6 +410,45 @@ thunar_progress_view_cancel_job (ThunarProgressView *view)
 
 
 
+static void
+thunar_progress_view_pause_job (ThunarProgressView *view,
+                                GtkToggleButton    *button)
+{
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+  _thunar_return_if_fail (GTK_IS_TOGGLE_BUTTON (button));
+
+  if (view->job != NULL)
+    {
+      /* the job stops at its next step, or does not start at all */
+      thunar_job_set_paused (view->job, gtk_toggle_button_get_active (button));
+
+      /* update the status text, the job will overwrite it once resumed */
+      if (gtk_toggle_button_get_active (button))
+        gtk_label_set_text (GTK_LABEL (view->progress_label), _("Paused"));
+      else
+        gtk_label_set_text (GTK_LABEL (view->progress_label), "");
+    }
+}
+
+
+
+static void
+thunar_progress_view_raise_job (ThunarProgressView *view)
+{
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+
+  if (view->job != NULL)
+    {
+      /* let the job start next on its devices */
+      thunar_job_raise (view->job);
+
+      /* let the dialog move the view up */
+      g_signal_emit_by_name (view, "raised");
+    }
+}
+
+
+
 static ThunarJobResponse
 thunar_progress_view_ask (ThunarProgressView *view,
                           const gchar        *message,
@@ -485,6 +577,68 @@ thunar_progress_view_percent (ThunarProgressView *view,
       gtk_label_set_text (GTK_LABEL (view->progress_label), text);
       g_free (text);
     }
+
+  if (G_UNLIKELY (view->stats_label != NULL))
+    thunar_progress_view_update_stats (view);
+}
+
+
+
+static void
+thunar_progress_view_update_stats (ThunarProgressView *view)
+{
+  ThunarJobStats *stats;
+  GString        *tooltip;
+  gchar          *size_string;
+  gchar          *text;
+  guint           n;
+
+  _thunar_return_if_fail (THUNAR_IS_PROGRESS_VIEW (view));
+  _thunar_return_if_fail (THUNAR_IS_JOB (view->job));
+
+  stats = thunar_job_get_stats (view->job);
+
+  /* throughput and where the time went */
+  size_string = g_format_size ((guint64) thunar_job_stats_bytes_rate (stats));
+  text = g_strdup_printf (_("%s/s, %.1f files/s (queued %.1fs, collecting %.1fs, "
+                            "processing %.1fs, paused %.1fs)"),
+                          size_string, thunar_job_stats_files_rate (stats),
+                          stats->phase_times[THUNAR_JOB_PHASE_QUEUED] / (gdouble) G_USEC_PER_SEC,
+                          stats->phase_times[THUNAR_JOB_PHASE_COLLECTING] / (gdouble) G_USEC_PER_SEC,
+                          stats->phase_times[THUNAR_JOB_PHASE_PROCESSING] / (gdouble) G_USEC_PER_SEC,
+                          stats->phase_times[THUNAR_JOB_PHASE_PAUSED] / (gdouble) G_USEC_PER_SEC);
+  gtk_label_set_text (GTK_LABEL (view->stats_label), text);
+  g_free (size_string);
+  g_free (text);
+
+  /* the latency histogram and the slowest files */
+  tooltip = g_string_new (_("Files by latency:"));
+  for (n = 0; n < THUNAR_JOB_STATS_N_LATENCIES; ++n)
+    {
+      if (stats->latencies[n] == 0)
+        continue;
+
+      if (n == 0)
+        g_string_append_printf (tooltip, "\n  < 1 ms: %u", stats->latencies[n]);
+      else if (n < THUNAR_JOB_STATS_N_LATENCIES - 1)
+        g_string_append_printf (tooltip, "\n  < %u ms: %u", 1u << n, stats->latencies[n]);
+      else
+        g_string_append_printf (tooltip, "\n  >= %u ms: %u", 1u << (n - 1), stats->latencies[n]);
+    }
+
+  if (stats->slowest_files[0] != NULL)
+    g_string_append_printf (tooltip, "\n%s", _("Slowest files:"));
+  for (n = 0; n < THUNAR_JOB_STATS_N_SLOWEST && stats->slowest_files[n] != NULL; ++n)
+    {
+      g_string_append_printf (tooltip, "\n  %.1f ms %s",
+                              stats->slowest_times[n] / 1000.0,
+                              stats->slowest_files[n]);
+    }
+
+  gtk_widget_set_tooltip_text (view->stats_label, tooltip->str);
+  g_string_free (tooltip, TRUE);
+
+  thunar_job_stats_free (stats);
 }
 
 
@@ -116,7 +116,13 @@ thunar_simple_job_execute (ExoJob  *job,
   _thunar_return_val_if_fail (simple_job->func != NULL, FALSE);
 
   /* try to execute the job using the supplied function */
+  thunar_job_set_phase (THUNAR_JOB (job), THUNAR_JOB_PHASE_COLLECTING);
   success = (*simple_job->func) (THUNAR_JOB (job), simple_job->param_values, &err);
+  thunar_job_set_phase (THUNAR_JOB (job), THUNAR_JOB_PHASE_IDLE);
+
+  /* let the next job on the same devices start, if the
+   * function waited for them */
+  thunar_job_unschedule (THUNAR_JOB (job));
 
   if (!success)
     {
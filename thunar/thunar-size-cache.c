@@ -0,0 +1,784 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-size-cache.h>
+
+
+
+/**
+ * ThunarSizeCache remembers the contents of the directories counted
+ * by the #ThunarDeepCountJob, so a re-count only needs to enumerate
+ * the directories whose modification time changed since.
+ *
+ * Each entry holds the size of the files directly inside a directory
+ * and the names of its subdirectories, and optionally the total size
+ * of the last count that started at the directory, which is what the
+ * details view shows for folders.
+ *
+ * The workers of the count jobs use the cache concurrently, so all
+ * access is serialized by a lock. The entries are loaded from and
+ * written to the user's cache directory, the writes happen in a
+ * thread of their own; the least recently used entries are dropped
+ * once there are more than THUNAR_SIZE_CACHE_MAX_ENTRIES of them.
+ *
+ * The modification times are in microseconds, see
+ * thunar_size_cache_get_mtime(), so a directory changed twice in the
+ * same second is not taken for unchanged.
+ **/
+
+
+
+/* maximum number of directories kept in the cache file */
+#define THUNAR_SIZE_CACHE_MAX_ENTRIES (50000)
+
+/* seconds after the last change before the cache is written */
+#define THUNAR_SIZE_CACHE_SAVE_DELAY (10)
+
+/* serialized type of the cache file */
+#define THUNAR_SIZE_CACHE_VARIANT_TYPE "a(stttuastx)"
+
+/* total size of entries without a count started at the directory */
+#define THUNAR_SIZE_CACHE_NO_TOTAL G_MAXUINT64
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _size_cache_lock(cache)   g_mutex_lock (&((cache)->lock))
+#define _size_cache_unlock(cache) g_mutex_unlock (&((cache)->lock))
+#else
+#define _size_cache_lock(cache)   g_mutex_lock ((cache)->lock)
+#define _size_cache_unlock(cache) g_mutex_unlock ((cache)->lock)
+#endif
+
+
+
+/* Signal identifiers */
+enum
+{
+  TOTAL_CHANGED,
+  LAST_SIGNAL,
+};
+
+
+
+typedef struct _ThunarSizeCacheEntry ThunarSizeCacheEntry;
+typedef struct _ThunarSizeCacheTotal ThunarSizeCacheTotal;
+
+
+
+static void     thunar_size_cache_finalize    (GObject         *object);
+static void     thunar_size_cache_loaded      (GObject         *object,
+                                               GAsyncResult    *result,
+                                               gpointer         user_data);
+static gboolean thunar_size_cache_save_timer  (gpointer         user_data);
+static void     thunar_size_cache_save_thread (gpointer         data,
+                                               gpointer         user_data);
+static void     thunar_size_cache_entry_free  (gpointer         data);
+
+
+
+struct _ThunarSizeCacheClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarSizeCache
+{
+  GObject      __parent__;
+
+  /* location of the cache file */
+  GFile       *file;
+
+  /* directory uri to its ThunarSizeCacheEntry */
+  GHashTable  *entries;
+
+  /* source to write the changed cache */
+  guint        save_timer_id;
+
+  /* single thread that writes the cache file */
+  GThreadPool *save_pool;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex       lock;
+#else
+  GMutex      *lock;
+#endif
+};
+
+struct _ThunarSizeCacheEntry
+{
+  /* uri of the directory, the key of the entry */
+  gchar   *uri;
+
+  /* modification time of the directory when it was counted */
+  guint64  mtime;
+
+  /* the files directly inside the directory */
+  guint64  size;
+  guint64  allocated_size;
+  guint    file_count;
+
+  /* names of the subdirectories */
+  gchar  **subdirectories;
+
+  /* total size of the last count started at this directory */
+  guint64  total_size;
+
+  /* real time in seconds when the entry was last used */
+  gint64   last_used;
+};
+
+struct _ThunarSizeCacheTotal
+{
+  ThunarSizeCache *cache;
+  GFile           *directory;
+};
+
+
+
+static guint size_cache_signals[LAST_SIGNAL];
+
+
+
+G_DEFINE_TYPE (ThunarSizeCache, thunar_size_cache, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_size_cache_class_init (ThunarSizeCacheClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_size_cache_finalize;
+
+  /**
+   * ThunarSizeCache::total-changed:
+   * @cache     : a #ThunarSizeCache.
+   * @directory : the #GFile of the directory.
+   *
+   * Emitted in the main loop when a count that started at
+   * @directory is done and its total size was remembered.
+   **/
+  size_cache_signals[TOTAL_CHANGED] =
+    g_signal_new (I_("total-changed"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__OBJECT,
+                  G_TYPE_NONE, 1, G_TYPE_FILE);
+}
+
+
+
+static void
+thunar_size_cache_init (ThunarSizeCache *cache)
+{
+  gchar *path;
+
+  cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                          thunar_size_cache_entry_free);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&cache->lock);
+#else
+  cache->lock = g_mutex_new ();
+#endif
+
+  /* write the cache file off the main loop, one write at a time */
+  cache->save_pool = g_thread_pool_new (thunar_size_cache_save_thread, cache,
+                                        1, FALSE, NULL);
+
+  path = xfce_resource_save_location (XFCE_RESOURCE_CACHE, "Thunar/folder-sizes", TRUE);
+  if (G_LIKELY (path != NULL))
+    {
+      cache->file = g_file_new_for_path (path);
+      g_free (path);
+
+      /* load the entries of the last sessions without blocking, the
+       * cache keeps itself alive until they're merged */
+      g_file_load_contents_async (cache->file, NULL, thunar_size_cache_loaded,
+                                  g_object_ref (cache));
+    }
+}
+
+
+
+static void
+thunar_size_cache_entry_free (gpointer data)
+{
+  ThunarSizeCacheEntry *entry = data;
+
+  g_free (entry->uri);
+  g_strfreev (entry->subdirectories);
+  g_slice_free (ThunarSizeCacheEntry, entry);
+}
+
+
+
+static gint
+thunar_size_cache_compare_last_used (gconstpointer a,
+                                     gconstpointer b)
+{
+  const ThunarSizeCacheEntry *entry_a = *((ThunarSizeCacheEntry **) a);
+  const ThunarSizeCacheEntry *entry_b = *((ThunarSizeCacheEntry **) b);
+
+  /* most recently used first */
+  if (entry_a->last_used != entry_b->last_used)
+    return (entry_a->last_used > entry_b->last_used) ? -1 : 1;
+
+  return 0;
+}
+
+
+
+/* returns the entries sorted by the time they were last used, the
+ * most recent first. must be called with the lock held */
+static GPtrArray *
+thunar_size_cache_sorted_entries (ThunarSizeCache *cache)
+{
+  GHashTableIter iter;
+  GPtrArray     *entries;
+  gpointer       entry;
+
+  entries = g_ptr_array_sized_new (g_hash_table_size (cache->entries));
+
+  g_hash_table_iter_init (&iter, cache->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &entry))
+    g_ptr_array_add (entries, entry);
+
+  g_ptr_array_sort (entries, thunar_size_cache_compare_last_used);
+
+  return entries;
+}
+
+
+
+/* drops the least recently used entries, must be called with the lock held */
+static void
+thunar_size_cache_prune (ThunarSizeCache *cache)
+{
+  ThunarSizeCacheEntry *entry;
+  GPtrArray            *entries;
+  guint                 n;
+
+  entries = thunar_size_cache_sorted_entries (cache);
+
+  for (n = THUNAR_SIZE_CACHE_MAX_ENTRIES; n < entries->len; ++n)
+    {
+      entry = g_ptr_array_index (entries, n);
+      g_hash_table_remove (cache->entries, entry->uri);
+    }
+
+  g_ptr_array_free (entries, TRUE);
+}
+
+
+
+/* writes the cache file, called from the save thread and
+ * when the cache is finalized */
+static void
+thunar_size_cache_save (ThunarSizeCache *cache)
+{
+  ThunarSizeCacheEntry *entry;
+  GVariantBuilder       builder;
+  GHashTableIter        iter;
+  GPtrArray            *entries;
+  GVariant             *variant;
+  gpointer              data;
+  gchar                *path;
+  guint                 n;
+
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+
+  if (G_UNLIKELY (cache->file == NULL))
+    return;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (THUNAR_SIZE_CACHE_VARIANT_TYPE));
+
+  /* take a copy of the entries, the file is written without the lock */
+  _size_cache_lock (cache);
+
+  /* only write the most recently used entries, the sorting
+   * is only needed if there are too many of them */
+  if (g_hash_table_size (cache->entries) > THUNAR_SIZE_CACHE_MAX_ENTRIES)
+    {
+      entries = thunar_size_cache_sorted_entries (cache);
+    }
+  else
+    {
+      entries = g_ptr_array_sized_new (g_hash_table_size (cache->entries));
+      g_hash_table_iter_init (&iter, cache->entries);
+      while (g_hash_table_iter_next (&iter, NULL, &data))
+        g_ptr_array_add (entries, data);
+    }
+
+  for (n = 0; n < entries->len && n < THUNAR_SIZE_CACHE_MAX_ENTRIES; ++n)
+    {
+      entry = g_ptr_array_index (entries, n);
+      g_variant_builder_add (&builder, "(stttu^astx)",
+                             entry->uri, entry->mtime,
+                             entry->size, entry->allocated_size,
+                             entry->file_count, entry->subdirectories,
+                             entry->total_size, entry->last_used);
+    }
+  g_ptr_array_free (entries, TRUE);
+
+  variant = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  _size_cache_unlock (cache);
+
+  /* write the cache atomically */
+  path = g_file_get_path (cache->file);
+  g_file_set_contents (path, g_variant_get_data (variant),
+                       g_variant_get_size (variant), NULL);
+  g_free (path);
+
+  g_variant_unref (variant);
+}
+
+
+
+static void
+thunar_size_cache_finalize (GObject *object)
+{
+  ThunarSizeCache *cache = THUNAR_SIZE_CACHE (object);
+
+  /* finish the running write */
+  g_thread_pool_free (cache->save_pool, FALSE, TRUE);
+
+  /* write pending changes */
+  if (cache->save_timer_id != 0)
+    {
+      g_source_remove (cache->save_timer_id);
+      thunar_size_cache_save (cache);
+    }
+
+  g_hash_table_destroy (cache->entries);
+
+  if (cache->file != NULL)
+    g_object_unref (cache->file);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&cache->lock);
+#else
+  g_mutex_free (cache->lock);
+#endif
+
+  (*G_OBJECT_CLASS (thunar_size_cache_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_size_cache_loaded (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  ThunarSizeCacheEntry *entry;
+  ThunarSizeCache      *cache = THUNAR_SIZE_CACHE (user_data);
+  GVariantIter          iter;
+  GVariant             *variant;
+  gchar                *contents;
+  gsize                 length;
+  gchar                *uri;
+
+  if (g_file_load_contents_finish (G_FILE (object), result, &contents, &length, NULL, NULL))
+    {
+      variant = g_variant_new_from_data (G_VARIANT_TYPE (THUNAR_SIZE_CACHE_VARIANT_TYPE),
+                                         contents, length, FALSE, g_free, contents);
+      g_variant_ref_sink (variant);
+
+      _size_cache_lock (cache);
+
+      g_variant_iter_init (&iter, variant);
+      for (;;)
+        {
+          entry = g_slice_new0 (ThunarSizeCacheEntry);
+          if (!g_variant_iter_next (&iter, "(stttu^astx)",
+                                    &uri, &entry->mtime,
+                                    &entry->size, &entry->allocated_size,
+                                    &entry->file_count, &entry->subdirectories,
+                                    &entry->total_size, &entry->last_used))
+            {
+              g_slice_free (ThunarSizeCacheEntry, entry);
+              break;
+            }
+
+          entry->uri = uri;
+
+          /* entries counted in this session are more recent */
+          if (g_hash_table_lookup (cache->entries, entry->uri) == NULL)
+            g_hash_table_insert (cache->entries, entry->uri, entry);
+          else
+            thunar_size_cache_entry_free (entry);
+        }
+
+      _size_cache_unlock (cache);
+
+      g_variant_unref (variant);
+    }
+
+  /* release the reference taken for the load */
+  g_object_unref (cache);
+}
+
+
+
+static gboolean
+thunar_size_cache_save_timer (gpointer user_data)
+{
+  ThunarSizeCache *cache = THUNAR_SIZE_CACHE (user_data);
+
+  _size_cache_lock (cache);
+  cache->save_timer_id = 0;
+  _size_cache_unlock (cache);
+
+  /* sorting and writing the entries takes a while */
+  g_thread_pool_push (cache->save_pool, cache, NULL);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_size_cache_save_thread (gpointer data,
+                               gpointer user_data)
+{
+  thunar_size_cache_save (THUNAR_SIZE_CACHE (user_data));
+}
+
+
+
+static gboolean
+thunar_size_cache_total_idle (gpointer user_data)
+{
+  ThunarSizeCacheTotal *total = user_data;
+
+  g_signal_emit (G_OBJECT (total->cache), size_cache_signals[TOTAL_CHANGED], 0, total->directory);
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_size_cache_total_free (gpointer user_data)
+{
+  ThunarSizeCacheTotal *total = user_data;
+
+  g_object_unref (total->cache);
+  g_object_unref (total->directory);
+  g_slice_free (ThunarSizeCacheTotal, total);
+}
+
+
+
+/* schedules a write of the cache file, must be called with the lock held */
+static void
+thunar_size_cache_schedule_save (ThunarSizeCache *cache)
+{
+  if (cache->save_timer_id == 0)
+    {
+      cache->save_timer_id = g_timeout_add_seconds (THUNAR_SIZE_CACHE_SAVE_DELAY,
+                                                    thunar_size_cache_save_timer,
+                                                    cache);
+    }
+}
+
+
+
+/**
+ * thunar_size_cache_get:
+ *
+ * Returns the shared #ThunarSizeCache.
+ *
+ * The caller is responsible to free the returned
+ * object using g_object_unref() when no longer needed.
+ *
+ * Return value: a #ThunarSizeCache.
+ **/
+ThunarSizeCache*
+thunar_size_cache_get (void)
+{
+  static ThunarSizeCache *cache = NULL;
+
+  if (G_UNLIKELY (cache == NULL))
+    {
+      cache = g_object_new (THUNAR_TYPE_SIZE_CACHE, NULL);
+      g_object_add_weak_pointer (G_OBJECT (cache), (gpointer) &cache);
+    }
+  else
+    {
+      g_object_ref (G_OBJECT (cache));
+    }
+
+  return cache;
+}
+
+
+
+/**
+ * thunar_size_cache_get_mtime:
+ * @info : the #GFileInfo of a directory.
+ *
+ * Returns the modification time of @info in microseconds, as it
+ * is passed to the other functions of the #ThunarSizeCache. @info
+ * should have the %G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC attribute.
+ *
+ * Return value: the modification time of @info.
+ **/
+guint64
+thunar_size_cache_get_mtime (GFileInfo *info)
+{
+  _thunar_return_val_if_fail (G_IS_FILE_INFO (info), 0);
+
+  return g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+         + g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+}
+
+
+
+/**
+ * thunar_size_cache_lookup:
+ * @cache          : a #ThunarSizeCache.
+ * @directory      : the #GFile of a directory.
+ * @mtime          : the current modification time of @directory.
+ * @size           : return location for the size of the files in @directory.
+ * @allocated_size : return location for the allocated size of the files.
+ * @file_count     : return location for the number of files.
+ * @subdirectories : return location for the names of the subdirectories,
+ *                   free with g_strfreev().
+ *
+ * Looks up the contents of @directory, not including its subdirectories,
+ * as they were when @directory had the modification time @mtime.
+ *
+ * This function may be called from any thread.
+ *
+ * Return value: %TRUE if @directory is cached and unchanged.
+ **/
+gboolean
+thunar_size_cache_lookup (ThunarSizeCache *cache,
+                          GFile           *directory,
+                          guint64          mtime,
+                          guint64         *size,
+                          guint64         *allocated_size,
+                          guint           *file_count,
+                          gchar         ***subdirectories)
+{
+  ThunarSizeCacheEntry *entry;
+  gchar                *uri;
+
+  _thunar_return_val_if_fail (THUNAR_IS_SIZE_CACHE (cache), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (directory), FALSE);
+
+  uri = g_file_get_uri (directory);
+
+  _size_cache_lock (cache);
+
+  entry = g_hash_table_lookup (cache->entries, uri);
+  if (entry != NULL && entry->mtime == mtime)
+    {
+      *size = entry->size;
+      *allocated_size = entry->allocated_size;
+      *file_count = entry->file_count;
+      *subdirectories = g_strdupv (entry->subdirectories);
+
+      entry->last_used = g_get_real_time () / G_USEC_PER_SEC;
+    }
+  else
+    {
+      entry = NULL;
+    }
+
+  _size_cache_unlock (cache);
+
+  g_free (uri);
+
+  return (entry != NULL);
+}
+
+
+
+/**
+ * thunar_size_cache_insert:
+ * @cache          : a #ThunarSizeCache.
+ * @directory      : the #GFile of a directory.
+ * @mtime          : the modification time of @directory when it was read.
+ * @size           : the size of the files in @directory.
+ * @allocated_size : the allocated size of the files in @directory.
+ * @file_count     : the number of files in @directory.
+ * @subdirectories : the names of the subdirectories, the cache takes
+ *                   ownership of the array.
+ *
+ * Remembers the contents of @directory, not including its subdirectories.
+ *
+ * This function may be called from any thread.
+ **/
+void
+thunar_size_cache_insert (ThunarSizeCache *cache,
+                          GFile           *directory,
+                          guint64          mtime,
+                          guint64          size,
+                          guint64          allocated_size,
+                          guint            file_count,
+                          gchar          **subdirectories)
+{
+  ThunarSizeCacheEntry *entry;
+  ThunarSizeCacheEntry *old_entry;
+
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+  _thunar_return_if_fail (G_IS_FILE (directory));
+  _thunar_return_if_fail (subdirectories != NULL);
+
+  entry = g_slice_new (ThunarSizeCacheEntry);
+  entry->uri = g_file_get_uri (directory);
+  entry->mtime = mtime;
+  entry->size = size;
+  entry->allocated_size = allocated_size;
+  entry->file_count = file_count;
+  entry->subdirectories = subdirectories;
+  entry->total_size = THUNAR_SIZE_CACHE_NO_TOTAL;
+  entry->last_used = g_get_real_time () / G_USEC_PER_SEC;
+
+  _size_cache_lock (cache);
+
+  /* keep the total of the last count until a new one is set, as
+   * long as the directory itself is unchanged */
+  old_entry = g_hash_table_lookup (cache->entries, entry->uri);
+  if (old_entry != NULL && old_entry->mtime == mtime)
+    entry->total_size = old_entry->total_size;
+
+  g_hash_table_replace (cache->entries, entry->uri, entry);
+
+  /* prune the cache once it is clearly too large */
+  if (g_hash_table_size (cache->entries) > 2 * THUNAR_SIZE_CACHE_MAX_ENTRIES)
+    thunar_size_cache_prune (cache);
+
+  thunar_size_cache_schedule_save (cache);
+
+  _size_cache_unlock (cache);
+}
+
+
+
+/**
+ * thunar_size_cache_get_total:
+ * @cache      : a #ThunarSizeCache.
+ * @directory  : the #GFile of a directory.
+ * @mtime      : the current modification time of @directory.
+ * @total_size : return location for the total size.
+ *
+ * Looks up the total size of the last count that started at
+ * @directory, if @directory was not modified since. This only
+ * looks at memory, so it can be used while drawing.
+ *
+ * Return value: %TRUE if a total size is known.
+ **/
+gboolean
+thunar_size_cache_get_total (ThunarSizeCache *cache,
+                             GFile           *directory,
+                             guint64          mtime,
+                             guint64         *total_size)
+{
+  ThunarSizeCacheEntry *entry;
+  gboolean              found = FALSE;
+  gchar                *uri;
+
+  _thunar_return_val_if_fail (THUNAR_IS_SIZE_CACHE (cache), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (directory), FALSE);
+
+  uri = g_file_get_uri (directory);
+
+  _size_cache_lock (cache);
+
+  entry = g_hash_table_lookup (cache->entries, uri);
+  if (entry != NULL
+      && entry->mtime == mtime
+      && entry->total_size != THUNAR_SIZE_CACHE_NO_TOTAL)
+    {
+      *total_size = entry->total_size;
+      found = TRUE;
+    }
+
+  _size_cache_unlock (cache);
+
+  g_free (uri);
+
+  return found;
+}
+
+
+
+/**
+ * thunar_size_cache_set_total:
+ * @cache      : a #ThunarSizeCache.
+ * @directory  : the #GFile of a directory.
+ * @total_size : the total size of @directory and its subdirectories.
+ *
+ * Remembers the result of a count that started at @directory. The
+ * contents of @directory must have been inserted before. The
+ * "total-changed" signal is emitted in the main loop afterwards.
+ *
+ * This function may be called from any thread.
+ **/
+void
+thunar_size_cache_set_total (ThunarSizeCache *cache,
+                             GFile           *directory,
+                             guint64          total_size)
+{
+  ThunarSizeCacheEntry *entry;
+  ThunarSizeCacheTotal *total;
+  gchar                *uri;
+
+  _thunar_return_if_fail (THUNAR_IS_SIZE_CACHE (cache));
+  _thunar_return_if_fail (G_IS_FILE (directory));
+
+  uri = g_file_get_uri (directory);
+
+  _size_cache_lock (cache);
+
+  entry = g_hash_table_lookup (cache->entries, uri);
+  if (G_LIKELY (entry != NULL))
+    {
+      entry->total_size = total_size;
+      thunar_size_cache_schedule_save (cache);
+    }
+
+  _size_cache_unlock (cache);
+
+  g_free (uri);
+
+  if (G_LIKELY (entry != NULL))
+    {
+      /* let the views update the directory */
+      total = g_slice_new (ThunarSizeCacheTotal);
+      total->cache = g_object_ref (cache);
+      total->directory = g_object_ref (directory);
+      g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, thunar_size_cache_total_idle,
+                       total, thunar_size_cache_total_free);
+    }
+}
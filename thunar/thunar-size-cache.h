@@ -0,0 +1,69 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_SIZE_CACHE_H__
+#define __THUNAR_SIZE_CACHE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarSizeCacheClass ThunarSizeCacheClass;
+typedef struct _ThunarSizeCache      ThunarSizeCache;
+
+#define THUNAR_TYPE_SIZE_CACHE            (thunar_size_cache_get_type ())
+#define THUNAR_SIZE_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_SIZE_CACHE, ThunarSizeCache))
+#define THUNAR_SIZE_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_SIZE_CACHE, ThunarSizeCacheClass))
+#define THUNAR_IS_SIZE_CACHE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_SIZE_CACHE))
+#define THUNAR_IS_SIZE_CACHE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_SIZE_CACHE))
+#define THUNAR_SIZE_CACHE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_SIZE_CACHE, ThunarSizeCacheClass))
+
+GType            thunar_size_cache_get_type  (void) G_GNUC_CONST;
+
+ThunarSizeCache *thunar_size_cache_get       (void) G_GNUC_MALLOC;
+
+guint64          thunar_size_cache_get_mtime (GFileInfo       *info);
+
+gboolean         thunar_size_cache_lookup    (ThunarSizeCache *cache,
+                                              GFile           *directory,
+                                              guint64          mtime,
+                                              guint64         *size,
+                                              guint64         *allocated_size,
+                                              guint           *file_count,
+                                              gchar         ***subdirectories);
+void             thunar_size_cache_insert    (ThunarSizeCache *cache,
+                                              GFile           *directory,
+                                              guint64          mtime,
+                                              guint64          size,
+                                              guint64          allocated_size,
+                                              guint            file_count,
+                                              gchar          **subdirectories);
+
+gboolean         thunar_size_cache_get_total (ThunarSizeCache *cache,
+                                              GFile           *directory,
+                                              guint64          mtime,
+                                              guint64         *total_size);
+void             thunar_size_cache_set_total (ThunarSizeCache *cache,
+                                              GFile           *directory,
+                                              guint64          total_size);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_SIZE_CACHE_H__ */
@@ -29,6 +29,9 @@
 #ifdef HAVE_LOCALE_H
 #include <locale.h>
 #endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
 
 #include <thunar/thunar-gtk-extensions.h>
 #include <thunar/thunar-private.h>
@@ -66,6 +69,7 @@ static void     thunar_size_label_finished              (ExoJob               *j
                                                          ThunarSizeLabel      *size_label);
 static void     thunar_size_label_status_update         (ThunarDeepCountJob   *job,
                                                          guint64               total_size,
+                                                         guint64               allocated_size,
                                                          guint                 file_count,
                                                          guint                 directory_count,
                                                          guint                 unreadable_directory_count,
@@ -354,12 +358,14 @@ thunar_size_label_finished (ExoJob          *job,
 static void
 thunar_size_label_status_update (ThunarDeepCountJob *job,
                                  guint64             total_size,
+                                 guint64             allocated_size,
                                  guint               file_count,
                                  guint               directory_count,
                                  guint               unreadable_directory_count,
                                  ThunarSizeLabel    *size_label)
 {
   gchar *size_string;
+  gchar *allocated_string;
   gchar *text;
   guint  n;
   gchar *unreable_text;
@@ -375,8 +381,22 @@ thunar_size_label_status_update (ThunarDeepCountJob *job,
     {
       /* update the label */
       size_string = g_format_size (total_size);
-      text = g_strdup_printf (ngettext ("%u item, totalling %s", "%u items, totalling %s", n), n, size_string);
+      allocated_string = g_format_size (allocated_size);
+
+      /* mention the size on disk if it differs, e.g. for sparse or compressed files */
+      if (allocated_size > 0 && strcmp (size_string, allocated_string) != 0)
+        {
+          text = g_strdup_printf (ngettext ("%u item, totalling %s (%s on disk)",
+                                            "%u items, totalling %s (%s on disk)", n),
+                                  n, size_string, allocated_string);
+        }
+      else
+        {
+          text = g_strdup_printf (ngettext ("%u item, totalling %s", "%u items, totalling %s", n), n, size_string);
+        }
+
       g_free (size_string);
+      g_free (allocated_string);
       
       if (unreadable_directory_count > 0)
         {
@@ -44,6 +44,7 @@
 #include <thunar/thunar-icon-renderer.h>
 #include <thunar/thunar-marshal.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-profiler.h>
 #include <thunar/thunar-properties-dialog.h>
 #include <thunar/thunar-renamer-dialog.h>
 #include <thunar/thunar-simple-job.h>
@@ -62,6 +63,11 @@
 
 #define THUNAR_STANDARD_VIEW_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), THUNAR_TYPE_STANDARD_VIEW, ThunarStandardViewPrivate))
 
+/* number of files sent to the thumbnailer per request and the maximum
+ * number of requests a view keeps outstanding at the same time */
+#define THUNAR_STANDARD_VIEW_THUMBNAIL_BATCH_SIZE   (16)
+#define THUNAR_STANDARD_VIEW_THUMBNAIL_MAX_BATCHES  (2)
+
 
 
 /* Property identifiers */
@@ -98,6 +104,11 @@ enum
 
 
 
+typedef struct _ThunarStandardViewThumbnailItem  ThunarStandardViewThumbnailItem;
+typedef struct _ThunarStandardViewThumbnailBatch ThunarStandardViewThumbnailBatch;
+
+
+
 static void                 thunar_standard_view_component_init             (ThunarComponentIface     *iface);
 static void                 thunar_standard_view_navigator_init             (ThunarNavigatorIface     *iface);
 static void                 thunar_standard_view_view_init                  (ThunarViewIface          *iface);
@@ -119,6 +130,12 @@ static void                 thunar_standard_view_unrealize                  (Gtk
 static void                 thunar_standard_view_grab_focus                 (GtkWidget                *widget);
 static gboolean             thunar_standard_view_expose_event               (GtkWidget                *widget,
                                                                              GdkEventExpose           *event);
+static gboolean             thunar_standard_view_child_expose_event         (GtkWidget                *view,
+                                                                             GdkEventExpose           *event,
+                                                                             ThunarStandardView       *standard_view);
+static gboolean             thunar_standard_view_child_expose_event_after   (GtkWidget                *view,
+                                                                             GdkEventExpose           *event,
+                                                                             ThunarStandardView       *standard_view);
 static GList               *thunar_standard_view_get_selected_files         (ThunarComponent          *component);
 static void                 thunar_standard_view_set_selected_files         (ThunarComponent          *component,
                                                                              GList                    *selected_files);
@@ -132,6 +149,7 @@ static gboolean             thunar_standard_view_get_loading                (Thu
 static void                 thunar_standard_view_set_loading                (ThunarStandardView       *standard_view,
                                                                              gboolean                  loading);
 static const gchar         *thunar_standard_view_get_statusbar_text         (ThunarView               *view);
+static guint                thunar_standard_view_get_n_selected_files       (ThunarView               *view);
 static gboolean             thunar_standard_view_get_show_hidden            (ThunarView               *view);
 static void                 thunar_standard_view_set_show_hidden            (ThunarView               *view,
                                                                              gboolean                  show_hidden);
@@ -163,6 +181,10 @@ static ThunarFile          *thunar_standard_view_get_drop_file              (Thu
 static void                 thunar_standard_view_merge_custom_actions       (ThunarStandardView       *standard_view,
                                                                              GList                    *selected_items);
 static void                 thunar_standard_view_update_statusbar_text      (ThunarStandardView       *standard_view);
+static void                 thunar_standard_view_num_files_changed          (ThunarStandardView       *standard_view);
+static GArray              *thunar_standard_view_get_selection_ranges       (ThunarStandardView       *standard_view);
+static void                 thunar_standard_view_selection_outdated         (ThunarStandardView       *standard_view);
+static void                 thunar_standard_view_update_actions             (ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_current_directory_destroy  (ThunarFile               *current_directory,
                                                                              ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_current_directory_changed  (ThunarFile               *current_directory,
@@ -284,6 +306,7 @@ static void                 thunar_standard_view_finished_thumbnailing      (Thu
                                                                              guint                     request,
                                                                              ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_cancel_thumbnailing        (ThunarStandardView       *standard_view);
+static void                 thunar_standard_view_dispatch_thumbnails        (ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_schedule_thumbnail_timeout (ThunarStandardView       *standard_view);
 static void                 thunar_standard_view_schedule_thumbnail_idle    (ThunarStandardView       *standard_view);
 static gboolean             thunar_standard_view_request_thumbnails         (gpointer                  data);
@@ -370,14 +393,26 @@ struct _ThunarStandardViewPrivate
   gfloat                  scroll_to_row_align;
   gfloat                  scroll_to_col_align;
 
-  /* selected_files support */
+  /* selected_files support, the selected rows are kept as sorted
+   * ranges and turned into a list of files only on demand */
   GList                  *selected_files;
+  gboolean                selected_files_valid;
+  GArray                 *selection_ranges;
+  gboolean                selection_frozen;
 
   /* support for generating thumbnails */
   ThunarThumbnailer      *thumbnailer;
-  guint                   thumbnail_request;
+  GSList                 *thumbnail_batches;
+  GArray                 *thumbnail_queue;
+  guint                   thumbnail_queue_pos;
   guint                   thumbnail_source_id;
   gboolean                thumbnailing_scheduled;
+  gboolean                thumbnail_lazy_request;
+
+  /* scroll direction used to prefetch thumbnails */
+  gdouble                 thumbnail_hvalue;
+  gdouble                 thumbnail_vvalue;
+  gint                    thumbnail_scroll_direction;
 
   /* file insert signal */
   gulong                  row_changed_id;
@@ -385,6 +420,24 @@ struct _ThunarStandardViewPrivate
   /* Tree path for restoring the selection after selecting and
    * deleting an item */
   GtkTreePath            *selection_before_delete;
+
+  /* start of the frame drawn by the real view (when profiling) */
+  gint64                  frame_begin;
+};
+
+struct _ThunarStandardViewThumbnailItem
+{
+  ThunarFile *file;
+  gint        index;
+  gint        distance;
+};
+
+struct _ThunarStandardViewThumbnailBatch
+{
+  /* request number returned by the thumbnailer */
+  guint  request;
+
+  GList *files;
 };
 
 
@@ -611,6 +664,7 @@ thunar_standard_view_view_init (ThunarViewIface *iface)
 {
   iface->get_loading = thunar_standard_view_get_loading;
   iface->get_statusbar_text = thunar_standard_view_get_statusbar_text;
+  iface->get_n_selected_files = thunar_standard_view_get_n_selected_files;
   iface->get_show_hidden = thunar_standard_view_get_show_hidden;
   iface->set_show_hidden = thunar_standard_view_set_show_hidden;
   iface->get_zoom_level = thunar_standard_view_get_zoom_level;
@@ -641,6 +695,7 @@ thunar_standard_view_init (ThunarStandardView *standard_view)
   standard_view->priv->thumbnailer = thunar_thumbnailer_get ();
   g_signal_connect (G_OBJECT (standard_view->priv->thumbnailer), "request-finished", G_CALLBACK (thunar_standard_view_finished_thumbnailing), standard_view);
   standard_view->priv->thumbnailing_scheduled = FALSE;
+  standard_view->priv->thumbnail_queue = g_array_new (FALSE, FALSE, sizeof (ThunarStandardViewThumbnailItem));
 
   /* initialize the scrolled window */
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (standard_view),
@@ -707,11 +762,19 @@ thunar_standard_view_init (ThunarStandardView *standard_view)
   /* be sure to update the selection whenever the folder changes */
   g_signal_connect_swapped (G_OBJECT (standard_view->model), "notify::folder", G_CALLBACK (thunar_standard_view_selection_changed), standard_view);
 
+  /* the row indices of the selection are outdated once rows move */
+  g_signal_connect_swapped (G_OBJECT (standard_view->model), "row-inserted", G_CALLBACK (thunar_standard_view_selection_outdated), standard_view);
+  g_signal_connect_swapped (G_OBJECT (standard_view->model), "row-deleted", G_CALLBACK (thunar_standard_view_selection_outdated), standard_view);
+  g_signal_connect_swapped (G_OBJECT (standard_view->model), "rows-reordered", G_CALLBACK (thunar_standard_view_selection_outdated), standard_view);
+
   /* be sure to update the statusbar text whenever the number of
    * files in our model changes.
    */
   g_signal_connect_swapped (G_OBJECT (standard_view->model), "notify::num-files", G_CALLBACK (thunar_standard_view_update_statusbar_text), standard_view);
 
+  /* keep a text measurement for every file in the model */
+  g_signal_connect_swapped (G_OBJECT (standard_view->model), "notify::num-files", G_CALLBACK (thunar_standard_view_num_files_changed), standard_view);
+
   /* connect to size allocation signals for generating thumbnail requests */
   g_signal_connect_after (G_OBJECT (standard_view), "size-allocate",
                           G_CALLBACK (thunar_standard_view_size_allocate), NULL);
@@ -795,6 +858,17 @@ thunar_standard_view_constructor (GType                  type,
   g_signal_connect (adjustment, "value-changed",
                     G_CALLBACK (thunar_standard_view_scrolled), object);
 
+  /* record the frames of the real view and model signal storms if profiling was requested */
+  if (G_UNLIKELY (thunar_profiler_get_enabled ()))
+    {
+      g_signal_connect (G_OBJECT (view), "expose-event", G_CALLBACK (thunar_standard_view_child_expose_event), object);
+      g_signal_connect_after (G_OBJECT (view), "expose-event", G_CALLBACK (thunar_standard_view_child_expose_event_after), object);
+      g_signal_connect_swapped (G_OBJECT (standard_view->model), "row-inserted", G_CALLBACK (thunar_profiler_count_signal), "row-inserted");
+      g_signal_connect_swapped (G_OBJECT (standard_view->model), "row-deleted", G_CALLBACK (thunar_profiler_count_signal), "row-deleted");
+      g_signal_connect_swapped (G_OBJECT (standard_view->model), "row-changed", G_CALLBACK (thunar_profiler_count_signal), "row-changed");
+      g_signal_connect_swapped (G_OBJECT (standard_view->model), "rows-reordered", G_CALLBACK (thunar_profiler_count_signal), "rows-reordered");
+    }
+
   /* done, we have a working object */
   return object;
 }
@@ -852,6 +926,8 @@ thunar_standard_view_finalize (GObject *object)
   /* release the thumbnailer */
   g_signal_handlers_disconnect_by_func (standard_view->priv->thumbnailer, thunar_standard_view_finished_thumbnailing, standard_view);
   g_object_unref (standard_view->priv->thumbnailer);
+  _thunar_assert (standard_view->priv->thumbnail_batches == NULL);
+  g_array_free (standard_view->priv->thumbnail_queue, TRUE);
 
   /* release the scroll_to_file reference (if any) */
   if (G_UNLIKELY (standard_view->priv->scroll_to_file != NULL))
@@ -859,6 +935,7 @@ thunar_standard_view_finalize (GObject *object)
 
   /* release the selected_files list (if any) */
   thunar_g_file_list_free (standard_view->priv->selected_files);
+  thunar_standard_view_selection_outdated (standard_view);
 
   /* release our reference on the provider factory */
   g_object_unref (G_OBJECT (standard_view->priv->provider_factory));
@@ -1027,9 +1104,9 @@ thunar_standard_view_realize (GtkWidget *widget)
   display = gtk_widget_get_display (widget);
   standard_view->clipboard = thunar_clipboard_manager_get_for_display (display);
 
-  /* we need update the selection state based on the clipboard content */
+  /* we need update the paste actions based on the clipboard content */
   g_signal_connect_swapped (G_OBJECT (standard_view->clipboard), "changed",
-                            G_CALLBACK (thunar_standard_view_selection_changed), standard_view);
+                            G_CALLBACK (thunar_standard_view_update_actions), standard_view);
 
   /* determine the icon factory for the screen on which we are realized */
   icon_theme = gtk_icon_theme_get_for_screen (gtk_widget_get_screen (widget));
@@ -1050,7 +1127,7 @@ thunar_standard_view_unrealize (GtkWidget *widget)
   ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (widget);
 
   /* disconnect the clipboard changed handler */
-  g_signal_handlers_disconnect_by_func (G_OBJECT (standard_view->clipboard), thunar_standard_view_selection_changed, standard_view);
+  g_signal_handlers_disconnect_by_func (G_OBJECT (standard_view->clipboard), thunar_standard_view_update_actions, standard_view);
 
   /* drop the reference on the icon factory */
   g_signal_handlers_disconnect_by_func (G_OBJECT (standard_view->icon_factory), gtk_widget_queue_draw, standard_view);
@@ -1083,6 +1160,9 @@ thunar_standard_view_expose_event (GtkWidget      *widget,
   gboolean result = FALSE;
   cairo_t *cr;
   gint     x, y, width, height;
+  gint64   begin;
+
+  begin = thunar_profiler_begin ();
 
   /* let the scrolled window do it's work */
   result = (*GTK_WIDGET_CLASS (thunar_standard_view_parent_class)->expose_event) (widget, event);
@@ -1109,15 +1189,54 @@ thunar_standard_view_expose_event (GtkWidget      *widget,
       cairo_destroy (cr);
     }
 
+  thunar_profiler_end_frame (G_OBJECT_TYPE_NAME (widget), begin);
+
   return result;
 }
 
 
 
+static gboolean
+thunar_standard_view_child_expose_event (GtkWidget          *view,
+                                         GdkEventExpose     *event,
+                                         ThunarStandardView *standard_view)
+{
+  /* a frame whose emission was stopped is simply not recorded */
+  standard_view->priv->frame_begin = thunar_profiler_begin ();
+
+  return FALSE;
+}
+
+
+
+static gboolean
+thunar_standard_view_child_expose_event_after (GtkWidget          *view,
+                                               GdkEventExpose     *event,
+                                               ThunarStandardView *standard_view)
+{
+  thunar_profiler_end_frame (G_OBJECT_TYPE_NAME (view), standard_view->priv->frame_begin);
+  standard_view->priv->frame_begin = 0;
+
+  return FALSE;
+}
+
+
+
 static GList*
 thunar_standard_view_get_selected_files (ThunarComponent *component)
 {
-  return THUNAR_STANDARD_VIEW (component)->priv->selected_files;
+  ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (component);
+  GArray             *ranges;
+
+  /* determine the files from the selected rows on demand */
+  if (!standard_view->priv->selected_files_valid && standard_view->model != NULL)
+    {
+      ranges = thunar_standard_view_get_selection_ranges (standard_view);
+      standard_view->priv->selected_files = thunar_list_model_get_files_for_ranges (standard_view->model, ranges);
+      standard_view->priv->selected_files_valid = TRUE;
+    }
+
+  return standard_view->priv->selected_files;
 }
 
 
@@ -1137,12 +1256,14 @@ thunar_standard_view_set_selected_files (ThunarComponent *component,
       thunar_g_file_list_free (standard_view->priv->selected_files);
       standard_view->priv->selected_files = NULL;
     }
+  standard_view->priv->selected_files_valid = FALSE;
 
   /* check if we're still loading */
   if (thunar_view_get_loading (THUNAR_VIEW (standard_view)))
     {
       /* remember a copy of the list for later */
       standard_view->priv->selected_files = thunar_g_file_list_copy (selected_files);
+      standard_view->priv->selected_files_valid = TRUE;
     }
   else
     {
@@ -1150,6 +1271,9 @@ thunar_standard_view_set_selected_files (ThunarComponent *component,
       if (G_UNLIKELY (standard_view->model == NULL))
         return;
 
+      /* update the selected files only once, not for every path */
+      standard_view->priv->selection_frozen = TRUE;
+
       /* unselect all previously selected files */
       (*THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->unselect_all) (standard_view);
 
@@ -1181,6 +1305,10 @@ thunar_standard_view_set_selected_files (ThunarComponent *component,
           /* release the tree paths */
           g_list_free_full (paths, (GDestroyNotify) gtk_tree_path_free);
         }
+
+      /* thaw and update the selected files */
+      standard_view->priv->selection_frozen = FALSE;
+      thunar_standard_view_selection_changed (standard_view);
     }
 }
 
@@ -1577,8 +1705,9 @@ thunar_standard_view_set_loading (ThunarStandardView *standard_view,
   if (!loading)
     {
       /* remember and reset the file list */
-      selected_files = standard_view->priv->selected_files;
+      selected_files = thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view));
       standard_view->priv->selected_files = NULL;
+      standard_view->priv->selected_files_valid = FALSE;
 
       /* and try setting the selected files again */
       thunar_component_set_selected_files (THUNAR_COMPONENT (standard_view), selected_files);
@@ -1611,24 +1740,23 @@ static const gchar*
 thunar_standard_view_get_statusbar_text (ThunarView *view)
 {
   ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (view);
-  GList              *items;
+  GArray             *ranges;
 
   _thunar_return_val_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view), NULL);
 
   /* generate the statusbar text on-demand */
   if (standard_view->priv->statusbar_text == NULL)
     {
-      /* query the selected items (actually a list of GtkTreePath's) */
-      items = THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items (standard_view);
+      /* query the ranges of selected rows */
+      ranges = thunar_standard_view_get_selection_ranges (standard_view);
 
       /* we display a loading text if no items are
        * selected and the view is loading
        */
-      if (items == NULL && standard_view->loading)
+      if (ranges->len == 0 && standard_view->loading)
         return _("Loading folder contents...");
 
-      standard_view->priv->statusbar_text = thunar_list_model_get_statusbar_text (standard_view->model, items);
-      g_list_free_full (items, (GDestroyNotify) gtk_tree_path_free);
+      standard_view->priv->statusbar_text = thunar_list_model_get_statusbar_text (standard_view->model, ranges);
     }
 
   return standard_view->priv->statusbar_text;
@@ -1636,6 +1764,19 @@ thunar_standard_view_get_statusbar_text (ThunarView *view)
 
 
 
+static guint
+thunar_standard_view_get_n_selected_files (ThunarView *view)
+{
+  ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (view);
+
+  _thunar_return_val_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view), 0);
+
+  /* count the selected rows without looking at the files */
+  return thunar_list_model_count_ranges (thunar_standard_view_get_selection_ranges (standard_view));
+}
+
+
+
 static gboolean
 thunar_standard_view_get_show_hidden (ThunarView *view)
 {
@@ -2095,9 +2236,12 @@ static gboolean
 thunar_standard_view_update_statusbar_text_idle (gpointer data)
 {
   ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (data);
+  gint64              begin;
 
   _thunar_return_val_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view), FALSE);
 
+  begin = thunar_profiler_begin ();
+
   GDK_THREADS_ENTER ();
 
   /* clear the current status text (will be recalculated on-demand) */
@@ -2111,6 +2255,8 @@ thunar_standard_view_update_statusbar_text_idle (gpointer data)
 
   GDK_THREADS_LEAVE ();
 
+  thunar_profiler_end_callback ("statusbar-text-idle", begin);
+
   return FALSE;
 }
 
@@ -2132,6 +2278,18 @@ thunar_standard_view_update_statusbar_text (ThunarStandardView *standard_view)
 
 
 
+static void
+thunar_standard_view_num_files_changed (ThunarStandardView *standard_view)
+{
+  gint n_files;
+
+  /* size the measurement cache of the name renderer to the model */
+  n_files = gtk_tree_model_iter_n_children (GTK_TREE_MODEL (standard_view->model), NULL);
+  thunar_text_renderer_set_n_texts (THUNAR_TEXT_RENDERER (standard_view->name_renderer), n_files);
+}
+
+
+
 static void
 thunar_standard_view_current_directory_destroy (ThunarFile         *current_directory,
                                                 ThunarStandardView *standard_view)
@@ -2379,6 +2537,7 @@ thunar_standard_view_action_properties (GtkAction          *action,
   ThunarFile *directory;
   GtkWidget  *toplevel;
   GtkWidget  *dialog;
+  GList      *selected_files;
 
   _thunar_return_if_fail (GTK_IS_ACTION (action));
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
@@ -2390,7 +2549,8 @@ thunar_standard_view_action_properties (GtkAction          *action,
       dialog = thunar_properties_dialog_new (GTK_WINDOW (toplevel));
 
       /* check if no files are currently selected */
-      if (standard_view->priv->selected_files == NULL)
+      selected_files = thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view));
+      if (selected_files == NULL)
         {
           /* if we don't have any files selected, we just popup
            * the properties dialog for the current folder.
@@ -2402,7 +2562,7 @@ thunar_standard_view_action_properties (GtkAction          *action,
         {
           /* popup the properties dialog for all file(s) */
           thunar_properties_dialog_set_files (THUNAR_PROPERTIES_DIALOG (dialog),
-                                              standard_view->priv->selected_files);
+                                              selected_files);
         }
 
       gtk_widget_show (dialog);
@@ -2419,7 +2579,7 @@ thunar_standard_view_action_cut (GtkAction          *action,
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
   _thunar_return_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (standard_view->clipboard));
 
-  thunar_clipboard_manager_cut_files (standard_view->clipboard, standard_view->priv->selected_files);
+  thunar_clipboard_manager_cut_files (standard_view->clipboard, thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)));
 }
 
 
@@ -2432,7 +2592,7 @@ thunar_standard_view_action_copy (GtkAction          *action,
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
   _thunar_return_if_fail (THUNAR_IS_CLIPBOARD_MANAGER (standard_view->clipboard));
 
-  thunar_clipboard_manager_copy_files (standard_view->clipboard, standard_view->priv->selected_files);
+  thunar_clipboard_manager_copy_files (standard_view->clipboard, thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)));
 }
 
 
@@ -2467,7 +2627,7 @@ thunar_standard_view_unlink_selection (ThunarStandardView *standard_view,
   /* delete the selected files */
   application = thunar_application_get ();
   thunar_application_unlink_files (application, GTK_WIDGET (standard_view),
-                                   standard_view->priv->selected_files,
+                                   thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)),
                                    permanently);
   g_object_unref (G_OBJECT (application));
 
@@ -2527,7 +2687,7 @@ thunar_standard_view_action_paste_into_folder (GtkAction          *action,
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
   /* determine the first selected file and verify that it's a folder */
-  file = g_list_nth_data (standard_view->priv->selected_files, 0);
+  file = g_list_nth_data (thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)), 0);
   if (G_LIKELY (file != NULL && thunar_file_is_directory (file)))
     thunar_clipboard_manager_paste_files (standard_view->clipboard, thunar_file_get_file (file), GTK_WIDGET (standard_view), NULL);
 }
@@ -2608,6 +2768,9 @@ thunar_standard_view_action_select_by_pattern (GtkAction          *action,
           pattern = pattern_extended;
         }
 
+      /* update the selected files only once, not for every path */
+      standard_view->priv->selection_frozen = TRUE;
+
       /* select all files that match pattern */
       paths = thunar_list_model_get_paths_for_pattern (standard_view->model, pattern);
       THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->unselect_all (standard_view);
@@ -2623,6 +2786,10 @@ thunar_standard_view_action_select_by_pattern (GtkAction          *action,
         }
       g_list_free (paths);
       g_free (pattern_extended);
+
+      /* thaw and update the selected files */
+      standard_view->priv->selection_frozen = FALSE;
+      thunar_standard_view_selection_changed (standard_view);
     }
 
   gtk_widget_destroy (dialog);
@@ -2663,7 +2830,7 @@ thunar_standard_view_action_duplicate (GtkAction          *action,
   if (G_LIKELY (current_directory != NULL))
     {
       /* determine the selected files for the view */
-      selected_files = thunar_file_list_to_thunar_g_file_list (standard_view->priv->selected_files);
+      selected_files = thunar_file_list_to_thunar_g_file_list (thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)));
       if (G_LIKELY (selected_files != NULL))
         {
           /* copy the selected files into the current directory, which effectively
@@ -2700,7 +2867,7 @@ thunar_standard_view_action_make_link (GtkAction          *action,
   if (G_LIKELY (current_directory != NULL))
     {
       /* determine the selected paths for the view */
-      selected_files = thunar_file_list_to_thunar_g_file_list (standard_view->priv->selected_files);
+      selected_files = thunar_file_list_to_thunar_g_file_list (thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)));
       if (G_LIKELY (selected_files != NULL))
         {
           /* link the selected files into the current directory, which effectively
@@ -2782,12 +2949,14 @@ thunar_standard_view_action_rename (GtkAction          *action,
   gboolean         force_bulk_renamer;
   const gchar     *accel_path;
   GtkAccelKey      key;
+  GList           *selected_files;
 
   _thunar_return_if_fail (GTK_IS_ACTION (action));
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
   /* leave if no files are selected */
-  if (G_UNLIKELY (standard_view->priv->selected_files == NULL))
+  selected_files = thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view));
+  if (G_UNLIKELY (selected_files == NULL))
     return;
 
   /* open the bulk renamer also with one file selected and shift */
@@ -2805,13 +2974,13 @@ thunar_standard_view_action_rename (GtkAction          *action,
 
   /* start renaming if we have exactly one selected file */
   if (!force_bulk_renamer
-      && standard_view->priv->selected_files->next == NULL)
+      && selected_files->next == NULL)
     {
       /* get the window */
       window = gtk_widget_get_toplevel (GTK_WIDGET (standard_view));
 
       /* get the file */
-      file = THUNAR_FILE (standard_view->priv->selected_files->data);
+      file = THUNAR_FILE (selected_files->data);
 
       /* run the rename dialog */
       job = thunar_dialogs_show_rename_file (GTK_WINDOW (window), file);
@@ -2827,7 +2996,7 @@ thunar_standard_view_action_rename (GtkAction          *action,
       file = thunar_navigator_get_current_directory (THUNAR_NAVIGATOR (standard_view));
 
       /* display the bulk rename dialog */
-      thunar_show_renamer_dialog (GTK_WIDGET (standard_view), file, standard_view->priv->selected_files, FALSE, NULL);
+      thunar_show_renamer_dialog (GTK_WIDGET (standard_view), file, selected_files, FALSE, NULL);
     }
 }
 
@@ -2844,7 +3013,7 @@ thunar_standard_view_action_restore (GtkAction          *action,
 
   /* restore the selected files */
   application = thunar_application_get ();
-  thunar_application_restore_files (application, GTK_WIDGET (standard_view), standard_view->priv->selected_files,
+  thunar_application_restore_files (application, GTK_WIDGET (standard_view), thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)),
                                     thunar_standard_view_new_files_closure (standard_view, NULL));
   g_object_unref (G_OBJECT (application));
 }
@@ -3533,7 +3702,7 @@ thunar_standard_view_drag_begin (GtkWidget          *view,
   thunar_g_file_list_free (standard_view->priv->drag_g_file_list);
 
   /* query the list of selected URIs */
-  standard_view->priv->drag_g_file_list = thunar_file_list_to_thunar_g_file_list (standard_view->priv->selected_files);
+  standard_view->priv->drag_g_file_list = thunar_file_list_to_thunar_g_file_list (thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view)));
   if (G_LIKELY (standard_view->priv->drag_g_file_list != NULL))
     {
       /* determine the first selected file */
@@ -3653,14 +3822,14 @@ thunar_standard_view_row_changed (ThunarListModel    *model,
                                   GtkTreeIter        *iter,
                                   ThunarStandardView *standard_view)
 {
-  ThunarFile *file;
+  ThunarStandardViewThumbnailItem item;
 
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (model));
   _thunar_return_if_fail (path != NULL);
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
   _thunar_return_if_fail (standard_view->model == model);
 
-  if (standard_view->priv->thumbnail_request != 0)
+  if (standard_view->priv->thumbnail_batches != NULL)
     return;
 
   /* leave if this view is not suitable for generating thumbnails */
@@ -3669,14 +3838,22 @@ thunar_standard_view_row_changed (ThunarListModel    *model,
     return;
 
   /* queue a thumbnail request */
-  file = thunar_list_model_get_file (standard_view->model, iter);
-  if (thunar_file_get_thumb_state (file) == THUNAR_FILE_THUMB_STATE_UNKNOWN)
+  item.file = thunar_list_model_get_file (standard_view->model, iter);
+  if (thunar_file_get_thumb_state (item.file) == THUNAR_FILE_THUMB_STATE_UNKNOWN)
     {
       thunar_standard_view_cancel_thumbnailing (standard_view);
-      thunar_thumbnailer_queue_file (standard_view->priv->thumbnailer, file,
-                                     &standard_view->priv->thumbnail_request);
+
+      /* send the file as a batch of its own */
+      item.index = gtk_tree_path_get_indices (path)[0];
+      item.distance = 0;
+      g_array_append_val (standard_view->priv->thumbnail_queue, item);
+      standard_view->priv->thumbnail_lazy_request = FALSE;
+      thunar_standard_view_dispatch_thumbnails (standard_view);
+    }
+  else
+    {
+      g_object_unref (G_OBJECT (item.file));
     }
-  g_object_unref (G_OBJECT (file));
 }
 
 
@@ -3786,6 +3963,9 @@ thunar_standard_view_drag_scroll_timer (gpointer user_data)
   gint                offset;
   gint                y, x;
   gint                w, h;
+  gint64              begin;
+
+  begin = thunar_profiler_begin ();
 
   GDK_THREADS_ENTER ();
 
@@ -3835,6 +4015,8 @@ thunar_standard_view_drag_scroll_timer (gpointer user_data)
 
   GDK_THREADS_LEAVE ();
 
+  thunar_profiler_end_callback ("drag-scroll-timer", begin);
+
   return TRUE;
 }
 
@@ -3852,12 +4034,17 @@ static gboolean
 thunar_standard_view_drag_timer (gpointer user_data)
 {
   ThunarStandardView *standard_view = THUNAR_STANDARD_VIEW (user_data);
+  gint64              begin;
+
+  begin = thunar_profiler_begin ();
 
   /* fire up the context menu */
   GDK_THREADS_ENTER ();
   thunar_standard_view_context_menu (standard_view, 3, gtk_get_current_event_time ());
   GDK_THREADS_LEAVE ();
 
+  thunar_profiler_end_callback ("drag-timer", begin);
+
   return FALSE;
 }
 
@@ -3876,15 +4063,133 @@ thunar_standard_view_drag_timer_destroy (gpointer user_data)
 
 
 
+static void
+thunar_standard_view_thumbnail_batch_free (ThunarStandardView               *standard_view,
+                                           ThunarStandardViewThumbnailBatch *batch,
+                                           gboolean                          dequeue)
+{
+  GList *lp;
+
+  if (dequeue)
+    {
+      /* cancel the request */
+      thunar_thumbnailer_dequeue (standard_view->priv->thumbnailer, batch->request);
+
+      /* make sure the files are requested again once they become visible */
+      for (lp = batch->files; lp != NULL; lp = lp->next)
+        if (thunar_file_get_thumb_state (lp->data) == THUNAR_FILE_THUMB_STATE_LOADING)
+          thunar_file_set_thumb_state (lp->data, THUNAR_FILE_THUMB_STATE_UNKNOWN);
+    }
+
+  g_list_free_full (batch->files, g_object_unref);
+  g_slice_free (ThunarStandardViewThumbnailBatch, batch);
+}
+
+
+
+static void
+thunar_standard_view_thumbnail_queue_clear (ThunarStandardView *standard_view)
+{
+  GArray *queue = standard_view->priv->thumbnail_queue;
+  guint   n;
+
+  for (n = 0; n < queue->len; ++n)
+    g_object_unref (g_array_index (queue, ThunarStandardViewThumbnailItem, n).file);
+
+  g_array_set_size (queue, 0);
+  standard_view->priv->thumbnail_queue_pos = 0;
+}
+
+
+
+static gint
+thunar_standard_view_thumbnail_item_compare (gconstpointer a,
+                                             gconstpointer b)
+{
+  const ThunarStandardViewThumbnailItem *item_a = a;
+  const ThunarStandardViewThumbnailItem *item_b = b;
+
+  if (item_a->distance != item_b->distance)
+    return item_a->distance - item_b->distance;
+
+  /* keep the row order for items with the same distance */
+  return item_a->index - item_b->index;
+}
+
+
+
+static void
+thunar_standard_view_dispatch_thumbnails (ThunarStandardView *standard_view)
+{
+  ThunarStandardViewThumbnailBatch *batch;
+  ThunarStandardViewThumbnailItem  *item;
+  GArray                           *queue = standard_view->priv->thumbnail_queue;
+  guint                             n;
+
+  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
+
+  /* send small batches, nearest files first, so tumbler is never busy
+   * with a long list of files that might be scrolled away already */
+  while (g_slist_length (standard_view->priv->thumbnail_batches) < THUNAR_STANDARD_VIEW_THUMBNAIL_MAX_BATCHES
+         && standard_view->priv->thumbnail_queue_pos < queue->len)
+    {
+      batch = g_slice_new0 (ThunarStandardViewThumbnailBatch);
+
+      /* the thumbnailer reverses the list, so prepending here
+       * results in the nearest file being requested first */
+      for (n = 0; n < THUNAR_STANDARD_VIEW_THUMBNAIL_BATCH_SIZE
+           && standard_view->priv->thumbnail_queue_pos < queue->len; ++n)
+        {
+          item = &g_array_index (queue, ThunarStandardViewThumbnailItem,
+                                 standard_view->priv->thumbnail_queue_pos++);
+          batch->files = g_list_prepend (batch->files, g_object_ref (item->file));
+        }
+
+      if (thunar_thumbnailer_queue_files (standard_view->priv->thumbnailer,
+                                          standard_view->priv->thumbnail_lazy_request,
+                                          batch->files, &batch->request))
+        {
+          standard_view->priv->thumbnail_batches =
+            g_slist_prepend (standard_view->priv->thumbnail_batches, batch);
+        }
+      else
+        {
+          /* nothing to generate in this batch */
+          thunar_standard_view_thumbnail_batch_free (standard_view, batch, FALSE);
+        }
+    }
+
+  /* release the queue once everything has been sent */
+  if (standard_view->priv->thumbnail_queue_pos >= queue->len)
+    thunar_standard_view_thumbnail_queue_clear (standard_view);
+}
+
+
+
 static void
 thunar_standard_view_finished_thumbnailing (ThunarThumbnailer  *thumbnailer,
                                             guint               request,
                                             ThunarStandardView *standard_view)
 {
+  ThunarStandardViewThumbnailBatch *batch;
+  GSList                           *lp;
+
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
-  if (standard_view->priv->thumbnail_request == request)
-    standard_view->priv->thumbnail_request = 0;
+  for (lp = standard_view->priv->thumbnail_batches; lp != NULL; lp = lp->next)
+    {
+      batch = lp->data;
+      if (batch->request == request)
+        {
+          standard_view->priv->thumbnail_batches =
+            g_slist_delete_link (standard_view->priv->thumbnail_batches, lp);
+          thunar_standard_view_thumbnail_batch_free (standard_view, batch, FALSE);
+
+          /* send the next batch from the queue */
+          thunar_standard_view_dispatch_thumbnails (standard_view);
+          break;
+        }
+    }
 }
 
 
@@ -3892,6 +4197,8 @@ thunar_standard_view_finished_thumbnailing (ThunarThumbnailer  *thumbnailer,
 static void
 thunar_standard_view_cancel_thumbnailing (ThunarStandardView *standard_view)
 {
+  GSList *lp;
+
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
   /* check if we have a pending thumbnail timeout/idle handler */
@@ -3902,14 +4209,14 @@ thunar_standard_view_cancel_thumbnailing (ThunarStandardView *standard_view)
       standard_view->priv->thumbnail_source_id = 0;
     }
 
-  /* check if we have a pending thumbnail request */
-  if (standard_view->priv->thumbnail_request > 0)
-    {
-      /* cancel the request */
-      thunar_thumbnailer_dequeue (standard_view->priv->thumbnailer,
-                                  standard_view->priv->thumbnail_request);
-      standard_view->priv->thumbnail_request = 0;
-    }
+  /* drop the files that have not been sent yet */
+  thunar_standard_view_thumbnail_queue_clear (standard_view);
+
+  /* cancel the pending thumbnail requests */
+  for (lp = standard_view->priv->thumbnail_batches; lp != NULL; lp = lp->next)
+    thunar_standard_view_thumbnail_batch_free (standard_view, lp->data, TRUE);
+  g_slist_free (standard_view->priv->thumbnail_batches);
+  standard_view->priv->thumbnail_batches = NULL;
 }
 
 
@@ -3929,8 +4236,10 @@ thunar_standard_view_schedule_thumbnail_timeout (ThunarStandardView *standard_vi
       return;
     }
 
-  /* cancel any pending thumbnail sources and requests */
-  thunar_standard_view_cancel_thumbnailing (standard_view);
+  /* cancel any pending thumbnail source, outstanding requests are
+   * cancelled by the next request pass if they are out of range */
+  if (standard_view->priv->thumbnail_source_id > 0)
+    g_source_remove (standard_view->priv->thumbnail_source_id);
 
   /* schedule the timeout handler */
   standard_view->priv->thumbnail_source_id =
@@ -3954,8 +4263,9 @@ thunar_standard_view_schedule_thumbnail_idle (ThunarStandardView *standard_view)
       return;
     }
 
-  /* cancel any pending thumbnail sources or requests */
-  thunar_standard_view_cancel_thumbnailing (standard_view);
+  /* cancel any pending thumbnail source */
+  if (standard_view->priv->thumbnail_source_id > 0)
+    g_source_remove (standard_view->priv->thumbnail_source_id);
 
   /* schedule the timeout or idle handler */
   standard_view->priv->thumbnail_source_id =
@@ -3968,13 +4278,22 @@ static gboolean
 thunar_standard_view_request_thumbnails_real (ThunarStandardView *standard_view,
                                               gboolean            lazy_request)
 {
-  GtkTreePath *start_path;
-  GtkTreePath *end_path;
-  GtkTreePath *path;
-  GtkTreeIter  iter;
-  ThunarFile  *file;
-  gboolean     valid_iter;
-  GList       *visible_files = NULL;
+  ThunarStandardViewThumbnailBatch *batch;
+  ThunarStandardViewThumbnailItem   item;
+  GtkTreePath                      *start_path;
+  GtkTreePath                      *end_path;
+  GtkTreeIter                       iter;
+  gboolean                          valid_iter;
+  GHashTable                       *files_in_range;
+  GSList                           *lp;
+  GSList                           *lnext;
+  GList                            *fp;
+  gint                              first;
+  gint                              last;
+  gint                              center;
+  gint                              n_visible;
+  gint                              n_rows;
+  gint                              n;
 
   _thunar_return_val_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view), FALSE);
   _thunar_return_val_if_fail (THUNAR_IS_ICON_FACTORY (standard_view->icon_factory), FALSE);
@@ -3993,45 +4312,75 @@ thunar_standard_view_request_thumbnails_real (ThunarStandardView *standard_view,
                                                                             &start_path,
                                                                             &end_path))
     {
-      /* iterate over the range to collect all files */
-      valid_iter = gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model),
-                                            &iter, start_path);
+      first = gtk_tree_path_get_indices (start_path)[0];
+      last = gtk_tree_path_get_indices (end_path)[0];
+      center = (first + last) / 2;
 
-      while (valid_iter)
+      /* release the start and end path */
+      gtk_tree_path_free (start_path);
+      gtk_tree_path_free (end_path);
+
+      /* prefetch one screen ahead in the direction the user is scrolling */
+      n_visible = last - first + 1;
+      n_rows = gtk_tree_model_iter_n_children (GTK_TREE_MODEL (standard_view->model), NULL);
+      if (standard_view->priv->thumbnail_scroll_direction > 0)
+        last = MIN (last + n_visible, n_rows - 1);
+      else if (standard_view->priv->thumbnail_scroll_direction < 0)
+        first = MAX (first - n_visible, 0);
+
+      /* rebuild the queue from the files in the range */
+      thunar_standard_view_thumbnail_queue_clear (standard_view);
+      files_in_range = g_hash_table_new (g_direct_hash, g_direct_equal);
+      valid_iter = gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (standard_view->model),
+                                                  &iter, NULL, first);
+      for (n = first; valid_iter && n <= last; ++n)
         {
-          /* prepend the file to the visible items list */
-          file = thunar_list_model_get_file (standard_view->model, &iter);
-          visible_files = g_list_prepend (visible_files, file);
+          item.file = thunar_list_model_get_file (standard_view->model, &iter);
+          g_hash_table_insert (files_in_range, item.file, item.file);
 
-          /* check if we've reached the end of the visible range */
-          path = gtk_tree_model_get_path (GTK_TREE_MODEL (standard_view->model), &iter);
-          if (gtk_tree_path_compare (path, end_path) != 0)
+          /* skip files that are part of an outstanding request */
+          if (thunar_file_get_thumb_state (item.file) != THUNAR_FILE_THUMB_STATE_LOADING)
             {
-              /* try to compute the next visible item */
-              valid_iter =
-                gtk_tree_model_iter_next (GTK_TREE_MODEL (standard_view->model), &iter);
+              item.index = n;
+              item.distance = ABS (n - center);
+              g_array_append_val (standard_view->priv->thumbnail_queue, item);
             }
           else
             {
-              /* we have reached the end, terminate the loop */
-              valid_iter = FALSE;
+              g_object_unref (G_OBJECT (item.file));
             }
 
-          /* release the tree path */
-          gtk_tree_path_free (path);
+          valid_iter = gtk_tree_model_iter_next (GTK_TREE_MODEL (standard_view->model), &iter);
         }
 
-      /* queue a thumbnail request */
-      thunar_thumbnailer_queue_files (standard_view->priv->thumbnailer,
-                                      lazy_request, visible_files,
-                                      &standard_view->priv->thumbnail_request);
+      /* cancel the outstanding requests whose files were all scrolled away,
+       * by file because rows may have been inserted or removed since */
+      for (lp = standard_view->priv->thumbnail_batches; lp != NULL; lp = lnext)
+        {
+          lnext = lp->next;
+          batch = lp->data;
 
-      /* release the file list */
-      g_list_free_full (visible_files, g_object_unref);
+          for (fp = batch->files; fp != NULL; fp = fp->next)
+            if (g_hash_table_lookup (files_in_range, fp->data) != NULL)
+              break;
 
-      /* release the start and end path */
-      gtk_tree_path_free (start_path);
-      gtk_tree_path_free (end_path);
+          if (fp == NULL)
+            {
+              standard_view->priv->thumbnail_batches =
+                g_slist_delete_link (standard_view->priv->thumbnail_batches, lp);
+              thunar_standard_view_thumbnail_batch_free (standard_view, batch, TRUE);
+            }
+        }
+
+      g_hash_table_destroy (files_in_range);
+
+      /* order the queue by distance from the center of the viewport */
+      g_array_sort (standard_view->priv->thumbnail_queue,
+                    thunar_standard_view_thumbnail_item_compare);
+
+      /* send the first batches */
+      standard_view->priv->thumbnail_lazy_request = lazy_request;
+      thunar_standard_view_dispatch_thumbnails (standard_view);
     }
 
   /* reset the timeout or idle handler ID */
@@ -4045,7 +4394,14 @@ thunar_standard_view_request_thumbnails_real (ThunarStandardView *standard_view,
 static gboolean
 thunar_standard_view_request_thumbnails (gpointer data)
 {
-  return thunar_standard_view_request_thumbnails_real (data, FALSE);
+  gboolean result;
+  gint64   begin;
+
+  begin = thunar_profiler_begin ();
+  result = thunar_standard_view_request_thumbnails_real (data, FALSE);
+  thunar_profiler_end_callback ("request-thumbnails", begin);
+
+  return result;
 }
 
 
@@ -4053,7 +4409,14 @@ thunar_standard_view_request_thumbnails (gpointer data)
 static gboolean
 thunar_standard_view_request_thumbnails_lazy (gpointer data)
 {
-  return thunar_standard_view_request_thumbnails_real (data, TRUE);
+  gboolean result;
+  gint64   begin;
+
+  begin = thunar_profiler_begin ();
+  result = thunar_standard_view_request_thumbnails_real (data, TRUE);
+  thunar_profiler_end_callback ("request-thumbnails-lazy", begin);
+
+  return result;
 }
 
 
@@ -4092,9 +4455,22 @@ static void
 thunar_standard_view_scrolled (GtkAdjustment      *adjustment,
                                ThunarStandardView *standard_view)
 {
+  gdouble  value;
+  gdouble *last_value;
+
   _thunar_return_if_fail (GTK_IS_ADJUSTMENT (adjustment));
   _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
 
+  /* remember the scroll direction for prefetching thumbnails */
+  value = gtk_adjustment_get_value (adjustment);
+  if (adjustment == gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (standard_view)))
+    last_value = &standard_view->priv->thumbnail_vvalue;
+  else
+    last_value = &standard_view->priv->thumbnail_hvalue;
+  if (value != *last_value)
+    standard_view->priv->thumbnail_scroll_direction = (value > *last_value) ? 1 : -1;
+  *last_value = value;
+
   /* ignore adjustment changes when the view is still loading */
   if (thunar_view_get_loading (THUNAR_VIEW (standard_view)))
     return;
@@ -4218,77 +4594,83 @@ thunar_standard_view_queue_popup (ThunarStandardView *standard_view,
 
 
 
-/**
- * thunar_standard_view_selection_changed:
- * @standard_view : a #ThunarStandardView instance.
- *
- * Called by derived classes (and only by derived classes!) whenever the file
- * selection changes.
- *
- * Note, that this is also called internally whenever the number of
- * files in the @standard_view<!---->s model changes.
- **/
-void
-thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
+static GArray*
+thunar_standard_view_get_selection_ranges (ThunarStandardView *standard_view)
 {
-  GtkTreeIter iter;
-  ThunarFile *current_directory;
-  gboolean    can_paste_into_folder;
-  gboolean    restorable;
-  gboolean    pastable;
-  gboolean    writable;
-  gboolean    trashed;
-  GList      *lp, *selected_files;
-  gint        n_selected_files = 0;
+  GList *paths;
 
-  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
-
-  /* drop any existing "new-files" closure */
-  if (G_UNLIKELY (standard_view->priv->new_files_closure != NULL))
+  /* determine the sorted ranges of selected rows on demand */
+  if (standard_view->priv->selection_ranges == NULL)
     {
-      g_closure_invalidate (standard_view->priv->new_files_closure);
-      g_closure_unref (standard_view->priv->new_files_closure);
-      standard_view->priv->new_files_closure = NULL;
+      paths = (*THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items) (standard_view);
+      standard_view->priv->selection_ranges = thunar_list_model_get_ranges_for_paths (standard_view->model, paths);
+      g_list_free_full (paths, (GDestroyNotify) gtk_tree_path_free);
     }
 
-  /* release the previously selected files */
-  thunar_g_file_list_free (standard_view->priv->selected_files);
+  return standard_view->priv->selection_ranges;
+}
+
 
-  /* determine the new list of selected files (replacing GtkTreePath's with ThunarFile's) */
-  selected_files = (*THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items) (standard_view);
-  restorable = (selected_files != NULL);
-  for (lp = selected_files; lp != NULL; lp = lp->next, ++n_selected_files)
+
+static void
+thunar_standard_view_selection_outdated (ThunarStandardView *standard_view)
+{
+  /* the selected rows are determined again on the next request */
+  if (standard_view->priv->selection_ranges != NULL)
     {
-      /* determine the iterator for the path */
-      gtk_tree_model_get_iter (GTK_TREE_MODEL (standard_view->model), &iter, lp->data);
+      g_array_free (standard_view->priv->selection_ranges, TRUE);
+      standard_view->priv->selection_ranges = NULL;
+    }
+}
 
-      /* release the tree path... */
-      gtk_tree_path_free (lp->data);
 
-      /* ...and replace it with the file */
-      lp->data = thunar_list_model_get_file (standard_view->model, &iter);
 
-      /* enable "Restore" if we have only trashed files (atleast one file) */
-      if (!thunar_file_is_trashed (lp->data))
-        restorable = FALSE;
-    }
+static void
+thunar_standard_view_update_actions (ThunarStandardView *standard_view)
+{
+  ThunarFile *current_directory;
+  gboolean    can_paste_into_folder;
+  gboolean    restorable;
+  gboolean    pastable;
+  gboolean    writable;
+  gboolean    trashed;
+  GList      *selected_files;
+  guint       n_selected_files;
+
+  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
+
+  /* the actions are updated once the selection is thawed again */
+  if (G_UNLIKELY (standard_view->priv->selection_frozen))
+    return;
 
-  /* and setup the new selected files list */
-  standard_view->priv->selected_files = selected_files;
+  /* determine the number of selected rows */
+  n_selected_files = thunar_view_get_n_selected_files (THUNAR_VIEW (standard_view));
 
   /* check whether the folder displayed by the view is writable/in the trash */
   current_directory = thunar_navigator_get_current_directory (THUNAR_NAVIGATOR (standard_view));
   writable = (current_directory != NULL && thunar_file_is_writable (current_directory));
   trashed = (current_directory != NULL && thunar_file_is_trashed (current_directory));
 
+  /* enable "Restore" if we have only trashed files (atleast one file), which
+   * is the case for every file in a folder in the trash */
+  restorable = (n_selected_files > 0 && trashed);
+
   /* check whether the clipboard contains data that can be pasted here */
   pastable = (standard_view->clipboard != NULL && thunar_clipboard_manager_get_can_paste (standard_view->clipboard));
 
   /* check whether the only selected file is
    * folder to which we can paste to */
-  can_paste_into_folder = (n_selected_files == 1)
-                       && thunar_file_is_directory (selected_files->data)
-                       && thunar_file_is_writable (selected_files->data);
+  if (n_selected_files == 1)
+    {
+      selected_files = thunar_component_get_selected_files (THUNAR_COMPONENT (standard_view));
+      can_paste_into_folder = (selected_files != NULL)
+                           && thunar_file_is_directory (selected_files->data)
+                           && thunar_file_is_writable (selected_files->data);
+    }
+  else
+    {
+      can_paste_into_folder = FALSE;
+    }
 
   /* update the "Create Folder"/"Create Document" actions */
   gtk_action_set_sensitive (standard_view->priv->action_create_folder, !trashed && writable);
@@ -4372,6 +4754,48 @@ thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
                                      "Restore the selected files",
                                      n_selected_files),
                 NULL);
+}
+
+
+
+/**
+ * thunar_standard_view_selection_changed:
+ * @standard_view : a #ThunarStandardView instance.
+ *
+ * Called by derived classes (and only by derived classes!) whenever the file
+ * selection changes.
+ *
+ * Note, that this is also called internally whenever the number of
+ * files in the @standard_view<!---->s model changes.
+ **/
+void
+thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
+{
+  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
+
+  /* the selection is updated once it is thawed again */
+  if (G_UNLIKELY (standard_view->priv->selection_frozen))
+    return;
+
+  /* drop any existing "new-files" closure */
+  if (G_UNLIKELY (standard_view->priv->new_files_closure != NULL))
+    {
+      g_closure_invalidate (standard_view->priv->new_files_closure);
+      g_closure_unref (standard_view->priv->new_files_closure);
+      standard_view->priv->new_files_closure = NULL;
+    }
+
+  /* release the previously selected files, the new list of selected
+   * files is only determined when somebody asks for it */
+  thunar_g_file_list_free (standard_view->priv->selected_files);
+  standard_view->priv->selected_files = NULL;
+  standard_view->priv->selected_files_valid = FALSE;
+
+  /* the ranges of selected rows are determined again on demand */
+  thunar_standard_view_selection_outdated (standard_view);
+
+  /* update the actions for the new selection */
+  thunar_standard_view_update_actions (standard_view);
 
   /* update the statusbar text */
   thunar_standard_view_update_statusbar_text (standard_view);
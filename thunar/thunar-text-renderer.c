@@ -37,6 +37,11 @@
 
 
 
+/* minimum number of cached text measurements per renderer */
+#define THUNAR_TEXT_RENDERER_MIN_MEASUREMENTS (1024)
+
+
+
 enum
 {
   PROP_0,
@@ -87,6 +92,11 @@ static GtkCellEditable *thunar_text_renderer_start_editing                    (G
                                                                                GdkRectangle            *background_area,
                                                                                GdkRectangle            *cell_area,
                                                                                GtkCellRendererState     flags);
+static guint            thunar_text_renderer_measurement_hash                 (gconstpointer            data);
+static gboolean         thunar_text_renderer_measurement_equal                (gconstpointer            a,
+                                                                               gconstpointer            b);
+static void             thunar_text_renderer_measurement_free                 (gpointer                 data);
+static void             thunar_text_renderer_trim_measurements                (ThunarTextRenderer      *text_renderer);
 static void             thunar_text_renderer_invalidate                       (ThunarTextRenderer      *text_renderer);
 static void             thunar_text_renderer_set_widget                       (ThunarTextRenderer      *text_renderer,
                                                                                GtkWidget               *widget);
@@ -107,6 +117,10 @@ static void             thunar_text_renderer_entry_menu_popdown_timer_destroy (g
 
 
 
+typedef struct _ThunarTextRendererMeasurement ThunarTextRendererMeasurement;
+
+
+
 struct _ThunarTextRendererClass
 {
   GtkCellRendererClass __parent__;
@@ -140,6 +154,24 @@ struct _ThunarTextRenderer
   GtkWidget      *entry;
   guint           entry_menu_active : 1;
   guint           entry_menu_popdown_timer_id;
+
+  /* measured sizes of wrapped texts for the current widget font */
+  GHashTable     *measurements;
+  GQueue          measurements_lru;
+  guint           max_measurements;
+};
+
+struct _ThunarTextRendererMeasurement
+{
+  gchar        *text;
+  gint          wrap_width;
+  PangoWrapMode wrap_mode;
+
+  /* the pixel size of the laid out text */
+  gint          width;
+  gint          height;
+
+  GList         lru_link;
 };
 
 
@@ -280,6 +312,13 @@ thunar_text_renderer_init (ThunarTextRenderer *text_renderer)
 {
   text_renderer->wrap_width = -1;
   text_renderer->alignment = PANGO_ALIGN_LEFT;
+  text_renderer->max_measurements = THUNAR_TEXT_RENDERER_MIN_MEASUREMENTS;
+
+  /* the measurements share their keys and values */
+  text_renderer->measurements = g_hash_table_new_full (thunar_text_renderer_measurement_hash,
+                                                       thunar_text_renderer_measurement_equal,
+                                                       thunar_text_renderer_measurement_free,
+                                                       NULL);
 }
 
 
@@ -296,6 +335,9 @@ thunar_text_renderer_finalize (GObject *object)
   /* drop the cached widget */
   thunar_text_renderer_set_widget (text_renderer, NULL);
 
+  /* release the measurement cache */
+  g_hash_table_destroy (text_renderer->measurements);
+
   (*G_OBJECT_CLASS (thunar_text_renderer_parent_class)->finalize) (object);
 }
 
@@ -405,10 +447,12 @@ thunar_text_renderer_get_size (GtkCellRenderer *renderer,
                                gint            *width,
                                gint            *height)
 {
-  ThunarTextRenderer *text_renderer = THUNAR_TEXT_RENDERER (renderer);
-  gint                text_length;
-  gint                text_width;
-  gint                text_height;
+  ThunarTextRenderer            *text_renderer = THUNAR_TEXT_RENDERER (renderer);
+  ThunarTextRendererMeasurement *measurement;
+  ThunarTextRendererMeasurement  key;
+  gint                           text_length;
+  gint                           text_width;
+  gint                           text_height;
 
   /* setup the new widget */
   thunar_text_renderer_set_widget (text_renderer, widget);
@@ -428,11 +472,39 @@ thunar_text_renderer_get_size (GtkCellRenderer *renderer,
     }
   else
     {
-      /* calculate the real text dimension */
-      pango_layout_set_width (text_renderer->layout, text_renderer->wrap_width * PANGO_SCALE);
-      pango_layout_set_wrap (text_renderer->layout, text_renderer->wrap_mode);
-      pango_layout_set_text (text_renderer->layout, text_renderer->text, -1);
-      pango_layout_get_pixel_size (text_renderer->layout, &text_width, &text_height);
+      /* check if we already measured this text with the current font */
+      key.text = (text_renderer->text != NULL) ? text_renderer->text : "";
+      key.wrap_width = text_renderer->wrap_width;
+      key.wrap_mode = text_renderer->wrap_mode;
+      measurement = g_hash_table_lookup (text_renderer->measurements, &key);
+      if (G_LIKELY (measurement != NULL))
+        {
+          /* move the measurement to the front of the LRU list */
+          g_queue_unlink (&text_renderer->measurements_lru, &measurement->lru_link);
+          g_queue_push_head_link (&text_renderer->measurements_lru, &measurement->lru_link);
+        }
+      else
+        {
+          /* calculate the real text dimension */
+          pango_layout_set_width (text_renderer->layout, text_renderer->wrap_width * PANGO_SCALE);
+          pango_layout_set_wrap (text_renderer->layout, text_renderer->wrap_mode);
+          pango_layout_set_text (text_renderer->layout, text_renderer->text, -1);
+
+          measurement = g_slice_new0 (ThunarTextRendererMeasurement);
+          measurement->text = g_strdup (key.text);
+          measurement->wrap_width = text_renderer->wrap_width;
+          measurement->wrap_mode = text_renderer->wrap_mode;
+          measurement->lru_link.data = measurement;
+          pango_layout_get_pixel_size (text_renderer->layout, &measurement->width, &measurement->height);
+
+          /* remember the measurement, dropping the least recently used one if the cache is full */
+          g_hash_table_insert (text_renderer->measurements, measurement, measurement);
+          g_queue_push_head_link (&text_renderer->measurements_lru, &measurement->lru_link);
+          thunar_text_renderer_trim_measurements (text_renderer);
+        }
+
+      text_width = measurement->width;
+      text_height = measurement->height;
     }
 
   /* if we have to follow the state manually, we'll need
@@ -643,6 +715,56 @@ thunar_text_renderer_start_editing (GtkCellRenderer     *renderer,
 
 
 
+static guint
+thunar_text_renderer_measurement_hash (gconstpointer data)
+{
+  const ThunarTextRendererMeasurement *measurement = data;
+
+  return g_str_hash (measurement->text) ^ (measurement->wrap_width << 2) ^ measurement->wrap_mode;
+}
+
+
+
+static gboolean
+thunar_text_renderer_measurement_equal (gconstpointer a,
+                                        gconstpointer b)
+{
+  const ThunarTextRendererMeasurement *measurement_a = a;
+  const ThunarTextRendererMeasurement *measurement_b = b;
+
+  return (measurement_a->wrap_width == measurement_b->wrap_width
+       && measurement_a->wrap_mode == measurement_b->wrap_mode
+       && strcmp (measurement_a->text, measurement_b->text) == 0);
+}
+
+
+
+static void
+thunar_text_renderer_measurement_free (gpointer data)
+{
+  ThunarTextRendererMeasurement *measurement = data;
+
+  g_free (measurement->text);
+  g_slice_free (ThunarTextRendererMeasurement, measurement);
+}
+
+
+
+static void
+thunar_text_renderer_trim_measurements (ThunarTextRenderer *text_renderer)
+{
+  GList *lp;
+
+  /* drop the least recently used measurements until the cache fits */
+  while (text_renderer->measurements_lru.length > text_renderer->max_measurements)
+    {
+      lp = g_queue_pop_tail_link (&text_renderer->measurements_lru);
+      g_hash_table_remove (text_renderer->measurements, lp->data);
+    }
+}
+
+
+
 static void
 thunar_text_renderer_invalidate (ThunarTextRenderer *text_renderer)
 {
@@ -671,6 +793,10 @@ thunar_text_renderer_set_widget (ThunarTextRenderer *text_renderer,
       g_object_unref (G_OBJECT (text_renderer->widget));
     }
 
+  /* the measurements are only valid for the font of the previous widget */
+  g_hash_table_remove_all (text_renderer->measurements);
+  g_queue_init (&text_renderer->measurements_lru);
+
   /* activate the new widget */
   text_renderer->widget = widget;
 
@@ -853,3 +979,24 @@ thunar_text_renderer_new (void)
   return g_object_new (THUNAR_TYPE_TEXT_RENDERER, NULL);
 }
 
+
+
+
+/**
+ * thunar_text_renderer_set_n_texts:
+ * @text_renderer : a #ThunarTextRenderer.
+ * @n_texts       : the number of texts rendered by @text_renderer.
+ *
+ * Sizes the measurement cache of @text_renderer to hold atleast
+ * @n_texts texts, so a layout of all rows in a large folder does
+ * not keep evicting measurements it needs again on the next pass.
+ **/
+void
+thunar_text_renderer_set_n_texts (ThunarTextRenderer *text_renderer,
+                                  guint               n_texts)
+{
+  _thunar_return_if_fail (THUNAR_IS_TEXT_RENDERER (text_renderer));
+
+  text_renderer->max_measurements = MAX (n_texts, THUNAR_TEXT_RENDERER_MIN_MEASUREMENTS);
+  thunar_text_renderer_trim_measurements (text_renderer);
+}
@@ -38,6 +38,9 @@ GType            thunar_text_renderer_get_type (void) G_GNUC_CONST;
 
 GtkCellRenderer *thunar_text_renderer_new      (void) G_GNUC_MALLOC;
 
+void             thunar_text_renderer_set_n_texts (ThunarTextRenderer *text_renderer,
+                                                   guint               n_texts);
+
 G_END_DECLS;
 
 #endif /* !__THUNAR_TEXT_RENDERER_H__ */
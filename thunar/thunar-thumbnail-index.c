@@ -0,0 +1,304 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-thumbnail-index.h>
+
+
+
+/**
+ * ThunarThumbnailIndex keeps the names of the thumbnails in the
+ * thumbnail directories in memory, so checking whether a thumbnail
+ * exists for a file does not require a stat() on the main thread.
+ *
+ * Each directory is read once on the first query and kept up to
+ * date by a directory monitor afterwards. Queries for paths outside
+ * the thumbnail directories fall back to g_file_test().
+ **/
+
+
+
+/* thumbnail flavors in the thumbnail directory */
+enum
+{
+  FLAVOR_NORMAL,
+  FLAVOR_LARGE,
+  N_FLAVORS,
+};
+
+
+
+static void thunar_thumbnail_index_finalize (GObject *object);
+
+
+
+struct _ThunarThumbnailIndexClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarThumbnailIndex
+{
+  GObject       __parent__;
+
+  /* absolute paths of the thumbnail directories */
+  gchar        *paths[N_FLAVORS];
+
+  /* thumbnail basenames per directory, loaded on demand */
+  GHashTable   *thumbnails[N_FLAVORS];
+
+  /* monitors to keep the tables up to date */
+  GFileMonitor *monitors[N_FLAVORS];
+};
+
+
+
+static const gchar *flavor_names[N_FLAVORS] = { "normal", "large" };
+
+
+
+G_DEFINE_TYPE (ThunarThumbnailIndex, thunar_thumbnail_index, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_thumbnail_index_class_init (ThunarThumbnailIndexClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_thumbnail_index_finalize;
+}
+
+
+
+static void
+thunar_thumbnail_index_init (ThunarThumbnailIndex *index)
+{
+  guint n;
+
+  for (n = 0; n < N_FLAVORS; ++n)
+    {
+      index->paths[n] = g_build_filename (xfce_get_homedir (), ".thumbnails",
+                                          flavor_names[n], NULL);
+    }
+}
+
+
+
+static void
+thunar_thumbnail_index_finalize (GObject *object)
+{
+  ThunarThumbnailIndex *index = THUNAR_THUMBNAIL_INDEX (object);
+  guint                 n;
+
+  for (n = 0; n < N_FLAVORS; ++n)
+    {
+      if (index->monitors[n] != NULL)
+        {
+          g_signal_handlers_disconnect_matched (index->monitors[n], G_SIGNAL_MATCH_DATA,
+                                                0, 0, NULL, NULL, index);
+          g_file_monitor_cancel (index->monitors[n]);
+          g_object_unref (index->monitors[n]);
+        }
+
+      if (index->thumbnails[n] != NULL)
+        g_hash_table_destroy (index->thumbnails[n]);
+
+      g_free (index->paths[n]);
+    }
+
+  (*G_OBJECT_CLASS (thunar_thumbnail_index_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_thumbnail_index_changed (GFileMonitor         *monitor,
+                                GFile                *file,
+                                GFile                *other_file,
+                                GFileMonitorEvent     event_type,
+                                ThunarThumbnailIndex *index)
+{
+  GHashTable *thumbnails = NULL;
+  gchar      *basename;
+  guint       n;
+
+  _thunar_return_if_fail (G_IS_FILE_MONITOR (monitor));
+  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_INDEX (index));
+
+  /* find the table of the monitored directory */
+  for (n = 0; thumbnails == NULL && n < N_FLAVORS; ++n)
+    if (index->monitors[n] == monitor)
+      thumbnails = index->thumbnails[n];
+
+  if (G_UNLIKELY (thumbnails == NULL))
+    return;
+
+  switch (event_type)
+    {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+      basename = g_file_get_basename (file);
+      g_hash_table_replace (thumbnails, basename, basename);
+      break;
+
+    case G_FILE_MONITOR_EVENT_DELETED:
+      basename = g_file_get_basename (file);
+      g_hash_table_remove (thumbnails, basename);
+      g_free (basename);
+      break;
+
+    default:
+      break;
+    }
+}
+
+
+
+static GHashTable *
+thunar_thumbnail_index_load (ThunarThumbnailIndex *index,
+                             guint                 flavor)
+{
+  GFile       *directory;
+  GDir        *dir;
+  const gchar *name;
+  gchar       *basename;
+
+  if (G_LIKELY (index->thumbnails[flavor] != NULL))
+    return index->thumbnails[flavor];
+
+  index->thumbnails[flavor] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  /* start monitoring before reading the directory, so we don't miss
+   * thumbnails that are written in the meantime. this also works if
+   * the directory does not exist yet */
+  directory = g_file_new_for_path (index->paths[flavor]);
+  index->monitors[flavor] = g_file_monitor_directory (directory, G_FILE_MONITOR_NONE, NULL, NULL);
+  g_object_unref (directory);
+
+  if (G_LIKELY (index->monitors[flavor] != NULL))
+    {
+      g_signal_connect (index->monitors[flavor], "changed",
+                        G_CALLBACK (thunar_thumbnail_index_changed), index);
+    }
+
+  /* read all names at once, a missing directory results in an empty table */
+  dir = g_dir_open (index->paths[flavor], 0, NULL);
+  if (G_LIKELY (dir != NULL))
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          basename = g_strdup (name);
+          g_hash_table_replace (index->thumbnails[flavor], basename, basename);
+        }
+      g_dir_close (dir);
+    }
+
+  return index->thumbnails[flavor];
+}
+
+
+
+/**
+ * thunar_thumbnail_index_get:
+ *
+ * Returns the shared #ThunarThumbnailIndex.
+ *
+ * The caller is responsible to free the returned
+ * object using g_object_unref() when no longer needed.
+ *
+ * Return value: a #ThunarThumbnailIndex.
+ **/
+ThunarThumbnailIndex*
+thunar_thumbnail_index_get (void)
+{
+  static ThunarThumbnailIndex *index = NULL;
+
+  if (G_UNLIKELY (index == NULL))
+    {
+      index = g_object_new (THUNAR_TYPE_THUMBNAIL_INDEX, NULL);
+      g_object_add_weak_pointer (G_OBJECT (index), (gpointer) &index);
+    }
+  else
+    {
+      g_object_ref (G_OBJECT (index));
+    }
+
+  return index;
+}
+
+
+
+/**
+ * thunar_thumbnail_index_exists:
+ * @index          : a #ThunarThumbnailIndex.
+ * @thumbnail_path : absolute path of a thumbnail.
+ *
+ * Checks whether the thumbnail at @thumbnail_path exists. Paths in
+ * the thumbnail directories are answered from memory.
+ *
+ * Return value: %TRUE if the thumbnail exists.
+ **/
+gboolean
+thunar_thumbnail_index_exists (ThunarThumbnailIndex *index,
+                               const gchar          *thumbnail_path)
+{
+  GHashTable  *thumbnails;
+  const gchar *basename;
+  gsize        length;
+  guint        n;
+
+  _thunar_return_val_if_fail (THUNAR_IS_THUMBNAIL_INDEX (index), FALSE);
+  _thunar_return_val_if_fail (thumbnail_path != NULL, FALSE);
+
+  for (n = 0; n < N_FLAVORS; ++n)
+    {
+      /* check if the path is a direct child of this directory */
+      length = strlen (index->paths[n]);
+      if (strncmp (thumbnail_path, index->paths[n], length) != 0
+          || thumbnail_path[length] != G_DIR_SEPARATOR)
+        continue;
+
+      basename = thumbnail_path + length + 1;
+      if (strchr (basename, G_DIR_SEPARATOR) != NULL)
+        continue;
+
+      thumbnails = thunar_thumbnail_index_load (index, n);
+
+      /* without a monitor the table can't be trusted */
+      if (G_UNLIKELY (index->monitors[n] == NULL))
+        break;
+
+      return g_hash_table_lookup (thumbnails, basename) != NULL;
+    }
+
+  return g_file_test (thumbnail_path, G_FILE_TEST_EXISTS);
+}
@@ -0,0 +1,47 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_THUMBNAIL_INDEX_H__
+#define __THUNAR_THUMBNAIL_INDEX_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ThunarThumbnailIndexClass ThunarThumbnailIndexClass;
+typedef struct _ThunarThumbnailIndex      ThunarThumbnailIndex;
+
+#define THUNAR_TYPE_THUMBNAIL_INDEX            (thunar_thumbnail_index_get_type ())
+#define THUNAR_THUMBNAIL_INDEX(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_THUMBNAIL_INDEX, ThunarThumbnailIndex))
+#define THUNAR_THUMBNAIL_INDEX_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_THUMBNAIL_INDEX, ThunarThumbnailIndexClass))
+#define THUNAR_IS_THUMBNAIL_INDEX(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_THUMBNAIL_INDEX))
+#define THUNAR_IS_THUMBNAIL_INDEX_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_THUMBNAIL_INDEX))
+#define THUNAR_THUMBNAIL_INDEX_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_THUMBNAIL_INDEX, ThunarThumbnailIndexClass))
+
+GType                 thunar_thumbnail_index_get_type (void) G_GNUC_CONST;
+
+ThunarThumbnailIndex *thunar_thumbnail_index_get      (void) G_GNUC_MALLOC;
+
+gboolean              thunar_thumbnail_index_exists   (ThunarThumbnailIndex *index,
+                                                       const gchar          *thumbnail_path);
+
+G_END_DECLS
+
+#endif /* !__THUNAR_THUMBNAIL_INDEX_H__ */
@@ -23,6 +23,24 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
 #ifdef HAVE_DBUS
 #include <dbus/dbus.h>
 #include <dbus/dbus-glib.h>
@@ -31,7 +49,10 @@
 #endif
 
 #include <thunar/thunar-marshal.h>
+#include <thunar/thunar-icon-factory.h>
 #include <thunar/thunar-private.h>
+#include <thunar/thunar-profiler.h>
+#include <thunar/thunar-thumbnail-index.h>
 #include <thunar/thunar-thumbnailer.h>
 
 
@@ -72,10 +93,28 @@
  * The Finished signal handler looks up the internal request ID based on
  * the D-Bus thumbnailer handle. It then drops all corresponding information
  * from handle_request_mapping and request_handle_mapping.
+ *
+ *
+ * In-process thumbnailer
+ * ======================
+ *
+ * If Thunar is built without D-Bus support or no thumbnailer service is
+ * available, local images that gdk-pixbuf can load are thumbnailed by a
+ * small pool of low priority worker threads. Each request is split into
+ * one task per file. The workers write the thumbnails to the normal
+ * thumbnail directory and push the finished tasks to a result queue,
+ * which is drained by an idle function in the main thread. Once all tasks
+ * of a request are back, "request-finished" is emitted just like for
+ * the D-Bus thumbnailer.
  */
 
 
 
+/* maximum number of threads generating thumbnails in-process */
+#define THUNAR_THUMBNAILER_LOCAL_MAX_THREADS (2)
+
+
+
 #ifdef HAVE_DBUS
 typedef enum
 {
@@ -89,6 +128,9 @@ typedef struct _ThunarThumbnailerJob  ThunarThumbnailerJob;
 typedef struct _ThunarThumbnailerIdle ThunarThumbnailerIdle;
 #endif
 
+typedef struct _ThunarThumbnailerLocalJob  ThunarThumbnailerLocalJob;
+typedef struct _ThunarThumbnailerLocalTask ThunarThumbnailerLocalTask;
+
 /* Signal identifiers */
 enum
 {
@@ -127,6 +169,10 @@ static void                   thunar_thumbnailer_idle                   (ThunarT
 static gboolean               thunar_thumbnailer_idle_func              (gpointer                    user_data);
 static void                   thunar_thumbnailer_idle_free              (gpointer                    data);
 #endif
+static void                   thunar_thumbnailer_local_thread           (gpointer                    data,
+                                                                         gpointer                    user_data);
+static gboolean               thunar_thumbnailer_local_idle             (gpointer                    user_data);
+static void                   thunar_thumbnailer_local_task_free        (ThunarThumbnailerLocalTask *task);
 
 #if GLIB_CHECK_VERSION (2, 32, 0)
 #define _thumbnailer_lock(thumbnailer)    g_mutex_lock (&((thumbnailer)->lock))
@@ -149,28 +195,40 @@ struct _ThunarThumbnailer
 {
   GObject __parent__;
 
+  /* names of the thumbnails on disk */
+  ThunarThumbnailIndex *index;
+
 #ifdef HAVE_DBUS
   /* proxies to communicate with D-Bus services */
-  DBusGProxy *thumbnailer_proxy;
+  DBusGProxy  *thumbnailer_proxy;
 
   /* running jobs */
-  GSList     *jobs;
+  GSList      *jobs;
+
+  /* cached MIME types -> URI schemes for which thumbs can be generated */
+  GHashTable  *supported;
+
+  /* IDs of idle functions */
+  GSList      *idles;
+#endif
 
 #if GLIB_CHECK_VERSION (2, 32, 0)
-  GMutex      lock;
+  GMutex       lock;
 #else
-  GMutex     *lock;
+  GMutex      *lock;
 #endif
 
-  /* cached MIME types -> URI schemes for which thumbs can be generated */
-  GHashTable *supported;
-
   /* last ThunarThumbnailer request ID */
-  guint       last_request;
+  guint        last_request;
 
-  /* IDs of idle functions */
-  GSList     *idles;
-#endif
+  /* in-process thumbnailer, used if no D-Bus thumbnailer is available */
+  GThreadPool *local_pool;
+  GAsyncQueue *local_results;
+  guint        local_results_idle_id;
+  GSList      *local_jobs;
+
+  /* MIME types gdk-pixbuf can load */
+  GHashTable  *local_types;
 };
 
 #ifdef HAVE_DBUS
@@ -189,6 +247,9 @@ struct _ThunarThumbnailerJob
 
   /* dbus call to get the handle */
   DBusGProxyCall    *handle_call;
+
+  /* time at which the request was queued, for the profiler */
+  gint64             queued_time;
 };
 
 struct _ThunarThumbnailerIdle
@@ -197,9 +258,38 @@ struct _ThunarThumbnailerIdle
   ThunarThumbnailer          *thumbnailer;
   guint                       id;
   gchar                     **uris;
+  gint64                      queued_time;
 };
 #endif
 
+struct _ThunarThumbnailerLocalJob
+{
+  /* request number returned by ThunarThumbnailer */
+  guint   request;
+
+  /* if this job is cancelled, read by the worker threads */
+  gint    cancelled;
+
+  /* number of tasks that have not been handled in the main thread */
+  guint   n_tasks;
+
+  /* time at which the request was queued, for the profiler */
+  gint64  queued_time;
+};
+
+struct _ThunarThumbnailerLocalTask
+{
+  ThunarThumbnailerLocalJob *job;
+
+  gchar                     *uri;
+  gchar                     *path;
+  gchar                     *thumbnail_path;
+  guint64                    mtime;
+
+  /* whether the thumbnail was written */
+  gboolean                   success;
+};
+
 
 
 static guint thumbnailer_signals[LAST_SIGNAL];
@@ -242,6 +332,9 @@ thunar_thumbnailer_init (ThunarThumbnailer *thumbnailer)
 {
 #ifdef HAVE_DBUS
   DBusGConnection *connection;
+#endif
+
+  thumbnailer->index = thunar_thumbnail_index_get ();
 
 #if GLIB_CHECK_VERSION (2, 32, 0)
   g_mutex_init (&thumbnailer->lock);
@@ -249,6 +342,7 @@ thunar_thumbnailer_init (ThunarThumbnailer *thumbnailer)
   thumbnailer->lock = g_mutex_new ();
 #endif
 
+#ifdef HAVE_DBUS
   /* try to connect to D-Bus */
   connection = dbus_g_bus_get (DBUS_BUS_SESSION, NULL);
 
@@ -266,12 +360,40 @@ thunar_thumbnailer_init (ThunarThumbnailer *thumbnailer)
 static void
 thunar_thumbnailer_finalize (GObject *object)
 {
+  ThunarThumbnailer          *thumbnailer = THUNAR_THUMBNAILER (object);
+  ThunarThumbnailerLocalTask *task;
+  GSList                     *lp;
 #ifdef HAVE_DBUS
-  ThunarThumbnailer     *thumbnailer = THUNAR_THUMBNAILER (object);
-  ThunarThumbnailerIdle *idle;
-  ThunarThumbnailerJob  *job;
-  GSList                *lp;
+  ThunarThumbnailerIdle      *idle;
+  ThunarThumbnailerJob       *job;
+#endif
+
+  /* stop the in-process thumbnailer */
+  if (thumbnailer->local_pool != NULL)
+    {
+      /* let the workers skip the remaining tasks and wait for them */
+      for (lp = thumbnailer->local_jobs; lp != NULL; lp = lp->next)
+        g_atomic_int_set (&((ThunarThumbnailerLocalJob *) lp->data)->cancelled, TRUE);
+      g_thread_pool_free (thumbnailer->local_pool, FALSE, TRUE);
+
+      if (thumbnailer->local_results_idle_id != 0)
+        g_source_remove (thumbnailer->local_results_idle_id);
+
+      /* release the finished tasks, this also releases the jobs */
+      while ((task = g_async_queue_try_pop (thumbnailer->local_results)) != NULL)
+        {
+          if (--task->job->n_tasks == 0)
+            g_slice_free (ThunarThumbnailerLocalJob, task->job);
+          thunar_thumbnailer_local_task_free (task);
+        }
+      g_async_queue_unref (thumbnailer->local_results);
+      g_slist_free (thumbnailer->local_jobs);
+    }
+
+  if (thumbnailer->local_types != NULL)
+    g_hash_table_destroy (thumbnailer->local_types);
 
+#ifdef HAVE_DBUS
   /* acquire the thumbnailer lock */
   _thumbnailer_lock (thumbnailer);
 
@@ -319,20 +441,41 @@ thunar_thumbnailer_finalize (GObject *object)
 
   /* release the thumbnailer lock */
   _thumbnailer_unlock (thumbnailer);
+#endif
 
 /* release the mutex */
 #if GLIB_CHECK_VERSION (2, 32, 0)
   g_mutex_clear (&thumbnailer->lock);
 #else
   g_mutex_free (thumbnailer->lock);
-#endif
 #endif
 
+  g_object_unref (thumbnailer->index);
+
   (*G_OBJECT_CLASS (thunar_thumbnailer_parent_class)->finalize) (object);
 }
 
 
 
+static guint
+thunar_thumbnailer_next_request (ThunarThumbnailer *thumbnailer)
+{
+  guint request_no;
+
+  _thunar_return_val_if_fail (!_thumbnailer_trylock (thumbnailer), 0);
+
+  /* compute the next request ID, making sure it's never 0 */
+  request_no = thumbnailer->last_request + 1;
+  request_no = MAX (request_no, 1);
+
+  /* remember the ID for the next request */
+  thumbnailer->last_request = request_no;
+
+  return request_no;
+}
+
+
+
 #ifdef HAVE_DBUS
 static void
 thunar_thumbnailer_init_thumbnailer_proxy (ThunarThumbnailer *thumbnailer,
@@ -448,9 +591,19 @@ thunar_thumbnailer_get_supported_types (ThunarThumbnailer *thumbnailer)
 
   /* request the supported types from the thumbnailer D-Bus service. We only do
    * this once, so using a non-async call should be ok */
-  thunar_thumbnailer_proxy_get_supported (thumbnailer->thumbnailer_proxy,
-                                          &schemes, &types,
-                                          NULL);
+  if (!thunar_thumbnailer_proxy_get_supported (thumbnailer->thumbnailer_proxy,
+                                               &schemes, &types,
+                                               NULL))
+    {
+      /* there is no thumbnailer service, fall back to the in-process
+       * thumbnailer */
+      g_signal_handlers_disconnect_matched (thumbnailer->thumbnailer_proxy,
+                                            G_SIGNAL_MATCH_DATA, 0, 0,
+                                            NULL, NULL, thumbnailer);
+      g_object_unref (thumbnailer->thumbnailer_proxy);
+      thumbnailer->thumbnailer_proxy = NULL;
+      return;
+    }
 
   if (G_LIKELY (schemes != NULL && types != NULL))
     {
@@ -653,17 +806,14 @@ thunar_thumbnailer_queue_async (ThunarThumbnailer *thumbnailer,
   _thunar_return_val_if_fail (DBUS_IS_G_PROXY (thumbnailer->thumbnailer_proxy), 0);
   _thunar_return_val_if_fail (!_thumbnailer_trylock (thumbnailer), 0);
 
-  /* compute the next request ID, making sure it's never 0 */
-  request_no = thumbnailer->last_request + 1;
-  request_no = MAX (request_no, 1);
-
-  /* remember the ID for the next request */
-  thumbnailer->last_request = request_no;
+  /* compute the next request ID */
+  request_no = thunar_thumbnailer_next_request (thumbnailer);
 
   /* allocate a new struct to follow this job until finished */
   job = g_slice_new0 (ThunarThumbnailerJob);
   job->thumbnailer = thumbnailer;
   job->request = request_no;
+  job->queued_time = thunar_profiler_begin ();
 
   /* store the job */
   thumbnailer->jobs = g_slist_prepend (thumbnailer->jobs, job);
@@ -710,6 +860,7 @@ thunar_thumbnailer_idle (ThunarThumbnailer          *thumbnailer,
           idle = g_slice_new0 (ThunarThumbnailerIdle);
           idle->type = type;
           idle->thumbnailer = thumbnailer;
+          idle->queued_time = job->queued_time;
 
           /* copy the URI array because we need it in the idle function */
           idle->uris = g_strdupv ((gchar **)uris);
@@ -764,6 +915,9 @@ thunar_thumbnailer_idle_func (gpointer user_data)
             {
               /* set thumbnail state to ready - we now have a thumbnail */
               thunar_file_set_thumb_state (file, THUNAR_FILE_THUMB_STATE_READY);
+
+              /* time between queuing the request and the thumbnail being shown */
+              thunar_profiler_end_latency ("thumbnail-ready", idle->queued_time);
             }
           else
             {
@@ -804,6 +958,343 @@ thunar_thumbnailer_idle_free (gpointer data)
 
 
 
+static gboolean
+thunar_thumbnailer_local_is_supported (ThunarThumbnailer *thumbnailer,
+                                       ThunarFile        *file)
+{
+  const gchar  *content_type;
+  GSList       *formats;
+  GSList       *lp;
+  gchar       **mime_types;
+  guint         n;
+
+  /* we can only load local files */
+  if (!thunar_file_is_local (file))
+    return FALSE;
+
+  content_type = thunar_file_get_content_type (file);
+  if (content_type == NULL)
+    return FALSE;
+
+  /* collect the MIME types of the gdk-pixbuf loaders once */
+  if (G_UNLIKELY (thumbnailer->local_types == NULL))
+    {
+      thumbnailer->local_types = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+      formats = gdk_pixbuf_get_formats ();
+      for (lp = formats; lp != NULL; lp = lp->next)
+        {
+          if (gdk_pixbuf_format_is_disabled (lp->data))
+            continue;
+
+          mime_types = gdk_pixbuf_format_get_mime_types (lp->data);
+          for (n = 0; mime_types != NULL && mime_types[n] != NULL; ++n)
+            g_hash_table_insert (thumbnailer->local_types, g_strdup (mime_types[n]), GUINT_TO_POINTER (1));
+          g_strfreev (mime_types);
+        }
+      g_slist_free (formats);
+    }
+
+  return g_hash_table_lookup (thumbnailer->local_types, content_type) != NULL;
+}
+
+
+
+static void
+thunar_thumbnailer_local_task_free (ThunarThumbnailerLocalTask *task)
+{
+  g_free (task->uri);
+  g_free (task->path);
+  g_free (task->thumbnail_path);
+  g_slice_free (ThunarThumbnailerLocalTask, task);
+}
+
+
+
+static void
+thunar_thumbnailer_local_lower_priority (void)
+{
+  /* on Linux both calls only affect the calling thread */
+#if defined (HAVE_SETPRIORITY) && defined (__linux__)
+  setpriority (PRIO_PROCESS, 0, 10);
+#endif
+
+#if defined (HAVE_SYS_SYSCALL_H) && defined (SYS_ioprio_set)
+  /* IOPRIO_WHO_PROCESS, IOPRIO_CLASS_IDLE */
+  syscall (SYS_ioprio_set, 1, 0, 3 << 13);
+#endif
+}
+
+
+
+static gboolean
+thunar_thumbnailer_local_generate (ThunarThumbnailerLocalTask *task)
+{
+  GdkPixbuf   *pixbuf;
+  GdkPixbuf   *tmp;
+  const gchar *option;
+  gboolean     succeed = FALSE;
+  gchar       *mtime;
+  gchar       *dirname;
+  gchar       *tmp_path;
+  gint         width;
+  gint         height;
+  gint         fd;
+
+  mtime = g_strdup_printf ("%" G_GUINT64_FORMAT, task->mtime);
+
+  /* check if there already is an up to date thumbnail */
+  pixbuf = gdk_pixbuf_new_from_file (task->thumbnail_path, NULL);
+  if (pixbuf != NULL)
+    {
+      option = gdk_pixbuf_get_option (pixbuf, "tEXt::Thumb::MTime");
+      succeed = (option != NULL && strcmp (option, mtime) == 0);
+      g_object_unref (pixbuf);
+    }
+
+  if (!succeed && gdk_pixbuf_get_file_info (task->path, &width, &height) != NULL)
+    {
+      /* load the image, only scale down */
+      if (width > THUNAR_THUMBNAIL_SIZE || height > THUNAR_THUMBNAIL_SIZE)
+        pixbuf = gdk_pixbuf_new_from_file_at_size (task->path, THUNAR_THUMBNAIL_SIZE, THUNAR_THUMBNAIL_SIZE, NULL);
+      else
+        pixbuf = gdk_pixbuf_new_from_file (task->path, NULL);
+
+      if (G_LIKELY (pixbuf != NULL))
+        {
+          /* rotate the image according to the exif orientation */
+          tmp = gdk_pixbuf_apply_embedded_orientation (pixbuf);
+          g_object_unref (pixbuf);
+          pixbuf = tmp;
+
+          dirname = g_path_get_dirname (task->thumbnail_path);
+          if (g_mkdir_with_parents (dirname, 0700) == 0)
+            {
+              /* write to a temporary file first, so readers never
+               * see a partial thumbnail. g_mkstemp() creates the
+               * file with mode 0600 as the specification requires */
+              tmp_path = g_strconcat (task->thumbnail_path, ".XXXXXX", NULL);
+              fd = g_mkstemp (tmp_path);
+              if (G_LIKELY (fd >= 0))
+                {
+                  close (fd);
+
+                  if (gdk_pixbuf_save (pixbuf, tmp_path, "png", NULL,
+                                       "tEXt::Thumb::URI", task->uri,
+                                       "tEXt::Thumb::MTime", mtime,
+                                       "tEXt::Software", "Thunar",
+                                       NULL)
+                      && g_rename (tmp_path, task->thumbnail_path) == 0)
+                    succeed = TRUE;
+                  else
+                    g_unlink (tmp_path);
+                }
+              g_free (tmp_path);
+            }
+          g_free (dirname);
+
+          g_object_unref (pixbuf);
+        }
+    }
+
+  g_free (mtime);
+
+  return succeed;
+}
+
+
+
+static void
+thunar_thumbnailer_local_thread (gpointer data,
+                                 gpointer user_data)
+{
+  ThunarThumbnailerLocalTask *task = data;
+  ThunarThumbnailer          *thumbnailer = THUNAR_THUMBNAILER (user_data);
+
+  /* generate the thumbnail unless the request was cancelled */
+  if (!g_atomic_int_get (&task->job->cancelled))
+    {
+      thunar_thumbnailer_local_lower_priority ();
+      task->success = thunar_thumbnailer_local_generate (task);
+    }
+
+  /* hand the task back to the main thread */
+  g_async_queue_push (thumbnailer->local_results, task);
+
+  _thumbnailer_lock (thumbnailer);
+  if (thumbnailer->local_results_idle_id == 0)
+    {
+      thumbnailer->local_results_idle_id =
+        g_idle_add_full (G_PRIORITY_LOW, thunar_thumbnailer_local_idle, thumbnailer, NULL);
+    }
+  _thumbnailer_unlock (thumbnailer);
+}
+
+
+
+static gboolean
+thunar_thumbnailer_local_idle (gpointer user_data)
+{
+  ThunarThumbnailer          *thumbnailer = THUNAR_THUMBNAILER (user_data);
+  ThunarThumbnailerLocalTask *task;
+  ThunarThumbnailerLocalJob  *job;
+  ThunarFile                 *file;
+  GFile                      *gfile;
+
+  /* reset the idle ID before draining the queue, so tasks that
+   * are pushed in the meantime schedule a new idle */
+  _thumbnailer_lock (thumbnailer);
+  thumbnailer->local_results_idle_id = 0;
+  _thumbnailer_unlock (thumbnailer);
+
+  while ((task = g_async_queue_try_pop (thumbnailer->local_results)) != NULL)
+    {
+      job = task->job;
+
+      if (!g_atomic_int_get (&job->cancelled))
+        {
+          /* look up the corresponding ThunarFile from the cache */
+          gfile = g_file_new_for_uri (task->uri);
+          file = thunar_file_cache_lookup (gfile);
+          g_object_unref (gfile);
+
+          if (file != NULL)
+            {
+              if (task->success)
+                {
+                  thunar_file_set_thumb_state (file, THUNAR_FILE_THUMB_STATE_READY);
+
+                  /* time between queuing the request and the thumbnail being shown */
+                  thunar_profiler_end_latency ("thumbnail-ready", job->queued_time);
+                }
+              else if (thunar_file_get_thumb_state (file) != THUNAR_FILE_THUMB_STATE_READY)
+                {
+                  thunar_file_set_thumb_state (file, THUNAR_FILE_THUMB_STATE_NONE);
+                }
+            }
+        }
+
+      thunar_thumbnailer_local_task_free (task);
+
+      /* check if this was the last task of the request */
+      if (--job->n_tasks == 0)
+        {
+          _thumbnailer_lock (thumbnailer);
+          thumbnailer->local_jobs = g_slist_remove (thumbnailer->local_jobs, job);
+          _thumbnailer_unlock (thumbnailer);
+
+          /* tell everybody we're done here */
+          if (!g_atomic_int_get (&job->cancelled))
+            g_signal_emit (G_OBJECT (thumbnailer), thumbnailer_signals[REQUEST_FINISHED], 0, job->request);
+
+          g_slice_free (ThunarThumbnailerLocalJob, job);
+        }
+    }
+
+  return FALSE;
+}
+
+
+
+static gboolean
+thunar_thumbnailer_queue_files_local (ThunarThumbnailer *thumbnailer,
+                                      gboolean           lazy_checks,
+                                      GList             *files,
+                                      guint             *request)
+{
+  ThunarThumbnailerLocalJob  *job = NULL;
+  ThunarThumbnailerLocalTask *task;
+  ThunarFileThumbState        thumb_state;
+  const gchar                *thumbnail_path;
+  GSList                     *tasks = NULL;
+  GSList                     *lp;
+  GList                      *fp;
+
+  for (fp = files; fp != NULL; fp = fp->next)
+    {
+      /* the icon factory only loads icons for regular files */
+      if (!thunar_file_is_regular (fp->data))
+        {
+          thunar_file_set_thumb_state (fp->data, THUNAR_FILE_THUMB_STATE_NONE);
+          continue;
+        }
+
+      /* get the current thumb state */
+      thumb_state = thunar_file_get_thumb_state (fp->data);
+
+      /* in lazy mode, don't bother for files that have already
+       * been loaded or are not supported */
+      if (lazy_checks
+          && (thumb_state == THUNAR_FILE_THUMB_STATE_NONE
+              || thumb_state == THUNAR_FILE_THUMB_STATE_READY))
+        continue;
+
+      if (!thunar_thumbnailer_local_is_supported (thumbnailer, fp->data))
+        {
+          /* we can't generate a thumbnail, but maybe the application created one */
+          thumbnail_path = thunar_file_get_thumbnail_path (fp->data);
+          if (thumbnail_path != NULL
+              && thunar_thumbnail_index_exists (thumbnailer->index, thumbnail_path))
+            thunar_file_set_thumb_state (fp->data, THUNAR_FILE_THUMB_STATE_READY);
+          else
+            thunar_file_set_thumb_state (fp->data, THUNAR_FILE_THUMB_STATE_NONE);
+          continue;
+        }
+
+      /* set the thumbnail state to loading, also makes sure we get a path */
+      thunar_file_set_thumb_state (fp->data, THUNAR_FILE_THUMB_STATE_LOADING);
+
+      if (job == NULL)
+        {
+          job = g_slice_new0 (ThunarThumbnailerLocalJob);
+          job->queued_time = thunar_profiler_begin ();
+        }
+
+      task = g_slice_new0 (ThunarThumbnailerLocalTask);
+      task->job = job;
+      task->uri = thunar_file_dup_uri (fp->data);
+      task->path = g_file_get_path (thunar_file_get_file (fp->data));
+      task->thumbnail_path = g_strdup (thunar_file_get_thumbnail_path (fp->data));
+      task->mtime = thunar_file_get_date (fp->data, THUNAR_FILE_DATE_MODIFIED);
+      tasks = g_slist_prepend (tasks, task);
+
+      job->n_tasks++;
+    }
+
+  /* check if we have any supported files */
+  if (job == NULL)
+    return FALSE;
+
+  _thumbnailer_lock (thumbnailer);
+
+  /* start the worker pool on demand, the exclusive threads are never
+   * shared with other pools, so they can keep their lower priority */
+  if (G_UNLIKELY (thumbnailer->local_pool == NULL))
+    {
+      thumbnailer->local_results = g_async_queue_new ();
+      thumbnailer->local_pool = g_thread_pool_new (thunar_thumbnailer_local_thread, thumbnailer,
+                                                   THUNAR_THUMBNAILER_LOCAL_MAX_THREADS, TRUE, NULL);
+    }
+
+  job->request = thunar_thumbnailer_next_request (thumbnailer);
+  thumbnailer->local_jobs = g_slist_prepend (thumbnailer->local_jobs, job);
+
+  /* queue the tasks in the order of the files */
+  tasks = g_slist_reverse (tasks);
+  for (lp = tasks; lp != NULL; lp = lp->next)
+    g_thread_pool_push (thumbnailer->local_pool, lp->data, NULL);
+  g_slist_free (tasks);
+
+  _thumbnailer_unlock (thumbnailer);
+
+  if (request != NULL)
+    *request = job->request;
+
+  return TRUE;
+}
+
+
+
 /**
  * thunar_thumbnailer_get:
  *
@@ -856,14 +1347,14 @@ thunar_thumbnailer_queue_file (ThunarThumbnailer *thumbnailer,
 
 
 
-gboolean
-thunar_thumbnailer_queue_files (ThunarThumbnailer *thumbnailer,
-                                gboolean           lazy_checks,
-                                GList             *files,
-                                guint             *request)
+#ifdef HAVE_DBUS
+static gboolean
+thunar_thumbnailer_queue_files_dbus (ThunarThumbnailer *thumbnailer,
+                                     gboolean           lazy_checks,
+                                     GList             *files,
+                                     guint             *request)
 {
   gboolean               success = FALSE;
-#ifdef HAVE_DBUS
   const gchar          **mime_hints;
   gchar                **uris;
   GList                 *lp;
@@ -872,12 +1363,10 @@ thunar_thumbnailer_queue_files (ThunarThumbnailer *thumbnailer,
   guint                  n_items = 0;
   ThunarFileThumbState   thumb_state;
   const gchar           *thumbnail_path;
-#endif
 
   _thunar_return_val_if_fail (THUNAR_IS_THUMBNAILER (thumbnailer), FALSE);
   _thunar_return_val_if_fail (files != NULL, FALSE);
 
-#ifdef HAVE_DBUS
   /* acquire the thumbnailer lock */
   _thumbnailer_lock (thumbnailer);
 
@@ -928,8 +1417,9 @@ thunar_thumbnailer_queue_files (ThunarThumbnailer *thumbnailer,
            * maybe the application created a thumbnail */
           thumbnail_path = thunar_file_get_thumbnail_path (lp->data);
 
-          /* test if a thumbnail can be found */
-          if (g_file_test (thumbnail_path, G_FILE_TEST_EXISTS))
+          /* test if a thumbnail can be found, without touching the disk */
+          if (thumbnail_path != NULL
+              && thunar_thumbnail_index_exists (thumbnailer->index, thumbnail_path))
             thunar_file_set_thumb_state (lp->data, THUNAR_FILE_THUMB_STATE_READY);
           else
             thunar_file_set_thumb_state (lp->data, THUNAR_FILE_THUMB_STATE_NONE);
@@ -981,28 +1471,81 @@ thunar_thumbnailer_queue_files (ThunarThumbnailer *thumbnailer,
       /* we assume success if we've come so far */
       success = TRUE;
     }
-#endif /* HAVE_DBUS */
 
   return success;
 }
 
 
 
+static gboolean
+thunar_thumbnailer_has_proxy (ThunarThumbnailer *thumbnailer)
+{
+  gboolean has_proxy;
+
+  _thumbnailer_lock (thumbnailer);
+
+  /* load the supported types, which drops the proxy if there is
+   * no thumbnailer service */
+  if (thumbnailer->thumbnailer_proxy != NULL)
+    thunar_thumbnailer_get_supported_types (thumbnailer);
+  has_proxy = (thumbnailer->thumbnailer_proxy != NULL);
+
+  _thumbnailer_unlock (thumbnailer);
+
+  return has_proxy;
+}
+#endif /* HAVE_DBUS */
+
+
+
+gboolean
+thunar_thumbnailer_queue_files (ThunarThumbnailer *thumbnailer,
+                                gboolean           lazy_checks,
+                                GList             *files,
+                                guint             *request)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_THUMBNAILER (thumbnailer), FALSE);
+  _thunar_return_val_if_fail (files != NULL, FALSE);
+
+#ifdef HAVE_DBUS
+  /* use the D-Bus thumbnailer if it is available */
+  if (thunar_thumbnailer_has_proxy (thumbnailer))
+    return thunar_thumbnailer_queue_files_dbus (thumbnailer, lazy_checks, files, request);
+#endif
+
+  return thunar_thumbnailer_queue_files_local (thumbnailer, lazy_checks, files, request);
+}
+
+
+
 void
 thunar_thumbnailer_dequeue (ThunarThumbnailer *thumbnailer,
                             guint              request)
 {
+  ThunarThumbnailerLocalJob *local_job;
+  GSList                    *lp;
 #ifdef HAVE_DBUS
-  ThunarThumbnailerJob *job;
-  GSList               *lp;
+  ThunarThumbnailerJob      *job;
 #endif
 
   _thunar_return_if_fail (THUNAR_IS_THUMBNAILER (thumbnailer));
 
-#ifdef HAVE_DBUS
   /* acquire the thumbnailer lock */
   _thumbnailer_lock (thumbnailer);
 
+  /* let the workers skip the tasks of an in-process request, the
+   * job is released once all its tasks are back */
+  for (lp = thumbnailer->local_jobs; lp != NULL; lp = lp->next)
+    {
+      local_job = lp->data;
+      if (local_job->request == request)
+        {
+          g_atomic_int_set (&local_job->cancelled, TRUE);
+          break;
+        }
+    }
+
+#ifdef HAVE_DBUS
   for (lp = thumbnailer->jobs; lp != NULL; lp = lp->next)
     {
       job = lp->data;
@@ -1027,8 +1570,8 @@ thunar_thumbnailer_dequeue (ThunarThumbnailer *thumbnailer,
           break;
         }
     }
+#endif
 
   /* release the thumbnailer lock */
   _thumbnailer_unlock (thumbnailer);
-#endif
 }
@@ -23,11 +23,32 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_IOCTL_H
+#include <sys/ioctl.h>
+#endif
+#ifdef HAVE_LINUX_FS_H
+#include <linux/fs.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <gio/gio.h>
 
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-gio-extensions.h>
-#include <thunar/thunar-io-scan-directory.h>
 #include <thunar/thunar-io-jobs-util.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-private.h>
@@ -39,15 +60,41 @@
 /* seconds before we show the transfer rate + remaining time */
 #define MINIMUM_TRANSFER_TIME (10 * G_USEC_PER_SEC) /* 10 seconds */
 
+/* maximum number of files copied at the same time */
+#define THUNAR_TRANSFER_JOB_MAX_WORKERS (4)
+
+/* maximum number of files handed to the workers but not copied yet */
+#define THUNAR_TRANSFER_JOB_MAX_TASKS (2 * THUNAR_TRANSFER_JOB_MAX_WORKERS)
 
+/* bytes copied in-kernel between progress updates and cancellation checks */
+#define THUNAR_TRANSFER_JOB_NATIVE_CHUNK (8 * 1024 * 1024)
+
+/* maximum number of scanned entries waiting to be copied */
+#define THUNAR_TRANSFER_JOB_MAX_QUEUED (4096)
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+#define _transfer_job_lock(job, lock)   g_mutex_lock (&((job)->lock))
+#define _transfer_job_unlock(job, lock) g_mutex_unlock (&((job)->lock))
+#else
+#define _transfer_job_lock(job, lock)   g_mutex_lock ((job)->lock)
+#define _transfer_job_unlock(job, lock) g_mutex_unlock ((job)->lock)
+#endif
 
-typedef struct _ThunarTransferNode ThunarTransferNode;
+
+
+typedef struct _ThunarTransferNode  ThunarTransferNode;
+typedef struct _ThunarTransferEntry ThunarTransferEntry;
+typedef struct _ThunarTransferTask  ThunarTransferTask;
 
 
 
 static void     thunar_transfer_job_finalize     (GObject                *object);
 static gboolean thunar_transfer_job_execute      (ExoJob                 *job,
                                                   GError                **error);
+static void     thunar_transfer_job_scanner      (gpointer                data,
+                                                  gpointer                user_data);
+static void     thunar_transfer_job_worker       (gpointer                data,
+                                                  gpointer                user_data);
 static void     thunar_transfer_node_free        (gpointer                data);
 
 
@@ -71,15 +118,77 @@ struct _ThunarTransferJob
 
   guint64               total_size;
   guint64               total_progress;
-  guint64               file_progress;
   guint64               transfer_rate;
+
+  /* free space on the destination the total size is checked
+   * against while the scan grows it, G_MAXUINT64 if unknown
+   * or the user decided to copy anyway */
+  guint64               free_space;
+  gchar                *free_space_name;
+
+  /* entries found by the scanner thread in the order they are copied,
+   * the folders are scanned while the copy of the first entries runs */
+  GAsyncQueue          *scan_queue;
+
+  /* holds a token for each free slot in the scan queue */
+  GAsyncQueue          *scan_slots;
+
+  /* set by the job thread to stop the scanner early */
+  volatile gint         scan_stopped;
+
+  /* copies files in parallel, directories are still created by
+   * the job thread before any of their children are queued */
+  GThreadPool          *workers;
+
+  /* holds a token for each task the workers can still accept */
+  GAsyncQueue          *worker_slots;
+
+  /* first fatal error of a worker or of the space check
+   * of the scanner, stops the copy */
+  GError               *worker_error;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  GMutex                progress_lock;
+  GMutex                ask_lock;
+#else
+  GMutex               *progress_lock;
+  GMutex               *ask_lock;
+#endif
 };
 
 struct _ThunarTransferNode
 {
-  ThunarTransferNode *next;
-  ThunarTransferNode *children;
   GFile              *source_file;
+  gchar              *display_name;
+  guint               is_directory : 1;
+};
+
+struct _ThunarTransferEntry
+{
+  /* NULL for the entry that ends the scan */
+  GFile              *source_file;
+
+  /* the target file of toplevel entries, the others are copied
+   * to the real target file of their parent folder */
+  GFile              *target_file;
+  GFile              *real_target_file;
+
+  gchar              *display_name;
+  guint               depth;
+  guint               is_directory : 1;
+
+  /* the error that stopped the scan */
+  GError             *error;
+};
+
+struct _ThunarTransferTask
+{
+  ThunarTransferJob *job;
+  GFile             *source_file;
+  GFile             *target_file;
+
+  /* bytes of the current file already added to the total progress */
+  guint64            file_progress;
 };
 
 
@@ -111,11 +220,19 @@ thunar_transfer_job_init (ThunarTransferJob *job)
   job->target_file_list = NULL;
   job->total_size = 0;
   job->total_progress = 0;
-  job->file_progress = 0;
   job->last_update_time = 0;
   job->last_total_progress = 0;
   job->transfer_rate = 0;
   job->start_time = 0;
+  job->free_space = G_MAXUINT64;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_init (&job->progress_lock);
+  g_mutex_init (&job->ask_lock);
+#else
+  job->progress_lock = g_mutex_new ();
+  job->ask_lock = g_mutex_new ();
+#endif
 }
 
 
@@ -129,6 +246,16 @@ thunar_transfer_job_finalize (GObject *object)
 
   thunar_g_file_list_free (job->target_file_list);
 
+  g_free (job->free_space_name);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+  g_mutex_clear (&job->progress_lock);
+  g_mutex_clear (&job->ask_lock);
+#else
+  g_mutex_free (job->progress_lock);
+  g_mutex_free (job->ask_lock);
+#endif
+
   (*G_OBJECT_CLASS (thunar_transfer_job_parent_class)->finalize) (object);
 }
 
@@ -139,21 +266,29 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
                               goffset  total_num_bytes,
                               gpointer user_data)
 {
-  ThunarTransferJob *job = user_data;
-  guint64            new_percentage;
-  gint64             current_time;
-  gint64             expired_time;
-  guint64            transfer_rate;
+  ThunarTransferTask *task = user_data;
+  ThunarTransferJob  *job = task->job;
+  guint64             new_percentage;
+  gint64              current_time;
+  gint64              expired_time;
+  guint64             transfer_rate;
+  gboolean            notify = FALSE;
 
   _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
 
+  /* stop in the middle of the file while the job is paused */
+  thunar_job_check_paused (THUNAR_JOB (job));
+
   if (G_LIKELY (job->total_size > 0))
     {
+      /* the workers report their progress concurrently */
+      _transfer_job_lock (job, progress_lock);
+
       /* update total progress */
-      job->total_progress += (current_num_bytes - job->file_progress);
+      job->total_progress += (current_num_bytes - task->file_progress);
 
       /* update file progress */
-      job->file_progress = current_num_bytes;
+      task->file_progress = current_num_bytes;
 
       /* compute the new percentage after the progress we've made */
       new_percentage = (job->total_progress * 100.0) / job->total_size;
@@ -174,77 +309,246 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
           else
             job->transfer_rate = transfer_rate;
 
-          /* emit the percent signal */
-          exo_job_percent (EXO_JOB (job), new_percentage);
-
           /* update internals */
           job->last_update_time = current_time;
           job->last_total_progress = job->total_progress;
+
+          notify = TRUE;
         }
+
+      _transfer_job_unlock (job, progress_lock);
+
+      /* emit the percent signal */
+      if (notify)
+        exo_job_percent (EXO_JOB (job), new_percentage);
     }
 }
 
 
 
+static void
+thunar_transfer_job_add_node (ThunarTransferJob  *job,
+                              ThunarTransferNode *node,
+                              GFileInfo          *info)
+{
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (G_IS_FILE_INFO (info));
+
+  node->display_name = g_strdup (g_file_info_get_display_name (info));
+  node->is_directory = (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY);
+
+  /* the contents of folders are added by the scanner */
+  job->total_size += g_file_info_get_size (info);
+}
+
+
+
+static ThunarTransferEntry *
+thunar_transfer_entry_new (GFile       *source_file,
+                           GFile       *target_file,
+                           const gchar *display_name,
+                           guint        depth,
+                           gboolean     is_directory)
+{
+  ThunarTransferEntry *entry;
+
+  entry = g_slice_new0 (ThunarTransferEntry);
+  entry->source_file = g_object_ref (source_file);
+  entry->target_file = (target_file != NULL) ? g_object_ref (target_file) : NULL;
+  entry->display_name = g_strdup (display_name);
+  entry->depth = depth;
+  entry->is_directory = is_directory;
+
+  return entry;
+}
+
+
+
+static void
+thunar_transfer_entry_free (ThunarTransferEntry *entry)
+{
+  if (entry->source_file != NULL)
+    g_object_unref (entry->source_file);
+  if (entry->target_file != NULL)
+    g_object_unref (entry->target_file);
+  if (entry->real_target_file != NULL)
+    g_object_unref (entry->real_target_file);
+  if (entry->error != NULL)
+    g_error_free (entry->error);
+
+  g_free (entry->display_name);
+  g_slice_free (ThunarTransferEntry, entry);
+}
+
+
+
+static void
+thunar_transfer_job_scan_push (ThunarTransferJob   *job,
+                               ThunarTransferEntry *entry)
+{
+  /* wait for a free slot, the scanner never runs more than
+   * THUNAR_TRANSFER_JOB_MAX_QUEUED entries ahead of the copy */
+  g_async_queue_pop (job->scan_slots);
+  g_async_queue_push (job->scan_queue, entry);
+}
+
+
+
 static gboolean
-thunar_transfer_job_collect_node (ThunarTransferJob  *job,
-                                  ThunarTransferNode *node,
-                                  GError            **error)
+thunar_transfer_job_stopped (ThunarTransferJob *job)
+{
+  gboolean failed;
+
+  _transfer_job_lock (job, ask_lock);
+  failed = (job->worker_error != NULL);
+  _transfer_job_unlock (job, ask_lock);
+
+  return failed;
+}
+
+
+
+static gboolean
+thunar_transfer_job_check_space (ThunarTransferJob *job,
+                                 GError           **error)
+{
+  gboolean  proceed;
+  guint64   missing = 0;
+  gchar    *size_string;
+
+  /* check if the scan grew the total size beyond the free space */
+  _transfer_job_lock (job, progress_lock);
+  if (G_UNLIKELY (job->total_size > job->free_space))
+    missing = job->total_size - job->free_space;
+  _transfer_job_unlock (job, progress_lock);
+
+  if (G_LIKELY (missing == 0))
+    return TRUE;
+
+  size_string = g_format_size (missing);
+
+  /* the copy stops at the next file while the user is asked */
+  _transfer_job_lock (job, ask_lock);
+  proceed = thunar_job_ask_no_size (THUNAR_JOB (job),
+                                    _("Error while copying to \"%s\": %s more space is "
+                                      "required to copy to the destination"),
+                                    job->free_space_name, size_string);
+  if (G_UNLIKELY (!proceed))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+                   _("Error while copying to \"%s\": %s more space is "
+                     "required to copy to the destination"),
+                   job->free_space_name, size_string);
+
+      /* stop the job thread and the workers before they write more */
+      if (job->worker_error == NULL)
+        job->worker_error = g_error_copy (*error);
+    }
+  _transfer_job_unlock (job, ask_lock);
+
+  /* do not ask again if the user decided to copy anyway */
+  if (proceed)
+    {
+      _transfer_job_lock (job, progress_lock);
+      job->free_space = G_MAXUINT64;
+      _transfer_job_unlock (job, progress_lock);
+    }
+
+  g_free (size_string);
+
+  return proceed;
+}
+
+
+
+static gboolean
+thunar_transfer_job_scan_directory (ThunarTransferJob *job,
+                                    GFile             *directory,
+                                    guint              depth,
+                                    GError           **error)
 {
-  ThunarTransferNode *child_node;
-  GFileInfo          *info;
-  GError             *err = NULL;
-  GList              *file_list;
-  GList              *lp;
+  ThunarTransferEntry *entry;
+  GFileEnumerator     *enumerator;
+  GFileInfo           *info;
+  GError              *err = NULL;
+  GList               *entries = NULL;
+  GList               *lp;
+  GFile               *child_file;
+  gboolean             is_directory;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
-  _thunar_return_val_if_fail (node != NULL && G_IS_FILE (node->source_file), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (directory), FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
-    return FALSE;
+  /* the enumeration already provides the type and size of the
+   * children, so they don't need to be queried one by one */
+  enumerator = g_file_enumerate_children (directory,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          exo_job_get_cancellable (EXO_JOB (job)),
+                                          &err);
+  if (G_UNLIKELY (enumerator == NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
 
-  info = g_file_query_info (node->source_file,
-                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
-                            G_FILE_ATTRIBUTE_STANDARD_TYPE,
-                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                            exo_job_get_cancellable (EXO_JOB (job)),
-                            &err);
+  /* read the immediate children, so the enumerator is closed before
+   * we descend and deep trees don't keep a descriptor per level */
+  while (err == NULL && !g_atomic_int_get (&job->scan_stopped))
+    {
+      info = g_file_enumerator_next_file (enumerator, exo_job_get_cancellable (EXO_JOB (job)), &err);
+      if (info == NULL)
+        break;
 
-  if (G_UNLIKELY (info == NULL))
-    return FALSE;
+      child_file = g_file_get_child (directory, g_file_info_get_name (info));
+      entry = thunar_transfer_entry_new (child_file, NULL,
+                                         g_file_info_get_display_name (info), depth,
+                                         g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY);
+      entries = g_list_prepend (entries, entry);
 
-  job->total_size += g_file_info_get_size (info);
+      /* refine the total size while the scan proceeds */
+      _transfer_job_lock (job, progress_lock);
+      job->total_size += g_file_info_get_size (info);
+      _transfer_job_unlock (job, progress_lock);
+
+      g_object_unref (child_file);
+      g_object_unref (info);
+    }
 
-  /* check if we have a directory here */
-  if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+  g_object_unref (enumerator);
+
+  /* make sure the children still fit on the destination */
+  if (err == NULL)
+    thunar_transfer_job_check_space (job, &err);
+
+  /* hand the children to the copy, each folder followed by its contents */
+  entries = g_list_reverse (entries);
+  for (lp = entries; lp != NULL; lp = lp->next)
     {
-      /* scan the directory for immediate children */
-      file_list = thunar_io_scan_directory (THUNAR_JOB (job), node->source_file,
-                                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                            FALSE, FALSE, FALSE, &err);
+      entry = lp->data;
 
-      /* add children to the transfer node */
-      for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
+      if (err != NULL || g_atomic_int_get (&job->scan_stopped))
         {
-          /* allocate a new transfer node for the child */
-          child_node = g_slice_new0 (ThunarTransferNode);
-          child_node->source_file = g_object_ref (lp->data);
+          thunar_transfer_entry_free (entry);
+          continue;
+        }
 
-          /* hook the child node into the child list */
-          child_node->next = node->children;
-          node->children = child_node;
+      /* the entry belongs to the job thread once it's queued */
+      child_file = g_object_ref (entry->source_file);
+      is_directory = entry->is_directory;
+      thunar_transfer_job_scan_push (job, entry);
 
-          /* collect the child node */
-          thunar_transfer_job_collect_node (job, child_node, &err);
-        }
+      if (is_directory)
+        thunar_transfer_job_scan_directory (job, child_file, depth + 1, &err);
 
-      /* release the child files */
-      thunar_g_file_list_free (file_list);
+      g_object_unref (child_file);
     }
 
-  /* release file info */
-  g_object_unref (info);
+  g_list_free (entries);
 
   if (G_UNLIKELY (err != NULL))
     {
@@ -257,18 +561,204 @@ thunar_transfer_job_collect_node (ThunarTransferJob  *job,
 
 
 
+static void
+thunar_transfer_job_scanner (gpointer data,
+                             gpointer user_data)
+{
+  ThunarTransferEntry *entry;
+  ThunarTransferNode  *node;
+  ThunarTransferJob   *job = THUNAR_TRANSFER_JOB (user_data);
+  GError              *err = NULL;
+  GList               *sp;
+  GList               *tp;
+
+  for (sp = job->source_node_list, tp = job->target_file_list;
+       sp != NULL && tp != NULL && err == NULL;
+       sp = sp->next, tp = tp->next)
+    {
+      if (g_atomic_int_get (&job->scan_stopped))
+        break;
+
+      node = sp->data;
+
+      /* toplevel entries carry their target file, to get proper
+       * behavior wrt restoring files from the trash */
+      entry = thunar_transfer_entry_new (node->source_file, tp->data,
+                                         node->display_name, 0,
+                                         node->is_directory);
+      thunar_transfer_job_scan_push (job, entry);
+
+      if (node->is_directory)
+        thunar_transfer_job_scan_directory (job, node->source_file, 1, &err);
+    }
+
+  /* tell the job thread the scan is done */
+  entry = g_slice_new0 (ThunarTransferEntry);
+  entry->error = err;
+  thunar_transfer_job_scan_push (job, entry);
+}
+
+
+
+/**
+ * ttj_copy_file_native:
+ * @task        : the #ThunarTransferTask of the job.
+ * @source_file : a local regular file.
+ * @target_file : a local file that does not exist yet.
+ * @error       : return location for errors or %NULL.
+ *
+ * Copies @source_file without passing the data through userspace,
+ * either by cloning the extents (reflink) on file systems that support
+ * it, or with copy_file_range(). Empty files are left to GIO, as
+ * pseudo files report a size of 0 even though they have contents.
+ *
+ * Return value: %FALSE if the kernel cannot copy the file and the
+ *               caller should use the generic GIO copy, %TRUE if the
+ *               file was copied or @error was set.
+ **/
 static gboolean
-ttj_copy_file (ThunarTransferJob *job,
-               GFile             *source_file,
-               GFile             *target_file,
-               GFileCopyFlags     copy_flags,
-               gboolean           merge_directories,
-               GError           **error)
+ttj_copy_file_native (ThunarTransferTask *task,
+                      GFile              *source_file,
+                      GFile              *target_file,
+                      GError            **error)
 {
-  GFileType source_type;
-  GFileType target_type;
-  gboolean  target_exists;
-  GError   *err = NULL;
+#if defined (FICLONE) || defined (HAVE_COPY_FILE_RANGE)
+  GCancellable *cancellable = exo_job_get_cancellable (EXO_JOB (task->job));
+  struct stat   statb;
+  gboolean      handled = FALSE;
+  goffset       copied = 0;
+  gssize        n;
+  gchar        *source_path;
+  gchar        *target_path;
+  gint          source_fd = -1;
+  gint          target_fd = -1;
+  gint          errsv = 0;
+
+  source_path = g_file_get_path (source_file);
+  target_path = g_file_get_path (target_file);
+  if (G_UNLIKELY (source_path == NULL || target_path == NULL))
+    goto out;
+
+  /* let GIO report problems with the source */
+  source_fd = open (source_path, O_RDONLY);
+  if (source_fd < 0 || fstat (source_fd, &statb) < 0 || !S_ISREG (statb.st_mode))
+    goto out;
+
+  /* files in procfs or sysfs report a size of 0 but have contents,
+   * GIO reads those until the end of the file */
+  if (statb.st_size == 0)
+    goto out;
+
+  /* the target must not exist, GIO handles the overwrite semantics */
+  target_fd = open (target_path, O_WRONLY | O_CREAT | O_EXCL, statb.st_mode & 0777);
+  if (target_fd < 0)
+    goto out;
+
+#ifdef FICLONE
+  /* share the extents of the source on copy-on-write file systems */
+  if (ioctl (target_fd, FICLONE, source_fd) == 0)
+    {
+      copied = statb.st_size;
+      thunar_transfer_job_progress (copied, statb.st_size, task);
+    }
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+  /* copy in chunks, so we can report progress and stop on cancellation */
+  while (copied < statb.st_size)
+    {
+      if (g_cancellable_is_cancelled (cancellable))
+        {
+          errsv = ECANCELED;
+          break;
+        }
+
+      n = copy_file_range (source_fd, NULL, target_fd, NULL,
+                           MIN (statb.st_size - copied, THUNAR_TRANSFER_JOB_NATIVE_CHUNK), 0);
+      if (G_UNLIKELY (n < 0))
+        {
+          if (errno == EINTR)
+            continue;
+          errsv = errno;
+          break;
+        }
+
+      /* some kernels copy nothing between special file systems, let GIO
+       * read the file then. otherwise the source was truncated */
+      if (G_UNLIKELY (n == 0))
+        {
+          if (copied == 0)
+            errsv = EOPNOTSUPP;
+          break;
+        }
+
+      copied += n;
+      thunar_transfer_job_progress (copied, statb.st_size, task);
+    }
+#else
+  /* the file system cannot clone the file */
+  if (copied < statb.st_size)
+    errsv = EOPNOTSUPP;
+#endif
+
+  /* nothing was copied, fall back to GIO if the kernel cannot copy between these files */
+  if (errsv != 0 && copied == 0
+      && (errsv == ENOSYS || errsv == EXDEV || errsv == EINVAL || errsv == EOPNOTSUPP || errsv == EBADF))
+    {
+      close (target_fd);
+      target_fd = -1;
+      unlink (target_path);
+      goto out;
+    }
+
+  /* apply the permissions of the source, which the umask may have masked */
+  if (errsv == 0 && fchmod (target_fd, statb.st_mode & 07777) < 0)
+    errsv = errno;
+  if (close (target_fd) < 0 && errsv == 0)
+    errsv = errno;
+  target_fd = -1;
+
+  handled = TRUE;
+  if (G_UNLIKELY (errsv != 0))
+    {
+      /* do not leave a partial copy behind */
+      unlink (target_path);
+
+      if (errsv == ECANCELED)
+        g_cancellable_set_error_if_cancelled (cancellable, error);
+      else
+        g_set_error_literal (error, G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+    }
+
+out:
+  if (target_fd >= 0)
+    close (target_fd);
+  if (source_fd >= 0)
+    close (source_fd);
+  g_free (source_path);
+  g_free (target_path);
+
+  return handled;
+#else
+  return FALSE;
+#endif
+}
+
+
+
+static gboolean
+ttj_copy_file (ThunarTransferTask *task,
+               GFile              *source_file,
+               GFile              *target_file,
+               GFileCopyFlags      copy_flags,
+               gboolean            merge_directories,
+               GError            **error)
+{
+  ThunarTransferJob *job = task->job;
+  GFileType          source_type;
+  GFileType          target_type;
+  gboolean           target_exists;
+  GError            *err = NULL;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
   _thunar_return_val_if_fail (G_IS_FILE (source_file), FALSE);
@@ -276,7 +766,7 @@ ttj_copy_file (ThunarTransferJob *job,
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
   /* reset the file progress */
-  job->file_progress = 0;
+  task->file_progress = 0;
 
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
     return FALSE;
@@ -304,10 +794,19 @@ ttj_copy_file (ThunarTransferJob *job,
         }
     }
 
-  /* try to copy the file */
-  g_file_copy (source_file, target_file, copy_flags,
-               exo_job_get_cancellable (EXO_JOB (job)),
-               thunar_transfer_job_progress, job, &err);
+  /* new local files are copied in the kernel if possible, everything
+   * else (and anything the kernel refuses) goes through GIO */
+  if (source_type != G_FILE_TYPE_REGULAR
+      || target_type != G_FILE_TYPE_UNKNOWN
+      || !g_file_is_native (source_file)
+      || !g_file_is_native (target_file)
+      || !ttj_copy_file_native (task, source_file, target_file, &err))
+    {
+      /* try to copy the file */
+      g_file_copy (source_file, target_file, copy_flags,
+                   exo_job_get_cancellable (EXO_JOB (job)),
+                   thunar_transfer_job_progress, task, &err);
+    }
 
   /* check if there were errors */
   if (G_UNLIKELY (err != NULL && err->domain == G_IO_ERROR))
@@ -380,7 +879,7 @@ ttj_copy_file (ThunarTransferJob *job,
 
 /**
  * thunar_transfer_job_copy_file:
- * @job                : a #ThunarTransferJob.
+ * @task               : the #ThunarTransferTask of the job.
  * @source_file        : the source #GFile to copy.
  * @target_file        : the destination #GFile to copy to.
  * @error              : return location for errors or %NULL.
@@ -401,15 +900,17 @@ ttj_copy_file (ThunarTransferJob *job,
  *               on error or cancellation.
  **/
 static GFile *
-thunar_transfer_job_copy_file (ThunarTransferJob *job,
-                               GFile             *source_file,
-                               GFile             *target_file,
-                               GError           **error)
+thunar_transfer_job_copy_file (ThunarTransferTask *task,
+                               GFile              *source_file,
+                               GFile              *target_file,
+                               GError            **error)
 {
-  ThunarJobResponse response;
-  GFileCopyFlags    copy_flags = G_FILE_COPY_NOFOLLOW_SYMLINKS;
-  GError           *err = NULL;
-  gint              n;
+  ThunarTransferJob *job = task->job;
+  ThunarJobResponse  response;
+  GFileCopyFlags     copy_flags = G_FILE_COPY_NOFOLLOW_SYMLINKS;
+  GError            *err = NULL;
+  gint64             start_time;
+  gint               n;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
   _thunar_return_val_if_fail (G_IS_FILE (source_file), NULL);
@@ -420,14 +921,20 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
     return NULL;
 
+  /* the latency of the file includes the questions */
+  start_time = g_get_monotonic_time ();
+
   /* various attempts to copy the file */
   while (err == NULL)
     {
       if (G_LIKELY (!g_file_equal (source_file, target_file)))
         {
           /* try to copy the file from source_file to the target_file */
-          if (ttj_copy_file (job, source_file, target_file, copy_flags, TRUE, &err))
+          if (ttj_copy_file (task, source_file, target_file, copy_flags, TRUE, &err))
             {
+              thunar_job_file_done (THUNAR_JOB (job), source_file,
+                                    task->file_progress, start_time);
+
               /* return the real target file */
               return g_object_ref (target_file);
             }
@@ -444,8 +951,11 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
               if (err == NULL)
                 {
                   /* try to copy the file from source file to the duplicate file */
-                  if (ttj_copy_file (job, source_file, duplicate_file, copy_flags, TRUE, &err))
+                  if (ttj_copy_file (task, source_file, duplicate_file, copy_flags, TRUE, &err))
                     {
+                      thunar_job_file_done (THUNAR_JOB (job), source_file,
+                                            task->file_progress, start_time);
+
                       /* return the real target file */
                       return duplicate_file;
                     }
@@ -467,9 +977,12 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
           /* reset the error */
           g_clear_error (&err);
 
-          /* ask the user whether to replace the target file */
+          /* ask the user whether to replace the target file, one
+           * question at a time if files are copied in parallel */
+          _transfer_job_lock (job, ask_lock);
           response = thunar_job_ask_replace (THUNAR_JOB (job), source_file,
                                              target_file, &err);
+          _transfer_job_unlock (job, ask_lock);
 
           if (err != NULL)
             break;
@@ -501,134 +1014,195 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
 
 
 static void
-thunar_transfer_job_copy_node (ThunarTransferJob  *job,
-                               ThunarTransferNode *node,
-                               GFile              *target_file,
-                               GFile              *target_parent_file,
-                               GList             **target_file_list_return,
-                               GError            **error)
+thunar_transfer_job_copy_done (ThunarTransferJob    *job,
+                               ThunarThumbnailCache *thumbnail_cache,
+                               ThunarTransferEntry  *entry,
+                               GFile                *real_target_file,
+                               GList               **target_file_list_return)
+{
+  ThunarJobResponse response;
+  GError           *err = NULL;
+
+  /* add the real target file of toplevel entries to the return list */
+  if (entry->depth == 0 && target_file_list_return != NULL)
+    {
+      *target_file_list_return =
+        thunar_g_file_list_prepend (*target_file_list_return,
+                                    real_target_file);
+    }
+
+retry_remove:
+  /* try to remove the source if we are on copy+remove fallback for move */
+  if (job->type == THUNAR_TRANSFER_JOB_MOVE)
+    {
+      if (g_file_delete (entry->source_file,
+                         exo_job_get_cancellable (EXO_JOB (job)),
+                         &err))
+        {
+          /* notify the thumbnail cache of the delete operation */
+          thunar_thumbnail_cache_delete_file (thumbnail_cache,
+                                              entry->source_file);
+        }
+      else
+        {
+          /* ask the user to retry */
+          _transfer_job_lock (job, ask_lock);
+          response = thunar_job_ask_skip (THUNAR_JOB (job), "%s",
+                                          err->message);
+          _transfer_job_unlock (job, ask_lock);
+
+          /* reset the error */
+          g_clear_error (&err);
+
+          /* check whether to retry */
+          if (G_UNLIKELY (response == THUNAR_JOB_RESPONSE_RETRY))
+            goto retry_remove;
+        }
+    }
+}
+
+
+
+static void
+thunar_transfer_job_copy_entries (ThunarTransferJob  *job,
+                                  GList             **target_file_list_return,
+                                  GError            **error)
 {
   ThunarThumbnailCache *thumbnail_cache;
+  ThunarTransferEntry  *entry;
+  ThunarTransferEntry  *parent;
+  ThunarTransferTask   *task;
+  ThunarTransferTask    job_task = { job, NULL, NULL, 0 };
   ThunarApplication    *application;
   ThunarJobResponse     response;
-  GFileInfo            *info;
+  GSList               *directories = NULL;
   GError               *err = NULL;
-  GFile                *real_target_file = NULL;
+  GFile                *target_file;
+  GFile                *real_target_file;
   gchar                *base_name;
 
   _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
-  _thunar_return_if_fail (node != NULL && G_IS_FILE (node->source_file));
-  _thunar_return_if_fail (target_file == NULL || node->next == NULL);
-  _thunar_return_if_fail ((target_file == NULL && target_parent_file != NULL) || (target_file != NULL && target_parent_file == NULL));
   _thunar_return_if_fail (error == NULL || *error == NULL);
 
-  /* The caller can either provide a target_file or a target_parent_file, but not both. The toplevel
-   * transfer_nodes (for which next is NULL) should be called with target_file, to get proper behavior
-   * wrt restoring files from the trash. Other transfer_nodes will be called with target_parent_file.
-   */
-
   /* take a reference on the thumbnail cache */
   application = thunar_application_get ();
   thumbnail_cache = thunar_application_get_thumbnail_cache (application);
   g_object_unref (application);
 
-  for (; err == NULL && node != NULL; node = node->next)
+  /* the scanner queues every folder before its contents, the stack
+   * holds the folders whose contents are still being copied */
+  for (;;)
     {
-      /* guess the target file for this node (unless already provided) */
-      if (G_LIKELY (target_file == NULL))
+      entry = g_async_queue_pop (job->scan_queue);
+      g_async_queue_push (job->scan_slots, GINT_TO_POINTER (1));
+
+      /* stop between two files while the job is paused */
+      thunar_job_check_paused (THUNAR_JOB (job));
+
+      /* finish the folders whose contents were copied completely */
+      while (directories != NULL
+             && (entry->source_file == NULL
+                 || ((ThunarTransferEntry *) directories->data)->depth >= entry->depth))
         {
-          base_name = g_file_get_basename (node->source_file);
-          target_file = g_file_get_child (target_parent_file, base_name);
-          g_free (base_name);
-        }
-      else
-        target_file = g_object_ref (target_file);
+          parent = directories->data;
+          directories = g_slist_delete_link (directories, directories);
 
-      /* query file info */
-      info = g_file_query_info (node->source_file,
-                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
-                                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                exo_job_get_cancellable (EXO_JOB (job)),
-                                &err);
+          if (err == NULL && parent->real_target_file != NULL)
+            {
+              thunar_transfer_job_copy_done (job, thumbnail_cache, parent,
+                                             parent->real_target_file,
+                                             target_file_list_return);
+            }
 
-      /* abort on error or cancellation */
-      if (info == NULL)
+          thunar_transfer_entry_free (parent);
+        }
+
+      /* check if the scan is done */
+      if (entry->source_file == NULL)
         {
-          g_object_unref (target_file);
+          if (err == NULL)
+            {
+              err = entry->error;
+              entry->error = NULL;
+            }
+
+          thunar_transfer_entry_free (entry);
           break;
         }
 
+      /* stop the scanner on errors, cancellation or a fatal error of a
+       * worker or the space check, but keep draining the queue until it's done so it doesn't
+       * block on a full queue. the worker error is reported by the caller */
+      if (err == NULL)
+        exo_job_set_error_if_cancelled (EXO_JOB (job), &err);
+      if (G_UNLIKELY (err != NULL || thunar_transfer_job_stopped (job)))
+        {
+          g_atomic_int_set (&job->scan_stopped, TRUE);
+          thunar_transfer_entry_free (entry);
+          continue;
+        }
+
+      /* skip the contents of folders that were not copied */
+      parent = (directories != NULL) ? directories->data : NULL;
+      if (entry->depth > 0 && (parent == NULL || parent->real_target_file == NULL))
+        {
+          thunar_transfer_entry_free (entry);
+          continue;
+        }
+
+      /* determine the target file for this entry */
+      if (entry->depth == 0)
+        {
+          target_file = g_object_ref (entry->target_file);
+        }
+      else
+        {
+          base_name = g_file_get_basename (entry->source_file);
+          target_file = g_file_get_child (parent->real_target_file, base_name);
+          g_free (base_name);
+        }
+
       /* update progress information */
-      exo_job_info_message (EXO_JOB (job), "%s", g_file_info_get_display_name (info));
+      exo_job_info_message (EXO_JOB (job), "%s", entry->display_name);
+
+      /* hand files inside the copied folders over to the workers, the
+       * folder itself was created before its children are copied */
+      if (job->workers != NULL && entry->depth > 0 && !entry->is_directory)
+        {
+          task = g_slice_new0 (ThunarTransferTask);
+          task->job = job;
+          task->source_file = g_object_ref (entry->source_file);
+          task->target_file = target_file;
+
+          /* wait for a free slot, so the workers never fall more
+           * than THUNAR_TRANSFER_JOB_MAX_TASKS files behind */
+          g_async_queue_pop (job->worker_slots);
+          g_thread_pool_push (job->workers, task, NULL);
+
+          thunar_transfer_entry_free (entry);
+          continue;
+        }
 
 retry_copy:
-      /* copy the item specified by this node (not recursively) */
-      real_target_file = thunar_transfer_job_copy_file (job, node->source_file,
+      /* copy the item specified by this entry (not recursively) */
+      real_target_file = thunar_transfer_job_copy_file (&job_task, entry->source_file,
                                                         target_file, &err);
       if (G_LIKELY (real_target_file != NULL))
         {
-          /* node->source_file == real_target_file means to skip the file */
-          if (G_LIKELY (node->source_file != real_target_file))
+          /* entry->source_file == real_target_file means to skip the file */
+          if (G_LIKELY (entry->source_file != real_target_file))
             {
               /* notify the thumbnail cache of the copy operation */
               thunar_thumbnail_cache_copy_file (thumbnail_cache,
-                                                node->source_file,
+                                                entry->source_file,
                                                 real_target_file);
 
-              /* check if we have children to copy */
-              if (node->children != NULL)
-                {
-                  /* copy all children of this node */
-                  thunar_transfer_job_copy_node (job, node->children, NULL, real_target_file, NULL, &err);
-
-                  /* free resources allocted for the children */
-                  thunar_transfer_node_free (node->children);
-                  node->children = NULL;
-                }
-
-              /* check if the child copy failed */
-              if (G_UNLIKELY (err != NULL))
-                {
-                  /* outa here, freeing the target paths */
-                  g_object_unref (real_target_file);
-                  g_object_unref (target_file);
-                  break;
-                }
-
-              /* add the real target file to the return list */
-              if (G_LIKELY (target_file_list_return != NULL))
-                {
-                  *target_file_list_return =
-                    thunar_g_file_list_prepend (*target_file_list_return,
-                                                real_target_file);
-                }
-
-retry_remove:
-              /* try to remove the source directory if we are on copy+remove fallback for move */
-              if (job->type == THUNAR_TRANSFER_JOB_MOVE)
-                {
-                  if (g_file_delete (node->source_file,
-                                     exo_job_get_cancellable (EXO_JOB (job)),
-                                     &err))
-                    {
-                      /* notify the thumbnail cache of the delete operation */
-                      thunar_thumbnail_cache_delete_file (thumbnail_cache,
-                                                          node->source_file);
-                    }
-                  else
-                    {
-                      /* ask the user to retry */
-                      response = thunar_job_ask_skip (THUNAR_JOB (job), "%s",
-                                                      err->message);
-
-                      /* reset the error */
-                      g_clear_error (&err);
-
-                      /* check whether to retry */
-                      if (G_UNLIKELY (response == THUNAR_JOB_RESPONSE_RETRY))
-                        goto retry_remove;
-                    }
-                }
+              /* folders are done once their contents were copied */
+              if (entry->is_directory)
+                entry->real_target_file = g_object_ref (real_target_file);
+              else
+                thunar_transfer_job_copy_done (job, thumbnail_cache, entry, real_target_file,
+                                               target_file_list_return);
             }
 
           g_object_unref (real_target_file);
@@ -638,8 +1212,10 @@ retry_remove:
           /* we can only skip if there is space left on the device */
           if (err->domain != G_IO_ERROR || err->code != G_IO_ERROR_NO_SPACE)
             {
-              /* ask the user to skip this node and all subnodes */
+              /* ask the user to skip this entry and all of its contents */
+              _transfer_job_lock (job, ask_lock);
               response = thunar_job_ask_skip (THUNAR_JOB (job), "%s", err->message);
+              _transfer_job_unlock (job, ask_lock);
 
               /* reset the error */
               g_clear_error (&err);
@@ -652,12 +1228,17 @@ retry_remove:
 
       /* release the guessed target file */
       g_object_unref (target_file);
-      target_file = NULL;
 
-      /* release file info */
-      g_object_unref (info);
+      /* keep folders around until their contents were copied */
+      if (entry->is_directory)
+        directories = g_slist_prepend (directories, entry);
+      else
+        thunar_transfer_entry_free (entry);
     }
 
+  /* the end of the scan finishes all folders */
+  _thunar_assert (directories == NULL);
+
   /* release the thumbnail cache */
   g_object_unref (thumbnail_cache);
 
@@ -668,6 +1249,126 @@ retry_remove:
 
 
 
+static void
+thunar_transfer_job_worker (gpointer data,
+                            gpointer user_data)
+{
+  ThunarThumbnailCache *thumbnail_cache;
+  ThunarTransferTask   *task = data;
+  ThunarTransferJob    *job = THUNAR_TRANSFER_JOB (user_data);
+  ThunarApplication    *application;
+  ThunarJobResponse     response;
+  GError               *err = NULL;
+  GFile                *real_target_file;
+  gboolean              failed;
+
+  _thunar_return_if_fail (task->job == job);
+
+  /* skip the remaining files once the copy failed or was cancelled */
+  failed = thunar_transfer_job_stopped (job);
+
+  while (!failed && !exo_job_is_cancelled (EXO_JOB (job)))
+    {
+      real_target_file = thunar_transfer_job_copy_file (task, task->source_file,
+                                                        task->target_file, &err);
+      if (G_LIKELY (real_target_file != NULL))
+        {
+          /* notify the thumbnail cache of the copy operation, unless skipped */
+          if (G_LIKELY (real_target_file != task->source_file))
+            {
+              application = thunar_application_get ();
+              thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+              thunar_thumbnail_cache_copy_file (thumbnail_cache, task->source_file, real_target_file);
+              g_object_unref (thumbnail_cache);
+              g_object_unref (application);
+            }
+
+          g_object_unref (real_target_file);
+          break;
+        }
+      else if (err != NULL && !exo_job_is_cancelled (EXO_JOB (job)))
+        {
+          _transfer_job_lock (job, ask_lock);
+
+          /* we can only skip if there is space left on the device */
+          if (err->domain != G_IO_ERROR || err->code != G_IO_ERROR_NO_SPACE)
+            {
+              /* ask the user to skip this file */
+              response = thunar_job_ask_skip (THUNAR_JOB (job), "%s", err->message);
+              g_clear_error (&err);
+            }
+          else
+            {
+              /* remember the first fatal error for the job thread */
+              if (job->worker_error == NULL)
+                job->worker_error = err;
+              else
+                g_error_free (err);
+              err = NULL;
+              response = THUNAR_JOB_RESPONSE_CANCEL;
+            }
+
+          _transfer_job_unlock (job, ask_lock);
+
+          /* check whether to retry */
+          if (G_LIKELY (response != THUNAR_JOB_RESPONSE_RETRY))
+            break;
+        }
+      else
+        {
+          break;
+        }
+    }
+
+  if (err != NULL)
+    g_error_free (err);
+
+  g_object_unref (task->source_file);
+  g_object_unref (task->target_file);
+  g_slice_free (ThunarTransferTask, task);
+
+  /* let the job thread queue the next file */
+  g_async_queue_push (job->worker_slots, GINT_TO_POINTER (1));
+}
+
+
+
+static gboolean
+thunar_transfer_job_has_directories (ThunarTransferJob *job)
+{
+  GList *lp;
+
+  for (lp = job->source_node_list; lp != NULL; lp = lp->next)
+    if (((ThunarTransferNode *) lp->data)->is_directory)
+      return TRUE;
+
+  return FALSE;
+}
+
+
+
+static gboolean
+thunar_transfer_job_schedule (ThunarTransferJob  *job,
+                              GError            **error)
+{
+  gboolean result;
+  GList   *files;
+  GList   *lp;
+
+  /* the job reads from the sources and writes to the targets */
+  files = g_list_copy (job->target_file_list);
+  for (lp = job->source_node_list; lp != NULL; lp = lp->next)
+    files = g_list_prepend (files, ((ThunarTransferNode *) lp->data)->source_file);
+
+  result = thunar_job_schedule (THUNAR_JOB (job), files, error);
+
+  g_list_free (files);
+
+  return result;
+}
+
+
+
 static gboolean
 thunar_transfer_job_veryify_destination (ThunarTransferJob  *transfer_job,
                                          GError            **error)
@@ -687,10 +1388,6 @@ thunar_transfer_job_veryify_destination (ThunarTransferJob  *transfer_job,
   if (transfer_job->target_file_list == NULL)
     return TRUE;
 
-  /* total size is nul, should be fine */
-  if (transfer_job->total_size == 0)
-    return TRUE;
-
   /* for all actions in thunar use the same target directory so
    * although not all files are checked, this should work nicely */
   dest = g_file_get_parent (G_FILE (transfer_job->target_file_list->data));
@@ -736,6 +1433,12 @@ thunar_transfer_job_veryify_destination (ThunarTransferJob  *transfer_job,
                                             dest_name, size_string);
           g_free (size_string);
         }
+      else
+        {
+          /* the scanner checks the contents of folders against it */
+          transfer_job->free_space = free_space;
+          transfer_job->free_space_name = g_strdup (dest_name);
+        }
     }
 
   if (succeed && g_file_info_get_attribute_boolean (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_READONLY))
@@ -775,8 +1478,10 @@ thunar_transfer_job_execute (ExoJob  *job,
   GList                *tnext;
   GList                *tp;
   GFile                *target_parent;
+  GThreadPool          *scanner;
   gchar                *base_name;
   gchar                *parent_display_name;
+  guint                 n;
 
   _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -784,6 +1489,7 @@ thunar_transfer_job_execute (ExoJob  *job,
   if (exo_job_set_error_if_cancelled (job, error))
     return FALSE;
 
+  thunar_job_set_phase (THUNAR_JOB (job), THUNAR_JOB_PHASE_COLLECTING);
   exo_job_info_message (job, _("Collecting files..."));
 
   /* take a reference on the thumbnail cache */
@@ -803,7 +1509,9 @@ thunar_transfer_job_execute (ExoJob  *job,
       node = sp->data;
 
       info = g_file_query_info (node->source_file,
-                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
+                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                G_FILE_ATTRIBUTE_STANDARD_TYPE,
                                 G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
                                 exo_job_get_cancellable (job),
                                 &err);
@@ -923,18 +1631,12 @@ thunar_transfer_job_execute (ExoJob  *job,
                                            "Collecting files for copying..."),
                                     g_file_info_get_display_name (info));
 
-              if (!thunar_transfer_job_collect_node (transfer_job, node, &err))
-                {
-                  /* failed to collect, cannot continue */
-                  g_object_unref (info);
-                  break;
-                }
+              thunar_transfer_job_add_node (transfer_job, node, info);
             }
         }
       else if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY)
         {
-          if (!thunar_transfer_job_collect_node (THUNAR_TRANSFER_JOB (job), node, &err))
-            break;
+          thunar_transfer_job_add_node (transfer_job, node, info);
         }
 
       g_object_unref (info);
@@ -961,19 +1663,80 @@ thunar_transfer_job_execute (ExoJob  *job,
             }
         }
 
+      /* wait for the other jobs on the same devices */
+      thunar_transfer_job_schedule (transfer_job, &err);
+    }
+
+  /* continue if the job may start */
+  if (G_LIKELY (err == NULL))
+    {
       /* transfer starts now */
       transfer_job->start_time = g_get_real_time ();
+      thunar_job_set_phase (THUNAR_JOB (job), THUNAR_JOB_PHASE_PROCESSING);
+
+      /* copy the files inside folders in parallel, each file is a round
+       * trip to the file system otherwise. the number of files is not known
+       * before the scan, so the threads are only started on demand */
+      if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY
+          && thunar_transfer_job_has_directories (transfer_job))
+        {
+          transfer_job->workers = g_thread_pool_new (thunar_transfer_job_worker, transfer_job,
+                                                     THUNAR_TRANSFER_JOB_MAX_WORKERS,
+                                                     FALSE, NULL);
+          transfer_job->worker_slots = g_async_queue_new ();
+          for (n = 0; n < THUNAR_TRANSFER_JOB_MAX_TASKS; n++)
+            g_async_queue_push (transfer_job->worker_slots, GINT_TO_POINTER (1));
+        }
+
+      if (transfer_job->source_node_list != NULL)
+        {
+          /* scan the folders in another thread, the copy starts with the
+           * first entries found instead of waiting for the whole tree */
+          transfer_job->scan_queue = g_async_queue_new ();
+          transfer_job->scan_slots = g_async_queue_new ();
+          transfer_job->scan_stopped = FALSE;
+          for (n = 0; n < THUNAR_TRANSFER_JOB_MAX_QUEUED; n++)
+            g_async_queue_push (transfer_job->scan_slots, GINT_TO_POINTER (1));
+
+          scanner = g_thread_pool_new (thunar_transfer_job_scanner, transfer_job, 1, FALSE, NULL);
+          g_thread_pool_push (scanner, transfer_job, NULL);
+
+          /* perform the copy for all entries of the scan */
+          thunar_transfer_job_copy_entries (transfer_job, &new_files_list, &err);
+
+          /* the scanner is done once its last entry was copied */
+          g_thread_pool_free (scanner, FALSE, TRUE);
+
+          g_async_queue_unref (transfer_job->scan_queue);
+          transfer_job->scan_queue = NULL;
+          g_async_queue_unref (transfer_job->scan_slots);
+          transfer_job->scan_slots = NULL;
+        }
+
+      /* wait until the workers copied all queued files */
+      if (transfer_job->workers != NULL)
+        {
+          g_thread_pool_free (transfer_job->workers, FALSE, TRUE);
+          transfer_job->workers = NULL;
+          g_async_queue_unref (transfer_job->worker_slots);
+          transfer_job->worker_slots = NULL;
+        }
 
-      /* perform the copy recursively for all source transfer nodes */
-      for (sp = transfer_job->source_node_list, tp = transfer_job->target_file_list;
-           sp != NULL && tp != NULL && err == NULL;
-           sp = sp->next, tp = tp->next)
+      /* report the error that stopped the workers or the scan */
+      if (transfer_job->worker_error != NULL)
         {
-          thunar_transfer_job_copy_node (transfer_job, sp->data, tp->data, NULL,
-                                         &new_files_list, &err);
+          if (err == NULL)
+            err = transfer_job->worker_error;
+          else
+            g_error_free (transfer_job->worker_error);
+          transfer_job->worker_error = NULL;
         }
     }
 
+  /* let the next job on the same devices start */
+  thunar_job_set_phase (THUNAR_JOB (job), THUNAR_JOB_PHASE_IDLE);
+  thunar_job_unschedule (THUNAR_JOB (job));
+
   /* check if we failed */
   if (G_UNLIKELY (err != NULL))
     {
@@ -994,26 +1757,13 @@ static void
 thunar_transfer_node_free (gpointer data)
 {
   ThunarTransferNode *node = data;
-  ThunarTransferNode *next;
 
-  /* free all nodes in a row */
-  while (node != NULL)
-    {
-      /* free all children of this node */
-      thunar_transfer_node_free (node->children);
-
-      /* determine the next node */
-      next = node->next;
-
-      /* drop the source file of this node */
-      g_object_unref (node->source_file);
+  /* drop the source file of this node */
+  g_object_unref (node->source_file);
+  g_free (node->display_name);
 
-      /* release the resources of this node */
-      g_slice_free (ThunarTransferNode, node);
-
-      /* continue with the next node */
-      node = next;
-    }
+  /* release the resources of this node */
+  g_slice_free (ThunarTransferNode, node);
 }
 
 
@@ -46,6 +46,7 @@
 #define G_NODE_HAS_DUMMY(node)       (node->children != NULL \
                                       && node->children->data == NULL \
                                       && node->children->next == NULL)
+#define G_NODE_CHILDREN_ARRAY(node)  (THUNAR_TREE_MODEL_ITEM ((node)->data)->children)
 
 
 
@@ -108,6 +109,9 @@ static void                 thunar_tree_model_unref_node              (GtkTreeMo
 static gint                 thunar_tree_model_cmp_array               (gconstpointer           a,
                                                                        gconstpointer           b,
                                                                        gpointer                user_data);
+static gint                 thunar_tree_model_cmp_files               (gconstpointer           a,
+                                                                       gconstpointer           b,
+                                                                       gpointer                user_data);
 static void                 thunar_tree_model_sort                    (ThunarTreeModel        *model,
                                                                        GNode                  *node);
 static gboolean             thunar_tree_model_cleanup_idle            (gpointer                user_data);
@@ -133,6 +137,8 @@ static ThunarTreeModelItem *thunar_tree_model_item_new_with_file      (ThunarTre
 static ThunarTreeModelItem *thunar_tree_model_item_new_with_device    (ThunarTreeModel        *model,
                                                                        ThunarDevice           *device) G_GNUC_MALLOC;
 static void                 thunar_tree_model_item_free               (ThunarTreeModelItem    *item);
+static void                 thunar_tree_model_item_take_file          (ThunarTreeModelItem    *item,
+                                                                       ThunarFile             *file);
 static void                 thunar_tree_model_item_reset              (ThunarTreeModelItem    *item);
 static void                 thunar_tree_model_item_load_folder        (ThunarTreeModelItem    *item);
 static void                 thunar_tree_model_item_files_added        (ThunarTreeModelItem    *item,
@@ -148,12 +154,25 @@ static void                 thunar_tree_model_item_notify_loading     (ThunarTre
                                                                        ThunarFolder           *folder);
 static void                 thunar_tree_model_node_insert_dummy       (GNode                  *parent,
                                                                        ThunarTreeModel        *model);
+static gint                 thunar_tree_model_node_position           (GNode                  *node,
+                                                                       ThunarTreeModel        *model);
+static guint                thunar_tree_model_node_search             (GNode                  *parent,
+                                                                       ThunarFile             *file,
+                                                                       ThunarTreeModel        *model);
+static GNode               *thunar_tree_model_node_link               (GNode                  *parent,
+                                                                       guint                   position,
+                                                                       GNode                  *node);
+static void                 thunar_tree_model_node_unlink             (GNode                  *node,
+                                                                       ThunarTreeModel        *model);
+static void                 thunar_tree_model_node_insert_files       (GNode                  *node,
+                                                                       GList                  *files,
+                                                                       ThunarTreeModel        *model);
+static void                 thunar_tree_model_node_reposition         (GNode                  *node,
+                                                                       ThunarTreeModel        *model);
 static void                 thunar_tree_model_node_drop_dummy         (GNode                  *node,
                                                                        ThunarTreeModel        *model);
 static gboolean             thunar_tree_model_node_traverse_cleanup   (GNode                  *node,
                                                                        gpointer                user_data);
-static gboolean             thunar_tree_model_node_traverse_changed   (GNode                  *node,
-                                                                       gpointer                user_data);
 static gboolean             thunar_tree_model_node_traverse_remove    (GNode                  *node,
                                                                        gpointer                user_data);
 static gboolean             thunar_tree_model_node_traverse_sort      (GNode                  *node,
@@ -197,6 +216,10 @@ struct _ThunarTreeModel
 
   GNode                      *root;
 
+  /* the items of every file in the tree, a file may be in
+   * several nodes, e.g. below "Home" and "File System" */
+  GHashTable                 *file_items;
+
   guint                       cleanup_idle_id;
 };
 
@@ -209,6 +232,13 @@ struct _ThunarTreeModelItem
   ThunarDevice    *device;
   ThunarTreeModel *model;
 
+  /* the node of this item in the tree */
+  GNode           *node;
+
+  /* the child nodes in the order of the node's children,
+   * to look up rows and positions without walking the list */
+  GPtrArray       *children;
+
   /* list of children of this node that are
    * not visible in the treeview */
   GSList          *invisible_children;
@@ -305,6 +335,9 @@ thunar_tree_model_init (ThunarTreeModel *model)
   /* allocate the "virtual root node" */
   model->root = g_node_new (NULL);
 
+  /* the lists of items per file */
+  model->file_items = g_hash_table_new (g_direct_hash, g_direct_equal);
+
   /* connect to the volume monitor */
   model->device_monitor = thunar_device_monitor_get ();
   g_signal_connect (model->device_monitor, "device-added", G_CALLBACK (thunar_tree_model_device_added), model);
@@ -348,10 +381,11 @@ thunar_tree_model_init (ThunarTreeModel *model)
           /* create and append the new node */
           item = thunar_tree_model_item_new_with_file (model, file);
           node = g_node_append_data (model->root, item);
+          item->node = node;
           g_object_unref (G_OBJECT (file));
 
           /* add the dummy node */
-          g_node_append_data (node, NULL);
+          thunar_tree_model_node_link (node, 0, g_node_new (NULL));
         }
 
       /* release the system defined path */
@@ -389,6 +423,7 @@ thunar_tree_model_finalize (GObject *object)
   /* release all resources allocated to the model */
   g_node_traverse (model->root, G_POST_ORDER, G_TRAVERSE_ALL, -1, thunar_tree_model_node_traverse_free, NULL);
   g_node_destroy (model->root);
+  g_hash_table_destroy (model->file_items);
 
   /* disconnect from the volume monitor */
   g_signal_handlers_disconnect_matched (model->device_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, model);
@@ -528,7 +563,6 @@ thunar_tree_model_get_path (GtkTreeModel *tree_model,
   ThunarTreeModel *model = THUNAR_TREE_MODEL (tree_model);
   GtkTreePath     *path;
   GtkTreeIter      tmp_iter;
-  GNode           *tmp_node;
   GNode           *node;
   gint             n;
 
@@ -547,7 +581,6 @@ thunar_tree_model_get_path (GtkTreeModel *tree_model,
   if (node->parent == model->root)
     {
       path = gtk_tree_path_new ();
-      tmp_node = g_node_first_child (model->root);
     }
   else
     {
@@ -556,21 +589,16 @@ thunar_tree_model_get_path (GtkTreeModel *tree_model,
 
       /* determine the path for the parent node */
       path = gtk_tree_model_get_path (tree_model, &tmp_iter);
-
-      /* and the node for the parent's children */
-      tmp_node = g_node_first_child (node->parent);
     }
 
   /* check if we have a valid path */
   if (G_LIKELY (path != NULL))
     {
       /* lookup our index in the child list */
-      for (n = 0; tmp_node != NULL; ++n, tmp_node = tmp_node->next)
-        if (tmp_node == node)
-          break;
+      n = thunar_tree_model_node_position (node, model);
 
       /* check if we have found the node */
-      if (G_UNLIKELY (tmp_node == NULL))
+      if (G_UNLIKELY (n < 0))
         {
           gtk_tree_path_free (path);
           return NULL;
@@ -703,11 +731,17 @@ thunar_tree_model_iter_n_children (GtkTreeModel *tree_model,
                                    GtkTreeIter  *iter)
 {
   ThunarTreeModel *model = THUNAR_TREE_MODEL (tree_model);
+  GNode           *node;
 
   _thunar_return_val_if_fail (iter == NULL || iter->user_data != NULL, 0);
   _thunar_return_val_if_fail (iter == NULL || iter->stamp == model->stamp, 0);
 
-  return g_node_n_children ((iter == NULL) ? model->root : iter->user_data);
+  /* the dummy and the "virtual root node" have no child array */
+  node = (iter == NULL) ? model->root : iter->user_data;
+  if (G_UNLIKELY (node->data == NULL))
+    return g_node_n_children (node);
+
+  return G_NODE_CHILDREN_ARRAY (node)->len;
 }
 
 
@@ -719,12 +753,25 @@ thunar_tree_model_iter_nth_child (GtkTreeModel *tree_model,
                                   gint          n)
 {
   ThunarTreeModel *model = THUNAR_TREE_MODEL (tree_model);
+  GPtrArray       *children;
   GNode           *child;
+  GNode           *node;
 
   _thunar_return_val_if_fail (parent == NULL || parent->user_data != NULL, FALSE);
   _thunar_return_val_if_fail (parent == NULL || parent->stamp == model->stamp, FALSE);
 
-  child = g_node_nth_child ((parent != NULL) ? parent->user_data : model->root, n);
+  /* the dummy and the "virtual root node" have no child array */
+  node = (parent != NULL) ? parent->user_data : model->root;
+  if (G_UNLIKELY (node->data == NULL))
+    {
+      child = g_node_nth_child (node, n);
+    }
+  else
+    {
+      children = G_NODE_CHILDREN_ARRAY (node);
+      child = (n >= 0 && (guint) n < children->len) ? g_ptr_array_index (children, n) : NULL;
+    }
+
   if (G_LIKELY (child != NULL))
     {
       GTK_TREE_ITER_INIT (*iter, model->stamp, child);
@@ -843,6 +890,20 @@ thunar_tree_model_cmp_array (gconstpointer a,
 
 
 
+static gint
+thunar_tree_model_cmp_files (gconstpointer a,
+                             gconstpointer b,
+                             gpointer      user_data)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_TREE_MODEL (user_data), 0);
+
+  /* same order as thunar_tree_model_cmp_array() */
+  return thunar_file_compare_by_name (THUNAR_FILE (a), THUNAR_FILE (b),
+                                      THUNAR_TREE_MODEL (user_data)->sort_case_sensitive);
+}
+
+
+
 static void
 thunar_tree_model_sort (ThunarTreeModel *model,
                         GNode           *node)
@@ -896,6 +957,10 @@ thunar_tree_model_sort (ThunarTreeModel *model,
       sort_array[n].node->prev = NULL;
       sort_array[n].node->parent = NULL;
       g_node_append (node, sort_array[n].node);
+
+      /* keep the child array in sync */
+      if (G_LIKELY (node->data != NULL))
+        g_ptr_array_index (G_NODE_CHILDREN_ARRAY (node), n) = sort_array[n].node;
     }
 
   /* determine the iterator for the parent node */
@@ -944,14 +1009,40 @@ thunar_tree_model_file_changed (ThunarFileMonitor *file_monitor,
                                 ThunarFile        *file,
                                 ThunarTreeModel   *model)
 {
+  ThunarTreeModelItem *item;
+  GtkTreePath         *path;
+  GtkTreeIter          iter;
+  GSList              *lp;
+
   _thunar_return_if_fail (THUNAR_IS_FILE_MONITOR (file_monitor));
   _thunar_return_if_fail (model->file_monitor == file_monitor);
   _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (model));
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
-  /* traverse the model and emit "row-changed" for the file's nodes */
-  if (thunar_file_is_directory (file))
-    g_node_traverse (model->root, G_PRE_ORDER, G_TRAVERSE_ALL, -1, thunar_tree_model_node_traverse_changed, file);
+  if (!thunar_file_is_directory (file))
+    return;
+
+  /* emit "row-changed" for the file's nodes */
+  for (lp = g_hash_table_lookup (model->file_items, file); lp != NULL; lp = lp->next)
+    {
+      item = THUNAR_TREE_MODEL_ITEM (lp->data);
+
+      /* the name of the file may have changed */
+      if (G_LIKELY (item->node->parent != model->root))
+        thunar_tree_model_node_reposition (item->node, model);
+
+      /* determine the iterator for the node */
+      GTK_TREE_ITER_INIT (iter, model->stamp, item->node);
+
+      /* determine the path for the node */
+      path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+      if (G_LIKELY (path != NULL))
+        {
+          /* emit "row-changed" */
+          gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+          gtk_tree_path_free (path);
+        }
+    }
 }
 
 
@@ -991,7 +1082,7 @@ thunar_tree_model_device_changed (ThunarDeviceMonitor *device_monitor,
       if (mount_point != NULL)
         {
           /* try to determine the file for the mount point */
-          item->file = thunar_file_get (mount_point, NULL);
+          thunar_tree_model_item_take_file (item, thunar_file_get (mount_point, NULL));
 
           /* because the volume node is already reffed, we need to load the folder manually here */
           thunar_tree_model_item_load_folder (item);
@@ -1080,6 +1171,7 @@ thunar_tree_model_device_added (ThunarDeviceMonitor *device_monitor,
   /* insert before the last child of the root (the "File System" node) */
   node = g_node_last_child (model->root);
   node = g_node_insert_data_before (model->root, node, item);
+  item->node = node;
 
   /* determine the iterator for the new node */
   GTK_TREE_ITER_INIT (iter, model->stamp, node);
@@ -1129,8 +1221,9 @@ thunar_tree_model_item_new_with_file (ThunarTreeModel *model,
   ThunarTreeModelItem *item;
 
   item = g_slice_new0 (ThunarTreeModelItem);
-  item->file = g_object_ref (G_OBJECT (file));
   item->model = model;
+  item->children = g_ptr_array_new ();
+  thunar_tree_model_item_take_file (item, g_object_ref (G_OBJECT (file)));
 
   return item;
 }
@@ -1147,6 +1240,7 @@ thunar_tree_model_item_new_with_device (ThunarTreeModel *model,
   item = g_slice_new0 (ThunarTreeModelItem);
   item->device = g_object_ref (G_OBJECT (device));
   item->model = model;
+  item->children = g_ptr_array_new ();
 
   /* check if the volume is mounted */
   if (thunar_device_is_mounted (device))
@@ -1155,7 +1249,7 @@ thunar_tree_model_item_new_with_device (ThunarTreeModel *model,
       if (G_LIKELY (mount_point != NULL))
         {
           /* try to determine the file for the mount point */
-          item->file = thunar_file_get (mount_point, NULL);
+          thunar_tree_model_item_take_file (item, thunar_file_get (mount_point, NULL));
           g_object_unref (mount_point);
         }
     }
@@ -1175,6 +1269,9 @@ thunar_tree_model_item_free (ThunarTreeModelItem *item)
   /* reset the remaining resources */
   thunar_tree_model_item_reset (item);
 
+  /* release the child array */
+  g_ptr_array_free (item->children, TRUE);
+
   /* release the item */
   g_slice_free (ThunarTreeModelItem, item);
 }
@@ -1211,9 +1308,37 @@ thunar_tree_model_item_reset (ThunarTreeModelItem *item)
         thunar_file_unwatch (item->file);
 
       /* release and reset the file */
+      thunar_tree_model_item_take_file (item, NULL);
+    }
+}
+
+
+
+static void
+thunar_tree_model_item_take_file (ThunarTreeModelItem *item,
+                                  ThunarFile          *file)
+{
+  GHashTable *file_items = item->model->file_items;
+  GSList     *items;
+
+  /* forget the previous file */
+  if (item->file != NULL)
+    {
+      items = g_slist_remove (g_hash_table_lookup (file_items, item->file), item);
+      if (items != NULL)
+        g_hash_table_insert (file_items, item->file, items);
+      else
+        g_hash_table_remove (file_items, item->file);
+
       g_object_unref (G_OBJECT (item->file));
-      item->file = NULL;
     }
+
+  /* take over the reference on the new file */
+  item->file = file;
+
+  /* remember the item for the file */
+  if (file != NULL)
+    g_hash_table_insert (file_items, file, g_slist_prepend (g_hash_table_lookup (file_items, file), item));
 }
 
 
@@ -1238,14 +1363,10 @@ thunar_tree_model_item_files_added (ThunarTreeModelItem *item,
                                     GList               *files,
                                     ThunarFolder        *folder)
 {
-  ThunarTreeModelItem *child_item;
-  ThunarTreeModel     *model = THUNAR_TREE_MODEL (item->model);
-  GtkTreePath         *child_path;
-  GtkTreeIter          child_iter;
-  ThunarFile          *file;
-  GNode               *child_node;
-  GNode               *node = NULL;
-  GList               *lp;
+  ThunarTreeModel *model = THUNAR_TREE_MODEL (item->model);
+  ThunarFile      *file;
+  GList           *visible_files = NULL;
+  GList           *lp;
 
   _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
   _thunar_return_if_fail (item->folder == folder);
@@ -1268,50 +1389,15 @@ thunar_tree_model_item_files_added (ThunarTreeModelItem *item,
           continue;
         }
 
-      /* lookup the node for the item (on-demand) */
-      if (G_UNLIKELY (node == NULL))
-        node = g_node_find (model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
-      _thunar_return_if_fail (node != NULL);
-
-      /* allocate a new item for the file */
-      child_item = thunar_tree_model_item_new_with_file (model, file);
-
-      /* check if the node has only the dummy child */
-      if (G_UNLIKELY (G_NODE_HAS_DUMMY (node)))
-        {
-          /* replace the dummy node with the new node */
-          child_node = g_node_first_child (node);
-          child_node->data = child_item;
-
-          /* determine the tree iter for the child */
-          GTK_TREE_ITER_INIT (child_iter, model->stamp, child_node);
-
-          /* emit a "row-changed" for the new node */
-          child_path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &child_iter);
-          gtk_tree_model_row_changed (GTK_TREE_MODEL (model), child_path, &child_iter);
-          gtk_tree_path_free (child_path);
-        }
-      else
-        {
-          /* insert a new item for the child */
-          child_node = g_node_append_data (node, child_item);
-
-          /* determine the tree iter for the child */
-          GTK_TREE_ITER_INIT (child_iter, model->stamp, child_node);
-
-          /* emit a "row-inserted" for the new node */
-          child_path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &child_iter);
-          gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), child_path, &child_iter);
-          gtk_tree_path_free (child_path);
-        }
-
-      /* add a dummy child node */
-      thunar_tree_model_node_insert_dummy (child_node, model);
+      visible_files = g_list_prepend (visible_files, file);
     }
 
-  /* sort the folders if any new ones were added */
-  if (G_LIKELY (node != NULL))
-    thunar_tree_model_sort (model, node);
+  /* insert the new folders at their sorted positions */
+  if (G_LIKELY (visible_files != NULL))
+    {
+      thunar_tree_model_node_insert_files (item->node, visible_files, model);
+      g_list_free (visible_files);
+    }
 }
 
 
@@ -1325,15 +1411,13 @@ thunar_tree_model_item_files_removed (ThunarTreeModelItem *item,
   GtkTreePath     *path;
   GtkTreeIter      iter;
   GNode           *child_node;
-  GNode           *node;
+  GNode           *node = item->node;
   GList           *lp;
   GSList          *inv_link;
+  GSList          *items;
 
   _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
   _thunar_return_if_fail (item->folder == folder);
-
-  /* determine the node for the folder */
-  node = g_node_find (model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
   _thunar_return_if_fail (node != NULL);
 
   /* check if the node has any visible children */
@@ -1343,9 +1427,12 @@ thunar_tree_model_item_files_removed (ThunarTreeModelItem *item,
       for (lp = files; lp != NULL; lp = lp->next)
         {
           /* find the child node for the file */
-          for (child_node = g_node_first_child (node); child_node != NULL; child_node = g_node_next_sibling (child_node))
-            if (child_node->data != NULL && THUNAR_TREE_MODEL_ITEM (child_node->data)->file == lp->data)
-              break;
+          for (child_node = NULL, items = g_hash_table_lookup (model->file_items, lp->data); items != NULL; items = items->next)
+            if (THUNAR_TREE_MODEL_ITEM (items->data)->node->parent == node)
+              {
+                child_node = THUNAR_TREE_MODEL_ITEM (items->data)->node;
+                break;
+              }
 
           /* drop the child node (and all descendant nodes) from the model */
           if (G_LIKELY (child_node != NULL))
@@ -1391,22 +1478,16 @@ thunar_tree_model_item_notify_loading (ThunarTreeModelItem *item,
                                        GParamSpec          *pspec,
                                        ThunarFolder        *folder)
 {
-  GNode *node;
-
   _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
   _thunar_return_if_fail (item->folder == folder);
   _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (item->model));
+  _thunar_return_if_fail (item->node != NULL);
 
   /* be sure to drop the dummy child node once the folder is loaded */
   if (G_LIKELY (!thunar_folder_get_loading (folder)))
     {
-      /* lookup the node for the item... */
-      node = g_node_find (item->model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
-      _thunar_return_if_fail (node != NULL);
-
-      /* ...and drop the dummy for the node */
-      if (G_NODE_HAS_DUMMY (node))
-        thunar_tree_model_node_drop_dummy (node, item->model);
+      if (G_NODE_HAS_DUMMY (item->node))
+        thunar_tree_model_node_drop_dummy (item->node, item->model);
     }
 }
 
@@ -1418,21 +1499,13 @@ thunar_tree_model_item_load_idle (gpointer user_data)
   ThunarTreeModelItem *item = user_data;
   GFile               *mount_point;
   GList               *files;
-#ifndef NDEBUG
-  GNode               *node;
-#endif
 
   _thunar_return_val_if_fail (item->folder == NULL, FALSE);
 
-#ifndef NDEBUG
-      /* find the node in the tree */
-      node = g_node_find (item->model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
-
-      /* debug check to make sure the node is empty or contains a dummy node.
-       * if this is not true, the node already contains sub folders which means
-       * something went wrong. */
-      _thunar_return_val_if_fail (node->children == NULL || G_NODE_HAS_DUMMY (node), FALSE);
-#endif
+  /* debug check to make sure the node is empty or contains a dummy node.
+   * if this is not true, the node already contains sub folders which means
+   * something went wrong. */
+  _thunar_return_val_if_fail (item->node->children == NULL || G_NODE_HAS_DUMMY (item->node), FALSE);
 
   GDK_THREADS_ENTER ();
 
@@ -1443,7 +1516,7 @@ thunar_tree_model_item_load_idle (gpointer user_data)
       if (G_LIKELY (mount_point != NULL))
         {
           /* try to determine the file for the mount point */
-          item->file = thunar_file_get (mount_point, NULL);
+          thunar_tree_model_item_take_file (item, thunar_file_get (mount_point, NULL));
           g_object_unref (mount_point);
         }
     }
@@ -1451,8 +1524,8 @@ thunar_tree_model_item_load_idle (gpointer user_data)
   /* verify that we have a file */
   if (G_LIKELY (item->file != NULL))
     {
-      /* open the folder for the item */
-      item->folder = thunar_folder_get_for_file (item->file);
+      /* open the folder for the item, we are only interested in its sub folders */
+      item->folder = thunar_folder_get_directories_for_file (item->file);
       if (G_LIKELY (item->folder != NULL))
         {
           /* connect signals */
@@ -1498,7 +1571,7 @@ thunar_tree_model_node_insert_dummy (GNode           *parent,
   _thunar_return_if_fail (g_node_n_children (parent) == 0);
 
   /* add the dummy node */
-  node = g_node_append_data (parent, NULL);
+  node = thunar_tree_model_node_link (parent, 0, g_node_new (NULL));
 
   /* determine the iterator for the dummy node */
   GTK_TREE_ITER_INIT (iter, model->stamp, node);
@@ -1517,6 +1590,7 @@ thunar_tree_model_node_drop_dummy (GNode           *node,
 {
   GtkTreePath *path;
   GtkTreeIter  iter;
+  GNode       *dummy;
 
   _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (model));
   _thunar_return_if_fail (G_NODE_HAS_DUMMY (node) && g_node_n_children (node) == 1);
@@ -1532,7 +1606,9 @@ thunar_tree_model_node_drop_dummy (GNode           *node,
       gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
 
       /* drop the dummy from the model */
-      g_node_destroy (node->children);
+      dummy = node->children;
+      thunar_tree_model_node_unlink (dummy, model);
+      g_node_destroy (dummy);
 
       /* determine the iter to the parent node */
       GTK_TREE_ITER_INIT (iter, model->stamp, node);
@@ -1550,74 +1626,278 @@ thunar_tree_model_node_drop_dummy (GNode           *node,
 
 
 
-static gboolean
-thunar_tree_model_node_traverse_cleanup (GNode    *node,
-                                         gpointer  user_data)
+static gint
+thunar_tree_model_node_position (GNode           *node,
+                                 ThunarTreeModel *model)
 {
-  ThunarTreeModelItem *item = node->data;
-  ThunarTreeModel     *model = THUNAR_TREE_MODEL (user_data);
+  GPtrArray  *children;
+  ThunarFile *file;
+  GNode      *child;
+  guint       lower;
+  guint       upper;
+  guint       n;
 
-  if (item && item->folder != NULL && item->ref_count == 0)
+  _thunar_return_val_if_fail (node->parent != NULL, -1);
+
+  /* the "virtual root node" only has a few unsorted children */
+  if (G_UNLIKELY (node->parent == model->root))
+    return g_node_child_position (node->parent, node);
+
+  children = G_NODE_CHILDREN_ARRAY (node->parent);
+
+  /* the children are sorted by name, so binary search the first
+   * child that does not sort before the node */
+  if (G_LIKELY (node->data != NULL && children->len > 1))
     {
-      /* disconnect from the folder */
-      g_signal_handlers_disconnect_matched (G_OBJECT (item->folder), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, item);
-      g_object_unref (G_OBJECT (item->folder));
-      item->folder = NULL;
+      file = THUNAR_TREE_MODEL_ITEM (node->data)->file;
+      for (lower = 0, upper = children->len; lower < upper; )
+        {
+          n = (lower + upper) / 2;
+          child = g_ptr_array_index (children, n);
+          if (thunar_tree_model_cmp_files (THUNAR_TREE_MODEL_ITEM (child->data)->file, file, model) < 0)
+            lower = n + 1;
+          else
+            upper = n;
+        }
 
-      /* remove all the children of the node */
-      while (node->children)
-        g_node_traverse (node->children, G_POST_ORDER, G_TRAVERSE_ALL, -1,
-                         thunar_tree_model_node_traverse_remove, model);
+      /* the node is one of the children that compare equal */
+      for (n = lower; n < children->len; ++n)
+        {
+          child = g_ptr_array_index (children, n);
+          if (child == node)
+            return n;
+          if (thunar_tree_model_cmp_files (THUNAR_TREE_MODEL_ITEM (child->data)->file, file, model) != 0)
+            break;
+        }
+    }
 
-      /* insert a dummy node */
-      thunar_tree_model_node_insert_dummy (node, model);
+  /* not found, the name of a file changed and the node was not
+   * repositioned yet, so fall back to scanning the array */
+  for (n = 0; n < children->len; ++n)
+    if (g_ptr_array_index (children, n) == node)
+      return n;
+
+  return -1;
+}
+
+
+
+static guint
+thunar_tree_model_node_search (GNode           *parent,
+                               ThunarFile      *file,
+                               ThunarTreeModel *model)
+{
+  GPtrArray *children = G_NODE_CHILDREN_ARRAY (parent);
+  GNode     *child;
+  guint      lower;
+  guint      upper;
+  guint      n;
+
+  /* binary search the position after all children that do
+   * not sort after the file */
+  for (lower = 0, upper = children->len; lower < upper; )
+    {
+      n = (lower + upper) / 2;
+      child = g_ptr_array_index (children, n);
+      if (thunar_tree_model_cmp_files (THUNAR_TREE_MODEL_ITEM (child->data)->file, file, model) > 0)
+        upper = n;
+      else
+        lower = n + 1;
     }
 
-  return FALSE;
+  return lower;
 }
 
 
 
-static gboolean
-thunar_tree_model_node_traverse_changed (GNode   *node,
-                                         gpointer user_data)
+static GNode*
+thunar_tree_model_node_link (GNode *parent,
+                             guint  position,
+                             GNode *node)
+{
+  GPtrArray *children = G_NODE_CHILDREN_ARRAY (parent);
+
+  _thunar_return_val_if_fail (position <= children->len, NULL);
+
+  /* insert the node into the child list... */
+  g_node_insert_before (parent, (position < children->len) ? g_ptr_array_index (children, position) : NULL, node);
+
+  /* ...and into the child array */
+  g_ptr_array_add (children, NULL);
+  memmove (children->pdata + position + 1, children->pdata + position,
+           (children->len - position - 1) * sizeof (gpointer));
+  g_ptr_array_index (children, position) = node;
+
+  return node;
+}
+
+
+
+static void
+thunar_tree_model_node_unlink (GNode           *node,
+                               ThunarTreeModel *model)
+{
+  gint position;
+
+  /* drop the node from the child array of its parent */
+  if (G_LIKELY (node->parent != NULL && node->parent != model->root))
+    {
+      position = thunar_tree_model_node_position (node, model);
+      _thunar_assert (position >= 0);
+      g_ptr_array_remove_index (G_NODE_CHILDREN_ARRAY (node->parent), position);
+    }
+
+  g_node_unlink (node);
+}
+
+
+
+static void
+thunar_tree_model_node_insert_files (GNode           *node,
+                                     GList           *files,
+                                     ThunarTreeModel *model)
 {
-  ThunarTreeModel     *model;
+  ThunarTreeModelItem *child_item;
   GtkTreePath         *path;
+  GtkTreePath         *child_path;
   GtkTreeIter          iter;
-  ThunarFile          *file = THUNAR_FILE (user_data);
-  ThunarTreeModelItem *item = THUNAR_TREE_MODEL_ITEM (node->data);
+  GNode               *child_node;
+  GList               *lp;
+  gboolean             replaced_dummy;
+  guint                position;
 
-  /* check if the node's file is the file that changed */
-  if (G_UNLIKELY (item != NULL && item->file == file))
-    {
-      /* determine the tree model from the item */
-      model = THUNAR_TREE_MODEL_ITEM (node->data)->model;
+  _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (model));
+  _thunar_return_if_fail (node != NULL && node != model->root);
 
-      /* determine the iterator for the node */
-      GTK_TREE_ITER_INIT (iter, model->stamp, node);
+  /* determine the path of the parent node once */
+  GTK_TREE_ITER_INIT (iter, model->stamp, node);
+  path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+
+  for (lp = files; lp != NULL; lp = lp->next)
+    {
+      /* allocate a new item for the file */
+      child_item = thunar_tree_model_item_new_with_file (model, lp->data);
 
-      /* check if the changed node is not one of the root nodes */
-      if (G_LIKELY (node->parent != model->root))
+      /* check if the node has only the dummy child */
+      replaced_dummy = G_NODE_HAS_DUMMY (node);
+      if (G_UNLIKELY (replaced_dummy))
         {
-          /* need to re-sort as the name of the file may have changed */
-          thunar_tree_model_sort (model, node->parent);
+          /* replace the dummy node with the new node */
+          child_node = g_node_first_child (node);
+          child_node->data = child_item;
+          position = 0;
         }
-
-      /* determine the path for the node */
-      path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
-      if (G_LIKELY (path != NULL))
+      else
         {
-          /* emit "row-changed" */
-          gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
-          gtk_tree_path_free (path);
+          /* insert a new node for the child at its sorted position */
+          position = thunar_tree_model_node_search (node, lp->data, model);
+          child_node = thunar_tree_model_node_link (node, position, g_node_new (child_item));
         }
 
-      /* stop traversing */
-      return TRUE;
+      child_item->node = child_node;
+
+      /* determine the tree iter and path for the child */
+      GTK_TREE_ITER_INIT (iter, model->stamp, child_node);
+      child_path = gtk_tree_path_copy (path);
+      gtk_tree_path_append_index (child_path, position);
+
+      /* emit a "row-changed" for a replaced dummy or a "row-inserted" for the new node */
+      if (G_UNLIKELY (replaced_dummy))
+        gtk_tree_model_row_changed (GTK_TREE_MODEL (model), child_path, &iter);
+      else
+        gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), child_path, &iter);
+
+      /* add a dummy child node, without looking up its path again */
+      GTK_TREE_ITER_INIT (iter, model->stamp, thunar_tree_model_node_link (child_node, 0, g_node_new (NULL)));
+      gtk_tree_path_append_index (child_path, 0);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), child_path, &iter);
+      gtk_tree_path_free (child_path);
+    }
+
+  gtk_tree_path_free (path);
+}
+
+
+
+static void
+thunar_tree_model_node_reposition (GNode           *node,
+                                   ThunarTreeModel *model)
+{
+  ThunarFile  *file = THUNAR_TREE_MODEL_ITEM (node->data)->file;
+  GtkTreePath *path;
+  GtkTreeIter  iter;
+  GNode       *parent = node->parent;
+  gint        *new_order;
+  gint         old_position;
+  gint         new_position;
+  gint         n_children;
+  gint         n;
+
+  _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (model));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  /* nothing to do if the node is still between its neighbours */
+  if ((node->prev == NULL || thunar_tree_model_cmp_files (THUNAR_TREE_MODEL_ITEM (node->prev->data)->file, file, model) <= 0)
+      && (node->next == NULL || thunar_tree_model_cmp_files (file, THUNAR_TREE_MODEL_ITEM (node->next->data)->file, model) <= 0))
+    return;
+
+  old_position = thunar_tree_model_node_position (node, model);
+  n_children = G_NODE_CHILDREN_ARRAY (parent)->len;
+
+  /* unlink the node and look for its new position among the others */
+  thunar_tree_model_node_unlink (node, model);
+  new_position = thunar_tree_model_node_search (parent, file, model);
+  thunar_tree_model_node_link (parent, new_position, node);
+
+  /* generate the new order, only the moved range changes */
+  new_order = g_new (gint, n_children);
+  for (n = 0; n < n_children; ++n)
+    new_order[n] = n;
+  if (new_position < old_position)
+    {
+      for (n = new_position; n < old_position; ++n)
+        new_order[n + 1] = n;
+    }
+  else
+    {
+      for (n = old_position; n < new_position; ++n)
+        new_order[n] = n + 1;
+    }
+  new_order[new_position] = old_position;
+
+  /* tell the view about the new item order */
+  GTK_TREE_ITER_INIT (iter, model->stamp, parent);
+  path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+  gtk_tree_model_rows_reordered (GTK_TREE_MODEL (model), path, &iter, new_order);
+  gtk_tree_path_free (path);
+  g_free (new_order);
+}
+
+
+
+static gboolean
+thunar_tree_model_node_traverse_cleanup (GNode    *node,
+                                         gpointer  user_data)
+{
+  ThunarTreeModelItem *item = node->data;
+  ThunarTreeModel     *model = THUNAR_TREE_MODEL (user_data);
+
+  if (item && item->folder != NULL && item->ref_count == 0)
+    {
+      /* disconnect from the folder */
+      g_signal_handlers_disconnect_matched (G_OBJECT (item->folder), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, item);
+      g_object_unref (G_OBJECT (item->folder));
+      item->folder = NULL;
+
+      /* remove all the children of the node */
+      while (node->children)
+        g_node_traverse (node->children, G_POST_ORDER, G_TRAVERSE_ALL, -1,
+                         thunar_tree_model_node_traverse_remove, model);
+
+      /* insert a dummy node */
+      thunar_tree_model_node_insert_dummy (node, model);
     }
 
-  /* continue traversing */
   return FALSE;
 }
 
@@ -1643,6 +1923,9 @@ thunar_tree_model_node_traverse_remove (GNode   *node,
       /* emit a "row-deleted" */
       gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
 
+      /* drop the node from its parent, while its item is still alive */
+      thunar_tree_model_node_unlink (node, model);
+
       /* release the item for the node */
       thunar_tree_model_node_traverse_free (node, user_data);
 
@@ -1692,9 +1975,9 @@ thunar_tree_model_node_traverse_visible (GNode    *node,
   ThunarTreeModel     *model = THUNAR_TREE_MODEL (user_data);
   GtkTreePath         *path;
   GtkTreeIter          iter;
-  GNode               *child_node;
   GSList              *lp, *lnext;
-  ThunarTreeModelItem *parent, *child;
+  GList               *visible_files = NULL;
+  ThunarTreeModelItem *parent;
   ThunarFile          *file;
 
   _thunar_return_val_if_fail (model->visible_func != NULL, FALSE);
@@ -1725,6 +2008,7 @@ thunar_tree_model_node_traverse_visible (GNode    *node,
                                                           g_object_ref (G_OBJECT (item->file)));
 
           /* free the item and destroy the node */
+          thunar_tree_model_node_unlink (node, model);
           thunar_tree_model_item_free (item);
           g_node_destroy (node);
         }
@@ -1732,7 +2016,7 @@ thunar_tree_model_node_traverse_visible (GNode    *node,
         {
           /* this node should be visible. check if the node has invisible
            * files that should be visible too */
-          for (lp = item->invisible_children, child_node = NULL; lp != NULL; lp = lnext)
+          for (lp = item->invisible_children; lp != NULL; lp = lnext)
             {
               lnext = lp->next;
               file = THUNAR_FILE (lp->data);
@@ -1741,34 +2025,20 @@ thunar_tree_model_node_traverse_visible (GNode    *node,
 
               if (model->visible_func (model, file, model->visible_data))
                 {
-                  /* allocate a new item for the file */
-                  child = thunar_tree_model_item_new_with_file (model, file);
-
-                  /* insert a new node for the child */
-                  child_node = g_node_append_data (node, child);
-
-                  /* determine the tree iter for the child */
-                  GTK_TREE_ITER_INIT (iter, model->stamp, child_node);
-
-                  /* emit a "row-inserted" for the new node */
-                  path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
-                  gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
-                  gtk_tree_path_free (path);
-
-                  /* release the reference on the file hold by the invisible list */
-                  g_object_unref (G_OBJECT (file));
+                  /* take over the reference hold by the invisible list */
+                  visible_files = g_list_prepend (visible_files, file);
 
                   /* delete the file in the list */
                   item->invisible_children = g_slist_delete_link (item->invisible_children, lp);
-
-                  /* insert dummy */
-                  thunar_tree_model_node_insert_dummy (child_node, model);
                 }
             }
 
-          /* sort this node if one of new children have been added */
-          if (child_node != NULL)
-            thunar_tree_model_sort (model, node);
+          /* insert the new children at their sorted positions */
+          if (visible_files != NULL)
+            {
+              thunar_tree_model_node_insert_files (node, visible_files, model);
+              g_list_free_full (visible_files, g_object_unref);
+            }
         }
     }
 
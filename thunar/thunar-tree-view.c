@@ -30,6 +30,7 @@
 #include <thunar/thunar-create-dialog.h>
 #include <thunar/thunar-dialogs.h>
 #include <thunar/thunar-dnd.h>
+#include <thunar/thunar-folder.h>
 #include <thunar/thunar-gio-extensions.h>
 #include <thunar/thunar-gtk-extensions.h>
 #include <thunar/thunar-job.h>
@@ -49,9 +50,16 @@
 /* the timeout (in ms) until the drag dest row will be expanded */
 #define THUNAR_TREE_VIEW_EXPAND_TIMEOUT (750)
 
+/* the number of folders "Expand All" loads at the same time and
+ * the number of levels it expands below the row it started from */
+#define THUNAR_TREE_VIEW_EXPAND_ALL_MAX_LOADING (4)
+#define THUNAR_TREE_VIEW_EXPAND_ALL_MAX_DEPTH   (8)
 
 
-typedef struct _ThunarTreeViewMountData ThunarTreeViewMountData;
+
+typedef struct _ThunarTreeViewMountData     ThunarTreeViewMountData;
+typedef struct _ThunarTreeViewExpandAll     ThunarTreeViewExpandAll;
+typedef struct _ThunarTreeViewExpandAllItem ThunarTreeViewExpandAllItem;
 
 
 
@@ -127,6 +135,10 @@ static gboolean                 thunar_tree_view_test_expand_row              (G
 static void                     thunar_tree_view_row_collapsed                (GtkTreeView             *tree_view,
                                                                                GtkTreeIter             *iter,
                                                                                GtkTreePath             *path);
+static gboolean                 thunar_tree_view_expand_collapse_cursor_row   (GtkTreeView             *tree_view,
+                                                                               gboolean                 logical,
+                                                                               gboolean                 expand,
+                                                                               gboolean                 open_all);
 static gboolean                 thunar_tree_view_delete_selected_files        (ThunarTreeView          *view);
 static void                     thunar_tree_view_context_menu                 (ThunarTreeView          *view,
                                                                                GdkEventButton          *event,
@@ -161,6 +173,7 @@ static void                     thunar_tree_view_mount                        (T
                                                                                gboolean                 open_after_mounting,
                                                                                guint                    open_in);
 static void                     thunar_tree_view_action_open                  (ThunarTreeView          *view);
+static void                     thunar_tree_view_action_expand_all            (ThunarTreeView          *view);
 static void                     thunar_tree_view_open_selection               (ThunarTreeView          *view);
 static void                     thunar_tree_view_action_open_in_new_window    (ThunarTreeView          *view);
 static void                     thunar_tree_view_action_open_in_new_tab       (ThunarTreeView          *view);
@@ -191,6 +204,24 @@ static ThunarTreeViewMountData *thunar_tree_view_mount_data_new               (T
                                                                                gboolean                 open_after_mounting,
                                                                                guint                    open_in);
 static void                     thunar_tree_view_mount_data_free              (ThunarTreeViewMountData *data);
+static void                     thunar_tree_view_expand_all                   (ThunarTreeView          *view,
+                                                                               GtkTreePath             *path);
+static void                     thunar_tree_view_expand_all_cancel            (ThunarTreeView          *view);
+static void                     thunar_tree_view_expand_all_item_free         (ThunarTreeViewExpandAllItem *item);
+static void                     thunar_tree_view_expand_all_push              (ThunarTreeViewExpandAll *expand_all,
+                                                                               ThunarFile              *file,
+                                                                               guint                    depth);
+static void                     thunar_tree_view_expand_all_pump              (ThunarTreeViewExpandAll *expand_all);
+static void                     thunar_tree_view_expand_all_loaded            (ThunarTreeViewExpandAllItem *item);
+static void                     thunar_tree_view_expand_all_notify_loading    (ThunarTreeViewExpandAllItem *item);
+static void                     thunar_tree_view_expand_all_queue             (ThunarTreeViewExpandAll *expand_all);
+static gboolean                 thunar_tree_view_expand_all_row               (ThunarTreeViewExpandAll *expand_all,
+                                                                               ThunarFile              *file,
+                                                                               GtkTreePath             *path);
+static gboolean                 thunar_tree_view_expand_all_children          (ThunarTreeViewExpandAll *expand_all,
+                                                                               GtkTreeIter             *iter,
+                                                                               GtkTreePath             *path);
+static gboolean                 thunar_tree_view_expand_all_idle              (gpointer                 user_data);
 static gboolean                 thunar_tree_view_get_show_hidden              (ThunarTreeView          *view);
 static void                     thunar_tree_view_set_show_hidden              (ThunarTreeView          *view,
                                                                                gboolean                 show_hidden);
@@ -248,6 +279,9 @@ struct _ThunarTreeView
 
   /* expand drag dest row timer source */
   guint                   expand_timer_id;
+
+  /* running "Expand All" operation (if any) */
+  ThunarTreeViewExpandAll *expand_all;
 };
 
 enum
@@ -265,6 +299,42 @@ struct _ThunarTreeViewMountData
   guint           open_in;
 };
 
+struct _ThunarTreeViewExpandAll
+{
+  ThunarTreeView      *view;
+
+  /* the row the operation was started on, until it is expanded */
+  GtkTreeRowReference *root;
+
+  /* ThunarFile -> ThunarTreeViewExpandAllItem of the folders to
+   * expand. an item keeps its folder alive until the model populated
+   * its row, the model holds the folder from then on */
+  GHashTable          *items;
+
+  /* items waiting for a free loading slot and
+   * the number of items being loaded */
+  GQueue               pending;
+  guint                n_loading;
+
+  /* references of the expanded rows whose children are not all
+   * expanded yet, only these rows are checked after a change */
+  GList               *rows;
+
+  /* batches the row expansions after model changes */
+  guint                expand_idle_id;
+  gulong               model_handler_ids[3];
+};
+
+struct _ThunarTreeViewExpandAllItem
+{
+  ThunarTreeViewExpandAll *expand_all;
+  ThunarFile              *file;
+  ThunarFolder            *folder;
+  guint                    depth;
+  guint                    loaded : 1;
+  guint                    expanded : 1;
+};
+
 
 
 /* Target types for dropping into the tree view */
@@ -311,6 +381,7 @@ thunar_tree_view_class_init (ThunarTreeViewClass *klass)
   gtktree_view_class->row_activated = thunar_tree_view_row_activated;
   gtktree_view_class->test_expand_row = thunar_tree_view_test_expand_row;
   gtktree_view_class->row_collapsed = thunar_tree_view_row_collapsed;
+  gtktree_view_class->expand_collapse_cursor_row = thunar_tree_view_expand_collapse_cursor_row;
 
   klass->delete_selected_files = thunar_tree_view_delete_selected_files;
 
@@ -465,6 +536,9 @@ thunar_tree_view_finalize (GObject *object)
   if (G_UNLIKELY (view->expand_timer_id != 0))
     g_source_remove (view->expand_timer_id);
 
+  /* stop a running "Expand All" */
+  thunar_tree_view_expand_all_cancel (view);
+
   /* reset the current-directory property */
   thunar_navigator_set_current_directory (THUNAR_NAVIGATOR (view), NULL);
 
@@ -1051,12 +1125,42 @@ thunar_tree_view_row_collapsed (GtkTreeView *tree_view,
                                 GtkTreeIter *iter,
                                 GtkTreePath *path)
 {
+  /* the user took over, stop expanding rows */
+  thunar_tree_view_expand_all_cancel (THUNAR_TREE_VIEW (tree_view));
+
   /* schedule a cleanup of the tree model */
   thunar_tree_model_cleanup (THUNAR_TREE_VIEW (tree_view)->model);
 }
 
 
 
+static gboolean
+thunar_tree_view_expand_collapse_cursor_row (GtkTreeView *tree_view,
+                                             gboolean     logical,
+                                             gboolean     expand,
+                                             gboolean     open_all)
+{
+  GtkTreePath *path;
+
+  /* the lazy loaded model only has a dummy below unloaded folders, so
+   * recursive expansion (the "*" key) is done by "Expand All" */
+  if (expand && open_all)
+    {
+      gtk_tree_view_get_cursor (tree_view, &path, NULL);
+      if (G_LIKELY (path != NULL))
+        {
+          thunar_tree_view_expand_all (THUNAR_TREE_VIEW (tree_view), path);
+          gtk_tree_path_free (path);
+          return TRUE;
+        }
+    }
+
+  /* call the parent's handler */
+  return (*GTK_TREE_VIEW_CLASS (thunar_tree_view_parent_class)->expand_collapse_cursor_row) (tree_view, logical, expand, open_all);
+}
+
+
+
 static gboolean
 thunar_tree_view_delete_selected_files (ThunarTreeView *view)
 {
@@ -1134,6 +1238,13 @@ thunar_tree_view_context_menu (ThunarTreeView *view,
   gtk_widget_set_sensitive (item, (file != NULL || device != NULL));
   gtk_widget_show (item);
 
+  /* append the "Expand All" menu action */
+  item = gtk_menu_item_new_with_mnemonic (_("E_xpand All"));
+  g_signal_connect_swapped (G_OBJECT (item), "activate", G_CALLBACK (thunar_tree_view_action_expand_all), view);
+  gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
+  gtk_widget_set_sensitive (item, (file != NULL));
+  gtk_widget_show (item);
+
   /* append a separator item */
   item = gtk_separator_menu_item_new ();
   gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
@@ -2062,6 +2173,28 @@ thunar_tree_view_action_open (ThunarTreeView *view)
 
 
 
+static void
+thunar_tree_view_action_expand_all (ThunarTreeView *view)
+{
+  GtkTreeSelection *selection;
+  GtkTreeModel     *model;
+  GtkTreePath      *path;
+  GtkTreeIter       iter;
+
+  _thunar_return_if_fail (THUNAR_IS_TREE_VIEW (view));
+
+  /* expand the selected row and everything below it */
+  selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (view));
+  if (gtk_tree_selection_get_selected (selection, &model, &iter))
+    {
+      path = gtk_tree_model_get_path (model, &iter);
+      thunar_tree_view_expand_all (view, path);
+      gtk_tree_path_free (path);
+    }
+}
+
+
+
 static void
 thunar_tree_view_open_selection (ThunarTreeView *view)
 {
@@ -2592,6 +2725,395 @@ thunar_tree_view_mount_data_free (ThunarTreeViewMountData *data)
 
 
 
+static void
+thunar_tree_view_expand_all (ThunarTreeView *view,
+                             GtkTreePath    *path)
+{
+  ThunarTreeViewExpandAll *expand_all;
+  GtkTreeModel            *model = GTK_TREE_MODEL (view->model);
+  GtkTreeIter              iter;
+  ThunarFile              *file = NULL;
+
+  _thunar_return_if_fail (THUNAR_IS_TREE_VIEW (view));
+
+  /* only one "Expand All" at a time */
+  thunar_tree_view_expand_all_cancel (view);
+
+  /* determine the file for the row, unmounted devices are skipped */
+  if (gtk_tree_model_get_iter (model, &iter, path))
+    gtk_tree_model_get (model, &iter, THUNAR_TREE_MODEL_COLUMN_FILE, &file, -1);
+  if (G_UNLIKELY (file == NULL))
+    return;
+
+  expand_all = g_slice_new0 (ThunarTreeViewExpandAll);
+  expand_all->view = view;
+  expand_all->root = gtk_tree_row_reference_new (model, path);
+  expand_all->items = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                             (GDestroyNotify) thunar_tree_view_expand_all_item_free);
+  g_queue_init (&expand_all->pending);
+  view->expand_all = expand_all;
+
+  /* every change in the model may allow to expand more rows */
+  expand_all->model_handler_ids[0] = g_signal_connect_swapped (G_OBJECT (model), "row-inserted",
+                                                               G_CALLBACK (thunar_tree_view_expand_all_queue), expand_all);
+  expand_all->model_handler_ids[1] = g_signal_connect_swapped (G_OBJECT (model), "row-changed",
+                                                               G_CALLBACK (thunar_tree_view_expand_all_queue), expand_all);
+  expand_all->model_handler_ids[2] = g_signal_connect_swapped (G_OBJECT (model), "row-deleted",
+                                                               G_CALLBACK (thunar_tree_view_expand_all_queue), expand_all);
+
+  /* start with the folder of the row */
+  thunar_tree_view_expand_all_push (expand_all, file, 0);
+  thunar_tree_view_expand_all_pump (expand_all);
+
+  g_object_unref (G_OBJECT (file));
+}
+
+
+
+static void
+thunar_tree_view_expand_all_cancel (ThunarTreeView *view)
+{
+  ThunarTreeViewExpandAll *expand_all = view->expand_all;
+  guint                    n;
+
+  if (G_LIKELY (expand_all == NULL))
+    return;
+
+  view->expand_all = NULL;
+
+  /* disconnect from the model */
+  for (n = 0; n < G_N_ELEMENTS (expand_all->model_handler_ids); ++n)
+    g_signal_handler_disconnect (G_OBJECT (view->model), expand_all->model_handler_ids[n]);
+
+  /* stop the pending expansions */
+  if (G_UNLIKELY (expand_all->expand_idle_id != 0))
+    g_source_remove (expand_all->expand_idle_id);
+
+  /* drop the remaining folders, releasing the last
+   * reference on a folder cancels its job */
+  g_queue_clear (&expand_all->pending);
+  g_hash_table_destroy (expand_all->items);
+
+  g_list_foreach (expand_all->rows, (GFunc) gtk_tree_row_reference_free, NULL);
+  g_list_free (expand_all->rows);
+
+  if (expand_all->root != NULL)
+    gtk_tree_row_reference_free (expand_all->root);
+  g_slice_free (ThunarTreeViewExpandAll, expand_all);
+}
+
+
+
+static void
+thunar_tree_view_expand_all_item_free (ThunarTreeViewExpandAllItem *item)
+{
+  if (item->folder != NULL)
+    {
+      g_signal_handlers_disconnect_matched (G_OBJECT (item->folder), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, item);
+      g_object_unref (G_OBJECT (item->folder));
+    }
+  g_object_unref (G_OBJECT (item->file));
+  g_slice_free (ThunarTreeViewExpandAllItem, item);
+}
+
+
+
+static void
+thunar_tree_view_expand_all_push (ThunarTreeViewExpandAll *expand_all,
+                                  ThunarFile              *file,
+                                  guint                    depth)
+{
+  ThunarTreeViewExpandAllItem *item;
+
+  /* every folder is expanded once */
+  if (g_hash_table_lookup (expand_all->items, file) != NULL)
+    return;
+
+  item = g_slice_new0 (ThunarTreeViewExpandAllItem);
+  item->expand_all = expand_all;
+  item->file = g_object_ref (G_OBJECT (file));
+  item->depth = depth;
+  g_hash_table_insert (expand_all->items, item->file, item);
+
+  /* the queue is shared by all loading slots, the first slot that
+   * becomes free picks up the next folder */
+  g_queue_push_tail (&expand_all->pending, item);
+}
+
+
+
+static void
+thunar_tree_view_expand_all_pump (ThunarTreeViewExpandAll *expand_all)
+{
+  ThunarTreeViewExpandAllItem *item;
+
+  /* start loading folders until all slots are busy */
+  while (expand_all->n_loading < THUNAR_TREE_VIEW_EXPAND_ALL_MAX_LOADING
+         && (item = g_queue_pop_head (&expand_all->pending)) != NULL)
+    {
+      /* we only need the sub folders, same as the model */
+      item->folder = thunar_folder_get_directories_for_file (item->file);
+      if (G_UNLIKELY (item->folder == NULL))
+        {
+          g_hash_table_remove (expand_all->items, item->file);
+          continue;
+        }
+
+      /* the folder may have been loaded already */
+      if (!thunar_folder_get_loading (item->folder))
+        {
+          thunar_tree_view_expand_all_loaded (item);
+          continue;
+        }
+
+      expand_all->n_loading++;
+      g_signal_connect_swapped (G_OBJECT (item->folder), "notify::loading",
+                                G_CALLBACK (thunar_tree_view_expand_all_notify_loading), item);
+    }
+
+  /* check if everything was expanded once the last folder is in */
+  if (expand_all->n_loading == 0)
+    thunar_tree_view_expand_all_queue (expand_all);
+}
+
+
+
+static void
+thunar_tree_view_expand_all_loaded (ThunarTreeViewExpandAllItem *item)
+{
+  ThunarTreeViewExpandAll *expand_all = item->expand_all;
+  ThunarTreeView          *view = expand_all->view;
+  ThunarFile              *file;
+  GList                   *lp;
+
+  /* queue the visible sub folders above the depth limit, symlinks
+   * are not followed to avoid running in circles */
+  if (item->depth + 1 < THUNAR_TREE_VIEW_EXPAND_ALL_MAX_DEPTH)
+    {
+      for (lp = thunar_folder_get_files (item->folder); lp != NULL; lp = lp->next)
+        {
+          file = THUNAR_FILE (lp->data);
+          if (thunar_file_is_directory (file)
+              && !thunar_file_is_symlink (file)
+              && thunar_tree_view_visible_func (view->model, file, view))
+            thunar_tree_view_expand_all_push (expand_all, file, item->depth + 1);
+        }
+    }
+
+  /* keep the loaded folder until its row is populated, so the
+   * model picks up all sub folders in one batch */
+  item->loaded = TRUE;
+
+  thunar_tree_view_expand_all_queue (expand_all);
+}
+
+
+
+static void
+thunar_tree_view_expand_all_notify_loading (ThunarTreeViewExpandAllItem *item)
+{
+  ThunarTreeViewExpandAll *expand_all = item->expand_all;
+
+  if (thunar_folder_get_loading (item->folder))
+    return;
+
+  /* free the loading slot */
+  g_signal_handlers_disconnect_matched (G_OBJECT (item->folder), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, item);
+  expand_all->n_loading--;
+
+  thunar_tree_view_expand_all_loaded (item);
+
+  /* and give it to the next folder */
+  thunar_tree_view_expand_all_pump (expand_all);
+}
+
+
+
+static void
+thunar_tree_view_expand_all_queue (ThunarTreeViewExpandAll *expand_all)
+{
+  /* schedule the expansion after the model's load idles */
+  if (expand_all->expand_idle_id == 0)
+    {
+      expand_all->expand_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_tree_view_expand_all_idle,
+                                                    expand_all, NULL);
+    }
+}
+
+
+
+/* expands the row of @file at @path once its folder is loaded,
+ * returns %TRUE while the folder is still loading */
+static gboolean
+thunar_tree_view_expand_all_row (ThunarTreeViewExpandAll *expand_all,
+                                 ThunarFile              *file,
+                                 GtkTreePath             *path)
+{
+  ThunarTreeViewExpandAllItem *item;
+  GtkTreeModel                *model = GTK_TREE_MODEL (expand_all->view->model);
+  GtkTreeView                 *tree_view = GTK_TREE_VIEW (expand_all->view);
+
+  /* skip the folders that are not expanded or were done already */
+  item = g_hash_table_lookup (expand_all->items, file);
+  if (item == NULL || item->expanded)
+    return FALSE;
+
+  if (!item->loaded)
+    return TRUE;
+
+  item->expanded = TRUE;
+
+  if (gtk_tree_view_row_expanded (tree_view, path))
+    {
+      /* the row was expanded before, so no model change
+       * will tell us to check its children */
+      expand_all->rows = g_list_prepend (expand_all->rows, gtk_tree_row_reference_new (model, path));
+      thunar_tree_view_expand_all_queue (expand_all);
+    }
+  else if (gtk_tree_view_expand_row (tree_view, path, FALSE))
+    {
+      /* the model adds the children from the loaded folder */
+      expand_all->rows = g_list_prepend (expand_all->rows, gtk_tree_row_reference_new (model, path));
+    }
+  else
+    {
+      /* the folder has no sub folders */
+      g_hash_table_remove (expand_all->items, file);
+    }
+
+  return FALSE;
+}
+
+
+
+/* expands the loaded child folders of the expanded row at @iter, returns
+ * %TRUE while the row is not populated or a child folder is loading */
+static gboolean
+thunar_tree_view_expand_all_children (ThunarTreeViewExpandAll *expand_all,
+                                      GtkTreeIter             *iter,
+                                      GtkTreePath             *path)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (expand_all->view->model);
+  GtkTreeIter   child_iter;
+  ThunarFile   *file;
+  gboolean      populated = TRUE;
+  gboolean      busy = FALSE;
+
+  if (gtk_tree_model_iter_children (model, &child_iter, iter))
+    {
+      gtk_tree_path_down (path);
+      do
+        {
+          gtk_tree_model_get (model, &child_iter, THUNAR_TREE_MODEL_COLUMN_FILE, &file, -1);
+          if (file == NULL)
+            {
+              /* the model did not yet replace the dummy */
+              populated = FALSE;
+            }
+          else
+            {
+              if (thunar_tree_view_expand_all_row (expand_all, file, path))
+                busy = TRUE;
+              g_object_unref (G_OBJECT (file));
+            }
+          gtk_tree_path_next (path);
+        }
+      while (gtk_tree_model_iter_next (model, &child_iter));
+      gtk_tree_path_up (path);
+    }
+
+  /* the model keeps the folder of a populated row */
+  if (populated)
+    {
+      gtk_tree_model_get (model, iter, THUNAR_TREE_MODEL_COLUMN_FILE, &file, -1);
+      if (G_LIKELY (file != NULL))
+        {
+          g_hash_table_remove (expand_all->items, file);
+          g_object_unref (G_OBJECT (file));
+        }
+    }
+
+  return !populated || busy;
+}
+
+
+
+static gboolean
+thunar_tree_view_expand_all_idle (gpointer user_data)
+{
+  ThunarTreeViewExpandAll *expand_all = user_data;
+  ThunarTreeView          *view = expand_all->view;
+  GtkTreeModel            *model = GTK_TREE_MODEL (view->model);
+  GtkTreePath             *path;
+  GtkTreeIter              iter;
+  ThunarFile              *file = NULL;
+  gboolean                 busy = FALSE;
+  GList                   *rows;
+  GList                   *lp;
+
+  GDK_THREADS_ENTER ();
+
+  /* the idle may free the operation, so there is no destroy notify */
+  expand_all->expand_idle_id = 0;
+
+  /* expand the root row once its folder is loaded */
+  if (expand_all->root != NULL)
+    {
+      path = gtk_tree_row_reference_get_path (expand_all->root);
+      if (G_LIKELY (path != NULL))
+        {
+          if (gtk_tree_model_get_iter (model, &iter, path))
+            gtk_tree_model_get (model, &iter, THUNAR_TREE_MODEL_COLUMN_FILE, &file, -1);
+          if (G_LIKELY (file != NULL))
+            {
+              busy = thunar_tree_view_expand_all_row (expand_all, file, path);
+              g_object_unref (G_OBJECT (file));
+            }
+          gtk_tree_path_free (path);
+        }
+
+      if (!busy)
+        {
+          gtk_tree_row_reference_free (expand_all->root);
+          expand_all->root = NULL;
+        }
+    }
+
+  /* check the children of the expanded rows, the rows that are
+   * populated and have no loading sub folders are done */
+  rows = expand_all->rows;
+  expand_all->rows = NULL;
+  for (lp = rows; lp != NULL; lp = lp->next)
+    {
+      busy = FALSE;
+
+      path = gtk_tree_row_reference_get_path (lp->data);
+      if (G_LIKELY (path != NULL))
+        {
+          if (gtk_tree_model_get_iter (model, &iter, path))
+            busy = thunar_tree_view_expand_all_children (expand_all, &iter, path);
+          gtk_tree_path_free (path);
+        }
+
+      if (busy)
+        expand_all->rows = g_list_prepend (expand_all->rows, lp->data);
+      else
+        gtk_tree_row_reference_free (lp->data);
+    }
+  g_list_free (rows);
+
+  /* we're done when all folders are loaded and expanded, or the rows are gone */
+  if (expand_all->root == NULL && expand_all->rows == NULL
+      && expand_all->n_loading == 0 && g_queue_is_empty (&expand_all->pending))
+    thunar_tree_view_expand_all_cancel (view);
+
+  GDK_THREADS_LEAVE ();
+
+  return FALSE;
+}
+
+
+
 /**
  * thunar_tree_view_get_show_hidden:
  * @view : a #ThunarTreeView.
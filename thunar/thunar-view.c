@@ -162,6 +162,24 @@ thunar_view_get_statusbar_text (ThunarView *view)
 
 
 
+/**
+ * thunar_view_get_n_selected_files:
+ * @view : a #ThunarView instance.
+ *
+ * Returns the number of files selected in @view, without
+ * building the list of selected files.
+ *
+ * Return value: the number of selected files in @view.
+ **/
+guint
+thunar_view_get_n_selected_files (ThunarView *view)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_VIEW (view), 0);
+  return (*THUNAR_VIEW_GET_IFACE (view)->get_n_selected_files) (view);
+}
+
+
+
 /**
  * thunar_view_get_show_hidden:
  * @view : a #ThunarView instance.
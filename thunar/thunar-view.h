@@ -41,6 +41,7 @@ struct _ThunarViewIface
   /* virtual methods */
   gboolean        (*get_loading)        (ThunarView     *view);
   const gchar    *(*get_statusbar_text) (ThunarView     *view);
+  guint           (*get_n_selected_files) (ThunarView   *view);
 
   gboolean        (*get_show_hidden)    (ThunarView     *view);
   void            (*set_show_hidden)    (ThunarView     *view,
@@ -69,6 +70,7 @@ GType           thunar_view_get_type            (void) G_GNUC_CONST;
 
 gboolean        thunar_view_get_loading         (ThunarView     *view);
 const gchar    *thunar_view_get_statusbar_text  (ThunarView     *view);
+guint           thunar_view_get_n_selected_files (ThunarView    *view);
 
 gboolean        thunar_view_get_show_hidden     (ThunarView     *view);
 void            thunar_view_set_show_hidden     (ThunarView     *view,
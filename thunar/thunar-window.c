@@ -230,6 +230,11 @@ static void     thunar_window_menu_item_deselected        (GtkWidget
 static void     thunar_window_update_custom_actions       (ThunarView             *view,
                                                            GParamSpec             *pspec,
                                                            ThunarWindow           *window);
+static void     thunar_window_selection_changed           (ThunarView             *view,
+                                                           GParamSpec             *pspec,
+                                                           ThunarWindow           *window);
+static gboolean thunar_window_selection_idle              (gpointer                user_data);
+static void     thunar_window_selection_idle_destroy      (gpointer                user_data);
 static void     thunar_window_notify_loading              (ThunarView             *view,
                                                            GParamSpec             *pspec,
                                                            ThunarWindow           *window);
@@ -331,6 +336,9 @@ struct _ThunarWindow
   /* menu merge idle source */
   guint                   merge_idle_id;
 
+  /* selection update idle source */
+  guint                   selection_idle_id;
+
   /* support to remember window geometry */
   guint                   save_geometry_timer_id;
 
@@ -939,6 +947,10 @@ thunar_window_dispose (GObject *object)
   if (G_UNLIKELY (window->merge_idle_id != 0))
     g_source_remove (window->merge_idle_id);
 
+  /* destroy the selection idle source */
+  if (G_UNLIKELY (window->selection_idle_id != 0))
+    g_source_remove (window->selection_idle_id);
+
   /* un-merge the custom preferences */
   if (G_LIKELY (window->custom_preferences_merge_id != 0))
     {
@@ -1434,24 +1446,10 @@ thunar_window_notebook_switch_page (GtkWidget    *notebook,
   thunar_window_binding_create (window, window, "current-directory", page, "current-directory", G_BINDING_DEFAULT);
   thunar_window_binding_create (window, window, "show-hidden", page, "show-hidden", G_BINDING_SYNC_CREATE);
   thunar_window_binding_create (window, page, "loading", window->spinner, "active", G_BINDING_SYNC_CREATE);
-  thunar_window_binding_create (window, page, "selected-files", window->launcher, "selected-files", G_BINDING_SYNC_CREATE);
   thunar_window_binding_create (window, page, "zoom-level", window, "zoom-level", G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
 
-  /* connect to the location bar (if any) */
-  if (G_LIKELY (window->location_bar != NULL))
-    {
-      thunar_window_binding_create (window, page, "selected-files",
-                                    window->location_bar, "selected-files",
-                                    G_BINDING_SYNC_CREATE);
-    }
-
-  /* connect to the sidepane (if any) */
-  if (G_LIKELY (window->sidepane != NULL))
-    {
-      thunar_window_binding_create (window, page, "selected-files",
-                                    window->sidepane, "selected-files",
-                                    G_BINDING_SYNC_CREATE);
-    }
+  /* the launcher queries the selected files when it needs them */
+  thunar_launcher_set_selection_source (window->launcher, THUNAR_COMPONENT (page));
 
   /* connect to the statusbar (if any) */
   if (G_LIKELY (window->statusbar != NULL))
@@ -1513,7 +1511,7 @@ thunar_window_notebook_page_added (GtkWidget    *notebook,
 
   /* connect signals */
   g_signal_connect (G_OBJECT (page), "notify::loading", G_CALLBACK (thunar_window_notify_loading), window);
-  g_signal_connect (G_OBJECT (page), "notify::selected-files", G_CALLBACK (thunar_window_update_custom_actions), window);
+  g_signal_connect (G_OBJECT (page), "notify::selected-files", G_CALLBACK (thunar_window_selection_changed), window);
   g_signal_connect_swapped (G_OBJECT (page), "start-open-location", G_CALLBACK (thunar_window_start_open_location), window);
   g_signal_connect_swapped (G_OBJECT (page), "change-directory", G_CALLBACK (thunar_window_set_current_directory), window);
   g_signal_connect_swapped (G_OBJECT (page), "open-new-tab", G_CALLBACK (thunar_window_notebook_insert), window);
@@ -1811,10 +1809,6 @@ thunar_window_install_location_bar (ThunarWindow *window,
       g_signal_connect_swapped (G_OBJECT (window->location_bar), "change-directory", G_CALLBACK (thunar_window_set_current_directory), window);
       g_signal_connect_swapped (G_OBJECT (window->location_bar), "open-new-tab", G_CALLBACK (thunar_window_notebook_insert), window);
 
-      /* connect the location widget to the view (if any) */
-      if (G_LIKELY (window->view != NULL))
-        thunar_window_binding_create (window, window->view, "selected-files", window->location_bar, "selected-files", G_BINDING_SYNC_CREATE);
-
       /* check if the location bar should be placed into a toolbar */
       if (!thunar_location_bar_is_standalone (THUNAR_LOCATION_BAR (window->location_bar)))
         {
@@ -1881,9 +1875,9 @@ thunar_window_install_sidepane (ThunarWindow *window,
       gtk_paned_pack1 (GTK_PANED (window->paned), window->sidepane, FALSE, FALSE);
       gtk_widget_show (window->sidepane);
 
-      /* connect the side pane widget to the view (if any) */
+      /* pass the selected files of the view (if any) to the side pane */
       if (G_LIKELY (window->view != NULL))
-        thunar_window_binding_create (window, window->view, "selected-files", window->sidepane, "selected-files", G_BINDING_SYNC_CREATE);
+        thunar_window_selection_changed (THUNAR_VIEW (window->view), NULL, window);
     }
 
   /* remember the setting */
@@ -3319,6 +3313,65 @@ thunar_window_menu_item_deselected (GtkWidget    *menu_item,
 
 
 
+static void
+thunar_window_selection_changed (ThunarView   *view,
+                                 GParamSpec   *pspec,
+                                 ThunarWindow *window)
+{
+  _thunar_return_if_fail (THUNAR_IS_VIEW (view));
+  _thunar_return_if_fail (THUNAR_IS_WINDOW (window));
+
+  /* leave if the signal is emitted from a non-active tab */
+  if (window->view != GTK_WIDGET (view))
+    return;
+
+  /* update the side pane and the custom actions once the
+   * selection settled, instead of for every changed row */
+  if (window->selection_idle_id == 0)
+    {
+      window->selection_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_window_selection_idle,
+                                                   window, thunar_window_selection_idle_destroy);
+    }
+}
+
+
+
+static gboolean
+thunar_window_selection_idle (gpointer user_data)
+{
+  ThunarWindow *window = THUNAR_WINDOW (user_data);
+  GList        *selected_files;
+
+  GDK_THREADS_ENTER ();
+
+  if (G_LIKELY (window->view != NULL))
+    {
+      /* only the shortcuts pane looks at the selected files */
+      if (window->sidepane != NULL && THUNAR_IS_SHORTCUTS_PANE (window->sidepane))
+        {
+          selected_files = thunar_component_get_selected_files (THUNAR_COMPONENT (window->view));
+          thunar_component_set_selected_files (THUNAR_COMPONENT (window->sidepane), selected_files);
+        }
+
+      /* reload the actions of the menu providers */
+      thunar_window_update_custom_actions (THUNAR_VIEW (window->view), NULL, window);
+    }
+
+  GDK_THREADS_LEAVE ();
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_window_selection_idle_destroy (gpointer user_data)
+{
+  THUNAR_WINDOW (user_data)->selection_idle_id = 0;
+}
+
+
+
 static void
 thunar_window_update_custom_actions (ThunarView   *view,
                                      GParamSpec   *pspec,
@@ -3347,8 +3400,11 @@ thunar_window_update_custom_actions (ThunarView   *view,
       /* grab a reference to the current directory of the window */
       folder = thunar_window_get_current_directory (window);
 
-      /* get a list of selected files */
-      selected_files = thunar_component_get_selected_files (THUNAR_COMPONENT (view));
+      /* get a list of selected files (only if there are any) */
+      if (thunar_view_get_n_selected_files (view) > 0)
+        selected_files = thunar_component_get_selected_files (THUNAR_COMPONENT (view));
+      else
+        selected_files = NULL;
 
       /* load the actions offered by the menu providers */
       for (lp = providers; lp != NULL; lp = lp->next)